@@ -0,0 +1,236 @@
+// 轨迹球相机基准测试（只使用CPU，不需要OpenGL上下文）：ArcballCamera（四元数）与之前保存三个点的实现对比
+//  -- 随机生成一串鼠标拖动事件（大部分为 Arcball 旋转，少量 Planar 平移），两种实现处理相同的事件
+//  -- accuracy : 前若干个事件中每个事件之后两者视图矩阵元素的最大差，以及处理完所有事件后的差
+//  -- drift    : 处理完所有事件后视图矩阵旋转部分偏离正交矩阵的程度，以及到观察点距离的相对变化
+//  -- speed    : 每秒处理的事件数（每个事件之后取一次视图矩阵）
+// 用法：arcball_camera_benchmark [--out result.json] [--events N] [--compare N]
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "arcball_camera.h"
+#include "benchmark_utils.h"
+
+const int VIEW_WIDTH = 1280;
+const int VIEW_HEIGHT = 720;
+const int PLANAR_INTERVAL = 10;     // 每隔多少个事件有一个平移事件
+
+// 之前的实现：保存相机位置、观察点以及位置 + 右方向、位置 + 上方向两个点，旋转时用矩阵分别旋转三个点
+class LegacyArcballCamera {
+public:
+    LegacyArcballCamera(glm::vec3 position, glm::vec3 lookat, glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f))
+        : m_position(position), m_frontPoint(lookat) {
+        glm::vec3 frontDir = getFrontDir();
+        glm::vec3 rightDir = glm::normalize(glm::cross(frontDir, worldUp));
+        glm::vec3 upDir = glm::normalize(glm::cross(rightDir, frontDir));
+        m_rightPoint = m_position + rightDir;
+        m_upPoint = m_position + upDir;
+    }
+
+    glm::mat4 getViewMatrix() const {
+        glm::vec3 front = getFrontDir();
+        glm::vec3 right = getRightDir();
+        glm::vec3 up = getUpDir();
+
+        glm::mat4 result = glm::mat4(1.0f);
+        result[0][0] = right.x;
+        result[1][0] = right.y;
+        result[2][0] = right.z;
+        result[0][1] = up.x;
+        result[1][1] = up.y;
+        result[2][1] = up.z;
+        result[0][2] = -front.x;
+        result[1][2] = -front.y;
+        result[2][2] = -front.z;
+        result[3][0] = -glm::dot(right, m_position);
+        result[3][1] = -glm::dot(up, m_position);
+        result[3][2] = glm::dot(front, m_position);
+        return result;
+    }
+
+    glm::vec3 getPosition() const {
+        return m_position;
+    }
+
+    void processMouseMovement(int viewWidth, int viewHeight, float xoffset, float yoffset, ArcballCamera::MoveStyle moveStyle) {
+        glm::vec3 right = getRightDir();
+        glm::vec3 up = getUpDir();
+        if (moveStyle == ArcballCamera::MoveStyle::Planar) {
+            glm::vec3 offset = m_sensitive * glm::vec3(xoffset * right - yoffset * up);
+            m_position += offset;
+            m_frontPoint += offset;
+            m_rightPoint = m_position + right;
+            m_upPoint = m_position + up;
+        } else if (moveStyle == ArcballCamera::MoveStyle::Arcball) {
+            float deltaAngleX = (2.0f * PI / viewWidth) * xoffset;
+            float deltaAngleY = (PI / viewHeight) * yoffset;
+
+            glm::vec3 newPosition = rotatePoint(m_position, deltaAngleX, deltaAngleY);
+            glm::vec3 newRightPoint = rotatePoint(m_rightPoint, deltaAngleX, deltaAngleY);
+            glm::vec3 newUpPoint = rotatePoint(m_upPoint, deltaAngleX, deltaAngleY);
+
+            m_position = newPosition;
+            m_rightPoint = newRightPoint;
+            m_upPoint = newUpPoint;
+        }
+    }
+
+private:
+    static constexpr float PI = 3.14159265359f;
+
+    glm::vec3 m_position;
+    glm::vec3 m_frontPoint;
+    glm::vec3 m_rightPoint;
+    glm::vec3 m_upPoint;
+    float m_sensitive = 0.01f;
+
+    glm::vec3 getFrontDir() const {
+        return glm::normalize(m_frontPoint - m_position);
+    }
+
+    glm::vec3 getRightDir() const {
+        return glm::normalize(m_rightPoint - m_position);
+    }
+
+    glm::vec3 getUpDir() const {
+        return glm::normalize(m_upPoint - m_position);
+    }
+
+    glm::vec3 rotatePoint(glm::vec3 point, float angleX, float angleY) const {
+        glm::mat4 rotationX = glm::rotate(glm::mat4(1.0f), angleX, getUpDir());
+        glm::vec3 result = glm::vec3(rotationX * glm::vec4(point - m_frontPoint, 1.0f)) + m_frontPoint;
+
+        glm::mat4 rotationY = glm::rotate(glm::mat4(1.0f), angleY, getRightDir());
+        result = glm::vec3(rotationY * glm::vec4(result - m_frontPoint, 1.0f)) + m_frontPoint;
+        return result;
+    }
+};
+
+struct MouseEvent {
+    float xoffset;
+    float yoffset;
+    ArcballCamera::MoveStyle style;
+};
+
+// 拖动的速度平滑变化，偶尔夹杂平移
+std::vector<MouseEvent> createEvents(int count) {
+    std::vector<MouseEvent> events(count);
+    uint32_t seed = 43u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    float x = 0.0f;
+    float y = 0.0f;
+    for (int i = 0; i < count; i++) {
+        x = 0.9f * x + (random() - 0.5f) * 4.0f;
+        y = 0.9f * y + (random() - 0.5f) * 4.0f;
+        ArcballCamera::MoveStyle style = i % PLANAR_INTERVAL == PLANAR_INTERVAL - 1 ? ArcballCamera::MoveStyle::Planar : ArcballCamera::MoveStyle::Arcball;
+        events[i] = {x, y, style};
+    }
+    return events;
+}
+
+float maxDifference(const glm::mat4& a, const glm::mat4& b) {
+    float result = 0.0f;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            result = std::max(result, std::abs(a[column][row] - b[column][row]));
+        }
+    }
+    return result;
+}
+
+// 旋转部分 R * R^T 与单位矩阵的最大差
+float orthogonalityError(const glm::mat4& view) {
+    glm::mat3 rotation(view);
+    glm::mat3 product = rotation * glm::transpose(rotation);
+    float result = 0.0f;
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            result = std::max(result, std::abs(product[column][row] - (column == row ? 1.0f : 0.0f)));
+        }
+    }
+    return result;
+}
+
+// 视图矩阵的和，防止编译器删除计算
+float checksum(const glm::mat4& view) {
+    return view[0][0] + view[1][1] + view[2][2] + view[3][0] + view[3][1] + view[3][2];
+}
+
+int main(int argc, char** argv) {
+    const int eventCount = std::max(1, getIntArgument(argc, argv, "--events", 1000000));
+    const int compareCount = std::min(eventCount, std::max(1, getIntArgument(argc, argv, "--compare", 1000)));
+
+    const glm::vec3 position(0.0f, 2.0f, 10.0f);
+    const glm::vec3 lookat(0.0f, 0.0f, 0.0f);
+    const float distance = glm::length(lookat - position);
+    std::vector<MouseEvent> events = createEvents(eventCount);
+
+    BenchmarkReport report("arcball_camera");
+    report.info()
+        .set("events", eventCount)
+        .set("compare_events", compareCount);
+
+    // accuracy / drift
+    {
+        ArcballCamera camera(position, lookat);
+        LegacyArcballCamera legacy(position, lookat);
+        float maxCompareDifference = 0.0f;
+        for (int i = 0; i < eventCount; i++) {
+            const MouseEvent& event = events[i];
+            camera.processMouseMovement(VIEW_WIDTH, VIEW_HEIGHT, event.xoffset, event.yoffset, event.style);
+            legacy.processMouseMovement(VIEW_WIDTH, VIEW_HEIGHT, event.xoffset, event.yoffset, event.style);
+            if (i < compareCount) {
+                maxCompareDifference = std::max(maxCompareDifference, maxDifference(camera.getViewMatrix(), legacy.getViewMatrix()));
+            }
+        }
+        glm::mat4 view = camera.getViewMatrix();
+        glm::mat4 legacyView = legacy.getViewMatrix();
+        report.addRecord()
+            .set("stage", "accuracy")
+            .set("max_difference", maxCompareDifference)
+            .set("final_difference", maxDifference(view, legacyView));
+        report.addRecord()
+            .set("stage", "drift")
+            .set("quaternion_orthogonality_error", orthogonalityError(view))
+            .set("legacy_orthogonality_error", orthogonalityError(legacyView))
+            .set("quaternion_distance_error", std::abs(glm::length(camera.getPosition() - camera.getPivot()) - distance) / distance);
+    }
+
+    // speed
+    {
+        float sum = 0.0f;
+        ArcballCamera camera(position, lookat);
+        Timer timer;
+        for (const MouseEvent& event : events) {
+            camera.processMouseMovement(VIEW_WIDTH, VIEW_HEIGHT, event.xoffset, event.yoffset, event.style);
+            sum += checksum(camera.getViewMatrix());
+        }
+        double quaternionMs = timer.elapsedMs();
+
+        LegacyArcballCamera legacy(position, lookat);
+        Timer legacyTimer;
+        for (const MouseEvent& event : events) {
+            legacy.processMouseMovement(VIEW_WIDTH, VIEW_HEIGHT, event.xoffset, event.yoffset, event.style);
+            sum += checksum(legacy.getViewMatrix());
+        }
+        double legacyMs = legacyTimer.elapsedMs();
+
+        report.addRecord()
+            .set("stage", "speed")
+            .set("quaternion_updates_per_second", eventCount / (quaternionMs / 1000.0))
+            .set("legacy_updates_per_second", eventCount / (legacyMs / 1000.0))
+            .set("speedup", legacyMs / quaternionMs)
+            .set("checksum", sum);
+    }
+
+    report.write(argc, argv);
+    return 0;
+}
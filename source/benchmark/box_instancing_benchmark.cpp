@@ -0,0 +1,169 @@
+// 大量盒子的绘制压力测试，对比两种提交方式：
+//  -- per_object : 每个盒子一个 Box 对象，每帧 N 次 draw()
+//  -- instanced  : 一个 BoxInstancer，每帧一次 glDrawElementsInstanced，只上传被修改的实例
+// 每帧都会移动一部分盒子，统计CPU提交时间、GPU时间和整帧时间（提交到glFinish返回）
+// 用法：box_instancing_benchmark [--out result.json] [--count N] [--frames N] [--moving-percent N] [--skip-per-object]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "box.h"
+#include "box_instancer.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+
+struct Scene {
+    std::vector<glm::vec3> centers;
+    std::vector<glm::vec3> extensions;
+    std::vector<glm::vec4> colors;
+    size_t movingCount = 0;
+};
+
+// 盒子排列成立方体网格，颜色和大小随位置变化
+Scene createScene(size_t count, int movingPercent) {
+    Scene scene;
+    int side = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(count))));
+    float spacing = 3.0f;
+    float offset = (side - 1) * spacing * 0.5f;
+    for (size_t i = 0; i < count; i++) {
+        int x = static_cast<int>(i % side);
+        int y = static_cast<int>((i / side) % side);
+        int z = static_cast<int>(i / (static_cast<size_t>(side) * side));
+        scene.centers.emplace_back(x * spacing - offset, y * spacing - offset, z * spacing - offset);
+        scene.extensions.emplace_back(0.5f + 0.5f * (x % 3) / 2.0f, 0.5f + 0.5f * (y % 3) / 2.0f, 0.5f + 0.5f * (z % 3) / 2.0f);
+        scene.colors.emplace_back(static_cast<float>(x) / side, static_cast<float>(y) / side, static_cast<float>(z) / side, 1.0f);
+    }
+    scene.movingCount = count * movingPercent / 100;
+    return scene;
+}
+
+glm::vec3 animatedCenter(const Scene& scene, size_t index, int frame) {
+    return scene.centers[index] + glm::vec3(0.0f, std::sin(frame * 0.1f + index * 0.01f), 0.0f);
+}
+
+struct FrameStats {
+    std::vector<double> submitMs;
+    std::vector<double> gpuMs;
+    std::vector<double> frameMs;
+};
+
+template <typename DrawFunction>
+FrameStats runFrames(int frames, const ShaderProgram& shaderProgram, DrawFunction&& drawScene) {
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 1000.0f);
+    FrameStats stats;
+    GpuTimer gpuTimer;
+    for (int frame = 0; frame < frames; frame++) {
+        float angle = frame * 0.01f;
+        glm::mat4 view = glm::lookAt(glm::vec3(200.0f * std::sin(angle), 80.0f, 200.0f * std::cos(angle)),
+                                     glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        Timer frameTimer;
+        gpuTimer.begin();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shaderProgram.use();
+        shaderProgram.setUniform("view", view);
+        shaderProgram.setUniform("projection", projection);
+
+        Timer submitTimer;
+        drawScene(frame);
+        stats.submitMs.push_back(submitTimer.elapsedMs());
+        gpuTimer.end();
+
+        glFinish();
+        stats.frameMs.push_back(frameTimer.elapsedMs());
+        stats.gpuMs.push_back(gpuTimer.resultMs());
+    }
+    return stats;
+}
+
+void addRecord(BenchmarkReport& report, const char* mode, size_t count, const FrameStats& stats) {
+    report.addRecord()
+        .set("mode", mode)
+        .set("boxes", count)
+        .set("cpu_submit_ms", median(stats.submitMs))
+        .set("gpu_ms", median(stats.gpuMs))
+        .set("frame_ms", median(stats.frameMs));
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 100000)));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 100));
+    const int movingPercent = std::max(0, std::min(100, getIntArgument(argc, argv, "--moving-percent", 1)));
+    Scene scene = createScene(count, movingPercent);
+
+    BenchmarkReport report("box_instancing");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("frames", frames)
+        .set("moving_boxes", scene.movingCount);
+
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    using ShaderType = ShaderProgram::ShaderType;
+    {
+        ShaderProgram shaderProgram(
+            {
+                {ShaderType::VERTEX, "shaders/box_instanced.vert"},
+                {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+            }
+        );
+        BoxInstancer instancer(count);
+        for (size_t i = 0; i < count; i++) {
+            instancer.add(scene.centers[i], scene.extensions[i], scene.colors[i]);
+        }
+        FrameStats stats = runFrames(frames, shaderProgram, [&](int frame) {
+            // 移动的盒子位于实例数组的开头，每帧只上传这一段
+            for (size_t i = 0; i < scene.movingCount; i++) {
+                instancer.setCenter(i, animatedCenter(scene, i, frame));
+            }
+            instancer.draw();
+        });
+        addRecord(report, "instanced", count, stats);
+    }
+
+    if (!hasArgument(argc, argv, "--skip-per-object")) {
+        ShaderProgram shaderProgram(
+            {
+                {ShaderType::VERTEX, "shaders/box_single.vert"},
+                {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+            }
+        );
+        std::vector<std::unique_ptr<Box>> boxes;
+        boxes.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            boxes.push_back(std::make_unique<Box>(scene.centers[i], scene.extensions[i]));
+        }
+        FrameStats stats = runFrames(frames, shaderProgram, [&](int frame) {
+            for (size_t i = 0; i < count; i++) {
+                glm::vec3 center = i < scene.movingCount ? animatedCenter(scene, i, frame) : scene.centers[i];
+                shaderProgram.setUniform("model", glm::translate(glm::mat4(1.0f), center));
+                shaderProgram.setUniform("color", scene.colors[i]);
+                boxes[i]->draw();
+            }
+        });
+        addRecord(report, "per_object", count, stats);
+    }
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,226 @@
+// BVH基准测试（只使用CPU，不需要OpenGL上下文）
+//  -- objects   : 随机分布的大量物体（默认100k个AABB），统计构建耗时、节点数、深度和每秒射线数
+//                 与逐个测试所有物体的暴力方法对比，检查最近的相交结果是否一致
+//  -- refit     : 所有物体随机移动一小段距离后 refit() 和重新 build() 的耗时，以及两者的射线查询速度
+//  -- triangles : 以网格的三角形为图元（高精度球），射线从四周射向球心
+// 用法：bvh_benchmark [--out result.json] [--count N] [--rays N] [--frequency N]
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "bvh.h"
+#include "procedural_mesh.h"
+
+const float WORLD_SIZE = 200.0f;
+
+class Random {
+public:
+    explicit Random(uint32_t seed) : m_seed(seed) {}
+
+    float next() {
+        m_seed = m_seed * 1664525u + 1013904223u;
+        return static_cast<float>(m_seed >> 8) / 16777216.0f;
+    }
+
+    glm::vec3 nextVector() {
+        float x = next(), y = next(), z = next();
+        return glm::vec3(x, y, z) - 0.5f;
+    }
+
+private:
+    uint32_t m_seed;
+};
+
+std::vector<Aabb> createObjects(size_t count, Random& random) {
+    std::vector<Aabb> bounds(count);
+    for (auto& box : bounds) {
+        glm::vec3 center = random.nextVector() * WORLD_SIZE;
+        glm::vec3 extent = glm::vec3(0.1f) + glm::vec3(random.next(), random.next(), random.next()) * 0.9f;
+        box = {center - extent, center + extent};
+    }
+    return bounds;
+}
+
+// 射线从场景边界附近射向场景内的随机点
+std::vector<Ray> createRays(size_t count, float size, Random& random) {
+    std::vector<Ray> rays(count);
+    for (auto& ray : rays) {
+        glm::vec3 origin = glm::normalize(random.nextVector() + glm::vec3(1e-4f)) * size;
+        glm::vec3 target = random.nextVector() * size * 0.5f;
+        ray = {origin, glm::normalize(target - origin)};
+    }
+    return rays;
+}
+
+template <typename Query>
+double measureRaysPerSecond(const std::vector<Ray>& rays, std::vector<RayHit>& hits, Query&& query) {
+    hits.resize(rays.size());
+    Timer timer;
+    for (size_t i = 0; i < rays.size(); i++) {
+        hits[i] = query(rays[i]);
+    }
+    double ms = timer.elapsedMs();
+    return ms > 0.0 ? static_cast<double>(rays.size()) / ms * 1000.0 : 0.0;
+}
+
+// 暴力方法可能和BVH找到不同的图元（距离相同），因此只比较距离
+bool sameHits(const std::vector<RayHit>& a, const std::vector<RayHit>& b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (a[i].valid() != b[i].valid() || (a[i].valid() && std::abs(a[i].t - b[i].t) > 1e-4f * std::max(1.0f, a[i].t))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t countHits(const std::vector<RayHit>& hits) {
+    return static_cast<size_t>(std::count_if(hits.begin(), hits.end(), [](const RayHit& hit) { return hit.valid(); }));
+}
+
+double leafAverage(const Bvh& bvh) {
+    size_t leaves = 0;
+    for (const auto& node : bvh.nodes()) {
+        leaves += node.isLeaf();
+    }
+    return leaves > 0 ? static_cast<double>(bvh.primitives().size()) / static_cast<double>(leaves) : 0.0;
+}
+
+int main(int argc, char** argv) {
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 100000)));
+    const size_t rayCount = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--rays", 200000)));
+    const uint32_t frequency = static_cast<uint32_t>(std::max(1, getIntArgument(argc, argv, "--frequency", 64)));
+    // 暴力方法太慢，只对一部分射线做对比
+    const size_t bruteForceRays = std::min<size_t>(rayCount, 500);
+
+    BenchmarkReport report("bvh");
+    report.info()
+        .set("objects", count)
+        .set("rays", rayCount)
+        .set("bin_count", Bvh::BIN_COUNT)
+        .set("node_bytes", sizeof(Bvh::Node));
+
+    Random random(38u);
+    std::vector<Aabb> bounds = createObjects(count, random);
+    std::vector<Ray> rays = createRays(rayCount, WORLD_SIZE, random);
+    std::vector<RayHit> bvhHits, referenceHits;
+
+    // 物体
+    Bvh bvh;
+    std::vector<double> buildSamples;
+    for (int i = 0; i < 5; i++) {
+        Timer timer;
+        bvh.build(bounds.data(), bounds.size());
+        buildSamples.push_back(timer.elapsedMs());
+    }
+    auto queryObjects = [&](const Ray& ray) { return bvh.intersectBoxes(ray, bounds.data()); };
+    double raysPerSecond = measureRaysPerSecond(rays, bvhHits, queryObjects);
+    std::vector<Ray> bruteRays(rays.begin(), rays.begin() + bruteForceRays);
+    double brutePerSecond = measureRaysPerSecond(bruteRays, referenceHits, [&](const Ray& ray) {
+        RayHit hit;
+        const glm::vec3 inverseDirection = 1.0f / ray.direction;
+        for (uint32_t i = 0; i < bounds.size(); i++) {
+            float t = intersectAabb(ray.origin, inverseDirection, bounds[i].boundsMin, bounds[i].boundsMax, hit.t);
+            if (t < hit.t) {
+                hit = {i, t};
+            }
+        }
+        return hit;
+    });
+    report.addRecord()
+        .set("stage", "objects")
+        .set("primitives", count)
+        .set("build_ms", median(buildSamples))
+        .set("nodes", bvh.nodes().size())
+        .set("depth", bvh.depth())
+        .set("primitives_per_leaf", leafAverage(bvh))
+        .set("rays_per_second", raysPerSecond)
+        .set("brute_force_rays_per_second", brutePerSecond)
+        .set("hit_ratio", static_cast<double>(countHits(bvhHits)) / rayCount)
+        .set("matches_brute_force", sameHits(bvhHits, referenceHits, bruteForceRays) ? "true" : "false");
+
+    // 移动物体后 refit 与重新构建
+    {
+        for (auto& box : bounds) {
+            glm::vec3 offset = random.nextVector() * 2.0f;
+            box.boundsMin += offset;
+            box.boundsMax += offset;
+        }
+        Timer refitTimer;
+        bvh.refit(bounds.data());
+        double refitMs = refitTimer.elapsedMs();
+        double refitRaysPerSecond = measureRaysPerSecond(rays, bvhHits, queryObjects);
+
+        Bvh rebuilt;
+        Timer rebuildTimer;
+        rebuilt.build(bounds.data(), bounds.size());
+        double rebuildMs = rebuildTimer.elapsedMs();
+        double rebuildRaysPerSecond = measureRaysPerSecond(rays, referenceHits, [&](const Ray& ray) {
+            return rebuilt.intersectBoxes(ray, bounds.data());
+        });
+        report.addRecord()
+            .set("stage", "refit")
+            .set("primitives", count)
+            .set("refit_ms", refitMs)
+            .set("rebuild_ms", rebuildMs)
+            .set("refit_rays_per_second", refitRaysPerSecond)
+            .set("rebuild_rays_per_second", rebuildRaysPerSecond)
+            .set("matches_rebuild", sameHits(bvhHits, referenceHits, rayCount) ? "true" : "false");
+    }
+
+    // 三角形
+    {
+        const procedural_mesh::MeshSize size = procedural_mesh::icosphereSize(frequency);
+        std::vector<float> vertices(size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX);
+        std::vector<uint32_t> indices(size.indexCount);
+        procedural_mesh::generateIcosphere(10.0f, frequency, vertices.data(), indices.data());
+        const size_t strideBytes = procedural_mesh::FLOATS_PER_VERTEX * sizeof(float);
+        auto position = [&](uint32_t vertex) {
+            const float* p = &vertices[vertex * procedural_mesh::FLOATS_PER_VERTEX];
+            return glm::vec3(p[0], p[1], p[2]);
+        };
+        auto intersectMeshTriangle = [&](uint32_t triangle, const Ray& ray, float) {
+            return intersectTriangle(ray, position(indices[triangle * 3]), position(indices[triangle * 3 + 1]), position(indices[triangle * 3 + 2]));
+        };
+
+        Timer timer;
+        std::vector<Aabb> triangles = triangleBounds(vertices.data(), strideBytes, indices.data(), indices.size());
+        Bvh triangleBvh;
+        triangleBvh.build(triangles.data(), triangles.size());
+        double buildMs = timer.elapsedMs();
+
+        std::vector<Ray> sphereRays = createRays(rayCount, 20.0f, random);
+        double trianglesPerSecond = measureRaysPerSecond(sphereRays, bvhHits, [&](const Ray& ray) {
+            return triangleBvh.intersect(ray, intersectMeshTriangle);
+        });
+        std::vector<Ray> bruteSphereRays(sphereRays.begin(), sphereRays.begin() + bruteForceRays);
+        double bruteTrianglesPerSecond = measureRaysPerSecond(bruteSphereRays, referenceHits, [&](const Ray& ray) {
+            RayHit hit;
+            for (uint32_t i = 0; i < triangles.size(); i++) {
+                float t = intersectMeshTriangle(i, ray, hit.t);
+                if (t < hit.t) {
+                    hit = {i, t};
+                }
+            }
+            return hit;
+        });
+        report.addRecord()
+            .set("stage", "triangles")
+            .set("primitives", triangles.size())
+            .set("build_ms", buildMs)
+            .set("nodes", triangleBvh.nodes().size())
+            .set("depth", triangleBvh.depth())
+            .set("primitives_per_leaf", leafAverage(triangleBvh))
+            .set("rays_per_second", trianglesPerSecond)
+            .set("brute_force_rays_per_second", bruteTrianglesPerSecond)
+            .set("hit_ratio", static_cast<double>(countHits(bvhHits)) / rayCount)
+            .set("matches_brute_force", sameHits(bvhHits, referenceHits, bruteForceRays) ? "true" : "false");
+    }
+
+    report.write(argc, argv);
+    return 0;
+}
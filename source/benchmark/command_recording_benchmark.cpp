@@ -0,0 +1,299 @@
+// 多线程命令录制基准测试，默认50k个物体（盒子和球，分属4个程序、2个几何池的VAO），每帧旋转并做视锥剔除：
+//  -- direct      : GL线程按物体顺序遍历场景并直接调用GL（只跳过与上一个物体相同的程序/VAO绑定）
+//  -- recorded_N  : JobSystem 的 N 个线程（1、4、16）遍历场景，录制到各自的 CommandBuffer，
+//                   GL线程按 key（程序、VAO、物体编号）排序后回放
+// 每帧统计：
+//     record_ms  : 遍历和录制（direct 为遍历和GL调用）
+//     sort_ms    : 收集所有线程的包并排序
+//     replay_ms  : 回放时的GL调用
+//     cpu_ms     : CPU上一帧的总时间（不包括 glFinish）
+//     frame_ms   : 包括 glFinish
+// 同时统计绘制数、实际执行的程序/VAO绑定数，最后一帧的图像与 direct 比较，输出不同的像素数
+// 用法：command_recording_benchmark [--out result.json] [--count N] [--frames N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "box.h"
+#include "command_buffer.h"
+#include "frustum.h"
+#include "geometry_pool.h"
+#include "job_system.h"
+#include "procedural_mesh.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+const uint32_t MATERIAL_COUNT = 4;
+const float GRID_SPACING = 1.5f;
+const size_t RECORD_GRAIN = 256;
+
+struct Material {
+    std::unique_ptr<ShaderProgram> program;
+    GLint modelLocation;
+    GLint colorLocation;
+};
+
+struct MeshRef {
+    uint32_t pool;
+    GLuint vertexArray;
+    PoolMesh mesh;
+    float radius;
+};
+
+struct Object {
+    glm::vec3 position;
+    glm::vec4 color;
+    float spin;
+    uint32_t mesh;
+    uint32_t material;
+};
+
+std::vector<Object> createObjects(size_t count, uint32_t meshCount) {
+    std::vector<Object> objects(count);
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    uint32_t seed = 49u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; i++) {
+        Object& object = objects[i];
+        object.position = glm::vec3(static_cast<float>(i % side) - side * 0.5f, 0.0f, static_cast<float>(i / side) - side * 0.5f) * GRID_SPACING;
+        object.color = glm::vec4(random(), random(), random(), 1.0f);
+        object.spin = (random() - 0.5f) * 4.0f;
+        object.mesh = static_cast<uint32_t>(random() * meshCount) % meshCount;
+        object.material = static_cast<uint32_t>(random() * MATERIAL_COUNT) % MATERIAL_COUNT;
+    }
+    return objects;
+}
+
+PoolMesh addIcosphere(GeometryPool& pool, float radius, uint32_t frequency) {
+    procedural_mesh::MeshSize size = procedural_mesh::icosphereSize(frequency);
+    std::vector<float> vertices(size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX);
+    std::vector<uint32_t> indices(size.indexCount);
+    procedural_mesh::generateIcosphere(radius, frequency, vertices.data(), indices.data());
+    return pool.allocate(vertices.data(), size.vertexCount, indices.data(), size.indexCount);
+}
+
+glm::mat4 objectModel(const Object& object, float time) {
+    return glm::rotate(glm::translate(glm::mat4(1.0f), object.position), object.spin * time, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// 程序在最高位，其次是几何池，最后是物体编号，使排序后的顺序确定
+uint64_t sortKey(const Object& object, const MeshRef& mesh, size_t index) {
+    return (static_cast<uint64_t>(object.material) << 40) | (static_cast<uint64_t>(mesh.pool) << 32) | static_cast<uint64_t>(index);
+}
+
+struct FrameStats {
+    std::vector<double> recordMs, sortMs, replayMs, cpuMs, frameMs;
+    size_t draws = 0;
+    size_t stateChanges = 0;
+    size_t recordedBytes = 0;
+};
+
+std::vector<unsigned char> readPixels() {
+    std::vector<unsigned char> pixels(static_cast<size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT * 4);
+    glReadPixels(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+size_t countDifferentPixels(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+    size_t count = 0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        count += std::memcmp(a.data() + i, b.data() + i, 4) != 0;
+    }
+    return count;
+}
+
+void addRecord(BenchmarkReport& report, const char* mode, int threads, const FrameStats& stats, size_t differentPixels) {
+    report.addRecord()
+        .set("mode", mode)
+        .set("threads", threads)
+        .set("draws", stats.draws)
+        .set("state_changes", stats.stateChanges)
+        .set("recorded_bytes", stats.recordedBytes)
+        .set("record_ms", median(stats.recordMs))
+        .set("sort_ms", median(stats.sortMs))
+        .set("replay_ms", median(stats.replayMs))
+        .set("cpu_ms", median(stats.cpuMs))
+        .set("frame_ms", median(stats.frameMs))
+        .set("different_pixels", differentPixels);
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 50000)));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 30));
+
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 1000.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 40.0f, 120.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Frustum frustum = Frustum::fromMatrix(projection * view);
+
+    using ShaderType = ShaderProgram::ShaderType;
+    std::vector<Material> materials(MATERIAL_COUNT);
+    for (uint32_t m = 0; m < MATERIAL_COUNT; m++) {
+        Material& material = materials[m];
+        material.program = std::make_unique<ShaderProgram>(std::initializer_list<ShaderProgram::ShaderSourcePair>{
+            {ShaderType::VERTEX, "shaders/box_single.vert"},
+            {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+        });
+        material.program->use();
+        material.program->setUniform("view", view);
+        material.program->setUniform("projection", projection);
+        float tint = 0.6f + 0.4f * static_cast<float>(m) / (MATERIAL_COUNT - 1);
+        material.program->setUniform("tint", glm::vec4(tint, tint, tint, 1.0f));
+        material.modelLocation = material.program->getUniformLocation("model");
+        material.colorLocation = material.program->getUniformLocation("color");
+    }
+
+    GeometryPool boxPool(VertexFormat::positionNormalUV());
+    GeometryPool spherePool(VertexFormat::positionNormalUV());
+    std::vector<MeshRef> meshes;
+    for (float extension : {0.2f, 0.3f, 0.4f}) {
+        meshes.push_back({0, boxPool.vertexArray(), Box::addToPool(boxPool, glm::vec3(extension)), extension * std::sqrt(3.0f)});
+    }
+    for (float radius : {0.3f, 0.5f}) {
+        meshes.push_back({1, spherePool.vertexArray(), addIcosphere(spherePool, radius, 2), radius});
+    }
+
+    std::vector<Object> objects = createObjects(count, static_cast<uint32_t>(meshes.size()));
+
+    BenchmarkReport report("command_recording");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("objects", count)
+        .set("frames", frames)
+        .set("materials", static_cast<int>(MATERIAL_COUNT))
+        .set("hardware_threads", static_cast<int>(std::thread::hardware_concurrency()));
+
+    auto frameTime = [](int frame) {
+        return static_cast<float>(frame) / 60.0f;
+    };
+
+    // direct
+    std::vector<unsigned char> directPixels;
+    {
+        FrameStats stats;
+        for (int frame = 0; frame < frames; frame++) {
+            Timer frameTimer;
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            Timer recordTimer;
+            const float time = frameTime(frame);
+            GLuint program = 0, vertexArray = 0;
+            size_t draws = 0, stateChanges = 0;
+            for (size_t i = 0; i < count; i++) {
+                const Object& object = objects[i];
+                const MeshRef& mesh = meshes[object.mesh];
+                if (!frustum.intersectsSphere(object.position, mesh.radius)) {
+                    continue;
+                }
+                const Material& material = materials[object.material];
+                if (material.program->id() != program) {
+                    program = material.program->id();
+                    glUseProgram(program);
+                    stateChanges++;
+                }
+                if (mesh.vertexArray != vertexArray) {
+                    vertexArray = mesh.vertexArray;
+                    glBindVertexArray(vertexArray);
+                    stateChanges++;
+                }
+                glm::mat4 model = objectModel(object, time);
+                glUniformMatrix4fv(material.modelLocation, 1, GL_FALSE, &model[0][0]);
+                glUniform4fv(material.colorLocation, 1, &object.color[0]);
+                glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(mesh.mesh.indexCount), GL_UNSIGNED_INT,
+                                         (void*)(static_cast<uintptr_t>(mesh.mesh.firstIndex) * sizeof(uint32_t)), mesh.mesh.baseVertex);
+                draws++;
+            }
+            stats.recordMs.push_back(recordTimer.elapsedMs());
+            stats.sortMs.push_back(0.0);
+            stats.replayMs.push_back(0.0);
+            stats.cpuMs.push_back(frameTimer.elapsedMs());
+            glFinish();
+            stats.frameMs.push_back(frameTimer.elapsedMs());
+            stats.draws = draws;
+            stats.stateChanges = stateChanges;
+        }
+        directPixels = readPixels();
+        addRecord(report, "direct", 1, stats, 0);
+    }
+
+    // recorded
+    for (unsigned int threads : {1u, 4u, 16u}) {
+        JobSystem jobs(threads);
+        CommandQueue queue(jobs);
+        FrameStats stats;
+        for (int frame = 0; frame < frames; frame++) {
+            Timer frameTimer;
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            Timer recordTimer;
+            const float time = frameTime(frame);
+            queue.reset();
+            jobs.parallelFor(0, count, RECORD_GRAIN, [&](size_t begin, size_t end) {
+                CommandBuffer& commands = queue.recorder(jobs);
+                for (size_t i = begin; i < end; i++) {
+                    const Object& object = objects[i];
+                    const MeshRef& mesh = meshes[object.mesh];
+                    if (!frustum.intersectsSphere(object.position, mesh.radius)) {
+                        continue;
+                    }
+                    const Material& material = materials[object.material];
+                    commands.beginPacket(sortKey(object, mesh, i));
+                    commands.bindProgram(material.program->id());
+                    commands.bindVertexArray(mesh.vertexArray);
+                    commands.setUniform(material.modelLocation, objectModel(object, time));
+                    commands.setUniform(material.colorLocation, object.color);
+                    commands.drawMesh(mesh.mesh);
+                }
+            });
+            stats.recordMs.push_back(recordTimer.elapsedMs());
+
+            Timer sortTimer;
+            queue.sort();
+            stats.sortMs.push_back(sortTimer.elapsedMs());
+
+            Timer replayTimer;
+            queue.execute();
+            stats.replayMs.push_back(replayTimer.elapsedMs());
+            stats.cpuMs.push_back(frameTimer.elapsedMs());
+            glFinish();
+            stats.frameMs.push_back(frameTimer.elapsedMs());
+            stats.draws = queue.drawCount();
+            stats.stateChanges = queue.stateChangeCount();
+            stats.recordedBytes = queue.recordedBytes();
+        }
+        std::string mode = "recorded_" + std::to_string(threads);
+        addRecord(report, mode.c_str(), static_cast<int>(threads), stats, countDifferentPixels(readPixels(), directPixels));
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,329 @@
+// 绘制排序基准测试：默认20k个物体（2个几何池、4个程序、8个纹理，10%半透明）分布在相机前方，互相遮挡，
+// 由 JobSystem 录制到 CommandQueue，按三种 key 排序后回放：
+//  -- submission : 物体编号，即录制的顺序
+//  -- program    : 程序在高位，其余按物体编号（此前的做法）
+//  -- state_key  : draw_key，(pass, 半透明, 程序, 材质, 深度)，不透明从前到后、半透明从后到前
+// 每帧统计：
+//     state_changes  : 实际执行的状态切换（程序、VAO、纹理、渲染状态），以及各自的次数
+//     sort_ms        : CommandQueue::sort()（收集 + 基数排序），radix_passes 为实际执行的趟数
+//     std_sort_ms    : 同样的 key 用 std::stable_sort 排序的时间，作为对比
+//     samples_passed : 通过深度测试的采样数（遮挡查询），从前到后时被遮挡的片段不再着色
+//     gpu_ms / frame_ms
+// 同时检查基数排序的结果与 std::stable_sort 完全相同
+// 用法：draw_sorting_benchmark [--out result.json] [--count N] [--frames N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "box.h"
+#include "command_buffer.h"
+#include "geometry_pool.h"
+#include "job_system.h"
+#include "procedural_mesh.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+const uint32_t PROGRAM_COUNT = 4;
+const uint32_t TEXTURE_COUNT = 8;
+const int TEXTURE_SIZE = 64;
+const float Z_NEAR = 0.1f;
+const float Z_FAR = 200.0f;
+const size_t RECORD_GRAIN = 256;
+
+enum class SortMode {
+    SUBMISSION,
+    PROGRAM,
+    STATE_KEY,
+};
+
+const char* modeName(SortMode mode) {
+    switch (mode) {
+    case SortMode::SUBMISSION: return "submission";
+    case SortMode::PROGRAM: return "program";
+    case SortMode::STATE_KEY: return "state_key";
+    }
+    return "";
+}
+
+struct Program {
+    std::unique_ptr<ShaderProgram> shader;
+    GLint modelLocation;
+    GLint colorLocation;
+};
+
+struct MeshRef {
+    uint32_t pool;
+    GLuint vertexArray;
+    PoolMesh mesh;
+};
+
+struct Object {
+    glm::mat4 model;
+    glm::vec4 color;
+    float viewDepth;
+    uint32_t mesh;
+    uint32_t program;
+    uint32_t texture;
+    bool translucent;
+};
+
+PoolMesh addIcosphere(GeometryPool& pool, float radius, uint32_t frequency) {
+    procedural_mesh::MeshSize size = procedural_mesh::icosphereSize(frequency);
+    std::vector<float> vertices(size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX);
+    std::vector<uint32_t> indices(size.indexCount);
+    procedural_mesh::generateIcosphere(radius, frequency, vertices.data(), indices.data());
+    return pool.allocate(vertices.data(), size.vertexCount, indices.data(), size.indexCount);
+}
+
+std::vector<Object> createObjects(size_t count, uint32_t meshCount, const glm::mat4& view) {
+    std::vector<Object> objects(count);
+    uint32_t seed = 50u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (Object& object : objects) {
+        glm::vec3 position((random() - 0.5f) * 60.0f, random() * 8.0f, (random() - 0.6f) * 100.0f);
+        object.model = glm::rotate(glm::translate(glm::mat4(1.0f), position), random() * 6.2831853f, glm::vec3(0.0f, 1.0f, 0.0f));
+        object.viewDepth = -(view * glm::vec4(position, 1.0f)).z;
+        object.mesh = static_cast<uint32_t>(random() * meshCount) % meshCount;
+        object.program = static_cast<uint32_t>(random() * PROGRAM_COUNT) % PROGRAM_COUNT;
+        object.texture = static_cast<uint32_t>(random() * TEXTURE_COUNT) % TEXTURE_COUNT;
+        object.translucent = random() < 0.1f;
+        object.color = glm::vec4(0.5f + 0.5f * random(), 0.5f + 0.5f * random(), 0.5f + 0.5f * random(), object.translucent ? 0.4f : 1.0f);
+    }
+    return objects;
+}
+
+GLuint createCheckerTexture(uint32_t index) {
+    const glm::vec3 color(0.4f + 0.6f * static_cast<float>(index & 1), 0.4f + 0.3f * static_cast<float>((index >> 1) & 1),
+                          0.4f + 0.6f * static_cast<float>((index >> 2) & 1));
+    std::vector<unsigned char> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    for (int y = 0; y < TEXTURE_SIZE; y++) {
+        for (int x = 0; x < TEXTURE_SIZE; x++) {
+            float shade = ((x / 8 + y / 8) & 1) ? 1.0f : 0.6f;
+            unsigned char* pixel = pixels.data() + (y * TEXTURE_SIZE + x) * 4;
+            for (int c = 0; c < 3; c++) {
+                pixel[c] = static_cast<unsigned char>(color[c] * shade * 255.0f);
+            }
+            pixel[3] = 255;
+        }
+    }
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+uint64_t sortKey(SortMode mode, const Object& object, const MeshRef& mesh, uint32_t index) {
+    switch (mode) {
+    case SortMode::SUBMISSION:
+        return index;
+    case SortMode::PROGRAM:
+        return (static_cast<uint64_t>(object.program) << 32) | index;
+    case SortMode::STATE_KEY:
+        break;
+    }
+    const uint32_t material = mesh.pool * TEXTURE_COUNT + object.texture;
+    const uint32_t depth = draw_key::depthBucket(object.viewDepth, Z_NEAR, Z_FAR);
+    return object.translucent ? draw_key::translucent(0, object.program, material, depth, index)
+                              : draw_key::opaque(0, object.program, material, depth, index);
+}
+
+struct FrameStats {
+    std::vector<double> recordMs, sortMs, stdSortMs, replayMs, gpuMs, frameMs;
+    size_t draws = 0;
+    size_t stateChanges = 0;
+    size_t programBinds = 0;
+    size_t vertexArrayBinds = 0;
+    size_t textureBinds = 0;
+    size_t renderStateChanges = 0;
+    size_t radixPasses = 0;
+    uint64_t samplesPassed = 0;
+    bool sortMatches = true;
+};
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 20000)));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 20));
+
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, Z_NEAR, Z_FAR);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 6.0f, 60.0f), glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    using ShaderType = ShaderProgram::ShaderType;
+    std::vector<Program> programs(PROGRAM_COUNT);
+    for (Program& program : programs) {
+        program.shader = std::make_unique<ShaderProgram>(std::initializer_list<ShaderProgram::ShaderSourcePair>{
+            {ShaderType::VERTEX, "shaders/draw_sort.vert"},
+            {ShaderType::FRAGMENT, "shaders/draw_sort.frag"}
+        });
+        program.shader->use();
+        program.shader->setUniform("view", view);
+        program.shader->setUniform("projection", projection);
+        program.modelLocation = program.shader->getUniformLocation("model");
+        program.colorLocation = program.shader->getUniformLocation("color");
+    }
+    std::vector<GLuint> textures;
+    for (uint32_t i = 0; i < TEXTURE_COUNT; i++) {
+        textures.push_back(createCheckerTexture(i));
+    }
+
+    GeometryPool boxPool(VertexFormat::positionNormalUV());
+    GeometryPool spherePool(VertexFormat::positionNormalUV());
+    std::vector<MeshRef> meshes;
+    for (float extension : {0.4f, 0.7f, 1.0f}) {
+        meshes.push_back({0, boxPool.vertexArray(), Box::addToPool(boxPool, glm::vec3(extension))});
+    }
+    for (float radius : {0.6f, 1.0f}) {
+        meshes.push_back({1, spherePool.vertexArray(), addIcosphere(spherePool, radius, 2)});
+    }
+
+    std::vector<Object> objects = createObjects(count, static_cast<uint32_t>(meshes.size()), view);
+
+    JobSystem jobs;
+    CommandQueue queue(jobs);
+    GLuint query;
+    glGenQueries(1, &query);
+    GpuTimer gpuTimer;
+
+    BenchmarkReport report("draw_sorting");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("objects", count)
+        .set("frames", frames)
+        .set("programs", static_cast<int>(PROGRAM_COUNT))
+        .set("textures", static_cast<int>(TEXTURE_COUNT))
+        .set("record_threads", static_cast<int>(jobs.threadCount()));
+
+    bool allSortsMatch = true;
+    for (SortMode mode : {SortMode::SUBMISSION, SortMode::PROGRAM, SortMode::STATE_KEY}) {
+        FrameStats stats;
+        for (int frame = 0; frame < frames; frame++) {
+            Timer frameTimer;
+            gpuTimer.begin();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            Timer recordTimer;
+            queue.reset();
+            jobs.parallelFor(0, count, RECORD_GRAIN, [&](size_t begin, size_t end) {
+                CommandBuffer& commands = queue.recorder(jobs);
+                for (size_t i = begin; i < end; i++) {
+                    const Object& object = objects[i];
+                    const MeshRef& mesh = meshes[object.mesh];
+                    const Program& program = programs[object.program];
+                    commands.beginPacket(sortKey(mode, object, mesh, static_cast<uint32_t>(i)));
+                    commands.setRenderState(object.translucent ? render_command::SetRenderState::BLEND
+                                                               : render_command::SetRenderState::DEFAULT);
+                    commands.bindProgram(program.shader->id());
+                    commands.bindVertexArray(mesh.vertexArray);
+                    commands.bindTexture(0, textures[object.texture]);
+                    commands.setUniform(program.modelLocation, object.model);
+                    commands.setUniform(program.colorLocation, object.color);
+                    commands.drawMesh(mesh.mesh);
+                }
+            });
+            stats.recordMs.push_back(recordTimer.elapsedMs());
+
+            Timer sortTimer;
+            queue.sort();
+            stats.sortMs.push_back(sortTimer.elapsedMs());
+
+            // 对比：同样的 key 和收集顺序用 std::stable_sort
+            std::vector<std::pair<uint64_t, uint32_t>> keys;
+            keys.reserve(queue.packetCount());
+            for (size_t b = 0; b < queue.bufferCount(); b++) {
+                for (const CommandBuffer::Packet& packet : queue.buffer(b).packets()) {
+                    keys.push_back({packet.key, static_cast<uint32_t>(keys.size())});
+                }
+            }
+            Timer stdSortTimer;
+            std::stable_sort(keys.begin(), keys.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            stats.stdSortMs.push_back(stdSortTimer.elapsedMs());
+            for (size_t i = 0; i < keys.size(); i++) {
+                stats.sortMatches = stats.sortMatches && keys[i].first == queue.packetKey(i);
+            }
+
+            Timer replayTimer;
+            glBeginQuery(GL_SAMPLES_PASSED, query);
+            queue.execute();
+            glEndQuery(GL_SAMPLES_PASSED);
+            stats.replayMs.push_back(replayTimer.elapsedMs());
+            gpuTimer.end();
+
+            glFinish();
+            stats.frameMs.push_back(frameTimer.elapsedMs());
+            stats.gpuMs.push_back(gpuTimer.resultMs());
+            GLuint64 samples = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &samples);
+            stats.samplesPassed = samples;
+            stats.draws = queue.drawCount();
+            stats.stateChanges = queue.stateChangeCount();
+            stats.programBinds = queue.programBindCount();
+            stats.vertexArrayBinds = queue.vertexArrayBindCount();
+            stats.textureBinds = queue.textureBindCount();
+            stats.renderStateChanges = queue.renderStateChangeCount();
+            stats.radixPasses = queue.radixPassCount();
+        }
+        allSortsMatch = allSortsMatch && stats.sortMatches;
+
+        report.addRecord()
+            .set("mode", modeName(mode))
+            .set("draws", stats.draws)
+            .set("state_changes", stats.stateChanges)
+            .set("program_binds", stats.programBinds)
+            .set("vertex_array_binds", stats.vertexArrayBinds)
+            .set("texture_binds", stats.textureBinds)
+            .set("render_state_changes", stats.renderStateChanges)
+            .set("record_ms", median(stats.recordMs))
+            .set("sort_ms", median(stats.sortMs))
+            .set("radix_passes", stats.radixPasses)
+            .set("std_sort_ms", median(stats.stdSortMs))
+            .set("replay_ms", median(stats.replayMs))
+            .set("samples_passed", static_cast<size_t>(stats.samplesPassed))
+            .set("gpu_ms", median(stats.gpuMs))
+            .set("frame_ms", median(stats.frameMs))
+            .set("sort_matches", stats.sortMatches ? "true" : "false");
+    }
+    report.info().set("sort_matches", allSortsMatch ? "true" : "false");
+
+    glDeleteQueries(1, &query);
+    glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return allSortsMatch ? 0 : 1;
+}
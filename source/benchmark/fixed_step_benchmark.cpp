@@ -0,0 +1,251 @@
+// 固定步长模拟基准测试（只使用CPU，不需要OpenGL上下文）：FixedStepSimulation 在单独的线程中运行，
+// 主线程模拟不同帧率的渲染，验证模拟的结果与渲染的帧率无关
+//  -- 模拟的状态为 ArcballCamera 和一组在盒子中弹跳的物体，输入为预先写入 InputQueue 的脚本事件
+//     （拖动旋转、中键平移、滚轮），每步用 InputQueue::poll(time + step) 按时间戳取出
+//  -- reference : 在主线程中用 advanceTo() 运行，记录每一步之后状态的哈希
+//  -- render_* : 模拟线程以真实时间运行，渲染线程每帧 acquire() 快照后忙等一帧的时间
+//     tick_mismatches     : 每一步的哈希与 reference 不同的个数
+//     snapshot_mismatches : 渲染线程取得的快照（previous 和 current）与 reference 中对应步的哈希不同的个数
+//     acquire_max_us      : acquire() 的最长耗时，渲染线程不会等待模拟
+//     staleness_ms        : 渲染时的时间与快照时间之差（中位数，最大值），正常时小于一步
+//     step_late_ms        : 每一步完成的时间与这一步结束时间之差（中位数，最大值）
+//  -- stall_250ms : 模拟线程在中间停顿250ms，step_late_after_stall_ms 为补步之后每一步的延迟（中位数），
+//                   应该与没有停顿时相同（跳过的时间计入每一步的时间，输入不会一直落后）
+// 用法：fixed_step_benchmark [--out result.json] [--ticks N] [--bodies N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "arcball_camera.h"
+#include "benchmark_utils.h"
+#include "fixed_step_simulation.h"
+#include "glfw_callback.h"
+#include "input_queue.h"
+
+const double SIMULATION_STEP = 1.0 / 120.0;
+const size_t SIMULATION_CATCH_UP = FixedStepSimulation<int>::MAX_CATCH_UP + 1;
+const int VIEW_WIDTH = 1280;
+const int VIEW_HEIGHT = 720;
+const float BOX_SIZE = 10.0f;
+
+struct Body {
+    glm::vec3 position;
+    glm::vec3 velocity;
+};
+
+struct TestState {
+    ArcballCamera camera = ArcballCamera(glm::vec3(0.0f, 0.0f, 10.0f));
+    std::vector<Body> bodies;
+};
+
+std::vector<Body> createBodies(size_t count) {
+    std::vector<Body> bodies(count);
+    uint32_t seed = 47u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (Body& body : bodies) {
+        body.position = glm::vec3(random(), random(), random()) * BOX_SIZE;
+        body.velocity = (glm::vec3(random(), random(), random()) - 0.5f) * 8.0f;
+    }
+    return bodies;
+}
+
+// 脚本输入，时间从模拟开始计算：按住左键画圆旋转，之后按住中键平移，期间滚动滚轮
+std::vector<InputEvent> createScript(double duration) {
+    std::vector<InputEvent> events;
+    const double interval = 0.002;
+    const double rotateEnd = duration * 0.5;
+    events.push_back({InputEvent::CURSOR_MOVE, 0, 0, 640.0f, 360.0f, 0.0});
+    events.push_back({InputEvent::MOUSE_BUTTON, GLFW_MOUSE_BUTTON_LEFT, GLFW_PRESS, 0.0f, 0.0f, 0.01});
+    for (double time = 0.011; time < duration; time += interval) {
+        float angle = static_cast<float>(time * 3.0);
+        events.push_back({InputEvent::CURSOR_MOVE, 0, 0, 640.0f + 200.0f * std::cos(angle), 360.0f + 150.0f * std::sin(angle), time});
+        if (time < rotateEnd && time + interval >= rotateEnd) {
+            events.push_back({InputEvent::MOUSE_BUTTON, GLFW_MOUSE_BUTTON_LEFT, GLFW_RELEASE, 0.0f, 0.0f, time});
+            events.push_back({InputEvent::MOUSE_BUTTON, GLFW_MOUSE_BUTTON_MIDDLE, GLFW_PRESS, 0.0f, 0.0f, time});
+        }
+        if (static_cast<int>(time / interval) % 50 == 0) {
+            events.push_back({InputEvent::SCROLL, 0, 0, 0.0f, 1.0f, time});
+        }
+    }
+    return events;
+}
+
+// 物体受重力影响，碰到盒子的边界时反弹
+void stepBodies(std::vector<Body>& bodies, float step) {
+    const glm::vec3 gravity(0.0f, -9.8f, 0.0f);
+    for (Body& body : bodies) {
+        body.velocity += gravity * step;
+        body.position += body.velocity * step;
+        for (int axis = 0; axis < 3; axis++) {
+            if (body.position[axis] < 0.0f) {
+                body.position[axis] = -body.position[axis];
+                body.velocity[axis] = -body.velocity[axis] * 0.9f;
+            } else if (body.position[axis] > BOX_SIZE) {
+                body.position[axis] = 2.0f * BOX_SIZE - body.position[axis];
+                body.velocity[axis] = -body.velocity[axis] * 0.9f;
+            }
+        }
+    }
+}
+
+// FNV-1a
+uint64_t hashState(const TestState& state) {
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    CameraPose pose = state.camera.getPose();
+    add(&pose.position, sizeof(pose.position));
+    add(&pose.orientation, sizeof(pose.orientation));
+    add(&pose.zoom, sizeof(pose.zoom));
+    add(state.bodies.data(), state.bodies.size() * sizeof(Body));
+    return hash;
+}
+
+// 一次运行：每一步之后的哈希，renderMs < 0 时为 reference
+struct RunResult {
+    std::vector<uint64_t> tickHashes;
+    size_t frames = 0;
+    size_t snapshotMismatches = 0;
+    double acquireMaxUs = 0.0;
+    std::vector<double> stalenessMs;
+    std::vector<double> stepLateMs;
+    uint64_t skippedTicks = 0;
+};
+
+RunResult run(const TestState& initial, const std::vector<InputEvent>& script, size_t ticks, double renderMs,
+              const std::vector<uint64_t>* reference, double stallMs = 0.0) {
+    RunResult result;
+    result.tickHashes.resize(ticks);
+    InputQueue input(script.size() + 1);
+    for (const InputEvent& event : script) {
+        input.push(event);
+    }
+
+    FixedStepSimulation<TestState>* simulationPointer = nullptr;
+    FixedStepSimulation<TestState> simulation(SIMULATION_STEP, initial, [&](TestState& state, uint64_t tick, double time, double step) {
+        // 模拟线程在中间停顿 stallMs（例如调试断点），之后跳过落后的时间
+        if (stallMs > 0.0 && tick == ticks / 2) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(stallMs));
+        }
+        InputFrame inputFrame = input.poll(time + step);
+        applyCameraInput(inputFrame, state.camera, VIEW_WIDTH, VIEW_HEIGHT);
+        stepBodies(state.bodies, static_cast<float>(step));
+        if (tick < ticks) {
+            result.tickHashes[tick] = hashState(state);
+            if (simulationPointer->running()) {
+                result.stepLateMs.push_back((simulationPointer->time() - (time + step)) * 1000.0);
+            }
+        }
+    });
+    simulationPointer = &simulation;
+
+    if (reference == nullptr) {
+        simulation.advanceTo(static_cast<double>(ticks) * SIMULATION_STEP);
+        return result;
+    }
+
+    simulation.start();
+    while (simulation.tickCount() < ticks) {
+        Timer acquireTimer;
+        const auto& snapshot = simulation.acquire();
+        result.acquireMaxUs = std::max(result.acquireMaxUs, acquireTimer.elapsedMs() * 1000.0);
+        double now = simulation.time();
+        if (snapshot.tick > 0 && snapshot.tick <= ticks) {
+            result.stalenessMs.push_back((now - snapshot.time) * 1000.0);
+            if (hashState(snapshot.current) != (*reference)[snapshot.tick - 1]) {
+                result.snapshotMismatches++;
+            }
+            if (snapshot.tick > 1 && hashState(snapshot.previous) != (*reference)[snapshot.tick - 2]) {
+                result.snapshotMismatches++;
+            }
+        }
+        // 渲染这一帧（不会等待模拟线程）
+        Timer frameTimer;
+        while (frameTimer.elapsedMs() < renderMs) {
+        }
+        result.frames++;
+    }
+    simulation.stop();
+    result.skippedTicks = simulation.skippedTicks();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const size_t ticks = static_cast<size_t>(std::max(2, getIntArgument(argc, argv, "--ticks", 240)));
+    const size_t bodyCount = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--bodies", 1000)));
+
+    TestState initial;
+    initial.bodies = createBodies(bodyCount);
+    std::vector<InputEvent> script = createScript(static_cast<double>(ticks) * SIMULATION_STEP);
+
+    BenchmarkReport report("fixed_step");
+    report.info()
+        .set("step_ms", SIMULATION_STEP * 1000.0)
+        .set("ticks", ticks)
+        .set("bodies", bodyCount)
+        .set("input_events", script.size());
+
+    RunResult reference = run(initial, script, ticks, -1.0, nullptr);
+    // 在主线程中再运行一次，结果应该完全相同
+    RunResult repeated = run(initial, script, ticks, -1.0, nullptr);
+    report.info().set("reference_repeatable", reference.tickHashes == repeated.tickHashes ? "true" : "false");
+
+    const std::pair<double, const char*> renderRates[] = {
+        {0.0, "render_unlimited"}, {1.0, "render_1ms"}, {7.0, "render_7ms"}, {16.7, "render_16.7ms"}, {33.3, "render_33.3ms"}
+    };
+    size_t totalMismatches = 0;
+    for (const auto& [renderMs, name] : renderRates) {
+        RunResult result = run(initial, script, ticks, renderMs, &reference.tickHashes);
+        size_t tickMismatches = 0;
+        for (size_t i = 0; i < ticks; i++) {
+            tickMismatches += result.tickHashes[i] != reference.tickHashes[i];
+        }
+        totalMismatches += tickMismatches + result.snapshotMismatches;
+        report.addRecord()
+            .set("mode", name)
+            .set("render_ms", renderMs)
+            .set("frames", result.frames)
+            .set("tick_mismatches", tickMismatches)
+            .set("snapshot_mismatches", result.snapshotMismatches)
+            .set("acquire_max_us", result.acquireMaxUs)
+            .set("staleness_ms", median(result.stalenessMs))
+            .set("staleness_max_ms", result.stalenessMs.empty() ? 0.0 : *std::max_element(result.stalenessMs.begin(), result.stalenessMs.end()))
+            .set("step_late_ms", median(result.stepLateMs))
+            .set("step_late_max_ms", result.stepLateMs.empty() ? 0.0 : *std::max_element(result.stepLateMs.begin(), result.stepLateMs.end()))
+            .set("skipped_ticks", static_cast<size_t>(result.skippedTicks));
+    }
+    report.info().set("deterministic", totalMismatches == 0 ? "true" : "false");
+
+    // 停顿之后跳过的步不再模拟，这一行的哈希与 reference 不同，不计入 deterministic；
+    // 每步的时间包括跳过的时间，step_late 只在停顿后补步时变大，之后回到正常（输入不会一直落后）
+    const double stallMs = 250.0;
+    RunResult stalled = run(initial, script, ticks, 1.0, &reference.tickHashes, stallMs);
+    std::vector<double> settledLateMs(stalled.stepLateMs.begin() + std::min(stalled.stepLateMs.size(), ticks / 2 + SIMULATION_CATCH_UP),
+                                      stalled.stepLateMs.end());
+    report.addRecord()
+        .set("mode", "stall_250ms")
+        .set("render_ms", 1.0)
+        .set("frames", stalled.frames)
+        .set("step_late_ms", median(stalled.stepLateMs))
+        .set("step_late_max_ms", stalled.stepLateMs.empty() ? 0.0 : *std::max_element(stalled.stepLateMs.begin(), stalled.stepLateMs.end()))
+        .set("step_late_after_stall_ms", median(settledLateMs))
+        .set("skipped_ticks", static_cast<size_t>(stalled.skippedTicks));
+
+    report.write(argc, argv);
+    return totalMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+// 视锥剔除基准测试（只使用CPU，不需要OpenGL上下文）
+// 随机分布在一个立方体中的大量物体（默认1M个），相机位于中心，每次迭代朝向不同的方向：
+//  -- sphere / box        : 包围球和AABB两种包围体
+//  -- scalar / simd       : 单线程的标量实现和SIMD实现（AVX2每次8个，SSE2每次4个）
+//  -- parallel            : SIMD实现按线程数分段，每次剔除都创建线程
+//  -- jobs                : SIMD实现按固定大小分段，由 JobSystem 的线程执行（线程只在开始时创建一次）
+// 输出每毫秒剔除的物体数、可见物体数，以及结果是否与标量实现完全一致
+// 用法：frustum_culling_benchmark [--out result.json] [--count N] [--iterations N] [--threads N]
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "camera.h"
+#include "frustum_culling.h"
+#include "job_system.h"
+
+using namespace frustum_culling;
+
+const float WORLD_SIZE = 1000.0f;
+
+struct Scene {
+    SphereArrays spheres;
+    BoxArrays boxes;
+};
+
+Scene createScene(size_t count) {
+    Scene scene;
+    scene.spheres.resize(count);
+    scene.boxes.resize(count);
+    uint32_t seed = 37u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 center = (glm::vec3(random(), random(), random()) - 0.5f) * WORLD_SIZE;
+        glm::vec3 extent = glm::vec3(0.5f + 4.5f * random(), 0.5f + 4.5f * random(), 0.5f + 4.5f * random());
+        scene.boxes.set(i, center - extent, center + extent);
+        scene.spheres.set(i, center, glm::length(extent));
+    }
+    return scene;
+}
+
+// 相机在原点，第 i 个视角绕Y轴旋转
+std::vector<Frustum> createFrustums(int count) {
+    std::vector<Frustum> frustums;
+    for (int i = 0; i < count; i++) {
+        Camera camera(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f + 360.0f * static_cast<float>(i) / count, 10.0f);
+        frustums.push_back(camera.getFrustum(16.0f / 9.0f, 0.1f, WORLD_SIZE * 0.5f));
+    }
+    return frustums;
+}
+
+struct CullResult {
+    double ms;
+    size_t visible;
+    bool matchesScalar;
+};
+
+// cull(frustum, visible) 返回可见个数，reference 为每个视角的标量结果（为空时不比较）
+template <typename Function>
+CullResult measure(const std::vector<Frustum>& frustums, std::vector<uint32_t>& visible,
+                   const std::vector<std::vector<uint32_t>>& reference, Function&& cull) {
+    std::vector<double> samples;
+    CullResult result{0.0, 0, true};
+    for (size_t i = 0; i < frustums.size(); i++) {
+        Timer timer;
+        size_t count = cull(frustums[i], visible.data());
+        samples.push_back(timer.elapsedMs());
+        result.visible += count;
+        if (!reference.empty()) {
+            result.matchesScalar = result.matchesScalar && reference[i].size() == count &&
+                                   std::equal(reference[i].begin(), reference[i].end(), visible.begin());
+        }
+    }
+    result.ms = median(samples);
+    result.visible /= frustums.size();
+    return result;
+}
+
+template <typename Arrays, typename Scalar, typename Simd, typename Parallel, typename Jobs>
+void runShape(BenchmarkReport& report, const char* shape, const Arrays& arrays, const std::vector<Frustum>& frustums,
+              const std::vector<unsigned int>& threadCounts, Scalar&& scalar, Simd&& simd, Parallel&& parallel, Jobs&& jobsCull) {
+    std::vector<uint32_t> visible(arrays.paddedSize());
+    std::vector<std::vector<uint32_t>> reference;
+    for (const auto& frustum : frustums) {
+        size_t count = scalar(frustum, arrays, visible.data());
+        reference.emplace_back(visible.begin(), visible.begin() + count);
+    }
+
+    auto addRecord = [&](const char* implementation, int threads, const CullResult& result) {
+        report.addRecord()
+            .set("shape", shape)
+            .set("implementation", implementation)
+            .set("threads", threads)
+            .set("ms", result.ms)
+            .set("objects_per_ms", result.ms > 0.0 ? static_cast<double>(arrays.count) / result.ms : 0.0)
+            .set("visible", result.visible)
+            .set("matches_scalar", result.matchesScalar ? "true" : "false");
+    };
+    addRecord("scalar", 1, measure(frustums, visible, {}, [&](const Frustum& frustum, uint32_t* output) {
+        return scalar(frustum, arrays, output);
+    }));
+    addRecord("simd", 1, measure(frustums, visible, reference, [&](const Frustum& frustum, uint32_t* output) {
+        return simd(frustum, arrays, output);
+    }));
+    for (unsigned int threads : threadCounts) {
+        addRecord("parallel", static_cast<int>(threads), measure(frustums, visible, reference, [&](const Frustum& frustum, uint32_t* output) {
+            return parallel(frustum, arrays, output, threads);
+        }));
+    }
+    for (unsigned int threads : threadCounts) {
+        JobSystem jobs(threads);
+        addRecord("jobs", static_cast<int>(threads), measure(frustums, visible, reference, [&](const Frustum& frustum, uint32_t* output) {
+            return jobsCull(jobs, frustum, arrays, output);
+        }));
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 1 << 20)));
+    const int iterations = std::max(1, getIntArgument(argc, argv, "--iterations", 16));
+    const unsigned int maxThreads = static_cast<unsigned int>(
+        std::max(1, getIntArgument(argc, argv, "--threads", static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))));
+
+    Scene scene = createScene(count);
+    std::vector<Frustum> frustums = createFrustums(iterations);
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 2; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    if (maxThreads > 1) {
+        threadCounts.push_back(maxThreads);
+    }
+
+    BenchmarkReport report("frustum_culling");
+    report.info()
+        .set("objects", count)
+        .set("iterations", iterations)
+#if defined(SIMD_AVX2)
+        .set("simd", "avx2");
+#elif defined(SIMD_SSE2)
+        .set("simd", "sse2");
+#else
+        .set("simd", "none");
+#endif
+
+    runShape(report, "sphere", scene.spheres, frustums, threadCounts, cullSpheresScalar, cullSpheres,
+             [](const Frustum& frustum, const SphereArrays& spheres, uint32_t* visible, unsigned int threads) {
+                 return cullSpheresParallel(frustum, spheres, visible, threads);
+             },
+             [](JobSystem& jobs, const Frustum& frustum, const SphereArrays& spheres, uint32_t* visible) {
+                 return cullSpheresParallel(jobs, frustum, spheres, visible);
+             });
+    runShape(report, "box", scene.boxes, frustums, threadCounts, cullBoxesScalar, cullBoxes,
+             [](const Frustum& frustum, const BoxArrays& boxes, uint32_t* visible, unsigned int threads) {
+                 return cullBoxesParallel(frustum, boxes, visible, threads);
+             },
+             [](JobSystem& jobs, const Frustum& frustum, const BoxArrays& boxes, uint32_t* visible) {
+                 return cullBoxesParallel(jobs, frustum, boxes, visible);
+             });
+
+    report.write(argc, argv);
+    return 0;
+}
@@ -0,0 +1,227 @@
+// GPU视锥剔除基准测试：随机分布在立方体中的大量盒子（默认100k个），相机位于中心，每帧朝向不同的方向
+//  -- cpu : frustum_culling::cullSpheres 在CPU上剔除，可见物体每帧通过 IndirectRenderer 重新记录并上传
+//  -- gpu : GpuCuller，物体只上传一次，计算着色器剔除后由 glMultiDrawElementsIndirectCount 绘制
+// 输出每帧CPU上的耗时（剔除 + 记录提交）、可见物体数、GPU时间和帧时间
+// 另外每帧读回GPU的可见编号与CPU的结果逐个对比（不计入耗时），并比较最后一帧的画面
+// 用法：gpu_culling_benchmark [--out result.json] [--count N] [--frames N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "box.h"
+#include "frustum_culling.h"
+#include "geometry_pool.h"
+#include "gpu_culling.h"
+#include "indirect_renderer.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+const float WORLD_SIZE = 400.0f;
+const uint32_t MESH_COUNT = 16;
+
+struct Object {
+    uint32_t mesh;
+    glm::vec3 center;
+    float radius;
+    IndirectRenderer::DrawData data;
+};
+
+std::vector<Object> createObjects(size_t count, const std::vector<glm::vec3>& extensions) {
+    std::vector<Object> objects(count);
+    uint32_t seed = 39u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (auto& object : objects) {
+        object.mesh = static_cast<uint32_t>(random() * MESH_COUNT) % MESH_COUNT;
+        object.center = (glm::vec3(random(), random(), random()) - 0.5f) * WORLD_SIZE;
+        object.radius = glm::length(extensions[object.mesh]);
+        object.data.model = glm::translate(glm::mat4(1.0f), object.center);
+        object.data.color = glm::vec4(random(), random(), random(), 1.0f);
+    }
+    return objects;
+}
+
+std::vector<unsigned char> readPixels() {
+    std::vector<unsigned char> pixels(static_cast<size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+double differentPixelRatio(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int tolerance) {
+    size_t different = 0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        for (int c = 0; c < 3; c++) {
+            if (std::abs(static_cast<int>(a[i + c]) - static_cast<int>(b[i + c])) > tolerance) {
+                different++;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(different) / static_cast<double>(a.size() / 4);
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+    if (!GLAD_GL_ARB_shader_draw_parameters) {
+        std::cerr << "GL_ARB_shader_draw_parameters is not supported" << std::endl;
+        return 1;
+    }
+
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 100000)));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 30));
+
+    BenchmarkReport report("gpu_culling");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("objects", count)
+        .set("frames", frames)
+        .set("indirect_count", GpuCuller::supportsIndirectCount() ? "true" : "false");
+
+    GeometryPool pool(VertexFormat::positionNormalUV());
+    std::vector<glm::vec3> extensions;
+    std::vector<PoolMesh> meshes;
+    for (uint32_t i = 0; i < MESH_COUNT; i++) {
+        float t = static_cast<float>(i) / MESH_COUNT;
+        extensions.push_back(glm::vec3(0.5f + 1.5f * t, 0.5f + 1.5f * (1.0f - t), 1.0f));
+        meshes.push_back(Box::addToPool(pool, extensions.back()));
+    }
+    std::vector<Object> objects = createObjects(count, extensions);
+
+    frustum_culling::SphereArrays spheres;
+    spheres.resize(count);
+    GpuCuller culler;
+    for (size_t i = 0; i < count; i++) {
+        spheres.set(i, objects[i].center, objects[i].radius);
+        culler.add(meshes[objects[i].mesh], objects[i].data, objects[i].center, objects[i].radius);
+    }
+    Timer uploadTimer;
+    culler.upload();
+    glFinish();
+    report.info().set("upload_ms", uploadTimer.elapsedMs());
+
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    using ShaderType = ShaderProgram::ShaderType;
+    ShaderProgram shaderProgram(
+        {
+            {ShaderType::VERTEX, "shaders/indirect_draw.vert"},
+            {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+        }
+    );
+    IndirectRenderer renderer;
+    const float aspect = (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT;
+    const float zFar = WORLD_SIZE * 0.5f;
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, zFar);
+
+    // 相机在原点，第 i 帧绕Y轴旋转
+    auto viewMatrix = [frames](int frame) {
+        float angle = 6.2831853f * static_cast<float>(frame) / static_cast<float>(frames);
+        return glm::lookAt(glm::vec3(0.0f), glm::vec3(std::cos(angle), 0.2f, std::sin(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+    };
+
+    // 验证：每帧GPU的可见编号与CPU的结果完全一致
+    std::vector<uint32_t> visible(spheres.paddedSize());
+    std::vector<uint32_t> gpuVisible;
+    size_t mismatchedFrames = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        Frustum frustum = Frustum::fromMatrix(projection * viewMatrix(frame));
+        size_t visibleCount = frustum_culling::cullSpheres(frustum, spheres, visible.data());
+        culler.cull(frustum);
+        culler.readVisible(gpuVisible);
+        if (gpuVisible.size() != visibleCount || !std::equal(gpuVisible.begin(), gpuVisible.end(), visible.begin())) {
+            mismatchedFrames++;
+        }
+    }
+    report.info()
+        .set("mismatched_frames", mismatchedFrames)
+        .set("gpu_matches_cpu", mismatchedFrames == 0 ? "true" : "false");
+
+    enum class Mode { CPU, GPU };
+    const std::pair<Mode, const char*> modes[] = {{Mode::CPU, "cpu"}, {Mode::GPU, "gpu"}};
+    std::vector<unsigned char> reference;
+    for (const auto& [mode, modeName] : modes) {
+        std::vector<double> cpuMs;
+        std::vector<double> gpuMs;
+        std::vector<double> frameMs;
+        size_t totalVisible = 0;
+        GpuTimer gpuTimer;
+        for (int frame = 0; frame < frames; frame++) {
+            glm::mat4 view = viewMatrix(frame);
+            Frustum frustum = Frustum::fromMatrix(projection * view);
+
+            Timer frameTimer;
+            gpuTimer.begin();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            Timer cpuTimer;
+            if (mode == Mode::CPU) {
+                size_t visibleCount = frustum_culling::cullSpheres(frustum, spheres, visible.data());
+                shaderProgram.use();
+                shaderProgram.setUniform("view", view);
+                shaderProgram.setUniform("projection", projection);
+                shaderProgram.setUniform("tint", glm::vec4(1.0f));
+                renderer.begin();
+                for (size_t i = 0; i < visibleCount; i++) {
+                    const Object& object = objects[visible[i]];
+                    renderer.add(pool, meshes[object.mesh], object.data);
+                }
+                renderer.submit();
+                totalVisible += visibleCount;
+            } else {
+                culler.cull(frustum);
+                shaderProgram.use();
+                shaderProgram.setUniform("view", view);
+                shaderProgram.setUniform("projection", projection);
+                shaderProgram.setUniform("tint", glm::vec4(1.0f));
+                culler.draw(pool);
+            }
+            cpuMs.push_back(cpuTimer.elapsedMs());
+            gpuTimer.end();
+
+            glFinish();
+            frameMs.push_back(frameTimer.elapsedMs());
+            gpuMs.push_back(gpuTimer.resultMs());
+            if (mode == Mode::GPU) {
+                // 帧时间之外读回，只用于统计
+                totalVisible += culler.readDrawCount();
+            }
+        }
+
+        std::vector<unsigned char> pixels = readPixels();
+        if (reference.empty()) {
+            reference = pixels;
+        }
+        report.addRecord()
+            .set("mode", modeName)
+            .set("visible", totalVisible / frames)
+            .set("cpu_ms", median(cpuMs))
+            .set("gpu_ms", median(gpuMs))
+            .set("frame_ms", median(frameMs))
+            .set("different_pixels", differentPixelRatio(reference, pixels, 16));
+    }
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,262 @@
+// Hi-Z遮挡剔除基准测试：密集的城市场景，相机沿街道在楼房之间移动，大部分物体被楼房挡住
+//  -- 楼房排列成网格（默认100x100），每栋楼的楼顶还有几个小盒子（从街道上看不到）
+//  -- frustum : GpuCuller 只做视锥剔除
+//  -- hi_z    : 先用上一帧的Hi-Z和 投影 * 视图 矩阵做遮挡测试，绘制后再用本帧的深度生成Hi-Z
+// 输出每帧平均绘制、被遮挡的物体数、GPU时间和帧时间，Hi-Z的生成耗时，
+// 以及每隔几帧与 frustum 模式的画面对比（上一帧的深度在相机移动时可能造成个别物体晚一帧出现）
+// 用法：hi_z_occlusion_benchmark [--out result.json] [--grid N] [--frames N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "box.h"
+#include "geometry_pool.h"
+#include "gpu_culling.h"
+#include "hi_z.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+const float CELL_SIZE = 4.0f;
+const int ROOFTOP_OBJECTS = 4;
+const int COMPARE_INTERVAL = 8;
+
+// 颜色和深度纹理的帧缓冲，深度纹理用于生成Hi-Z
+class RenderTarget {
+public:
+    RenderTarget(int width, int height) {
+        glGenTextures(1, &m_color);
+        glBindTexture(GL_TEXTURE_2D, m_color);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+        glGenTextures(1, &m_depth);
+        glBindTexture(GL_TEXTURE_2D, m_depth);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &m_framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+        m_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    ~RenderTarget() {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteTextures(1, &m_color);
+        glDeleteTextures(1, &m_depth);
+    }
+
+    void bind() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    }
+
+    GLuint depthTexture() const {
+        return m_depth;
+    }
+
+    bool complete() const {
+        return m_complete;
+    }
+
+private:
+    GLuint m_framebuffer;
+    GLuint m_color;
+    GLuint m_depth;
+    bool m_complete;
+};
+
+// 楼房位于每个格子的中心，街道在格子之间
+void createCity(int grid, const PoolMesh& box, GpuCuller& culler) {
+    uint32_t seed = 40u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    auto addBox = [&](const glm::vec3& center, const glm::vec3& extent, const glm::vec4& color) {
+        glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), center), extent);
+        culler.add(box, {model, color}, center, glm::length(extent));
+    };
+    for (int z = 0; z < grid; z++) {
+        for (int x = 0; x < grid; x++) {
+            glm::vec3 base(x * CELL_SIZE, 0.0f, z * CELL_SIZE);
+            glm::vec3 extent(1.2f + 0.5f * random(), 3.0f + 9.0f * random(), 1.2f + 0.5f * random());
+            float gray = 0.4f + 0.4f * random();
+            addBox(base + glm::vec3(0.0f, extent.y, 0.0f), extent, glm::vec4(gray, gray, gray * 1.1f, 1.0f));
+            for (int i = 0; i < ROOFTOP_OBJECTS; i++) {
+                glm::vec3 offset((random() - 0.5f) * extent.x, 2.0f * extent.y + 0.3f, (random() - 0.5f) * extent.z);
+                addBox(base + offset, glm::vec3(0.3f), glm::vec4(random(), random(), random(), 1.0f));
+            }
+        }
+    }
+}
+
+// 相机在第一条和第二条楼房之间的街道上向前移动，视线左右摆动
+glm::mat4 viewMatrix(int frame, int frames, int grid) {
+    float t = static_cast<float>(frame) / static_cast<float>(frames);
+    glm::vec3 eye(CELL_SIZE * 0.5f, 1.5f, CELL_SIZE * (1.0f + 0.5f * t * grid));
+    float yaw = 0.35f * std::sin(6.2831853f * t * 2.0f);
+    return glm::lookAt(eye, eye + glm::vec3(std::sin(yaw), 0.05f, std::cos(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+std::vector<unsigned char> readPixels() {
+    std::vector<unsigned char> pixels(static_cast<size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+double differentPixelRatio(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int tolerance) {
+    size_t different = 0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        for (int c = 0; c < 3; c++) {
+            if (std::abs(static_cast<int>(a[i + c]) - static_cast<int>(b[i + c])) > tolerance) {
+                different++;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(different) / static_cast<double>(a.size() / 4);
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+    if (!GLAD_GL_ARB_shader_draw_parameters) {
+        std::cerr << "GL_ARB_shader_draw_parameters is not supported" << std::endl;
+        return 1;
+    }
+
+    const int grid = std::max(2, getIntArgument(argc, argv, "--grid", 100));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 60));
+
+    RenderTarget target(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!target.complete()) {
+        std::cerr << "Framebuffer is not complete" << std::endl;
+        return 1;
+    }
+
+    GeometryPool pool(VertexFormat::positionNormalUV());
+    PoolMesh box = Box::addToPool(pool);
+    GpuCuller culler;
+    createCity(grid, box, culler);
+    culler.upload();
+    HiZBuffer hiZ(SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    BenchmarkReport report("hi_z_occlusion");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("objects", culler.objectCount())
+        .set("frames", frames)
+        .set("hi_z_levels", hiZ.levels());
+
+    target.bind();
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glClearColor(0.5f, 0.6f, 0.7f, 1.0f);
+
+    using ShaderType = ShaderProgram::ShaderType;
+    ShaderProgram shaderProgram(
+        {
+            {ShaderType::VERTEX, "shaders/indirect_draw.vert"},
+            {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+        }
+    );
+    const float zFar = CELL_SIZE * grid * 1.5f;
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, zFar);
+
+    enum class Mode { FRUSTUM, HI_Z };
+    const std::pair<Mode, const char*> modes[] = {{Mode::FRUSTUM, "frustum"}, {Mode::HI_Z, "hi_z"}};
+    std::vector<std::vector<unsigned char>> reference;
+    for (const auto& [mode, modeName] : modes) {
+        std::vector<double> gpuMs;
+        std::vector<double> frameMs;
+        size_t totalDrawn = 0;
+        size_t totalOccluded = 0;
+        double maxDifferentPixels = 0.0;
+        hiZ.resize(SCREEN_WIDTH, SCREEN_HEIGHT);
+        glm::mat4 previousViewProjection(1.0f);
+        GpuTimer gpuTimer;
+        for (int frame = 0; frame < frames; frame++) {
+            glm::mat4 view = viewMatrix(frame, frames, grid);
+            Frustum frustum = Frustum::fromMatrix(projection * view);
+
+            Timer frameTimer;
+            gpuTimer.begin();
+            target.bind();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            if (mode == Mode::HI_Z) {
+                culler.cull(frustum, hiZ, previousViewProjection);
+            } else {
+                culler.cull(frustum);
+            }
+            shaderProgram.use();
+            shaderProgram.setUniform("view", view);
+            shaderProgram.setUniform("projection", projection);
+            shaderProgram.setUniform("tint", glm::vec4(1.0f));
+            culler.draw(pool);
+            if (mode == Mode::HI_Z) {
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                hiZ.build(target.depthTexture());
+                previousViewProjection = projection * view;
+            }
+            gpuTimer.end();
+
+            glFinish();
+            frameMs.push_back(frameTimer.elapsedMs());
+            gpuMs.push_back(gpuTimer.resultMs());
+            // 帧时间之外读回，只用于统计
+            totalDrawn += culler.readDrawCount();
+            totalOccluded += culler.readOccludedCount();
+            if (frame % COMPARE_INTERVAL == 0) {
+                target.bind();
+                std::vector<unsigned char> pixels = readPixels();
+                if (mode == Mode::FRUSTUM) {
+                    reference.push_back(std::move(pixels));
+                } else {
+                    maxDifferentPixels = std::max(maxDifferentPixels, differentPixelRatio(reference[frame / COMPARE_INTERVAL], pixels, 16));
+                }
+            }
+        }
+
+        report.addRecord()
+            .set("mode", modeName)
+            .set("drawn", totalDrawn / frames)
+            .set("occluded", totalOccluded / frames)
+            .set("gpu_ms", median(gpuMs))
+            .set("frame_ms", median(frameMs))
+            .set("max_different_pixels", maxDifferentPixels);
+    }
+
+    // Hi-Z的生成耗时（最后一帧的深度）
+    std::vector<double> buildMs;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    for (int i = 0; i < 10; i++) {
+        Timer timer;
+        hiZ.build(target.depthTexture());
+        glFinish();
+        buildMs.push_back(timer.elapsedMs());
+    }
+    report.info().set("hi_z_build_ms", median(buildMs));
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,198 @@
+// 输入延迟基准测试：一个线程模拟高回报率的鼠标，把光标事件放入 InputQueue，主线程按帧消费
+//  -- 每帧依次为：更新（模拟、剔除等CPU工作，用忙等代替）、提交绘制（忙等 + 清屏）、显示（glFinish + 交换缓冲区）
+//  -- frame_start   : 帧开始时取出输入（之前在 glfwPollEvents 的回调中直接修改相机的方式）
+//  -- before_render : 更新之后、提交绘制之前才取出输入
+//  输出每帧最新和最早的事件到显示完成的延迟（中位数），每帧合并后的鼠标移动段数和事件数
+//  -- queue : 两个线程之间传递事件的吞吐量，SpscQueue 与 std::mutex + std::deque 对比
+// 用法：input_latency_benchmark [--out result.json] [--frames N] [--update-ms N] [--render-ms N] [--rate N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "input_queue.h"
+#include "spsc_queue.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+const size_t QUEUE_EVENTS = 10000000;
+
+void busyWait(double ms) {
+    Timer timer;
+    while (timer.elapsedMs() < ms) {
+    }
+}
+
+// 以固定的频率产生光标事件，光标在屏幕上画圆
+class MouseSimulator {
+public:
+    MouseSimulator(InputQueue& queue, int rate) : m_queue(queue), m_interval(std::chrono::microseconds(1000000 / std::max(1, rate))) {
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    ~MouseSimulator() {
+        m_running = false;
+        m_thread.join();
+    }
+
+private:
+    InputQueue& m_queue;
+    std::chrono::microseconds m_interval;
+    std::atomic<bool> m_running{true};
+    std::thread m_thread;
+
+    void run() {
+        auto next = std::chrono::steady_clock::now();
+        int step = 0;
+        while (m_running) {
+            float angle = 0.01f * step++;
+            m_queue.push({InputEvent::CURSOR_MOVE, 0, 0, 640.0f + 200.0f * std::cos(angle), 360.0f + 200.0f * std::sin(angle), glfwGetTime()});
+            next += m_interval;
+            std::this_thread::sleep_until(next);
+        }
+    }
+};
+
+// 生产者线程写入 count 个事件，消费者（调用线程）全部取出，返回耗时
+template <typename Push, typename Pop>
+double transfer(size_t count, Push push, Pop pop) {
+    Timer timer;
+    std::thread producer([&]() {
+        InputEvent event = {InputEvent::CURSOR_MOVE, 0, 0, 0.0f, 0.0f, 0.0};
+        for (size_t i = 0; i < count; i++) {
+            event.x = static_cast<float>(i);
+            while (!push(event)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    size_t received = 0;
+    InputEvent event;
+    while (received < count) {
+        if (pop(event)) {
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    return timer.elapsedMs();
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 240));
+    const double updateMs = std::max(0, getIntArgument(argc, argv, "--update-ms", 6));
+    const double renderMs = std::max(0, getIntArgument(argc, argv, "--render-ms", 2));
+    const int rate = std::max(1, getIntArgument(argc, argv, "--rate", 1000));
+
+    BenchmarkReport report("input_latency");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("frames", frames)
+        .set("update_ms", updateMs)
+        .set("render_ms", renderMs)
+        .set("mouse_rate", rate);
+
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+    enum class Mode { FRAME_START, BEFORE_RENDER };
+    const std::pair<Mode, const char*> modes[] = {{Mode::FRAME_START, "frame_start"}, {Mode::BEFORE_RENDER, "before_render"}};
+    for (const auto& [mode, modeName] : modes) {
+        InputQueue input(4096);
+        std::vector<double> newestMs, oldestMs, frameMs;
+        size_t totalEvents = 0;
+        size_t totalMotions = 0;
+        {
+            MouseSimulator mouse(input, rate);
+            // 等待第一个事件，之后每帧都有新的事件
+            busyWait(5.0);
+            input.poll();
+            for (int frame = 0; frame < frames; frame++) {
+                Timer frameTimer;
+                InputFrame inputFrame;
+                if (mode == Mode::FRAME_START) {
+                    inputFrame = input.poll();
+                }
+                busyWait(updateMs);
+                if (mode == Mode::BEFORE_RENDER) {
+                    inputFrame = input.poll();
+                }
+                busyWait(renderMs);
+                glClear(GL_COLOR_BUFFER_BIT);
+                glFinish();
+                glfwSwapBuffers(window);
+                double presentTime = glfwGetTime();
+                frameMs.push_back(frameTimer.elapsedMs());
+                if (inputFrame.eventCount > 0) {
+                    newestMs.push_back((presentTime - inputFrame.newestTime) * 1000.0);
+                    oldestMs.push_back((presentTime - inputFrame.oldestTime) * 1000.0);
+                }
+                totalEvents += inputFrame.eventCount;
+                totalMotions += inputFrame.motions.size();
+            }
+        }
+        report.addRecord()
+            .set("mode", modeName)
+            .set("newest_event_latency_ms", median(newestMs))
+            .set("oldest_event_latency_ms", median(oldestMs))
+            .set("frame_ms", median(frameMs))
+            .set("events_per_frame", static_cast<double>(totalEvents) / frames)
+            .set("motions_per_frame", static_cast<double>(totalMotions) / frames)
+            .set("dropped", input.droppedCount());
+    }
+
+    // queue
+    {
+        SpscQueue<InputEvent> spsc(4096);
+        double spscMs = transfer(QUEUE_EVENTS,
+            [&spsc](const InputEvent& event) { return spsc.push(event); },
+            [&spsc](InputEvent& event) { return spsc.pop(event); });
+
+        std::mutex mutex;
+        std::deque<InputEvent> deque;
+        double mutexMs = transfer(QUEUE_EVENTS,
+            [&](const InputEvent& event) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (deque.size() >= 4096) {
+                    return false;
+                }
+                deque.push_back(event);
+                return true;
+            },
+            [&](InputEvent& event) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (deque.empty()) {
+                    return false;
+                }
+                event = deque.front();
+                deque.pop_front();
+                return true;
+            });
+        report.addRecord()
+            .set("mode", "queue")
+            .set("events", QUEUE_EVENTS)
+            .set("spsc_events_per_ms", QUEUE_EVENTS / spscMs)
+            .set("mutex_events_per_ms", QUEUE_EVENTS / mutexMs);
+    }
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
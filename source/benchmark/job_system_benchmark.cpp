@@ -0,0 +1,193 @@
+// JobSystem 基准测试（只使用CPU，不需要OpenGL上下文），线程数从1开始每次翻倍，直到 --threads（最多64）：
+//  -- spawn        : 0号线程 spawn 空任务（每 JOB_POOL_SIZE / 2 个等待一次），每个任务的平均耗时
+//  -- nested_spawn : 每个任务再 spawn SPAWN_FANOUT 个空任务，任务分散在各个线程的队列中，测试窃取
+//  -- parallel_for : 对 --items 个元素做固定的计算，grain 为 1、64、1024 和自动选择（0）
+//  -- std_thread   : 同样的计算，每次调用都创建 threads - 1 个 std::thread 平均分段（此前各模块的做法）
+// 输出每种情况的耗时、相对1个线程的加速比，以及计算结果是否与单线程一致
+// 用法：job_system_benchmark [--out result.json] [--threads N] [--jobs N] [--items N] [--iterations N]
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "job_system.h"
+
+const size_t SPAWN_BATCH = JobSystem::JOB_POOL_SIZE / 2;
+const size_t SPAWN_FANOUT = 64;
+
+// 每个元素的计算量大约几百纳秒
+inline float work(size_t item) {
+    float x = static_cast<float>(item & 1023) * 0.001f;
+    for (int i = 0; i < 64; i++) {
+        x = std::sqrt(x * x + 1.0f) * 0.5f + std::sin(x) * 0.25f;
+    }
+    return x;
+}
+
+double measureSpawn(JobSystem& jobs, size_t jobCount, size_t& executed) {
+    std::atomic<size_t> count{0};
+    Timer timer;
+    for (size_t begin = 0; begin < jobCount; begin += SPAWN_BATCH) {
+        JobCounter counter;
+        const size_t end = std::min(jobCount, begin + SPAWN_BATCH);
+        for (size_t i = begin; i < end; i++) {
+            jobs.spawn(counter, [&count]() { count.fetch_add(1, std::memory_order_relaxed); });
+        }
+        jobs.wait(counter);
+    }
+    double ms = timer.elapsedMs();
+    executed = count.load();
+    return ms;
+}
+
+double measureNestedSpawn(JobSystem& jobs, size_t jobCount, size_t& executed) {
+    std::atomic<size_t> count{0};
+    const size_t parents = std::max<size_t>(1, jobCount / SPAWN_FANOUT);
+    Timer timer;
+    JobCounter counter;
+    for (size_t p = 0; p < parents; p++) {
+        jobs.spawn(counter, [&jobs, &count]() {
+            JobCounter children;
+            for (size_t i = 0; i < SPAWN_FANOUT; i++) {
+                jobs.spawn(children, [&count]() { count.fetch_add(1, std::memory_order_relaxed); });
+            }
+            jobs.wait(children);
+        });
+        if ((p + 1) % (SPAWN_BATCH / 2) == 0) {
+            jobs.wait(counter);
+        }
+    }
+    jobs.wait(counter);
+    double ms = timer.elapsedMs();
+    executed = count.load();
+    return ms;
+}
+
+void computeStdThreads(std::vector<float>& results, unsigned int threadCount) {
+    const size_t count = results.size();
+    auto compute = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            results[i] = work(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threadCount; t++) {
+        threads.emplace_back(compute, count * t / threadCount, count * (t + 1) / threadCount);
+    }
+    compute(0, count / threadCount);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+int main(int argc, char** argv) {
+    const unsigned int maxThreads = static_cast<unsigned int>(std::min(64, std::max(1,
+        getIntArgument(argc, argv, "--threads", static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))))));
+    const size_t jobCount = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--jobs", 1 << 18)));
+    const size_t itemCount = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--items", 1 << 18)));
+    const int iterations = std::max(1, getIntArgument(argc, argv, "--iterations", 5));
+
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    BenchmarkReport report("job_system");
+    report.info()
+        .set("hardware_threads", static_cast<int>(std::thread::hardware_concurrency()))
+        .set("jobs", jobCount)
+        .set("items", itemCount)
+        .set("iterations", iterations);
+
+    std::vector<float> reference(itemCount);
+    for (size_t i = 0; i < itemCount; i++) {
+        reference[i] = work(i);
+    }
+
+    const size_t grains[] = {1, 64, 1024, 0};
+    std::vector<double> singleThreadMs;      // 1个线程时每种 grain 的耗时，用于计算加速比
+    double singleStdThreadMs = 0.0;
+    bool correct = true;
+    for (unsigned int threads : threadCounts) {
+        JobSystem jobs(threads);
+
+        std::vector<double> spawnSamples, nestedSamples;
+        size_t executed = 0, nestedExecuted = 0;
+        for (int i = 0; i < iterations; i++) {
+            spawnSamples.push_back(measureSpawn(jobs, jobCount, executed));
+            nestedSamples.push_back(measureNestedSpawn(jobs, jobCount, nestedExecuted));
+        }
+        const size_t nestedCount = std::max<size_t>(1, jobCount / SPAWN_FANOUT) * SPAWN_FANOUT;
+        correct = correct && executed == jobCount && nestedExecuted == nestedCount;
+        report.addRecord()
+            .set("test", "spawn")
+            .set("threads", static_cast<int>(threads))
+            .set("ms", median(spawnSamples))
+            .set("ns_per_job", median(spawnSamples) * 1e6 / static_cast<double>(jobCount))
+            .set("correct", executed == jobCount ? "true" : "false");
+        report.addRecord()
+            .set("test", "nested_spawn")
+            .set("threads", static_cast<int>(threads))
+            .set("ms", median(nestedSamples))
+            .set("ns_per_job", median(nestedSamples) * 1e6 / static_cast<double>(nestedCount))
+            .set("correct", nestedExecuted == nestedCount ? "true" : "false");
+
+        for (size_t g = 0; g < std::size(grains); g++) {
+            std::vector<float> results(itemCount);
+            std::vector<double> samples;
+            for (int i = 0; i < iterations; i++) {
+                std::fill(results.begin(), results.end(), 0.0f);
+                Timer timer;
+                jobs.parallelFor(0, itemCount, grains[g], [&results](size_t begin, size_t end) {
+                    for (size_t item = begin; item < end; item++) {
+                        results[item] = work(item);
+                    }
+                });
+                samples.push_back(timer.elapsedMs());
+            }
+            const bool matches = results == reference;
+            correct = correct && matches;
+            const double ms = median(samples);
+            if (threads == 1) {
+                singleThreadMs.push_back(ms);
+            }
+            report.addRecord()
+                .set("test", "parallel_for")
+                .set("threads", static_cast<int>(threads))
+                .set("grain", grains[g])
+                .set("ms", ms)
+                .set("speedup", ms > 0.0 ? singleThreadMs[g] / ms : 0.0)
+                .set("correct", matches ? "true" : "false");
+        }
+
+        std::vector<float> results(itemCount);
+        std::vector<double> samples;
+        for (int i = 0; i < iterations; i++) {
+            Timer timer;
+            computeStdThreads(results, threads);
+            samples.push_back(timer.elapsedMs());
+        }
+        const bool matches = results == reference;
+        correct = correct && matches;
+        const double ms = median(samples);
+        if (threads == 1) {
+            singleStdThreadMs = ms;
+        }
+        report.addRecord()
+            .set("test", "std_thread")
+            .set("threads", static_cast<int>(threads))
+            .set("ms", ms)
+            .set("speedup", ms > 0.0 ? singleStdThreadMs / ms : 0.0)
+            .set("correct", matches ? "true" : "false");
+    }
+    report.info().set("correct", correct ? "true" : "false");
+
+    report.write(argc, argv);
+    return correct ? 0 : 1;
+}
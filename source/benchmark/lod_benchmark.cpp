@@ -0,0 +1,242 @@
+// LOD基准测试：一片由高精度球和圆环组成的物体，从近处一直排到远处
+//  -- 先对每种网格生成LOD链（mesh_simplifier），输出每一级的三角形数、误差和生成耗时
+//  -- full 模式总是绘制第0级，lod 模式由 LodSelector 按屏幕空间误差选择级别，分别使用几个不同的像素阈值
+//  -- 每种模式输出每帧的三角形数、各级别的物体数、选择耗时和帧时间
+//  -- 最后读回画面和 full 模式比较，输出差异超过阈值的像素比例
+// 所有物体通过 IndirectRenderer 一次提交
+// 用法：lod_benchmark [--out result.json] [--rows N] [--columns N] [--frames N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "arcball_camera.h"
+#include "benchmark_utils.h"
+#include "geometry_pool.h"
+#include "indirect_renderer.h"
+#include "lod.h"
+#include "procedural_mesh.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+
+struct SourceMesh {
+    std::string name;
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+
+    uint32_t vertexCount() const {
+        return static_cast<uint32_t>(vertices.size() / procedural_mesh::FLOATS_PER_VERTEX);
+    }
+};
+
+std::vector<SourceMesh> createSourceMeshes() {
+    std::vector<SourceMesh> meshes;
+    {
+        const procedural_mesh::MeshSize size = procedural_mesh::icosphereSize(24);
+        SourceMesh mesh{"icosphere", std::vector<float>(size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX), std::vector<uint32_t>(size.indexCount)};
+        procedural_mesh::generateIcosphere(1.0f, 24, mesh.vertices.data(), mesh.indices.data());
+        meshes.push_back(std::move(mesh));
+    }
+    {
+        const procedural_mesh::MeshSize size = procedural_mesh::torusSize(128, 64);
+        SourceMesh mesh{"torus", std::vector<float>(size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX), std::vector<uint32_t>(size.indexCount)};
+        procedural_mesh::generateTorus(0.8f, 0.3f, 128, 64, mesh.vertices.data(), mesh.indices.data());
+        meshes.push_back(std::move(mesh));
+    }
+    return meshes;
+}
+
+struct Object {
+    uint32_t mesh;
+    glm::mat4 model;
+    glm::vec4 color;
+};
+
+// 物体在 x 方向排成 columns 列，z 方向从相机前方排到远处，行距逐渐增大
+std::vector<Object> createObjects(int rows, int columns, uint32_t meshCount) {
+    std::vector<Object> objects;
+    uint32_t seed = 35u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    float z = -4.0f;
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            float x = (static_cast<float>(column) - (columns - 1) * 0.5f) * (3.0f + 0.05f * -z);
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, z));
+            model = glm::rotate(model, random() * 6.2831853f, glm::vec3(0.3f, 1.0f, 0.2f));
+            objects.push_back({static_cast<uint32_t>((row + column) % meshCount), model, glm::vec4(0.3f + 0.7f * random(), 0.3f + 0.7f * random(), 0.3f + 0.7f * random(), 1.0f)});
+        }
+        z -= 3.0f + 0.08f * -z;
+    }
+    return objects;
+}
+
+std::vector<unsigned char> readPixels() {
+    std::vector<unsigned char> pixels(static_cast<size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+// 任意通道相差超过 tolerance 的像素比例
+double differentPixelRatio(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int tolerance) {
+    size_t different = 0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        for (int c = 0; c < 3; c++) {
+            if (std::abs(static_cast<int>(a[i + c]) - static_cast<int>(b[i + c])) > tolerance) {
+                different++;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(different) / static_cast<double>(a.size() / 4);
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+    if (!GLAD_GL_ARB_shader_draw_parameters) {
+        std::cerr << "GL_ARB_shader_draw_parameters is not supported" << std::endl;
+        return 1;
+    }
+
+    const int rows = std::max(1, getIntArgument(argc, argv, "--rows", 24));
+    const int columns = std::max(1, getIntArgument(argc, argv, "--columns", 9));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 30));
+
+    BenchmarkReport report("lod");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("frames", frames)
+        .set("viewport", std::to_string(SCREEN_WIDTH) + "x" + std::to_string(SCREEN_HEIGHT));
+
+    // 生成LOD链并上传
+    std::vector<SourceMesh> sources = createSourceMeshes();
+    GeometryPool pool(VertexFormat::positionNormalUV());
+    std::vector<LodMesh> lodMeshes;
+    for (const auto& source : sources) {
+        Timer timer;
+        lodMeshes.push_back(createLodMesh(pool, source.vertices.data(), source.vertexCount(), procedural_mesh::FLOATS_PER_VERTEX * sizeof(float),
+                                          source.indices.data(), static_cast<uint32_t>(source.indices.size())));
+        double simplifyMs = timer.elapsedMs();
+        const LodMesh& lodMesh = lodMeshes.back();
+        for (size_t level = 0; level < lodMesh.levelCount(); level++) {
+            report.addRecord()
+                .set("stage", "lod_chain")
+                .set("mesh", source.name)
+                .set("level", level)
+                .set("triangles", static_cast<size_t>(lodMesh.triangleCount(level)))
+                .set("error", static_cast<double>(lodMesh.errors[level]))
+                .set("simplify_ms", level == 0 ? simplifyMs : 0.0);
+        }
+    }
+
+    std::vector<Object> objects = createObjects(rows, columns, static_cast<uint32_t>(lodMeshes.size()));
+    report.info().set("objects", objects.size());
+
+    ArcballCamera camera(glm::vec3(0.0f, 2.5f, 4.0f), glm::vec3(0.0f, 0.0f, -30.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(camera.getZoom()), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 1000.0f);
+    glm::mat4 view = camera.getViewMatrix();
+
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    using ShaderType = ShaderProgram::ShaderType;
+    ShaderProgram shaderProgram(
+        {
+            {ShaderType::VERTEX, "shaders/indirect_draw.vert"},
+            {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+        }
+    );
+    IndirectRenderer renderer;
+
+    // 像素阈值为0表示总是使用第0级
+    const float thresholds[] = {0.0f, 0.5f, 1.0f, 2.0f, 4.0f};
+    std::vector<unsigned char> reference;
+    for (float threshold : thresholds) {
+        LodSelector selector = LodSelector::fromCamera(camera, static_cast<float>(SCREEN_HEIGHT), threshold);
+        std::vector<size_t> histogram;
+        size_t triangles = 0;
+        std::vector<double> selectMs;
+        std::vector<double> frameMs;
+        std::vector<double> gpuMs;
+        GpuTimer gpuTimer;
+        for (int frame = 0; frame < frames; frame++) {
+            Timer frameTimer;
+            gpuTimer.begin();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            shaderProgram.use();
+            shaderProgram.setUniform("view", view);
+            shaderProgram.setUniform("projection", projection);
+            shaderProgram.setUniform("tint", glm::vec4(1.0f));
+
+            Timer selectTimer;
+            histogram.assign(5, 0);
+            triangles = 0;
+            renderer.begin();
+            for (const auto& object : objects) {
+                const LodMesh& mesh = lodMeshes[object.mesh];
+                size_t level = threshold > 0.0f ? selector.select(mesh, object.model) : 0;
+                if (level >= histogram.size()) {
+                    histogram.resize(level + 1, 0);
+                }
+                histogram[level]++;
+                triangles += mesh.triangleCount(level);
+                renderer.add(pool, mesh.levels[level], {object.model, object.color});
+            }
+            selectMs.push_back(selectTimer.elapsedMs());
+            renderer.submit();
+            gpuTimer.end();
+
+            glFinish();
+            frameMs.push_back(frameTimer.elapsedMs());
+            gpuMs.push_back(gpuTimer.resultMs());
+        }
+
+        std::vector<unsigned char> pixels = readPixels();
+        if (reference.empty()) {
+            reference = pixels;
+        }
+        std::string levels;
+        for (size_t level = 0; level < histogram.size(); level++) {
+            levels += (level == 0 ? "" : "/") + std::to_string(histogram[level]);
+        }
+        report.addRecord()
+            .set("stage", "render")
+            .set("mode", threshold > 0.0f ? "lod" : "full")
+            .set("pixel_threshold", static_cast<double>(threshold))
+            .set("triangles", triangles)
+            .set("objects_per_level", levels)
+            .set("select_ms", median(selectMs))
+            .set("gpu_ms", median(gpuMs))
+            .set("frame_ms", median(frameMs))
+            .set("different_pixels", differentPixelRatio(reference, pixels, 16));
+    }
+    glDisable(GL_CULL_FACE);
+
+    for (auto& mesh : lodMeshes) {
+        freeLodMesh(pool, mesh);
+    }
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
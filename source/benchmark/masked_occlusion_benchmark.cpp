@@ -0,0 +1,344 @@
+// CPU遮挡剔除基准测试（只使用CPU，不需要OpenGL上下文）：与 hi_z_occlusion_benchmark 相同的城市场景
+//  -- 视锥内的楼房作为遮挡物光栅化到 OcclusionBuffer 中，然后测试所有视锥内物体（楼房和楼顶的小盒子）的AABB
+//  -- rasterize : 标量、AVX2（没有时与标量相同）和多线程实现每毫秒光栅化的三角形数，以及结果是否与标量实现完全一致
+//  -- accuracy  : 与全分辨率逐像素的参考深度缓冲对比（覆盖规则相同，深度精确），统计两者剔除的物体数
+//                 false_occluded 为被错误剔除的物体（应为0），accuracy 为剔除的物体占参考结果的比例
+//  -- pipeline  : 下一帧的遮挡剔除在工作线程上进行，同时主线程处理当前帧（这里用参考光栅化代替渲染），与串行执行对比
+// 用法：masked_occlusion_benchmark [--out result.json] [--grid N] [--frames N] [--width N] [--height N] [--threads N]
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "frustum.h"
+#include "masked_occlusion.h"
+#include "procedural_mesh.h"
+
+using namespace masked_occlusion;
+
+const float CELL_SIZE = 4.0f;
+const int ROOFTOP_OBJECTS = 4;
+const size_t BOX_STRIDE = procedural_mesh::FLOATS_PER_VERTEX * sizeof(float);
+
+struct Object {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    glm::mat4 model;        // 单位盒子 [-1, 1] -> 物体
+    bool occluder;
+};
+
+std::vector<Object> createCity(int grid) {
+    std::vector<Object> objects;
+    uint32_t seed = 40u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    auto addBox = [&](const glm::vec3& center, const glm::vec3& extent, bool occluder) {
+        glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), center), extent);
+        objects.push_back({center - extent, center + extent, model, occluder});
+    };
+    for (int z = 0; z < grid; z++) {
+        for (int x = 0; x < grid; x++) {
+            glm::vec3 base(x * CELL_SIZE, 0.0f, z * CELL_SIZE);
+            glm::vec3 extent(1.2f + 0.5f * random(), 3.0f + 9.0f * random(), 1.2f + 0.5f * random());
+            addBox(base + glm::vec3(0.0f, extent.y, 0.0f), extent, true);
+            for (int i = 0; i < ROOFTOP_OBJECTS; i++) {
+                glm::vec3 offset((random() - 0.5f) * extent.x, 2.0f * extent.y + 0.3f, (random() - 0.5f) * extent.z);
+                addBox(base + offset, glm::vec3(0.3f), false);
+            }
+        }
+    }
+    return objects;
+}
+
+// 相机在第一条和第二条楼房之间的街道上向前移动，视线左右摆动
+glm::mat4 viewMatrix(int frame, int frames, int grid) {
+    float t = static_cast<float>(frame) / static_cast<float>(frames);
+    glm::vec3 eye(CELL_SIZE * 0.5f, 1.5f, CELL_SIZE * (1.0f + 0.5f * t * grid));
+    float yaw = 0.35f * std::sin(6.2831853f * t * 2.0f);
+    return glm::lookAt(eye, eye + glm::vec3(std::sin(yaw), 0.05f, std::cos(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// 全分辨率的参考深度缓冲：覆盖规则与 OcclusionBuffer 相同（逐行的掩码），每个像素使用精确的深度
+class ReferenceDepthBuffer {
+public:
+    ReferenceDepthBuffer(int width, int height) : m_width(width), m_height(height), m_depth(static_cast<size_t>(width) * height) {}
+
+    void clear() {
+        std::fill(m_depth.begin(), m_depth.end(), 0.0f);
+    }
+
+    void renderBox(const glm::mat4& modelViewProjection) {
+        glm::vec4 clip[procedural_mesh::BOX_SIZE.vertexCount];
+        for (uint32_t i = 0; i < procedural_mesh::BOX_SIZE.vertexCount; i++) {
+            const float* p = &procedural_mesh::BOX_VERTICES[i * procedural_mesh::FLOATS_PER_VERTEX];
+            clip[i] = modelViewProjection * glm::vec4(p[0], p[1], p[2], 1.0f);
+        }
+        const auto& indices = procedural_mesh::BOX_INDICES<uint32_t>;
+        const int tilesX = m_width / TILE_WIDTH;
+        const int tilesY = m_height / TILE_HEIGHT;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            detail::Triangle triangle;
+            if (!detail::setupTriangle(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]], m_width, m_height,
+                                       tilesX, tilesY, triangle)) {
+                continue;
+            }
+            uint32_t mask[TILE_HEIGHT];
+            for (int ty = triangle.tileY0; ty <= triangle.tileY1; ty++) {
+                for (int tx = triangle.tileX0; tx <= triangle.tileX1; tx++) {
+                    detail::tileMaskScalar(triangle, static_cast<float>(tx * TILE_WIDTH), static_cast<float>(ty * TILE_HEIGHT), mask);
+                    for (int r = 0; r < TILE_HEIGHT; r++) {
+                        const int y = ty * TILE_HEIGHT + r;
+                        for (uint32_t bits = mask[r]; bits != 0; bits &= bits - 1) {
+                            const int x = tx * TILE_WIDTH + countTrailingZeros(bits);
+                            float z = triangle.zA * (x + 0.5f) + triangle.zB * (y + 0.5f) + triangle.zC;
+                            float& depth = m_depth[static_cast<size_t>(y) * m_width + x];
+                            depth = std::max(depth, z);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // 与 OcclusionBuffer::isVisible 相同的矩形，逐像素比较
+    bool isVisible(const glm::mat4& viewProjection, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+        glm::vec2 screenMin(FLT_MAX);
+        glm::vec2 screenMax(-FLT_MAX);
+        float nearest = 0.0f;
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y, (i & 4) ? boundsMax.z : boundsMin.z);
+            glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            if (clip.w < MIN_W) {
+                return true;
+            }
+            float inverseW = 1.0f / clip.w;
+            glm::vec2 screen((clip.x * inverseW * 0.5f + 0.5f) * m_width, (clip.y * inverseW * 0.5f + 0.5f) * m_height);
+            screenMin = glm::min(screenMin, screen);
+            screenMax = glm::max(screenMax, screen);
+            nearest = std::max(nearest, inverseW);
+        }
+        if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= m_width || screenMin.y >= m_height) {
+            return false;
+        }
+        screenMin = glm::max(screenMin, glm::vec2(0.0f));
+        screenMax = glm::min(screenMax, glm::vec2(static_cast<float>(m_width - 1), static_cast<float>(m_height - 1)));
+        for (int y = static_cast<int>(screenMin.y); y <= static_cast<int>(screenMax.y); y++) {
+            for (int x = static_cast<int>(screenMin.x); x <= static_cast<int>(screenMax.x); x++) {
+                if (nearest >= m_depth[static_cast<size_t>(y) * m_width + x]) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<float> m_depth;
+};
+
+struct Frame {
+    glm::mat4 viewProjection;
+    std::vector<uint32_t> occluders;    // 视锥内的遮挡物
+    std::vector<uint32_t> candidates;   // 视锥内的物体
+};
+
+RasterStats renderOccluders(OcclusionBuffer& buffer, const std::vector<Object>& objects, const Frame& frame, int implementation,
+                            unsigned int threads) {
+    std::vector<Occluder> occluders;
+    occluders.reserve(frame.occluders.size());
+    for (uint32_t index : frame.occluders) {
+        occluders.push_back({frame.viewProjection * objects[index].model, procedural_mesh::BOX_VERTICES.data(), BOX_STRIDE,
+                             procedural_mesh::BOX_SIZE.vertexCount, procedural_mesh::BOX_INDICES<uint32_t>.data(),
+                             procedural_mesh::BOX_SIZE.indexCount});
+    }
+    buffer.clear();
+    if (implementation == 0) {
+        return buffer.renderOccludersScalar(occluders.data(), occluders.size());
+    } else if (implementation == 1) {
+        return buffer.renderOccluders(occluders.data(), occluders.size());
+    }
+    return buffer.renderOccludersParallel(occluders.data(), occluders.size(), threads);
+}
+
+// 返回被遮挡的物体个数
+size_t testObjects(const OcclusionBuffer& buffer, const std::vector<Object>& objects, const Frame& frame, std::vector<char>& visible) {
+    size_t occluded = 0;
+    visible.assign(objects.size(), 0);
+    for (uint32_t index : frame.candidates) {
+        visible[index] = buffer.isVisible(frame.viewProjection, objects[index].boundsMin, objects[index].boundsMax);
+        occluded += !visible[index];
+    }
+    return occluded;
+}
+
+bool sameTiles(const OcclusionBuffer& a, const OcclusionBuffer& b) {
+    return std::memcmp(a.tiles().data(), b.tiles().data(), a.tiles().size() * sizeof(Tile)) == 0;
+}
+
+int main(int argc, char** argv) {
+    const int grid = std::max(2, getIntArgument(argc, argv, "--grid", 100));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 60));
+    const int width = std::max(TILE_WIDTH, getIntArgument(argc, argv, "--width", 512));
+    const int height = std::max(TILE_HEIGHT, getIntArgument(argc, argv, "--height", 256));
+    const unsigned int threads = static_cast<unsigned int>(
+        std::max(1, getIntArgument(argc, argv, "--threads", static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))));
+
+    std::vector<Object> objects = createCity(grid);
+    OcclusionBuffer buffer(width, height);
+    OcclusionBuffer scalarBuffer(width, height);
+    ReferenceDepthBuffer reference(buffer.width(), buffer.height());
+
+    BenchmarkReport report("masked_occlusion");
+    report.info()
+        .set("objects", objects.size())
+        .set("frames", frames)
+        .set("width", buffer.width())
+        .set("height", buffer.height())
+        .set("threads", static_cast<int>(threads))
+#if defined(SIMD_AVX2)
+        .set("simd", "avx2");
+#else
+        .set("simd", "none");
+#endif
+
+    const float aspect = static_cast<float>(buffer.width()) / static_cast<float>(buffer.height());
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), aspect, 0.1f, CELL_SIZE * grid * 1.5f);
+    std::vector<Frame> sequence(frames);
+    for (int i = 0; i < frames; i++) {
+        Frame& frame = sequence[i];
+        frame.viewProjection = projection * viewMatrix(i, frames, grid);
+        Frustum frustum = Frustum::fromMatrix(frame.viewProjection);
+        for (uint32_t index = 0; index < objects.size(); index++) {
+            const Object& object = objects[index];
+            if (frustum.intersectsBox((object.boundsMin + object.boundsMax) * 0.5f, (object.boundsMax - object.boundsMin) * 0.5f)) {
+                frame.candidates.push_back(index);
+                if (object.occluder) {
+                    frame.occluders.push_back(index);
+                }
+            }
+        }
+    }
+
+    // 光栅化
+    const char* implementations[] = {"scalar", "simd", "parallel"};
+    for (int implementation = 0; implementation < 3; implementation++) {
+        std::vector<double> samples;
+        RasterStats stats;
+        bool matchesScalar = true;
+        for (const Frame& frame : sequence) {
+            renderOccluders(scalarBuffer, objects, frame, 0, 1);
+            Timer timer;
+            stats = renderOccluders(buffer, objects, frame, implementation, threads);
+            samples.push_back(timer.elapsedMs());
+            matchesScalar = matchesScalar && sameTiles(buffer, scalarBuffer);
+        }
+        double ms = median(samples);
+        report.addRecord()
+            .set("stage", "rasterize")
+            .set("implementation", implementations[implementation])
+            .set("threads", implementation == 2 ? static_cast<int>(threads) : 1)
+            .set("triangles", stats.triangles)
+            .set("rasterized", stats.rasterized)
+            .set("ms", ms)
+            .set("triangles_per_ms", ms > 0.0 ? static_cast<double>(stats.rasterized) / ms : 0.0)
+            .set("matches_scalar", matchesScalar ? "true" : "false");
+    }
+
+    // 准确性
+    {
+        size_t tested = 0, occluded = 0, referenceOccluded = 0, falseOccluded = 0;
+        std::vector<double> testMs;
+        std::vector<char> visible;
+        for (const Frame& frame : sequence) {
+            renderOccluders(buffer, objects, frame, 1, 1);
+            Timer timer;
+            occluded += testObjects(buffer, objects, frame, visible);
+            testMs.push_back(timer.elapsedMs());
+            tested += frame.candidates.size();
+
+            reference.clear();
+            for (uint32_t index : frame.occluders) {
+                reference.renderBox(frame.viewProjection * objects[index].model);
+            }
+            for (uint32_t index : frame.candidates) {
+                bool referenceVisible = reference.isVisible(frame.viewProjection, objects[index].boundsMin, objects[index].boundsMax);
+                referenceOccluded += !referenceVisible;
+                falseOccluded += referenceVisible && !visible[index];
+            }
+        }
+        report.addRecord()
+            .set("stage", "accuracy")
+            .set("tested", tested / frames)
+            .set("occluded", occluded / frames)
+            .set("reference_occluded", referenceOccluded / frames)
+            .set("false_occluded", falseOccluded)
+            .set("accuracy", referenceOccluded > 0 ? static_cast<double>(occluded) / static_cast<double>(referenceOccluded) : 1.0)
+            .set("test_ms", median(testMs));
+    }
+
+    // 流水线：第 i 帧的“渲染”与第 i + 1 帧的遮挡剔除同时进行
+    {
+        auto cullFrame = [&](OcclusionBuffer& target, const Frame& frame, std::vector<char>& visible) {
+            renderOccluders(target, objects, frame, 1, 1);
+            return testObjects(target, objects, frame, visible);
+        };
+        auto renderFrame = [&](const Frame& frame, const std::vector<char>& visible) {
+            reference.clear();
+            for (uint32_t index : frame.candidates) {
+                if (visible[index]) {
+                    reference.renderBox(frame.viewProjection * objects[index].model);
+                }
+            }
+        };
+
+        std::vector<char> visible;
+        size_t serialOccluded = 0;
+        Timer serialTimer;
+        for (const Frame& frame : sequence) {
+            serialOccluded += cullFrame(buffer, frame, visible);
+            renderFrame(frame, visible);
+        }
+        double serialMs = serialTimer.elapsedMs() / frames;
+
+        // 两个缓冲交替使用，工作线程写一个时主线程读另一个的结果
+        OcclusionBuffer buffers[2] = {OcclusionBuffer(width, height), OcclusionBuffer(width, height)};
+        std::vector<char> visibleLists[2];
+        size_t pipelinedOccluded = 0;
+        Timer pipelinedTimer;
+        pipelinedOccluded += cullFrame(buffers[0], sequence[0], visibleLists[0]);
+        for (int i = 0; i < frames; i++) {
+            std::future<size_t> next;
+            if (i + 1 < frames) {
+                next = std::async(std::launch::async, [&, i]() {
+                    return cullFrame(buffers[(i + 1) % 2], sequence[i + 1], visibleLists[(i + 1) % 2]);
+                });
+            }
+            renderFrame(sequence[i], visibleLists[i % 2]);
+            if (next.valid()) {
+                pipelinedOccluded += next.get();
+            }
+        }
+        double pipelinedMs = pipelinedTimer.elapsedMs() / frames;
+        report.addRecord()
+            .set("stage", "pipeline")
+            .set("serial_frame_ms", serialMs)
+            .set("pipelined_frame_ms", pipelinedMs)
+            .set("matches_serial", serialOccluded == pipelinedOccluded ? "true" : "false");
+    }
+
+    report.write(argc, argv);
+    return 0;
+}
@@ -0,0 +1,162 @@
+// 程序化网格生成的基准测试（只使用CPU，不需要OpenGL上下文）
+// 对每种网格和细分参数，反复生成到同一块预先分配的缓冲中，统计：
+//  -- 每秒生成的网格数和顶点数（百万顶点每秒）
+//  -- 每次生成的堆分配次数（通过替换全局 operator new 统计）
+// box_legacy 是改造前 Box 的做法（每次生成都新建若干个 std::vector），作为对照
+// 用法：mesh_generation_benchmark [--out result.json] [--vertices N] [--iterations N]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "procedural_mesh.h"
+
+using namespace procedural_mesh;
+
+static std::atomic<size_t> g_allocationCount{0};
+
+void* operator new(size_t size) {
+    g_allocationCount++;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+// 改造前 Box 生成顶点的方式：角点、面、纹理坐标、法线都是临时的 std::vector
+std::vector<float> generateLegacyBox(const glm::vec3& extension) {
+    std::vector<glm::vec3> cornerPoints = {
+        { extension.x,  extension.y, extension.z}, {-extension.x,  extension.y, extension.z},
+        {-extension.x, -extension.y, extension.z}, { extension.x, -extension.y, extension.z},
+        { extension.x,  extension.y, -extension.z}, {-extension.x,  extension.y, -extension.z},
+        {-extension.x, -extension.y, -extension.z}, { extension.x, -extension.y, -extension.z},
+    };
+    std::vector<unsigned short> faceCorners = {0, 3, 7, 4, 1, 0, 4, 5, 2, 1, 5, 6, 3, 2, 6, 7, 1, 2, 3, 0, 4, 7, 6, 5};
+    std::vector<glm::vec2> textureCoord = {{1.0, 1.0}, {0.0, 1.0}, {0.0, 0.0}, {1.0, 0.0}};
+    std::vector<glm::vec3> normal = {{1, 0, 0}, {0, 1, 0}, {-1, 0, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+
+    std::vector<float> vertices;
+    int count = 0;
+    for (const auto& point : faceCorners) {
+        vertices.insert(vertices.end(), {cornerPoints[point].x, cornerPoints[point].y, cornerPoints[point].z});
+        vertices.insert(vertices.end(), {normal[count / 4].x, normal[count / 4].y, normal[count / 4].z});
+        vertices.insert(vertices.end(), {textureCoord[count % 4].x, textureCoord[count % 4].y});
+        count++;
+    }
+    return vertices;
+}
+
+struct Case {
+    std::string shape;
+    std::string parameters;
+    MeshSize size;
+    // 生成到调用者提供的 vertices / indices 中
+    std::function<void(float*, uint32_t*)> generate;
+};
+
+std::vector<Case> createCases() {
+    std::vector<Case> cases;
+    cases.push_back({"box_legacy", "", BOX_SIZE, [](float* vertices, uint32_t*) {
+        std::vector<float> data = generateLegacyBox(glm::vec3(1.0f, 2.0f, 3.0f));
+        std::copy(data.begin(), data.end(), vertices);
+    }});
+    cases.push_back({"box", "", BOX_SIZE, [](float* vertices, uint32_t* indices) {
+        generateBox(glm::vec3(1.0f, 2.0f, 3.0f), vertices, indices);
+    }});
+    for (uint32_t segments : {16u, 64u, 256u}) {
+        cases.push_back({"plane", std::to_string(segments) + "x" + std::to_string(segments), planeSize(segments, segments),
+                         [segments](float* vertices, uint32_t* indices) {
+                             generatePlane(10.0f, 10.0f, segments, segments, vertices, indices);
+                         }});
+    }
+    for (uint32_t segments : {16u, 64u, 256u}) {
+        cases.push_back({"uv_sphere", std::to_string(segments) + "x" + std::to_string(segments / 2), uvSphereSize(segments, segments / 2),
+                         [segments](float* vertices, uint32_t* indices) {
+                             generateUVSphere(1.0f, segments, segments / 2, vertices, indices);
+                         }});
+    }
+    for (uint32_t frequency : {1u, 4u, 16u, 64u}) {
+        cases.push_back({"icosphere", "frequency " + std::to_string(frequency), icosphereSize(frequency),
+                         [frequency](float* vertices, uint32_t* indices) {
+                             generateIcosphere(1.0f, frequency, vertices, indices);
+                         }});
+    }
+    for (uint32_t segments : {16u, 64u, 256u}) {
+        uint32_t stacks = segments / 8;
+        cases.push_back({"cylinder", std::to_string(segments) + "x" + std::to_string(stacks), cylinderSize(segments, stacks),
+                         [segments, stacks](float* vertices, uint32_t* indices) {
+                             generateCylinder(1.0f, 2.0f, segments, stacks, vertices, indices);
+                         }});
+    }
+    for (uint32_t segments : {16u, 64u, 256u}) {
+        cases.push_back({"torus", std::to_string(segments) + "x" + std::to_string(segments / 2), torusSize(segments, segments / 2),
+                         [segments](float* vertices, uint32_t* indices) {
+                             generateTorus(1.0f, 0.3f, segments, segments / 2, vertices, indices);
+                         }});
+    }
+    return cases;
+}
+
+int main(int argc, char** argv) {
+    // 每个样本大约生成这么多顶点，小网格会重复生成多次
+    const size_t targetVertices = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--vertices", 1 << 20)));
+    const int iterations = std::max(1, getIntArgument(argc, argv, "--iterations", 10));
+
+    std::vector<Case> cases = createCases();
+
+    BenchmarkReport report("mesh_generation");
+    report.info()
+        .set("target_vertices_per_sample", targetVertices)
+        .set("iterations", iterations);
+
+    double checksum = 0.0;
+    for (const auto& meshCase : cases) {
+        std::vector<float> vertices(static_cast<size_t>(meshCase.size.vertexCount) * FLOATS_PER_VERTEX);
+        std::vector<uint32_t> indices(meshCase.size.indexCount);
+        const size_t repeats = std::max<size_t>(1, targetVertices / meshCase.size.vertexCount);
+
+        // 预热一次，同时统计一次生成的分配次数
+        size_t allocationsBefore = g_allocationCount.load();
+        meshCase.generate(vertices.data(), indices.data());
+        size_t allocations = g_allocationCount.load() - allocationsBefore;
+
+        std::vector<double> samples;
+        for (int i = 0; i < iterations; i++) {
+            Timer timer;
+            for (size_t r = 0; r < repeats; r++) {
+                meshCase.generate(vertices.data(), indices.data());
+                checksum += vertices[r % vertices.size()];
+            }
+            samples.push_back(timer.elapsedMs());
+        }
+        double ms = median(samples);
+        double meshesPerSecond = ms > 0.0 ? repeats * 1000.0 / ms : 0.0;
+
+        report.addRecord()
+            .set("shape", meshCase.shape)
+            .set("parameters", meshCase.parameters)
+            .set("vertices", static_cast<size_t>(meshCase.size.vertexCount))
+            .set("indices", static_cast<size_t>(meshCase.size.indexCount))
+            .set("allocations_per_mesh", allocations)
+            .set("meshes_per_s", meshesPerSecond)
+            .set("mverts_per_s", meshesPerSecond * meshCase.size.vertexCount / 1e6);
+    }
+    report.info().set("checksum", checksum);
+
+    report.write(argc, argv);
+    return 0;
+}
@@ -0,0 +1,352 @@
+// 网格优化基准测试，对每个网格输出优化前后的指标：
+//  -- acmr / atvr : 16个顶点的FIFO缓存模拟，见 mesh_optimizer::analyzeVertexCache
+//  -- overdraw    : 开启背面剔除，从包围球外的8个方向渲染，通过的片段数 / 可见的像素数（用遮挡查询统计）
+//  -- optimize_ms : 单个网格的优化耗时
+// 三角形顺序分三种：input（模拟导入器输出的打乱顺序）、vertex_cache（只做顶点缓存优化）、full（完整流程）
+// 每个网格检查优化后的三角形是否是输入三角形的一个排列，包括第一个三角形退化的情况（triangles_preserved）
+// 最后分别用1个线程、多个线程和 JobSystem 优化所有网格，检查结果是否完全一致
+// 默认使用打乱了三角形和顶点顺序的程序化网格，也可以用 --model <file> 指定通过assimp导入的模型
+// 用法：mesh_optimization_benchmark [--out result.json] [--model file] [--threads N] [--threshold-percent N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "geometry_pool.h"
+#include "job_system.h"
+#include "mesh_optimizer.h"
+#include "model_loader.h"
+#include "procedural_mesh.h"
+#include "shader_program.h"
+
+const int VIEWPORT_SIZE = 512;
+
+struct TestMesh {
+    std::string name;
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+
+    uint32_t vertexCount() const {
+        return static_cast<uint32_t>(vertices.size() / procedural_mesh::FLOATS_PER_VERTEX);
+    }
+
+    mesh_optimizer::MeshView view() {
+        return {vertices.data(), vertexCount(), procedural_mesh::FLOATS_PER_VERTEX * sizeof(float), indices.data(), indices.size()};
+    }
+};
+
+// 每个三角形三个顶点的数据（按索引顺序）排序后的列表，优化只能改变三角形和顶点的顺序，不能改变这个列表
+std::vector<std::vector<float>> sortedTriangles(const TestMesh& mesh) {
+    const size_t floats = procedural_mesh::FLOATS_PER_VERTEX;
+    std::vector<std::vector<float>> triangles(mesh.indices.size() / 3);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        for (size_t k = 0; k < 3; k++) {
+            const float* vertex = mesh.vertices.data() + mesh.indices[t * 3 + k] * floats;
+            triangles[t].insert(triangles[t].end(), vertex, vertex + floats);
+        }
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// 第一个三角形退化（两个索引相同）时只做过度绘制优化，检查输出是否是输入三角形的排列
+// 退化的三角形在开头时不是硬边界，之前的实现会漏掉它之前的三角形
+bool overdrawKeepsDegenerateFirst(const TestMesh& cacheOptimized, float threshold) {
+    std::vector<uint32_t> input = cacheOptimized.indices;
+    input[2] = input[0];
+    std::vector<uint32_t> output(input.size(), ~0u);
+    mesh_optimizer::optimizeOverdraw(output.data(), input.data(), input.size(), cacheOptimized.vertices.data(),
+                                     cacheOptimized.vertexCount(), procedural_mesh::FLOATS_PER_VERTEX * sizeof(float), threshold);
+    auto triangles = [](const std::vector<uint32_t>& indices) {
+        std::vector<std::array<uint32_t, 3>> result(indices.size() / 3);
+        for (size_t t = 0; t < result.size(); t++) {
+            result[t] = {indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]};
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    return triangles(input) == triangles(output);
+}
+
+// 打乱三角形和顶点的顺序，模拟没有经过优化的导入结果
+void scramble(TestMesh& mesh, uint32_t seed) {
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+    const size_t triangleCount = mesh.indices.size() / 3;
+    for (size_t t = triangleCount - 1; t > 0; t--) {
+        size_t other = random() % (t + 1);
+        for (int k = 0; k < 3; k++) {
+            std::swap(mesh.indices[t * 3 + k], mesh.indices[other * 3 + k]);
+        }
+    }
+    const uint32_t vertexCount = mesh.vertexCount();
+    std::vector<uint32_t> remap(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        remap[v] = v;
+    }
+    for (uint32_t v = vertexCount - 1; v > 0; v--) {
+        std::swap(remap[v], remap[random() % (v + 1)]);
+    }
+    std::vector<float> vertices(mesh.vertices.size());
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        std::copy_n(&mesh.vertices[v * procedural_mesh::FLOATS_PER_VERTEX], procedural_mesh::FLOATS_PER_VERTEX,
+                    &vertices[remap[v] * procedural_mesh::FLOATS_PER_VERTEX]);
+    }
+    mesh.vertices.swap(vertices);
+    for (auto& index : mesh.indices) {
+        index = remap[index];
+    }
+}
+
+// 一串互相套在一起的圆环，自遮挡比较多，用于观察过度绘制优化的效果
+void generateTorusChain(uint32_t count, float* vertices, uint32_t* indices) {
+    const procedural_mesh::MeshSize size = procedural_mesh::torusSize(128, 64);
+    for (uint32_t i = 0; i < count; i++) {
+        float* meshVertices = vertices + static_cast<size_t>(i) * size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX;
+        procedural_mesh::generateTorus(1.0f, 0.3f, 128, 64, meshVertices, indices + static_cast<size_t>(i) * size.indexCount,
+                                       i * size.vertexCount);
+        // 相邻的圆环绕X轴相差90度，沿X轴错开一段距离
+        glm::mat3 rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(90.0f * i), glm::vec3(1.0f, 0.0f, 0.0f)));
+        for (uint32_t v = 0; v < size.vertexCount; v++) {
+            float* vertex = meshVertices + v * procedural_mesh::FLOATS_PER_VERTEX;
+            glm::vec3 position = rotation * glm::vec3(vertex[0], vertex[1], vertex[2]) + glm::vec3(1.4f * i, 0.0f, 0.0f);
+            glm::vec3 normal = rotation * glm::vec3(vertex[3], vertex[4], vertex[5]);
+            vertex[0] = position.x;
+            vertex[1] = position.y;
+            vertex[2] = position.z;
+            vertex[3] = normal.x;
+            vertex[4] = normal.y;
+            vertex[5] = normal.z;
+        }
+    }
+}
+
+template <typename Generator>
+TestMesh makeMesh(const std::string& name, procedural_mesh::MeshSize size, Generator&& generate) {
+    TestMesh mesh;
+    mesh.name = name;
+    mesh.vertices.resize(size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX);
+    mesh.indices.resize(size.indexCount);
+    generate(mesh.vertices.data(), mesh.indices.data());
+    scramble(mesh, static_cast<uint32_t>(size.indexCount));
+    return mesh;
+}
+
+std::vector<TestMesh> createProceduralMeshes() {
+    using namespace procedural_mesh;
+    std::vector<TestMesh> meshes;
+    meshes.push_back(makeMesh("icosphere_64", icosphereSize(64), [](float* v, uint32_t* i) { generateIcosphere(1.0f, 64, v, i); }));
+    meshes.push_back(makeMesh("uv_sphere_256x128", uvSphereSize(256, 128), [](float* v, uint32_t* i) { generateUVSphere(1.0f, 256, 128, v, i); }));
+    meshes.push_back(makeMesh("torus_256x128", torusSize(256, 128), [](float* v, uint32_t* i) { generateTorus(1.0f, 0.4f, 256, 128, v, i); }));
+    meshes.push_back(makeMesh("cylinder_256x64", cylinderSize(256, 64), [](float* v, uint32_t* i) { generateCylinder(0.5f, 2.0f, 256, 64, v, i); }));
+    const procedural_mesh::MeshSize torus = torusSize(128, 64);
+    meshes.push_back(makeMesh("torus_chain_8", {torus.vertexCount * 8, torus.indexCount * 8}, [](float* v, uint32_t* i) { generateTorusChain(8, v, i); }));
+    meshes.push_back(makeMesh("plane_256x256", planeSize(256, 256), [](float* v, uint32_t* i) { generatePlane(2.0f, 2.0f, 256, 256, v, i); }));
+    return meshes;
+}
+
+std::vector<TestMesh> loadModelMeshes(const std::string& path) {
+    std::vector<TestMesh> meshes;
+    Assimp::Importer importer;
+    std::shared_ptr<ModelData> model = importModel(path, importer);
+    if (!model) {
+        return meshes;
+    }
+    for (size_t i = 0; i < model->meshes().size(); i++) {
+        const ModelMesh& info = model->meshes()[i];
+        TestMesh mesh;
+        mesh.name = "mesh_" + std::to_string(i);
+        const float* vertices = model->meshVertices(info);
+        mesh.vertices.assign(vertices, vertices + static_cast<size_t>(info.vertexCount) * ModelData::FLOATS_PER_VERTEX);
+        mesh.indices.assign(model->meshIndices(info), model->meshIndices(info) + info.indexCount);
+        meshes.push_back(std::move(mesh));
+    }
+    return meshes;
+}
+
+// 先按给定的顺序开启深度测试绘制并统计通过的片段数，再用深度预渲染后的 GL_EQUAL 统计可见像素数
+class OverdrawAnalyzer {
+public:
+    OverdrawAnalyzer()
+        : m_program({
+              {ShaderProgram::ShaderType::VERTEX, "shaders/box_single.vert"},
+              {ShaderProgram::ShaderType::FRAGMENT, "shaders/box_color.frag"}
+          }) {
+        glGenQueries(1, &m_query);
+    }
+
+    ~OverdrawAnalyzer() {
+        glDeleteQueries(1, &m_query);
+    }
+
+    double measure(const TestMesh& mesh) {
+        GeometryPool pool(VertexFormat::positionNormalUV(), mesh.vertexCount(), static_cast<uint32_t>(mesh.indices.size()));
+        PoolMesh poolMesh = pool.allocate(mesh.vertices.data(), mesh.vertexCount(), mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()));
+
+        glm::vec3 minimum(mesh.vertices[0], mesh.vertices[1], mesh.vertices[2]);
+        glm::vec3 maximum = minimum;
+        for (size_t v = 0; v < mesh.vertexCount(); v++) {
+            glm::vec3 position(mesh.vertices[v * 8], mesh.vertices[v * 8 + 1], mesh.vertices[v * 8 + 2]);
+            minimum = glm::min(minimum, position);
+            maximum = glm::max(maximum, position);
+        }
+        glm::vec3 center = (minimum + maximum) * 0.5f;
+        float radius = glm::length(maximum - minimum) * 0.5f;
+
+        glViewport(0, 0, VIEWPORT_SIZE, VIEWPORT_SIZE);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        m_program.use();
+        m_program.setUniform("model", glm::mat4(1.0f));
+        m_program.setUniform("color", glm::vec4(1.0f));
+        m_program.setUniform("projection", glm::perspective(glm::radians(45.0f), 1.0f, radius * 0.1f, radius * 10.0f));
+        pool.bind();
+
+        uint64_t shaded = 0;
+        uint64_t visible = 0;
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 direction((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -0.5f, (i & 4) ? 1.0f : -1.0f);
+            glm::vec3 eye = center + glm::normalize(direction) * radius * 3.0f;
+            m_program.setUniform("view", glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+            glDepthFunc(GL_LESS);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            shaded += countSamples(pool, poolMesh);
+
+            glDepthFunc(GL_EQUAL);
+            visible += countSamples(pool, poolMesh);
+        }
+        glDepthFunc(GL_LESS);
+        glDisable(GL_CULL_FACE);
+        glBindVertexArray(0);
+        return visible > 0 ? static_cast<double>(shaded) / static_cast<double>(visible) : 0.0;
+    }
+
+private:
+    ShaderProgram m_program;
+    GLuint m_query = 0;
+
+    uint64_t countSamples(GeometryPool& pool, const PoolMesh& mesh) {
+        GLuint samples = 0;
+        glBeginQuery(GL_SAMPLES_PASSED, m_query);
+        pool.draw(mesh);
+        glEndQuery(GL_SAMPLES_PASSED);
+        glGetQueryObjectuiv(m_query, GL_QUERY_RESULT, &samples);
+        return samples;
+    }
+};
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(VIEWPORT_SIZE, VIEWPORT_SIZE);
+    if (window == nullptr) {
+        return 1;
+    }
+    const std::string modelPath = getStringArgument(argc, argv, "--model");
+    const unsigned int threads = static_cast<unsigned int>(std::max(1, getIntArgument(argc, argv, "--threads",
+                                                                                      static_cast<int>(std::max(2u, std::thread::hardware_concurrency())))));
+    const float threshold = static_cast<float>(getIntArgument(argc, argv, "--threshold-percent", 105)) / 100.0f;
+
+    std::vector<TestMesh> meshes = modelPath.empty() ? createProceduralMeshes() : loadModelMeshes(modelPath);
+    if (meshes.empty()) {
+        return 1;
+    }
+
+    BenchmarkReport report("mesh_optimization");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("source", modelPath.empty() ? std::string("procedural") : modelPath)
+        .set("overdraw_threshold", static_cast<double>(threshold))
+        .set("cache_size", 16);
+
+    OverdrawAnalyzer overdraw;
+    size_t totalTriangles = 0;
+    bool trianglesPreserved = true;
+    for (auto& mesh : meshes) {
+        const size_t triangleCount = mesh.indices.size() / 3;
+        totalTriangles += triangleCount;
+        mesh_optimizer::VertexCacheStats input = mesh_optimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+        double inputOverdraw = overdraw.measure(mesh);
+
+        TestMesh cacheOnly = mesh;
+        mesh_optimizer::optimizeMesh(cacheOnly.view(), 0.0f);
+        mesh_optimizer::VertexCacheStats cacheOnlyStats = mesh_optimizer::analyzeVertexCache(cacheOnly.indices.data(), cacheOnly.indices.size(), cacheOnly.vertexCount());
+        double cacheOnlyOverdraw = overdraw.measure(cacheOnly);
+
+        TestMesh full = mesh;
+        Timer timer;
+        mesh_optimizer::MeshOptimizationReport result = mesh_optimizer::optimizeMesh(full.view(), threshold);
+        double optimizeMs = timer.elapsedMs();
+        double fullOverdraw = overdraw.measure(full);
+        const std::vector<std::vector<float>> inputTriangles = sortedTriangles(mesh);
+        const bool preserved = sortedTriangles(cacheOnly) == inputTriangles && sortedTriangles(full) == inputTriangles &&
+                               overdrawKeepsDegenerateFirst(cacheOnly, threshold);
+        trianglesPreserved = trianglesPreserved && preserved;
+
+        report.addRecord()
+            .set("mesh", mesh.name)
+            .set("triangles", triangleCount)
+            .set("vertices", static_cast<size_t>(mesh.vertexCount()))
+            .set("input_acmr", static_cast<double>(input.acmr))
+            .set("input_atvr", static_cast<double>(input.atvr))
+            .set("input_overdraw", inputOverdraw)
+            .set("vertex_cache_acmr", static_cast<double>(cacheOnlyStats.acmr))
+            .set("vertex_cache_overdraw", cacheOnlyOverdraw)
+            .set("full_acmr", static_cast<double>(result.after.acmr))
+            .set("full_atvr", static_cast<double>(result.after.atvr))
+            .set("full_overdraw", fullOverdraw)
+            .set("optimize_ms", optimizeMs)
+            .set("triangles_preserved", preserved ? "true" : "false");
+    }
+
+    // 单线程和多线程的结果必须逐字节相同
+    std::vector<TestMesh> single = meshes;
+    std::vector<TestMesh> parallel = meshes;
+    std::vector<TestMesh> jobResults = meshes;
+    std::vector<mesh_optimizer::MeshView> singleViews, parallelViews, jobViews;
+    for (size_t i = 0; i < meshes.size(); i++) {
+        singleViews.push_back(single[i].view());
+        parallelViews.push_back(parallel[i].view());
+        jobViews.push_back(jobResults[i].view());
+    }
+    Timer singleTimer;
+    mesh_optimizer::optimizeMeshes(singleViews, threshold, 1);
+    double singleMs = singleTimer.elapsedMs();
+    Timer parallelTimer;
+    mesh_optimizer::optimizeMeshes(parallelViews, threshold, threads);
+    double parallelMs = parallelTimer.elapsedMs();
+    JobSystem jobs(threads);
+    Timer jobsTimer;
+    mesh_optimizer::optimizeMeshes(jobs, jobViews, threshold);
+    double jobsMs = jobsTimer.elapsedMs();
+    bool deterministic = true;
+    for (size_t i = 0; i < meshes.size(); i++) {
+        deterministic = deterministic && single[i].indices == parallel[i].indices && single[i].vertices == parallel[i].vertices;
+        deterministic = deterministic && single[i].indices == jobResults[i].indices && single[i].vertices == jobResults[i].vertices;
+    }
+
+    report.info()
+        .set("threads", static_cast<int>(threads))
+        .set("single_thread_ms", singleMs)
+        .set("multi_thread_ms", parallelMs)
+        .set("jobs_ms", jobsMs)
+        .set("single_thread_mtris_per_s", singleMs > 0.0 ? totalTriangles / (singleMs * 1000.0) : 0.0)
+        .set("deterministic", deterministic ? "true" : "false")
+        .set("triangles_preserved", trianglesPreserved ? "true" : "false");
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return deterministic && trianglesPreserved ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+// 网格簇剔除基准测试：几个很大的网格（高精度球和圆环），相机围绕场景旋转，部分物体在视野外
+//  -- build         : 构建簇的耗时、簇的个数、平均顶点数和三角形数
+//  -- whole_mesh    : 每个物体整体绘制
+//  -- cluster_scalar: 按簇剔除（标量实现），可见的簇通过 IndirectRenderer 一次提交
+//  -- cluster_simd  : 同上，使用SSE2实现
+// 剔除模式输出每帧平均测试、视锥剔除、背面剔除和可见的簇数，以及剔除耗时和帧时间
+// 同时检查SIMD和标量的剔除结果是否完全一致，以及最后一帧的画面和整体绘制是否相同
+// 用法：meshlet_culling_benchmark [--out result.json] [--frames N] [--frequency N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "frustum.h"
+#include "geometry_pool.h"
+#include "indirect_renderer.h"
+#include "meshlet.h"
+#include "procedural_mesh.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+
+struct ClusteredMesh {
+    std::string name;
+    PoolMesh mesh;
+    meshlet::MeshletMesh meshlets;
+    std::vector<float> vertices;
+};
+
+struct Object {
+    uint32_t mesh;
+    glm::mat4 model;
+    glm::mat4 inverseModel;
+    glm::vec4 color;
+};
+
+std::vector<unsigned char> readPixels() {
+    std::vector<unsigned char> pixels(static_cast<size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+double differentPixelRatio(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int tolerance) {
+    size_t different = 0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        for (int c = 0; c < 3; c++) {
+            if (std::abs(static_cast<int>(a[i + c]) - static_cast<int>(b[i + c])) > tolerance) {
+                different++;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(different) / static_cast<double>(a.size() / 4);
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+    if (!GLAD_GL_ARB_shader_draw_parameters) {
+        std::cerr << "GL_ARB_shader_draw_parameters is not supported" << std::endl;
+        return 1;
+    }
+
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 30));
+    const uint32_t frequency = static_cast<uint32_t>(std::max(4, getIntArgument(argc, argv, "--frequency", 96)));
+
+    BenchmarkReport report("meshlet_culling");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("frames", frames)
+#ifdef SIMD_SSE2
+        .set("simd", "sse2");
+#else
+        .set("simd", "none");
+#endif
+
+    // 生成网格并构建簇
+    GeometryPool pool(VertexFormat::positionNormalUV(), 1 << 20, 1 << 22);
+    std::vector<ClusteredMesh> meshes;
+    {
+        const procedural_mesh::MeshSize sphereSize = procedural_mesh::icosphereSize(frequency);
+        const procedural_mesh::MeshSize torusSize = procedural_mesh::torusSize(frequency * 4, frequency * 2);
+        std::vector<uint32_t> indices(std::max(sphereSize.indexCount, torusSize.indexCount));
+
+        meshes.push_back({"icosphere", {}, {}, std::vector<float>(sphereSize.vertexCount * procedural_mesh::FLOATS_PER_VERTEX)});
+        procedural_mesh::generateIcosphere(1.0f, frequency, meshes.back().vertices.data(), indices.data());
+        indices.resize(sphereSize.indexCount);
+        std::vector<std::vector<uint32_t>> sourceIndices = {indices};
+
+        indices.resize(torusSize.indexCount);
+        meshes.push_back({"torus", {}, {}, std::vector<float>(torusSize.vertexCount * procedural_mesh::FLOATS_PER_VERTEX)});
+        procedural_mesh::generateTorus(0.8f, 0.3f, frequency * 4, frequency * 2, meshes.back().vertices.data(), indices.data());
+        sourceIndices.push_back(indices);
+
+        for (size_t m = 0; m < meshes.size(); m++) {
+            ClusteredMesh& mesh = meshes[m];
+            const size_t vertexCount = mesh.vertices.size() / procedural_mesh::FLOATS_PER_VERTEX;
+            Timer timer;
+            mesh.meshlets = meshlet::buildMeshlets(mesh.vertices.data(), vertexCount, procedural_mesh::FLOATS_PER_VERTEX * sizeof(float),
+                                                   sourceIndices[m].data(), sourceIndices[m].size());
+            double buildMs = timer.elapsedMs();
+            mesh.mesh = pool.allocate(mesh.vertices.data(), static_cast<uint32_t>(vertexCount),
+                                      mesh.meshlets.indices.data(), static_cast<uint32_t>(mesh.meshlets.indices.size()));
+
+            size_t vertices = 0;
+            size_t backfaceCullable = 0;
+            for (size_t i = 0; i < mesh.meshlets.meshlets.size(); i++) {
+                vertices += mesh.meshlets.meshlets[i].vertexCount;
+                backfaceCullable += mesh.meshlets.bounds[i].coneCutoff < 1.0f;
+            }
+            const double count = static_cast<double>(mesh.meshlets.meshlets.size());
+            report.addRecord()
+                .set("stage", "build")
+                .set("mesh", mesh.name)
+                .set("triangles", sourceIndices[m].size() / 3)
+                .set("meshlets", mesh.meshlets.meshlets.size())
+                .set("average_triangles", static_cast<double>(sourceIndices[m].size() / 3) / count)
+                .set("average_vertices", static_cast<double>(vertices) / count)
+                .set("cone_cullable_ratio", static_cast<double>(backfaceCullable) / count)
+                .set("build_ms", buildMs);
+        }
+    }
+
+    std::vector<meshlet::ClusterBounds> clusterBounds;
+    for (const auto& mesh : meshes) {
+        clusterBounds.emplace_back(mesh.meshlets.bounds);
+    }
+
+    // 3x3 个物体，每个放大3倍
+    std::vector<Object> objects;
+    for (int z = -1; z <= 1; z++) {
+        for (int x = -1; x <= 1; x++) {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x * 8.0f, 0.0f, z * 8.0f));
+            model = glm::rotate(model, 0.7f * static_cast<float>(x + 3 * z), glm::vec3(1.0f, 0.5f, 0.0f));
+            model = glm::scale(model, glm::vec3(3.0f));
+            glm::vec4 color(0.4f + 0.15f * (x + 1), 0.5f, 0.4f + 0.15f * (z + 1), 1.0f);
+            objects.push_back({static_cast<uint32_t>((x + z + 2) % meshes.size()), model, glm::inverse(model), color});
+        }
+    }
+
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    using ShaderType = ShaderProgram::ShaderType;
+    ShaderProgram shaderProgram(
+        {
+            {ShaderType::VERTEX, "shaders/indirect_draw.vert"},
+            {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+        }
+    );
+    IndirectRenderer renderer;
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 200.0f);
+
+    // 相机在场景内部绕圈，每帧的视角不同
+    auto cameraPosition = [frames](int frame) {
+        float angle = 6.2831853f * static_cast<float>(frame) / static_cast<float>(frames);
+        return glm::vec3(std::cos(angle) * 12.0f, 6.0f, std::sin(angle) * 12.0f);
+    };
+
+    enum class Mode { WHOLE_MESH, CLUSTER_SCALAR, CLUSTER_SIMD };
+    const std::pair<Mode, const char*> modes[] = {
+        {Mode::WHOLE_MESH, "whole_mesh"}, {Mode::CLUSTER_SCALAR, "cluster_scalar"}, {Mode::CLUSTER_SIMD, "cluster_simd"}
+    };
+    size_t maxClusters = 0;
+    for (const auto& bounds : clusterBounds) {
+        maxClusters = std::max(maxClusters, bounds.count);
+    }
+    std::vector<uint32_t> visible(maxClusters);
+    std::vector<std::vector<uint32_t>> scalarVisible(frames);     // 每帧所有物体的可见簇，用于和SIMD对比
+    bool simdMatchesScalar = true;
+    std::vector<unsigned char> reference;
+
+    for (const auto& [mode, modeName] : modes) {
+        meshlet::ClusterCullStats totalStats;
+        size_t totalTriangles = 0;
+        size_t totalDraws = 0;
+        std::vector<double> cullMs;
+        std::vector<double> frameMs;
+        std::vector<double> gpuMs;
+        GpuTimer gpuTimer;
+        for (int frame = 0; frame < frames; frame++) {
+            glm::vec3 eye = cameraPosition(frame);
+            glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 viewProjection = projection * view;
+
+            Timer frameTimer;
+            gpuTimer.begin();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            shaderProgram.use();
+            shaderProgram.setUniform("view", view);
+            shaderProgram.setUniform("projection", projection);
+            shaderProgram.setUniform("tint", glm::vec4(1.0f));
+
+            Timer cullTimer;
+            renderer.begin();
+            std::vector<uint32_t> frameVisible;
+            for (const auto& object : objects) {
+                const ClusteredMesh& mesh = meshes[object.mesh];
+                if (mode == Mode::WHOLE_MESH) {
+                    renderer.add(pool, mesh.mesh, {object.model, object.color});
+                    totalTriangles += mesh.mesh.indexCount / 3;
+                    totalDraws++;
+                    continue;
+                }
+                Frustum frustum = Frustum::fromMatrix(viewProjection * object.model);
+                glm::vec3 localCamera = glm::vec3(object.inverseModel * glm::vec4(eye, 1.0f));
+                const meshlet::ClusterBounds& bounds = clusterBounds[object.mesh];
+                size_t count = mode == Mode::CLUSTER_SIMD ? meshlet::cullClusters(bounds, frustum, localCamera, visible.data(), totalStats)
+                                                          : meshlet::cullClustersScalar(bounds, frustum, localCamera, visible.data(), totalStats);
+                for (size_t i = 0; i < count; i++) {
+                    const meshlet::Meshlet& cluster = mesh.meshlets.meshlets[visible[i]];
+                    renderer.add(pool, meshlet::clusterMesh(mesh.mesh, cluster), {object.model, object.color});
+                    totalTriangles += cluster.indexCount / 3;
+                }
+                totalDraws += count;
+                frameVisible.insert(frameVisible.end(), visible.begin(), visible.begin() + count);
+            }
+            cullMs.push_back(cullTimer.elapsedMs());
+            renderer.submit();
+            gpuTimer.end();
+
+            glFinish();
+            frameMs.push_back(frameTimer.elapsedMs());
+            gpuMs.push_back(gpuTimer.resultMs());
+
+            if (mode == Mode::CLUSTER_SCALAR) {
+                scalarVisible[frame] = std::move(frameVisible);
+            } else if (mode == Mode::CLUSTER_SIMD) {
+                simdMatchesScalar = simdMatchesScalar && scalarVisible[frame] == frameVisible;
+            }
+        }
+
+        std::vector<unsigned char> pixels = readPixels();
+        if (reference.empty()) {
+            reference = pixels;
+        }
+        BenchmarkReport::Record& record = report.addRecord()
+            .set("stage", "render")
+            .set("mode", modeName)
+            .set("triangles_per_frame", totalTriangles / frames)
+            .set("draws_per_frame", totalDraws / frames);
+        if (mode != Mode::WHOLE_MESH) {
+            record
+                .set("clusters_tested", totalStats.tested / frames)
+                .set("frustum_culled", totalStats.frustumCulled / frames)
+                .set("backface_culled", totalStats.backfaceCulled / frames)
+                .set("visible", totalStats.visible / frames);
+        }
+        record
+            .set("cull_ms", median(cullMs))
+            .set("gpu_ms", median(gpuMs))
+            .set("frame_ms", median(frameMs))
+            .set("different_pixels", differentPixelRatio(reference, pixels, 16));
+    }
+    glDisable(GL_CULL_FACE);
+    report.info().set("simd_matches_scalar", simdMatchesScalar ? "true" : "false");
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
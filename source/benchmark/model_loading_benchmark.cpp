@@ -0,0 +1,164 @@
+// 模型加载基准测试，对比通过assimp导入和从二进制网格缓存加载：
+//  -- import        : assimp导入并转换为内部顶点格式（不使用缓存）
+//  -- cache_write   : 写入二进制缓存
+//  -- cache_load    : 映射缓存文件（不经过assimp），页面在上传时才真正从磁盘读入
+//  -- upload        : 分别从导入的数据和映射的缓存上传到 GeometryPool
+//  -- parallel      : 用 ModelLoader 同时导入多个模型文件，对比1个线程和多个线程
+// 测试用的模型是程序生成的OBJ文件（由多个UV球组成），写在系统临时目录中，结束后删除
+// 用法：model_loading_benchmark [--out result.json] [--meshes N] [--segments N] [--files N] [--iterations N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "geometry_pool.h"
+#include "model_loader.h"
+#include "procedural_mesh.h"
+
+// 写出由 meshCount 个UV球组成的OBJ文件，每个球是一个单独的对象
+void writeObjModel(const std::string& path, int meshCount, uint32_t segments) {
+    const procedural_mesh::MeshSize size = procedural_mesh::uvSphereSize(segments, segments / 2);
+    std::vector<float> vertices(size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX);
+    std::vector<uint32_t> indices(size.indexCount);
+
+    std::ofstream file(path);
+    char line[256];
+    uint32_t baseVertex = 1;
+    for (int mesh = 0; mesh < meshCount; mesh++) {
+        procedural_mesh::generateUVSphere(1.0f, segments, segments / 2, vertices.data(), indices.data());
+        file << "o sphere_" << mesh << "\n";
+        float offset = static_cast<float>(mesh) * 2.5f;
+        for (uint32_t i = 0; i < size.vertexCount; i++) {
+            const float* v = &vertices[i * procedural_mesh::FLOATS_PER_VERTEX];
+            std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvn %.6f %.6f %.6f\nvt %.6f %.6f\n",
+                          v[0] + offset, v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+            file << line;
+        }
+        for (uint32_t i = 0; i < size.indexCount; i += 3) {
+            uint32_t a = indices[i] + baseVertex, b = indices[i + 1] + baseVertex, c = indices[i + 2] + baseVertex;
+            std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+            file << line;
+        }
+        baseVertex += size.vertexCount;
+    }
+}
+
+template <typename Function>
+double measureMs(int iterations, Function&& function) {
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        Timer timer;
+        function();
+        samples.push_back(timer.elapsedMs());
+    }
+    return median(samples);
+}
+
+double measureUploadMs(int iterations, const ModelData& model) {
+    return measureMs(iterations, [&]() {
+        GeometryPool pool(VertexFormat::positionNormalUV(), model.vertexCount(), model.indexCount());
+        std::vector<PoolMesh> meshes = uploadModel(pool, model);
+        glFinish();
+    });
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext();
+    if (window == nullptr) {
+        return 1;
+    }
+
+    const int meshCount = std::max(1, getIntArgument(argc, argv, "--meshes", 64));
+    const uint32_t segments = static_cast<uint32_t>(std::max(4, getIntArgument(argc, argv, "--segments", 128)));
+    const int fileCount = std::max(1, getIntArgument(argc, argv, "--files", 4));
+    const int iterations = std::max(1, getIntArgument(argc, argv, "--iterations", 3));
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::vector<std::string> paths;
+    for (int i = 0; i < fileCount; i++) {
+        paths.push_back((directory / ("model_loading_benchmark_" + std::to_string(i) + ".obj")).string());
+        writeObjModel(paths.back(), meshCount, segments);
+    }
+    const std::string& path = paths.front();
+    const std::string cachePath = mesh_cache::cachePath(path);
+    const mesh_cache::SourceStamp stamp = mesh_cache::SourceStamp::of(path);
+
+    BenchmarkReport report("model_loading");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("iterations", iterations)
+        .set("source_bytes", static_cast<size_t>(stamp.size));
+
+    Assimp::Importer importer;
+    std::shared_ptr<ModelData> imported;
+    double importMs = measureMs(iterations, [&]() { imported = importModel(path, importer); });
+    if (!imported) {
+        return 1;
+    }
+    double writeMs = measureMs(iterations, [&]() { mesh_cache::write(cachePath, *imported, stamp); });
+    std::shared_ptr<ModelData> cached;
+    double loadMs = measureMs(iterations, [&]() { cached = mesh_cache::read(cachePath, stamp); });
+    if (!cached) {
+        return 1;
+    }
+    bool identical = cached->vertexCount() == imported->vertexCount() && cached->indexCount() == imported->indexCount() &&
+                     std::equal(imported->vertices(), imported->vertices() + imported->vertexCount() * ModelData::FLOATS_PER_VERTEX, cached->vertices()) &&
+                     std::equal(imported->indices(), imported->indices() + imported->indexCount(), cached->indices());
+
+    report.info()
+        .set("meshes", imported->meshes().size())
+        .set("vertices", static_cast<size_t>(imported->vertexCount()))
+        .set("indices", static_cast<size_t>(imported->indexCount()))
+        .set("cache_bytes", static_cast<size_t>(std::filesystem::file_size(cachePath)))
+        .set("cache_matches_import", identical ? "true" : "false");
+
+    report.addRecord().set("stage", "import").set("ms", importMs);
+    report.addRecord().set("stage", "cache_write").set("ms", writeMs);
+    report.addRecord().set("stage", "cache_load").set("ms", loadMs).set("speedup_vs_import", loadMs > 0.0 ? importMs / loadMs : 0.0);
+    report.addRecord().set("stage", "upload_imported").set("ms", measureUploadMs(iterations, *imported));
+    report.addRecord().set("stage", "upload_cached").set("ms", measureUploadMs(iterations, *cached));
+    imported.reset();
+    cached.reset();
+
+    // 多个模型文件同时导入
+    std::vector<unsigned int> threadCounts = {1u};
+    unsigned int maxThreads = std::min<unsigned int>(std::thread::hardware_concurrency(), fileCount);
+    if (maxThreads > 1) {
+        threadCounts.push_back(maxThreads);
+    }
+    for (unsigned int threads : threadCounts) {
+        double ms = measureMs(iterations, [&]() {
+            ModelLoader loader(threads);
+            loader.setCacheEnabled(false);
+            std::vector<std::future<std::shared_ptr<ModelData>>> futures;
+            for (const auto& file : paths) {
+                futures.push_back(loader.load(file));
+            }
+            for (auto& future : futures) {
+                future.get();
+            }
+        });
+        report.addRecord().set("stage", "parallel_import").set("files", paths.size()).set("threads", static_cast<int>(threads)).set("ms", ms);
+    }
+
+    for (const auto& file : paths) {
+        std::error_code error;
+        std::filesystem::remove(file, error);
+        std::filesystem::remove(mesh_cache::cachePath(file), error);
+    }
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,210 @@
+// 多重间接绘制基准测试，10k个互不相同的网格（每个物体一个独立尺寸的盒子），对比三种提交方式：
+//  -- per_object    : 每个物体一个 Box（各自的VAO），设置uniform后 draw()，与 imgui_draw_box.cpp 的方式相同
+//  -- pool_per_draw : 所有网格放在一个 GeometryPool 中，只绑定一次VAO，但仍然每个物体一次绘制调用
+//  -- indirect      : IndirectRenderer，每个状态桶一次 glMultiDrawElementsIndirect
+// 物体分为若干个状态桶（每个桶的tint不同），三种方式都按桶排序后提交
+// 用法：multi_draw_indirect_benchmark [--out result.json] [--count N] [--frames N] [--buckets N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "box.h"
+#include "geometry_pool.h"
+#include "indirect_renderer.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+
+struct Object {
+    glm::vec3 extension;
+    glm::mat4 model;
+    glm::vec4 color;
+    uint32_t bucket;
+};
+
+std::vector<Object> createObjects(size_t count, uint32_t buckets) {
+    std::vector<Object> objects;
+    objects.reserve(count);
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    uint32_t seed = 2024u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; i++) {
+        float x = static_cast<float>(i % side) - side * 0.5f;
+        float z = static_cast<float>(i / side) - side * 0.5f;
+        Object object;
+        object.extension = glm::vec3(0.1f + 0.35f * random(), 0.1f + 0.35f * random(), 0.1f + 0.35f * random());
+        object.model = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, z));
+        object.color = glm::vec4(random(), random(), random(), 1.0f);
+        object.bucket = static_cast<uint32_t>(i % buckets);
+        objects.push_back(object);
+    }
+    // 三种方式都按桶的顺序提交
+    std::stable_sort(objects.begin(), objects.end(), [](const Object& a, const Object& b) { return a.bucket < b.bucket; });
+    return objects;
+}
+
+glm::vec4 bucketTint(uint32_t bucket) {
+    float t = 0.6f + 0.4f * static_cast<float>(bucket % 4) / 3.0f;
+    return glm::vec4(t, t, t, 1.0f);
+}
+
+struct FrameStats {
+    std::vector<double> submitMs;
+    std::vector<double> gpuMs;
+    std::vector<double> frameMs;
+};
+
+template <typename DrawFunction>
+FrameStats runFrames(int frames, const ShaderProgram& shaderProgram, DrawFunction&& drawScene) {
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 1000.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 60.0f, 90.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    FrameStats stats;
+    GpuTimer gpuTimer;
+    for (int frame = 0; frame < frames; frame++) {
+        Timer frameTimer;
+        gpuTimer.begin();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shaderProgram.use();
+        shaderProgram.setUniform("view", view);
+        shaderProgram.setUniform("projection", projection);
+
+        Timer submitTimer;
+        drawScene();
+        stats.submitMs.push_back(submitTimer.elapsedMs());
+        gpuTimer.end();
+
+        glFinish();
+        stats.frameMs.push_back(frameTimer.elapsedMs());
+        stats.gpuMs.push_back(gpuTimer.resultMs());
+    }
+    return stats;
+}
+
+void addRecord(BenchmarkReport& report, const char* mode, size_t count, size_t drawCalls, const FrameStats& stats) {
+    report.addRecord()
+        .set("mode", mode)
+        .set("meshes", count)
+        .set("draw_calls", drawCalls)
+        .set("cpu_submit_ms", median(stats.submitMs))
+        .set("gpu_ms", median(stats.gpuMs))
+        .set("frame_ms", median(stats.frameMs));
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+    if (!GLAD_GL_ARB_shader_draw_parameters) {
+        std::cerr << "GL_ARB_shader_draw_parameters is not supported" << std::endl;
+        return 1;
+    }
+
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 10000)));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 100));
+    const uint32_t buckets = static_cast<uint32_t>(std::max(1, getIntArgument(argc, argv, "--buckets", 4)));
+    std::vector<Object> objects = createObjects(count, buckets);
+
+    BenchmarkReport report("multi_draw_indirect");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("frames", frames)
+        .set("buckets", static_cast<int>(buckets));
+
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    using ShaderType = ShaderProgram::ShaderType;
+    ShaderProgram singleProgram(
+        {
+            {ShaderType::VERTEX, "shaders/box_single.vert"},
+            {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+        }
+    );
+    ShaderProgram indirectProgram(
+        {
+            {ShaderType::VERTEX, "shaders/indirect_draw.vert"},
+            {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+        }
+    );
+
+    // per_object
+    {
+        std::vector<std::unique_ptr<Box>> boxes;
+        boxes.reserve(count);
+        for (const auto& object : objects) {
+            boxes.push_back(std::make_unique<Box>(glm::vec3(0.0f), object.extension));
+        }
+        FrameStats stats = runFrames(frames, singleProgram, [&]() {
+            for (size_t i = 0; i < count; i++) {
+                if (i == 0 || objects[i].bucket != objects[i - 1].bucket) {
+                    singleProgram.setUniform("tint", bucketTint(objects[i].bucket));
+                }
+                singleProgram.setUniform("model", objects[i].model);
+                singleProgram.setUniform("color", objects[i].color);
+                boxes[i]->draw();
+            }
+        });
+        addRecord(report, "per_object", count, count, stats);
+    }
+
+    GeometryPool pool(VertexFormat::positionNormalUV());
+    std::vector<PoolMesh> meshes;
+    meshes.reserve(count);
+    for (const auto& object : objects) {
+        meshes.push_back(Box::addToPool(pool, object.extension));
+    }
+
+    // pool_per_draw
+    {
+        FrameStats stats = runFrames(frames, singleProgram, [&]() {
+            pool.bind();
+            for (size_t i = 0; i < count; i++) {
+                if (i == 0 || objects[i].bucket != objects[i - 1].bucket) {
+                    singleProgram.setUniform("tint", bucketTint(objects[i].bucket));
+                }
+                singleProgram.setUniform("model", objects[i].model);
+                singleProgram.setUniform("color", objects[i].color);
+                pool.draw(meshes[i]);
+            }
+            glBindVertexArray(0);
+        });
+        addRecord(report, "pool_per_draw", count, count, stats);
+    }
+
+    // indirect
+    {
+        IndirectRenderer renderer;
+        FrameStats stats = runFrames(frames, indirectProgram, [&]() {
+            renderer.begin();
+            for (size_t i = 0; i < count; i++) {
+                renderer.add(pool, meshes[i], {objects[i].model, objects[i].color}, objects[i].bucket);
+            }
+            renderer.submit([&](uint32_t bucket) {
+                indirectProgram.setUniform("tint", bucketTint(bucket));
+            });
+        });
+        addRecord(report, "indirect", count, renderer.multiDrawCount(), stats);
+    }
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
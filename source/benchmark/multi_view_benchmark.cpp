@@ -0,0 +1,392 @@
+// 多视图渲染基准测试：随机分布的大量盒子（默认50k个），每帧在移动的位置绘制一张立方体贴图（6个视图）
+//  -- separate : 6次独立的绘制，每个面分别用 frustum_culling::cullSpheres 剔除、IndirectRenderer 记录并提交，
+//                绑定立方体贴图的一个面后清屏绘制
+//  -- per_view : MultiViewRenderer，6个视图共享一次剔除（合并相同的平面），每个面一次 glMultiDrawElementsIndirect
+//  -- single_pass : MultiViewRenderer，分层帧缓冲，所有面只需要一次清屏和一次 glMultiDrawElementsIndirect，
+//                   顶点着色器写入 gl_Layer（需要 GL_ARB_shader_viewport_layer_array）
+//  -- viewports_separate / viewports_single_pass : 同一个帧缓冲中的主视图和小地图（俯视图），
+//     两次绘制与视口数组 + gl_ViewportIndex 的一次绘制对比
+// 另外验证共享剔除的结果与每个视图分别剔除的结果一致（mask_mismatches）
+// 输出每帧CPU上的耗时（剔除 + 记录提交）、GPU时间、帧时间、glMultiDrawElementsIndirect 的次数、
+// 所有视图的可见物体数之和，以及最后一帧与 separate 的画面不同的像素比例（立方体贴图为6个面中最大的一个）
+// 用法：multi_view_benchmark [--out result.json] [--count N] [--frames N] [--size N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "box.h"
+#include "frustum_culling.h"
+#include "geometry_pool.h"
+#include "indirect_renderer.h"
+#include "multi_view.h"
+#include "shader_program.h"
+
+const int SCREEN_WIDTH = 1280;
+const int SCREEN_HEIGHT = 720;
+const int MINIMAP_SIZE = 320;
+const float WORLD_SIZE = 200.0f;
+const float CUBEMAP_FAR = 60.0f;
+const uint32_t MESH_COUNT = 16;
+
+struct Object {
+    uint32_t mesh;
+    glm::vec3 center;
+    float radius;
+    IndirectRenderer::DrawData data;
+};
+
+std::vector<Object> createObjects(size_t count, const std::vector<glm::vec3>& extensions) {
+    std::vector<Object> objects(count);
+    uint32_t seed = 46u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (auto& object : objects) {
+        object.mesh = static_cast<uint32_t>(random() * MESH_COUNT) % MESH_COUNT;
+        object.center = (glm::vec3(random(), random(), random()) - 0.5f) * WORLD_SIZE;
+        object.radius = glm::length(extensions[object.mesh]);
+        object.data.model = glm::translate(glm::mat4(1.0f), object.center);
+        object.data.color = glm::vec4(random(), random(), random(), 1.0f);
+    }
+    return objects;
+}
+
+double differentPixelRatio(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int tolerance) {
+    size_t different = 0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        for (int c = 0; c < 3; c++) {
+            if (std::abs(static_cast<int>(a[i + c]) - static_cast<int>(b[i + c])) > tolerance) {
+                different++;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(different) / static_cast<double>(a.size() / 4);
+}
+
+// 6个面依次排列
+std::vector<unsigned char> readCubemap(GLuint texture, int size) {
+    const size_t faceBytes = static_cast<size_t>(size) * size * 4;
+    std::vector<unsigned char> pixels(faceBytes * 6);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    for (int face = 0; face < 6; face++) {
+        glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data() + face * faceBytes);
+    }
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    return pixels;
+}
+
+double maxFaceDifference(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int size) {
+    const size_t faceBytes = static_cast<size_t>(size) * size * 4;
+    double result = 0.0;
+    for (int face = 0; face < 6; face++) {
+        std::vector<unsigned char> faceA(a.begin() + face * faceBytes, a.begin() + (face + 1) * faceBytes);
+        std::vector<unsigned char> faceB(b.begin() + face * faceBytes, b.begin() + (face + 1) * faceBytes);
+        result = std::max(result, differentPixelRatio(faceA, faceB, 16));
+    }
+    return result;
+}
+
+GLuint createCubemap(GLenum internalFormat, int size) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, internalFormat, size, size);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    return texture;
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (window == nullptr) {
+        return 1;
+    }
+    glfwSwapInterval(0);
+    if (!GLAD_GL_ARB_shader_draw_parameters) {
+        std::cerr << "GL_ARB_shader_draw_parameters is not supported" << std::endl;
+        return 1;
+    }
+
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 50000)));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 30));
+    const int size = std::max(16, getIntArgument(argc, argv, "--size", 512));
+    const bool singlePass = MultiViewRenderer::supportsSinglePass();
+
+    BenchmarkReport report("multi_view");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("objects", count)
+        .set("frames", frames)
+        .set("cubemap_size", size)
+        .set("single_pass", singlePass ? "true" : "false");
+
+    GeometryPool pool(VertexFormat::positionNormalUV());
+    std::vector<glm::vec3> extensions;
+    std::vector<PoolMesh> meshes;
+    for (uint32_t i = 0; i < MESH_COUNT; i++) {
+        float t = static_cast<float>(i) / MESH_COUNT;
+        extensions.push_back(glm::vec3(0.5f + 1.5f * t, 0.5f + 1.5f * (1.0f - t), 1.0f));
+        meshes.push_back(Box::addToPool(pool, extensions.back()));
+    }
+    std::vector<Object> objects = createObjects(count, extensions);
+    frustum_culling::SphereArrays spheres;
+    spheres.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        spheres.set(i, objects[i].center, objects[i].radius);
+    }
+
+    GLuint colorCubemap = createCubemap(GL_RGBA8, size);
+    GLuint depthCubemap = createCubemap(GL_DEPTH_COMPONENT24, size);
+    // faceFramebuffer 每次绑定一个面，layeredFramebuffer 绑定整个立方体贴图（gl_Layer 选择面）
+    GLuint faceFramebuffer, layeredFramebuffer;
+    glGenFramebuffers(1, &faceFramebuffer);
+    glGenFramebuffers(1, &layeredFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, layeredFramebuffer);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorCubemap, 0);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemap, 0);
+    bool layeredComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    auto bindFace = [&](uint32_t face) {
+        glBindFramebuffer(GL_FRAMEBUFFER, faceFramebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, colorCubemap, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, depthCubemap, 0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    };
+
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    using ShaderType = ShaderProgram::ShaderType;
+    ShaderProgram shaderProgram(
+        {
+            {ShaderType::VERTEX, "shaders/indirect_draw.vert"},
+            {ShaderType::FRAGMENT, "shaders/box_color.frag"}
+        }
+    );
+    IndirectRenderer renderer;
+    MultiViewRenderer multiView;
+
+    // 第 i 帧立方体贴图的中心沿圆周移动
+    auto probeCenter = [frames](int frame) {
+        float angle = 6.2831853f * static_cast<float>(frame) / static_cast<float>(frames);
+        return glm::vec3(40.0f * std::cos(angle), 5.0f * std::sin(2.0f * angle), 40.0f * std::sin(angle));
+    };
+
+    // 每个视图：CPU剔除，IndirectRenderer 记录并提交
+    std::vector<uint32_t> visible(spheres.paddedSize());
+    auto drawSeparate = [&](const MultiViewRenderer::View& view) {
+        Frustum frustum = Frustum::fromMatrix(view.projection * view.view);
+        size_t visibleCount = frustum_culling::cullSpheres(frustum, spheres, visible.data());
+        shaderProgram.use();
+        shaderProgram.setUniform("view", view.view);
+        shaderProgram.setUniform("projection", view.projection);
+        shaderProgram.setUniform("tint", glm::vec4(1.0f));
+        renderer.begin();
+        for (size_t i = 0; i < visibleCount; i++) {
+            const Object& object = objects[visible[i]];
+            renderer.add(pool, meshes[object.mesh], object.data);
+        }
+        renderer.submit();
+        return visibleCount;
+    };
+
+    // 共享的剔除：物体每帧重新记录，与 separate 相同
+    auto cullShared = [&](const std::vector<MultiViewRenderer::View>& views) {
+        multiView.setViews(views);
+        multiView.begin();
+        for (const Object& object : objects) {
+            multiView.add(meshes[object.mesh], object.data, object.center, object.radius);
+        }
+        multiView.cull();
+    };
+
+    // 验证：共享剔除得到的掩码与每个视图分别用 Frustum::intersectsSphere 测试的结果一致
+    // 立方体贴图的视图和下面的主视图 + 小地图都要检查
+    size_t maskMismatches = 0;
+    auto checkMasks = [&](const std::vector<MultiViewRenderer::View>& views) {
+        cullShared(views);
+        for (size_t i = 0; i < count; i++) {
+            for (uint32_t v = 0; v < multiView.viewCount(); v++) {
+                bool expected = multiView.frustum(v).intersectsSphere(objects[i].center, objects[i].radius);
+                if (expected != ((multiView.viewMask(i) >> v) & 1u)) {
+                    maskMismatches++;
+                }
+            }
+        }
+    };
+    for (int frame = 0; frame < frames; frame++) {
+        checkMasks(MultiViewRenderer::cubemapViews(probeCenter(frame), 0.1f, CUBEMAP_FAR, size));
+    }
+
+    // 立方体贴图
+    enum class Mode { SEPARATE, PER_VIEW, SINGLE_PASS };
+    const std::pair<Mode, const char*> modes[] = {
+        {Mode::SEPARATE, "separate"}, {Mode::PER_VIEW, "per_view"}, {Mode::SINGLE_PASS, "single_pass"}
+    };
+    std::vector<unsigned char> reference;
+    for (const auto& [mode, modeName] : modes) {
+        if (mode == Mode::SINGLE_PASS && !(singlePass && layeredComplete)) {
+            continue;
+        }
+        // 清除上一个模式的结果，保证比较的是这个模式绘制的画面
+        glClearTexImage(colorCubemap, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        std::vector<double> cpuMs;
+        std::vector<double> gpuMs;
+        std::vector<double> frameMs;
+        size_t totalVisible = 0;
+        size_t multiDraws = 0;
+        GpuTimer gpuTimer;
+        for (int frame = 0; frame < frames; frame++) {
+            std::vector<MultiViewRenderer::View> views = MultiViewRenderer::cubemapViews(probeCenter(frame), 0.1f, CUBEMAP_FAR, size);
+
+            Timer frameTimer;
+            gpuTimer.begin();
+            Timer cpuTimer;
+            if (mode == Mode::SEPARATE) {
+                glViewport(0, 0, size, size);
+                for (uint32_t face = 0; face < 6; face++) {
+                    bindFace(face);
+                    totalVisible += drawSeparate(views[face]);
+                }
+                multiDraws = 6;
+            } else {
+                cullShared(views);
+                if (mode == Mode::PER_VIEW) {
+                    multiView.submit(pool, MultiViewRenderer::Target::LAYERS, MultiViewRenderer::Pass::PER_VIEW, bindFace);
+                } else {
+                    glBindFramebuffer(GL_FRAMEBUFFER, layeredFramebuffer);
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    multiView.submit(pool, MultiViewRenderer::Target::LAYERS, MultiViewRenderer::Pass::SINGLE);
+                }
+                totalVisible += multiView.visiblePairCount();
+                multiDraws = multiView.multiDrawCount();
+            }
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            cpuMs.push_back(cpuTimer.elapsedMs());
+            gpuTimer.end();
+
+            glFinish();
+            frameMs.push_back(frameTimer.elapsedMs());
+            gpuMs.push_back(gpuTimer.resultMs());
+        }
+
+        std::vector<unsigned char> pixels = readCubemap(colorCubemap, size);
+        if (reference.empty()) {
+            reference = pixels;
+        }
+        report.addRecord()
+            .set("mode", modeName)
+            .set("views", 6)
+            .set("unique_planes", mode == Mode::SEPARATE ? 36 : multiView.uniquePlaneCount())
+            .set("visible", totalVisible / frames)
+            .set("multi_draws", multiDraws)
+            .set("cpu_ms", median(cpuMs))
+            .set("gpu_ms", median(gpuMs))
+            .set("frame_ms", median(frameMs))
+            .set("different_pixels", maxFaceDifference(reference, pixels, size));
+    }
+
+    // 主视图（左侧）和小地图（右上角的俯视图）绘制在同一个帧缓冲中
+    auto screenViews = [frames](int frame) {
+        float angle = 6.2831853f * static_cast<float>(frame) / static_cast<float>(frames);
+        glm::vec3 eye(0.0f, 10.0f, 0.0f);
+        const float mainWidth = static_cast<float>(SCREEN_WIDTH - MINIMAP_SIZE);
+        std::vector<MultiViewRenderer::View> views(2);
+        views[0].view = glm::lookAt(eye, eye + glm::vec3(std::cos(angle), -0.1f, std::sin(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+        views[0].projection = glm::perspective(glm::radians(60.0f), mainWidth / SCREEN_HEIGHT, 0.1f, WORLD_SIZE * 0.5f);
+        views[0].viewport = glm::vec4(0.0f, 0.0f, mainWidth, static_cast<float>(SCREEN_HEIGHT));
+        const float halfExtent = 40.0f;
+        views[1].view = glm::lookAt(eye + glm::vec3(0.0f, 100.0f, 0.0f), eye, glm::vec3(std::cos(angle), 0.0f, std::sin(angle)));
+        views[1].projection = glm::ortho(-halfExtent, halfExtent, -halfExtent, halfExtent, 0.1f, WORLD_SIZE);
+        views[1].viewport = glm::vec4(mainWidth, static_cast<float>(SCREEN_HEIGHT - MINIMAP_SIZE),
+                                      static_cast<float>(MINIMAP_SIZE), static_cast<float>(MINIMAP_SIZE));
+        return views;
+    };
+    for (int frame = 0; frame < frames; frame++) {
+        checkMasks(screenViews(frame));
+    }
+    report.info().set("mask_mismatches", maskMismatches);
+
+    std::vector<unsigned char> screenReference;
+    const std::pair<Mode, const char*> screenModes[] = {
+        {Mode::SEPARATE, "viewports_separate"}, {Mode::SINGLE_PASS, "viewports_single_pass"}
+    };
+    for (const auto& [mode, modeName] : screenModes) {
+        if (mode == Mode::SINGLE_PASS && !singlePass) {
+            continue;
+        }
+        std::vector<double> cpuMs;
+        std::vector<double> gpuMs;
+        std::vector<double> frameMs;
+        size_t totalVisible = 0;
+        size_t multiDraws = 0;
+        GpuTimer gpuTimer;
+        for (int frame = 0; frame < frames; frame++) {
+            std::vector<MultiViewRenderer::View> views = screenViews(frame);
+
+            Timer frameTimer;
+            gpuTimer.begin();
+            glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            Timer cpuTimer;
+            if (mode == Mode::SEPARATE) {
+                for (const auto& view : views) {
+                    glViewport(static_cast<GLint>(view.viewport.x), static_cast<GLint>(view.viewport.y),
+                               static_cast<GLsizei>(view.viewport.z), static_cast<GLsizei>(view.viewport.w));
+                    totalVisible += drawSeparate(view);
+                }
+                multiDraws = views.size();
+            } else {
+                cullShared(views);
+                multiView.submit(pool, MultiViewRenderer::Target::VIEWPORTS, MultiViewRenderer::Pass::SINGLE);
+                totalVisible += multiView.visiblePairCount();
+                multiDraws = multiView.multiDrawCount();
+            }
+            cpuMs.push_back(cpuTimer.elapsedMs());
+            gpuTimer.end();
+
+            glFinish();
+            frameMs.push_back(frameTimer.elapsedMs());
+            gpuMs.push_back(gpuTimer.resultMs());
+        }
+
+        std::vector<unsigned char> pixels(static_cast<size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        if (screenReference.empty()) {
+            screenReference = pixels;
+        }
+        report.addRecord()
+            .set("mode", modeName)
+            .set("views", 2)
+            .set("visible", totalVisible / frames)
+            .set("multi_draws", multiDraws)
+            .set("cpu_ms", median(cpuMs))
+            .set("gpu_ms", median(gpuMs))
+            .set("frame_ms", median(frameMs))
+            .set("different_pixels", differentPixelRatio(screenReference, pixels, 16));
+    }
+
+    report.write(argc, argv);
+
+    glDeleteFramebuffers(1, &faceFramebuffer);
+    glDeleteFramebuffers(1, &layeredFramebuffer);
+    glDeleteTextures(1, &colorCubemap);
+    glDeleteTextures(1, &depthCubemap);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,14 @@
+#version 450 core
+
+in vec3 Normal;
+in vec4 Color;
+
+out vec4 FragColor;
+
+const vec3 lightDir = normalize(vec3(0.3, 0.5, 0.8));
+
+void main()
+{
+    float diffuse = 0.3 + 0.7 * max(dot(normalize(Normal), lightDir), 0.0);
+    FragColor = vec4(Color.rgb * diffuse, Color.a);
+}
@@ -0,0 +1,22 @@
+#version 450 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+// 每个实例的数据
+layout (location = 3) in vec3 aCenter;
+layout (location = 4) in vec3 aExtension;
+layout (location = 5) in vec4 aColor;
+
+out vec3 Normal;
+out vec4 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * view * vec4(aPos * aExtension + aCenter, 1.0);
+    Normal = aNormal;
+    Color = aColor;
+}
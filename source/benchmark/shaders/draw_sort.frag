@@ -0,0 +1,22 @@
+#version 450 core
+
+in vec3 Normal;
+in vec4 Color;
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+layout (binding = 0) uniform sampler2D albedo;
+
+const vec3 lightDir = normalize(vec3(0.3, 0.5, 0.8));
+
+// 有意做一些额外的计算，使片段着色的开销能体现出 early-Z 的效果
+void main()
+{
+    vec3 texel = texture(albedo, TexCoord).rgb;
+    for (int i = 1; i < 8; i++) {
+        texel += texture(albedo, TexCoord * float(i + 1)).rgb * 0.05;
+    }
+    float diffuse = 0.3 + 0.7 * max(dot(normalize(Normal), lightDir), 0.0);
+    FragColor = vec4(Color.rgb * texel * diffuse, Color.a);
+}
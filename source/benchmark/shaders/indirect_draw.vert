@@ -0,0 +1,31 @@
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+};
+
+// 与 IndirectRenderer::DrawData 对应，下标为间接命令的 baseInstance
+layout (std430, binding = 0) readonly buffer DrawDataBuffer {
+    DrawData draws[];
+};
+
+out vec3 Normal;
+out vec4 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec4 tint;
+
+void main()
+{
+    DrawData draw = draws[gl_BaseInstanceARB];
+    gl_Position = projection * view * draw.model * vec4(aPos, 1.0);
+    Normal = mat3(draw.model) * aNormal;
+    Color = draw.color * tint;
+}
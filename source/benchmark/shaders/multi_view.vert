@@ -0,0 +1,43 @@
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+#extension GL_ARB_shader_viewport_layer_array : enable
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+};
+
+// 与 MultiViewRenderer 中的 binding 和布局一致
+layout (std430, binding = 0) readonly buffer DrawDataBuffer {
+    DrawData draws[];
+};
+
+// 每个实例对应一个 (绘制, 视图)，下标为 gl_BaseInstanceARB + gl_InstanceID
+layout (std430, binding = 4) readonly buffer InstanceBuffer {
+    uvec2 instances[];
+};
+
+layout (std430, binding = 5) readonly buffer ViewBuffer {
+    mat4 viewProjections[];
+};
+
+out vec3 Normal;
+out vec4 Color;
+
+void main()
+{
+    uvec2 instance = instances[gl_BaseInstanceARB + gl_InstanceID];
+    DrawData draw = draws[instance.x];
+    gl_Position = viewProjections[instance.y] * draw.model * vec4(aPos, 1.0);
+#ifdef GL_ARB_shader_viewport_layer_array
+    // 非分层的帧缓冲忽略 gl_Layer；所有视口相同时（glViewport）gl_ViewportIndex 不影响结果
+    gl_ViewportIndex = int(instance.y);
+    gl_Layer = int(instance.y);
+#endif
+    Normal = mat3(draw.model) * aNormal;
+    Color = draw.color;
+}
@@ -0,0 +1,302 @@
+// 空间索引基准测试（只使用CPU，不需要OpenGL上下文）：大量运动的AABB保存在 LooseGrid 中
+//  -- 物体在一个扁平的世界中匀速运动，碰到边界时反弹；少量大物体放入网格的单独列表
+//  -- build   : 插入所有物体的耗时
+//  -- update  : 每帧移动所有物体的耗时，以及换到其他格子的物体比例
+//  -- frustum : 视锥查询与 frustum_culling::cullBoxes（SoA，每帧需要重新填写数组）和逐个测试的耗时，结果是否一致
+//  -- sphere  : 球范围查询，与逐个测试的结果对比（只对比一部分查询）
+//  -- ray     : 从相机发出的射线查询最近的物体，与逐个测试的结果对比（只对比一部分查询）
+//  -- churn   : 删除并重新插入一部分物体的耗时
+// 用法：spatial_index_benchmark [--out result.json] [--objects N] [--frames N] [--queries N]
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "bvh.h"
+#include "frustum.h"
+#include "frustum_culling.h"
+#include "loose_grid.h"
+
+const float WORLD_SIZE = 2048.0f;
+const float WORLD_HEIGHT = 64.0f;
+const float GRID_CELL_SIZE = 8.0f;
+const float CAMERA_FAR = 512.0f;
+const float TIME_STEP = 1.0f / 60.0f;
+const int LARGE_OBJECT_INTERVAL = 1000;     // 每隔多少个物体有一个大物体
+const int VERIFY_QUERIES = 50;
+const float CHURN_RATIO = 0.1f;
+
+struct MovingObject {
+    glm::vec3 center;
+    glm::vec3 extent;
+    glm::vec3 velocity;
+};
+
+std::vector<MovingObject> createObjects(size_t count) {
+    std::vector<MovingObject> objects(count);
+    uint32_t seed = 42u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; i++) {
+        MovingObject& object = objects[i];
+        object.center = glm::vec3(random() * WORLD_SIZE, random() * WORLD_HEIGHT, random() * WORLD_SIZE);
+        object.extent = glm::vec3(0.25f + 1.5f * random(), 0.25f + 1.5f * random(), 0.25f + 1.5f * random());
+        if (i % LARGE_OBJECT_INTERVAL == 0) {
+            object.extent *= 10.0f;
+        }
+        object.velocity = (glm::vec3(random(), random() * 0.2f, random()) - glm::vec3(0.5f, 0.1f, 0.5f)) * 20.0f;
+    }
+    return objects;
+}
+
+Aabb boundsOf(const MovingObject& object) {
+    return {object.center - object.extent, object.center + object.extent};
+}
+
+void stepObjects(std::vector<MovingObject>& objects) {
+    const glm::vec3 worldMax(WORLD_SIZE, WORLD_HEIGHT, WORLD_SIZE);
+    for (MovingObject& object : objects) {
+        object.center += object.velocity * TIME_STEP;
+        for (int axis = 0; axis < 3; axis++) {
+            if (object.center[axis] < 0.0f || object.center[axis] > worldMax[axis]) {
+                object.velocity[axis] = -object.velocity[axis];
+                object.center[axis] = glm::clamp(object.center[axis], 0.0f, worldMax[axis]);
+            }
+        }
+    }
+}
+
+// 相机在世界中心附近绕圈，稍微向下看，远平面只覆盖世界的一部分
+void cameraMatrices(int frame, int frames, glm::mat4& view, glm::mat4& projection) {
+    float angle = 6.2831853f * static_cast<float>(frame) / static_cast<float>(frames);
+    glm::vec3 center(WORLD_SIZE * 0.5f, 0.0f, WORLD_SIZE * 0.5f);
+    glm::vec3 eye = center + glm::vec3(std::sin(angle) * WORLD_SIZE * 0.25f, WORLD_HEIGHT * 1.5f, std::cos(angle) * WORLD_SIZE * 0.25f);
+    glm::vec3 forward(std::cos(angle), -0.15f, -std::sin(angle));
+    view = glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+    projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.5f, CAMERA_FAR);
+}
+
+int main(int argc, char** argv) {
+    const size_t objectCount = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--objects", 1000000)));
+    const int frames = std::max(1, getIntArgument(argc, argv, "--frames", 30));
+    const int queries = std::max(VERIFY_QUERIES, getIntArgument(argc, argv, "--queries", 1000));
+
+    std::vector<MovingObject> objects = createObjects(objectCount);
+    LooseGrid grid({glm::vec3(0.0f), glm::vec3(WORLD_SIZE, WORLD_HEIGHT, WORLD_SIZE)}, GRID_CELL_SIZE);
+
+    BenchmarkReport report("spatial_index");
+    report.info()
+        .set("objects", objectCount)
+        .set("frames", frames)
+        .set("queries", queries)
+        .set("cells", grid.cellCount())
+        .set("cell_size", GRID_CELL_SIZE);
+
+    // build
+    std::vector<uint32_t> handles(objectCount);
+    {
+        Timer timer;
+        for (size_t i = 0; i < objectCount; i++) {
+            handles[i] = grid.insert(boundsOf(objects[i]));
+        }
+        report.addRecord()
+            .set("stage", "build")
+            .set("ms", timer.elapsedMs())
+            .set("oversized", grid.oversizedCount());
+    }
+    // 句柄 -> 物体下标，用于和逐个测试的结果对比
+    std::vector<uint32_t> objectOfHandle(objectCount);
+    for (size_t i = 0; i < objectCount; i++) {
+        objectOfHandle[handles[i]] = static_cast<uint32_t>(i);
+    }
+
+    // update / frustum：每帧移动所有物体后做一次视锥查询
+    std::vector<double> stepMs, moveMs, gridMs, soaMs, bruteMs;
+    size_t changedCells = 0;
+    size_t totalVisible = 0;
+    bool frustumMatches = true;
+    frustum_culling::BoxArrays boxArrays;
+    boxArrays.resize(objectCount);
+    std::vector<uint32_t> soaVisible(boxArrays.paddedSize());
+    std::vector<uint32_t> gridVisible;
+    std::vector<uint32_t> bruteVisible;
+    gridVisible.reserve(objectCount);
+    bruteVisible.reserve(objectCount);
+    for (int frame = 0; frame < frames; frame++) {
+        Timer stepTimer;
+        stepObjects(objects);
+        stepMs.push_back(stepTimer.elapsedMs());
+
+        Timer moveTimer;
+        for (size_t i = 0; i < objectCount; i++) {
+            changedCells += grid.move(handles[i], boundsOf(objects[i])) ? 1 : 0;
+        }
+        moveMs.push_back(moveTimer.elapsedMs());
+
+        glm::mat4 view, projection;
+        cameraMatrices(frame, frames, view, projection);
+        Frustum frustum = Frustum::fromMatrix(projection * view);
+
+        Timer gridTimer;
+        gridVisible.clear();
+        grid.queryFrustum(frustum, [&gridVisible](uint32_t handle) { gridVisible.push_back(handle); });
+        gridMs.push_back(gridTimer.elapsedMs());
+
+        Timer soaTimer;
+        for (size_t i = 0; i < objectCount; i++) {
+            Aabb bounds = boundsOf(objects[i]);
+            boxArrays.set(i, bounds.boundsMin, bounds.boundsMax);
+        }
+        frustum_culling::cullBoxes(frustum, boxArrays, soaVisible.data());
+        soaMs.push_back(soaTimer.elapsedMs());
+
+        Timer bruteTimer;
+        bruteVisible.clear();
+        for (size_t i = 0; i < objectCount; i++) {
+            if (frustum.intersectsBox(objects[i].center, objects[i].extent)) {
+                bruteVisible.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        bruteMs.push_back(bruteTimer.elapsedMs());
+
+        for (uint32_t& handle : gridVisible) {
+            handle = objectOfHandle[handle];
+        }
+        std::sort(gridVisible.begin(), gridVisible.end());
+        frustumMatches = frustumMatches && gridVisible == bruteVisible;
+        totalVisible += gridVisible.size();
+    }
+    report.addRecord()
+        .set("stage", "update")
+        .set("simulate_ms", median(stepMs))
+        .set("move_ms", median(moveMs))
+        .set("changed_cell_ratio", static_cast<double>(changedCells) / (static_cast<double>(objectCount) * frames));
+    report.addRecord()
+        .set("stage", "frustum")
+        .set("visible", totalVisible / frames)
+        .set("grid_ms", median(gridMs))
+        .set("soa_ms", median(soaMs))
+        .set("brute_force_ms", median(bruteMs))
+        .set("matches", frustumMatches);
+
+    uint32_t seed = 7u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+
+    // sphere
+    {
+        const float radius = 16.0f;
+        std::vector<glm::vec3> centers(queries);
+        for (glm::vec3& center : centers) {
+            center = glm::vec3(random() * WORLD_SIZE, random() * WORLD_HEIGHT, random() * WORLD_SIZE);
+        }
+        size_t found = 0;
+        Timer timer;
+        for (const glm::vec3& center : centers) {
+            grid.querySphere(center, radius, [&found](uint32_t) { found++; });
+        }
+        double gridMsPerQuery = timer.elapsedMs() / queries;
+
+        bool matches = true;
+        double bruteMsPerQuery = 0.0;
+        for (int q = 0; q < VERIFY_QUERIES; q++) {
+            std::vector<uint32_t> expected;
+            Timer bruteTimer;
+            for (size_t i = 0; i < objectCount; i++) {
+                glm::vec3 offset = glm::clamp(centers[q], objects[i].center - objects[i].extent, objects[i].center + objects[i].extent) - centers[q];
+                if (glm::dot(offset, offset) <= radius * radius) {
+                    expected.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            bruteMsPerQuery += bruteTimer.elapsedMs() / VERIFY_QUERIES;
+            std::vector<uint32_t> actual;
+            grid.querySphere(centers[q], radius, [&](uint32_t handle) { actual.push_back(objectOfHandle[handle]); });
+            std::sort(actual.begin(), actual.end());
+            matches = matches && actual == expected;
+        }
+        report.addRecord()
+            .set("stage", "sphere")
+            .set("radius", radius)
+            .set("found", found / queries)
+            .set("grid_ms", gridMsPerQuery)
+            .set("brute_force_ms", bruteMsPerQuery)
+            .set("matches", matches);
+    }
+
+    // ray：最后一帧的相机，屏幕上随机的点
+    {
+        glm::mat4 view, projection;
+        cameraMatrices(frames - 1, frames, view, projection);
+        std::vector<Ray> rays(queries);
+        for (Ray& ray : rays) {
+            ray = Ray::fromScreen(random() * 1600.0f, random() * 900.0f, 1600.0f, 900.0f, view, projection);
+        }
+        size_t hits = 0;
+        Timer timer;
+        for (const Ray& ray : rays) {
+            hits += grid.raycast(ray).valid() ? 1 : 0;
+        }
+        double gridMsPerQuery = timer.elapsedMs() / queries;
+
+        bool matches = true;
+        double bruteMsPerQuery = 0.0;
+        for (int q = 0; q < VERIFY_QUERIES; q++) {
+            const Ray& ray = rays[q];
+            const glm::vec3 inverseDirection = 1.0f / ray.direction;
+            RayHit expected;
+            Timer bruteTimer;
+            for (size_t i = 0; i < objectCount; i++) {
+                Aabb bounds = boundsOf(objects[i]);
+                float t = intersectAabb(ray.origin, inverseDirection, bounds.boundsMin, bounds.boundsMax, expected.t);
+                if (t < expected.t) {
+                    expected.t = t;
+                    expected.primitive = static_cast<uint32_t>(i);
+                }
+            }
+            bruteMsPerQuery += bruteTimer.elapsedMs() / VERIFY_QUERIES;
+            RayHit actual = grid.raycast(ray);
+            // 距离相同的物体可能返回其中任意一个，只比较t
+            matches = matches && actual.valid() == expected.valid() && actual.t == expected.t;
+        }
+        report.addRecord()
+            .set("stage", "ray")
+            .set("hit_ratio", static_cast<double>(hits) / queries)
+            .set("grid_ms", gridMsPerQuery)
+            .set("brute_force_ms", bruteMsPerQuery)
+            .set("matches", matches);
+    }
+
+    // churn：删除一部分物体后重新插入（句柄被重复使用）
+    {
+        const size_t churnCount = static_cast<size_t>(objectCount * CHURN_RATIO);
+        Timer removeTimer;
+        for (size_t i = 0; i < churnCount; i++) {
+            grid.remove(handles[i]);
+        }
+        double removeMs = removeTimer.elapsedMs();
+        Timer insertTimer;
+        for (size_t i = 0; i < churnCount; i++) {
+            handles[i] = grid.insert(boundsOf(objects[i]));
+        }
+        double insertMs = insertTimer.elapsedMs();
+        report.addRecord()
+            .set("stage", "churn")
+            .set("objects", churnCount)
+            .set("remove_ms", removeMs)
+            .set("insert_ms", insertMs)
+            .set("size_matches", grid.size() == objectCount);
+    }
+
+    report.write(argc, argv);
+    return 0;
+}
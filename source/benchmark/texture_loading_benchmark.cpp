@@ -0,0 +1,200 @@
+// 纹理解码/上传基准测试
+// 在不可见的OpenGL上下文中，对不同尺寸和格式（JPEG、PNG、HDR、KTX2）的图像分别统计：
+//  -- decode_ms  : 从内存解码的时间
+//  -- upload_ms  : glTexImage2D 上传并等待完成(glFinish)的时间
+//  -- mipmap_ms  : glGenerateMipmap 的时间
+//  -- rss_delta_bytes : 每次迭代中解码、上传和生成mipmap之后常驻内存相对迭代开始时的最大增长
+//                       （进程的峰值常驻内存只在报告中输出一次）
+// 测试图像在内存中程序化生成并编码，不依赖assets目录
+// 用法：texture_loading_benchmark [--out result.json] [--iterations N]
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "textures_loader.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+enum class ImageFormat {
+    JPEG,
+    PNG,
+    HDR,
+    KTX2,
+};
+
+const char* formatName(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::JPEG: return "jpeg";
+        case ImageFormat::PNG:  return "png";
+        case ImageFormat::HDR:  return "hdr";
+        case ImageFormat::KTX2: return "ktx2";
+    }
+    return "unknown";
+}
+
+// 生成带有渐变和噪声的RGB图像，避免被编码器压缩成过于理想的情况
+std::vector<float> generatePixels(int size) {
+    std::vector<float> pixels(static_cast<size_t>(size) * size * 3);
+    uint32_t seed = 12345u;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            seed = seed * 1664525u + 1013904223u;
+            float noise = static_cast<float>(seed >> 24) / 255.0f * 0.2f;
+            float u = static_cast<float>(x) / size;
+            float v = static_cast<float>(y) / size;
+            float* pixel = &pixels[(static_cast<size_t>(y) * size + x) * 3];
+            pixel[0] = std::min(1.0f, u + noise);
+            pixel[1] = std::min(1.0f, v + noise);
+            pixel[2] = std::min(1.0f, 0.5f + 0.5f * std::sin(10.0f * (u + v)) * 0.8f + noise);
+        }
+    }
+    return pixels;
+}
+
+void appendToBuffer(void* context, void* data, int size) {
+    auto* buffer = static_cast<std::vector<unsigned char>*>(context);
+    auto* bytes = static_cast<unsigned char*>(data);
+    buffer->insert(buffer->end(), bytes, bytes + size);
+}
+
+// 写出只包含一个层级、未压缩的RGBA8 KTX2文件
+// 读取端不使用数据格式描述符(DFD)，这里省略以保持简单
+std::vector<unsigned char> encodeKtx2(const std::vector<unsigned char>& rgb, int size) {
+    std::vector<unsigned char> rgba(static_cast<size_t>(size) * size * 4);
+    for (size_t i = 0; i < static_cast<size_t>(size) * size; i++) {
+        rgba[i * 4 + 0] = rgb[i * 3 + 0];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+
+    ktx2::Header header = {};
+    header.vkFormat = ktx2::R8G8B8A8_UNORM;
+    header.typeSize = 1;
+    header.pixelWidth = size;
+    header.pixelHeight = size;
+    header.faceCount = 1;
+    header.levelCount = 1;
+
+    ktx2::LevelIndex level = {};
+    level.byteOffset = sizeof(ktx2::IDENTIFIER) + sizeof(ktx2::Header) + sizeof(ktx2::LevelIndex);
+    level.byteLength = rgba.size();
+    level.uncompressedByteLength = rgba.size();
+
+    std::vector<unsigned char> file(static_cast<size_t>(level.byteOffset));
+    std::memcpy(file.data(), ktx2::IDENTIFIER, sizeof(ktx2::IDENTIFIER));
+    std::memcpy(file.data() + sizeof(ktx2::IDENTIFIER), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(ktx2::IDENTIFIER) + sizeof(header), &level, sizeof(level));
+    file.insert(file.end(), rgba.begin(), rgba.end());
+    return file;
+}
+
+std::vector<unsigned char> encodeImage(const std::vector<float>& pixels, int size, ImageFormat format) {
+    std::vector<unsigned char> encoded;
+    if (format == ImageFormat::HDR) {
+        stbi_write_hdr_to_func(appendToBuffer, &encoded, size, size, 3, pixels.data());
+        return encoded;
+    }
+
+    std::vector<unsigned char> ldr(pixels.size());
+    for (size_t i = 0; i < pixels.size(); i++) {
+        ldr[i] = static_cast<unsigned char>(pixels[i] * 255.0f + 0.5f);
+    }
+    if (format == ImageFormat::JPEG) {
+        stbi_write_jpg_to_func(appendToBuffer, &encoded, size, size, 3, ldr.data(), 90);
+    } else if (format == ImageFormat::PNG) {
+        stbi_write_png_to_func(appendToBuffer, &encoded, size, size, 3, ldr.data(), size * 3);
+    } else {
+        encoded = encodeKtx2(ldr, size);
+    }
+    return encoded;
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createHeadlessContext();
+    if (window == nullptr) {
+        return 1;
+    }
+
+    const int iterations = std::max(1, getIntArgument(argc, argv, "--iterations", 5));
+    const int sizes[] = {256, 512, 1024, 2048, 4096};
+    const ImageFormat formats[] = {ImageFormat::JPEG, ImageFormat::PNG, ImageFormat::HDR, ImageFormat::KTX2};
+
+    BenchmarkReport report("texture_loading");
+    report.info()
+        .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+        .set("iterations", iterations);
+
+    for (int size : sizes) {
+        std::vector<float> pixels = generatePixels(size);
+        for (ImageFormat format : formats) {
+            std::vector<unsigned char> encoded = encodeImage(pixels, size, format);
+            std::vector<double> decodeSamples, uploadSamples, mipmapSamples;
+            size_t rssDelta = 0;
+
+            for (int i = 0; i < iterations; i++) {
+                const size_t rssBefore = getCurrentRSS();
+                auto sampleRss = [&]() {
+                    const size_t rss = getCurrentRSS();
+                    rssDelta = std::max(rssDelta, rss > rssBefore ? rss - rssBefore : 0);
+                };
+                Timer timer;
+                TextureImage image = decodeTextureFromMemory(encoded.data(), encoded.size());
+                decodeSamples.push_back(timer.elapsedMs());
+                sampleRss();
+                if (!image) {
+                    std::cerr << "Failed to decode " << formatName(format) << " " << size << std::endl;
+                    break;
+                }
+
+                GLuint texture;
+                glGenTextures(1, &texture);
+                glBindTexture(GL_TEXTURE_2D, texture);
+                glFinish();
+
+                timer.reset();
+                uploadTextureImage(image);
+                glFinish();
+                uploadSamples.push_back(timer.elapsedMs());
+                sampleRss();
+
+                timer.reset();
+                glGenerateMipmap(GL_TEXTURE_2D);
+                glFinish();
+                mipmapSamples.push_back(timer.elapsedMs());
+                sampleRss();
+
+                glDeleteTextures(1, &texture);
+            }
+            if (decodeSamples.size() != uploadSamples.size() || uploadSamples.empty()) {
+                continue;
+            }
+
+            report.addRecord()
+                .set("format", formatName(format))
+                .set("width", size)
+                .set("height", size)
+                .set("encoded_bytes", encoded.size())
+                .set("decode_ms", median(decodeSamples))
+                .set("upload_ms", median(uploadSamples))
+                .set("mipmap_ms", median(mipmapSamples))
+                .set("rss_delta_bytes", rssDelta);
+        }
+    }
+
+    report.write(argc, argv);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
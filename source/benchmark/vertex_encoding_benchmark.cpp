@@ -0,0 +1,181 @@
+// 紧凑顶点格式的编码基准测试（只使用CPU，不需要OpenGL上下文）
+// 对随机生成的顶点分别统计位置量化、法线10_10_10_2打包、纹理坐标半精度转换：
+//  -- scalar/simd 两种实现的吞吐量（百万顶点每秒）以及两者结果是否一致
+//  -- 解码后的最大误差和平均误差（位置误差相对于包围盒尺寸）
+//  -- 标准布局和紧凑布局的每顶点字节数
+// 用法：vertex_encoding_benchmark [--out result.json] [--count N] [--iterations N]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "vertex_encoding.h"
+#include "vertex_format.h"
+
+using namespace vertex_encoding;
+
+// 生成 StandardVertexLayout 格式的随机顶点，法线为单位向量
+std::vector<float> generateVertices(size_t count) {
+    std::vector<float> vertices(count * 8);
+    uint32_t seed = 7u;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; i++) {
+        float* v = &vertices[i * 8];
+        v[0] = random() * 20.0f - 10.0f;
+        v[1] = random() * 5.0f;
+        v[2] = random() * 40.0f - 20.0f;
+        glm::vec3 normal = glm::normalize(glm::vec3(random() - 0.5f, random() - 0.5f, random() - 0.5f) + glm::vec3(1e-4f));
+        v[3] = normal.x;
+        v[4] = normal.y;
+        v[5] = normal.z;
+        v[6] = random() * 4.0f - 1.0f;
+        v[7] = random();
+    }
+    return vertices;
+}
+
+struct ErrorStats {
+    double maxError = 0.0;
+    double sumError = 0.0;
+    size_t count = 0;
+
+    void add(double error) {
+        maxError = std::max(maxError, error);
+        sumError += error;
+        count++;
+    }
+
+    double mean() const {
+        return count > 0 ? sumError / count : 0.0;
+    }
+};
+
+template <typename Function>
+double measureMegaVerticesPerSecond(size_t count, int iterations, Function&& encode) {
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        Timer timer;
+        encode();
+        samples.push_back(timer.elapsedMs());
+    }
+    double ms = median(samples);
+    return ms > 0.0 ? static_cast<double>(count) / (ms * 1000.0) : 0.0;
+}
+
+void addRecord(BenchmarkReport& report, const char* attribute, const char* encoding, double scalarRate, double simdRate,
+               bool identical, const ErrorStats& error) {
+    report.addRecord()
+        .set("attribute", attribute)
+        .set("encoding", encoding)
+        .set("scalar_mverts_per_s", scalarRate)
+        .set("simd_mverts_per_s", simdRate)
+        .set("simd_matches_scalar", identical ? "true" : "false")
+        .set("max_error", error.maxError)
+        .set("mean_error", error.mean());
+}
+
+int main(int argc, char** argv) {
+    const size_t count = static_cast<size_t>(std::max(1, getIntArgument(argc, argv, "--count", 1 << 20)));
+    const int iterations = std::max(1, getIntArgument(argc, argv, "--iterations", 10));
+    const size_t stride = StandardVertexLayout::stride;
+
+    std::vector<float> vertices = generateVertices(count);
+    QuantizationBounds bounds = QuantizationBounds::compute(vertices.data(), count, stride);
+
+    BenchmarkReport report("vertex_encoding");
+    report.info()
+        .set("vertices", count)
+        .set("iterations", iterations)
+#if defined(SIMD_F16C)
+        .set("simd", "sse2+f16c")
+#elif defined(SIMD_SSE2)
+        .set("simd", "sse2")
+#else
+        .set("simd", "none")
+#endif
+        .set("standard_bytes_per_vertex", static_cast<int>(StandardVertexLayout::stride))
+        .set("compact_bytes_per_vertex", static_cast<int>(CompactVertexLayout::stride))
+        .set("bandwidth_reduction", static_cast<double>(StandardVertexLayout::stride) / CompactVertexLayout::stride);
+
+    std::vector<CompactVertex> scalarResult(count), simdResult(count);
+    const size_t dstStride = sizeof(CompactVertex);
+
+    // 位置
+    {
+        double scalarRate = measureMegaVerticesPerSecond(count, iterations, [&]() {
+            encodePositionsScalar(vertices.data(), stride, count, bounds, scalarResult[0].position, dstStride);
+        });
+        double simdRate = measureMegaVerticesPerSecond(count, iterations, [&]() {
+            encodePositions(vertices.data(), stride, count, bounds, simdResult[0].position, dstStride);
+        });
+        bool identical = true;
+        ErrorStats error;
+        float size = std::max(bounds.extent.x, std::max(bounds.extent.y, bounds.extent.z));
+        for (size_t i = 0; i < count; i++) {
+            identical = identical && std::memcmp(scalarResult[i].position, simdResult[i].position, sizeof(simdResult[i].position)) == 0;
+            glm::vec3 decoded = bounds.dequantize(simdResult[i].position);
+            error.add(glm::length(decoded - glm::vec3(vertices[i * 8], vertices[i * 8 + 1], vertices[i * 8 + 2])) / size);
+        }
+        addRecord(report, "position", "unorm16x4", scalarRate, simdRate, identical, error);
+    }
+
+    // 法线
+    {
+        double scalarRate = measureMegaVerticesPerSecond(count, iterations, [&]() {
+            encodeNormalsScalar(vertices.data() + 3, stride, count, false, &scalarResult[0].normal, dstStride);
+        });
+        double simdRate = measureMegaVerticesPerSecond(count, iterations, [&]() {
+            encodeNormals(vertices.data() + 3, stride, count, false, &simdResult[0].normal, dstStride);
+        });
+        bool identical = true;
+        ErrorStats error;
+        for (size_t i = 0; i < count; i++) {
+            identical = identical && scalarResult[i].normal == simdResult[i].normal;
+            glm::vec3 decoded = glm::vec3(unpackSnorm1010102(simdResult[i].normal));
+            glm::vec3 original(vertices[i * 8 + 3], vertices[i * 8 + 4], vertices[i * 8 + 5]);
+            // 以角度误差（度）衡量法线的精度
+            float cosine = glm::clamp(glm::dot(glm::normalize(decoded), original), -1.0f, 1.0f);
+            error.add(glm::degrees(std::acos(cosine)));
+        }
+        addRecord(report, "normal", "snorm_10_10_10_2 (degrees)", scalarRate, simdRate, identical, error);
+    }
+
+    // 纹理坐标
+    {
+        double scalarRate = measureMegaVerticesPerSecond(count, iterations, [&]() {
+            encodeHalf2Scalar(vertices.data() + 6, stride, count, scalarResult[0].uv, dstStride);
+        });
+        double simdRate = measureMegaVerticesPerSecond(count, iterations, [&]() {
+            encodeHalf2(vertices.data() + 6, stride, count, simdResult[0].uv, dstStride);
+        });
+        bool identical = true;
+        ErrorStats error;
+        for (size_t i = 0; i < count; i++) {
+            identical = identical && std::memcmp(scalarResult[i].uv, simdResult[i].uv, sizeof(simdResult[i].uv)) == 0;
+            error.add(std::fabs(halfToFloat(simdResult[i].uv[0]) - vertices[i * 8 + 6]));
+            error.add(std::fabs(halfToFloat(simdResult[i].uv[1]) - vertices[i * 8 + 7]));
+        }
+        addRecord(report, "uv", "half2", scalarRate, simdRate, identical, error);
+    }
+
+    // 完整的紧凑顶点编码
+    {
+        std::vector<CompactVertex> compact;
+        double rate = measureMegaVerticesPerSecond(count, iterations, [&]() {
+            compact = encodeCompactVertices(vertices.data(), count, bounds);
+        });
+        report.addRecord()
+            .set("attribute", "all")
+            .set("encoding", "CompactVertexLayout")
+            .set("simd_mverts_per_s", rate);
+    }
+
+    report.write(argc, argv);
+    return 0;
+}
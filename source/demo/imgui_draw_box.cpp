@@ -2,26 +2,50 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <stdio.h>
+#include <atomic>
+#include <vector>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "arcball_camera.h"
 #include "box.h"
+#include "bvh.h"
+#include "camera_replay.h"
+#include "fixed_step_simulation.h"
+#include "glfw_callback.h"
 #include "shader_program.h"
 #include "textures_loader.h"
 
 const int SCREEN_WIDTH = 1280;
 const int SCREEN_HEIGHT = 720;
-
-ArcballCamera camera(glm::vec3(0.0f, 0.0f, 10.0f));
-
-#include "glfw_callback.h"
+const double SIMULATION_STEP = 1.0 / 120.0;
+
+// 模拟的状态，由模拟线程每步更新，渲染线程在最近两步之间插值（见 fixed_step_simulation.h）
+struct SimulationState {
+    ArcballCamera camera = ArcballCamera(glm::vec3(0.0f, 0.0f, 10.0f));
+    float boxAngle = 0.0f;          // 3x3个盒子整体绕Y轴旋转的角度
+    int pickedBox = -1;
+    bool closeRequested = false;
+};
+
+// 渲染线程每帧写入，模拟线程每步读取
+struct SharedSettings {
+    std::atomic<float> distance{10.0f};
+    std::atomic<float> spinSpeed{0.0f};
+    std::atomic<bool> guiWantsMouse{false};
+    std::atomic<int> framebufferWidth{SCREEN_WIDTH};
+    std::atomic<int> framebufferHeight{SCREEN_HEIGHT};
+    std::atomic<int> windowWidth{SCREEN_WIDTH};
+    std::atomic<int> windowHeight{SCREEN_HEIGHT};
+} sharedSettings;
 
 //TODO =======================================Define GUI DATA -- start=========================================*/
 struct GuiData {
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
     float distance = 10.0f;
+    float spinSpeed = 0.0f;
+    int pickedBox = -1;
 } guiData;
 
 void showImGuiWindow(ImGuiIO& io){
@@ -33,6 +57,7 @@ void showImGuiWindow(ImGuiIO& io){
     ImGui::Text("This is some useful text.");
 
     ImGui::SliderFloat("camera distance", &guiData.distance, 5.0f, 50.0f);
+    ImGui::SliderFloat("spin speed", &guiData.spinSpeed, 0.0f, 3.0f);
     ImGui::SliderFloat("float", &f, 0.0f, 1.0f);
     ImGui::ColorEdit3("clear color", (float*)&guiData.clear_color);
 
@@ -40,36 +65,51 @@ void showImGuiWindow(ImGuiIO& io){
         counter++;
     ImGui::SameLine();
     ImGui::Text("counter = %d", counter);
-    
-    isGuiFocused = io.WantCaptureMouse;
+    ImGui::Text("picked box = %d (right click to pick)", guiData.pickedBox);
+
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
     ImGui::End();
 }
 //TODO =======================================Define GUI DATA -- end=========================================*/
 // Main code
-int main(int, char**)
+// --record <file> 录制相机路径，--replay <file> 在不可见的窗口中回放并输出每帧的时间（见 camera_replay.h）
+// 相机、盒子的旋转和拾取在模拟线程中以固定的步长更新，渲染线程只读取最新的状态并插值
+int main(int argc, char** argv)
 {
-    glfwSetErrorCallback(glfw_error_callback);
-    if (!glfwInit())
+    CameraReplay replay(argc, argv, "imgui_draw_box");
+    if (replay.failed())
         return 1;
 
+    glfwSetErrorCallback(glfw_error_callback);
     const char* glsl_version = "#version 450";
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);  // 3.2+ only
-
-    // Create window with graphics context
-    GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Dear ImGui GLFW+OpenGL3 example", nullptr, nullptr);
-    if (window == nullptr)
-        return 1;
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
-    // glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    glfwSwapInterval(1);
-
-    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    GLFWwindow* window = nullptr;
+    InputQueue input;
+    if (replay.replaying()) {
+        // 回放时不需要鼠标输入，不设置输入回调，也不限制帧率
+        window = createHeadlessContext(SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (window == nullptr)
+            return 1;
+        glfwSwapInterval(0);
+    } else {
+        if (!glfwInit())
+            return 1;
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);  // 3.2+ only
+
+        // Create window with graphics context
+        window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Dear ImGui GLFW+OpenGL3 example", nullptr, nullptr);
+        if (window == nullptr)
+            return 1;
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        input.attach(window);
+        // glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSwapInterval(1);
+
+        gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    }
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
@@ -78,11 +118,12 @@ int main(int, char**)
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;         // Enable Docking
-    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;       // Enable Multi-Viewport / Platform Windows
+    if (!replay.replaying())
+        io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;   // Enable Multi-Viewport / Platform Windows
     // Setup Dear ImGui style
     ImGui::StyleColorsDark();
     // Setup Platform/Renderer backends
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplGlfw_InitForOpenGL(window, !replay.replaying());
     ImGui_ImplOpenGL3_Init(glsl_version);
     ImFont* font = io.Fonts->AddFontFromFileTTF("fonts/MiSans-Regular.ttf", 18.0f, nullptr, io.Fonts->GetGlyphRangesChineseFull());
 
@@ -96,14 +137,65 @@ int main(int, char**)
             {ShaderType::FRAGMENT, "shaders/draw_box.frag"}
         }
     );
-    // 创建Box
+    // 创建Box，3x3个盒子共用同一个网格，用模型矩阵平移
     glm::vec3 boxPositon(0.0f, 0.0f, 0.0f);
     glm::vec3 boxExtent(1.0f, 1.0f, 1.0f);
     Box box(boxPositon, boxExtent);
+    std::vector<glm::vec3> boxPositions;
+    std::vector<Aabb> boxBounds;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            boxPositions.push_back(glm::vec3(x * 3.0f, y * 3.0f, 0.0f));
+            boxBounds.push_back({boxPositions.back() - boxExtent, boxPositions.back() + boxExtent});
+        }
+    }
+    // 用于鼠标拾取的BVH，盒子整体旋转时把射线变换到旋转前的空间，只需要构建一次
+    Bvh boxBvh;
+    boxBvh.build(boxBounds.data(), boxBounds.size());
 
     glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
     glEnable(GL_DEPTH_TEST);
 
+    // 模拟的一步：取出这一步结束之前的输入，更新相机、拾取和旋转角度；只在模拟线程（回放时为主线程）中调用
+    // 输入事件的时间戳为 glfwGetTime()，inputStartTime 为模拟开始时的 glfwGetTime()
+    double inputStartTime = 0.0;
+    auto simulationStep = [&](SimulationState& state, uint64_t tick, double time, double step) {
+        InputFrame inputFrame = input.poll(inputStartTime + time + step);
+        if (inputFrame.keyPressed(GLFW_KEY_ESCAPE)) {
+            state.closeRequested = true;
+        }
+        state.camera.setDistance(sharedSettings.distance);
+        int width = sharedSettings.framebufferWidth;
+        int height = sharedSettings.framebufferHeight;
+        if (!sharedSettings.guiWantsMouse) {
+            applyCameraInput(inputFrame, state.camera, width, height);
+        }
+
+        // 右键按下时拾取鼠标下的盒子，使用按下时的光标位置（以窗口为单位）
+        const InputEvent* rightPress = inputFrame.findPress(InputEvent::MOUSE_BUTTON, GLFW_MOUSE_BUTTON_RIGHT);
+        int windowWidth = sharedSettings.windowWidth;
+        int windowHeight = sharedSettings.windowHeight;
+        if (rightPress != nullptr && !sharedSettings.guiWantsMouse && width > 0 && height > 0 && windowWidth > 0 && windowHeight > 0) {
+            glm::mat4 projection = state.camera.getProjectionMatrix((float)width / (float)height, 0.1f, 100.0f);
+            Ray ray = Ray::fromScreen(rightPress->x, rightPress->y, static_cast<float>(windowWidth), static_cast<float>(windowHeight),
+                                      state.camera.getViewMatrix(), projection);
+            glm::mat3 inverseRotation = glm::transpose(glm::mat3(glm::rotate(glm::mat4(1.0f), state.boxAngle, glm::vec3(0.0f, 1.0f, 0.0f))));
+            ray = {inverseRotation * ray.origin, inverseRotation * ray.direction};
+            RayHit hit = boxBvh.intersectBoxes(ray, boxBounds.data());
+            state.pickedBox = hit.valid() ? static_cast<int>(hit.primitive) : -1;
+        }
+
+        state.boxAngle += sharedSettings.spinSpeed * static_cast<float>(step);
+    };
+    // 回放时在主线程中按回放的时间推进，画面只取决于回放的时间
+    FixedStepSimulation<SimulationState> simulation(SIMULATION_STEP, SimulationState(), simulationStep);
+    double replayTime = 0.0;
+    if (!replay.replaying()) {
+        inputStartTime = glfwGetTime();
+        simulation.start();
+    }
+    ArcballCamera camera(glm::vec3(0.0f, 0.0f, 10.0f));
+
     //TODO =======================================Render With OpenGL -- end=========================================*/
 
     while (!glfwWindowShouldClose(window)) {
@@ -113,11 +205,8 @@ int main(int, char**)
             continue;
         }
 
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+        replayTime += replay.beginFrame(static_cast<float>(glfwGetTime()));
         glfwPollEvents();
-        processInput(window);
 
         /* -------------------------------------------start ImGui frame---------------------------------------*/
         ImGui_ImplOpenGL3_NewFrame();
@@ -135,25 +224,50 @@ int main(int, char**)
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, texture);
 
-        camera.setDistance(guiData.distance);
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        int windowWidth, windowHeight;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        sharedSettings.framebufferWidth = width;
+        sharedSettings.framebufferHeight = height;
+        sharedSettings.windowWidth = windowWidth;
+        sharedSettings.windowHeight = windowHeight;
+        sharedSettings.distance = guiData.distance;
+        sharedSettings.spinSpeed = guiData.spinSpeed;
+        sharedSettings.guiWantsMouse = io.WantCaptureMouse;
+
+        // 取得模拟最新的状态，在最近两步之间插值，不等待模拟线程
+        double simulationTime = replay.replaying() ? replayTime : simulation.time();
+        if (replay.replaying())
+            simulation.advanceTo(simulationTime);
+        const auto& snapshot = simulation.acquire();
+        float alpha = simulation.alpha(snapshot, simulationTime);
+        camera.setPose(CameraPose::interpolate(snapshot.previous.camera.getPose(), snapshot.current.camera.getPose(), alpha));
+        float boxAngle = glm::mix(snapshot.previous.boxAngle, snapshot.current.boxAngle, alpha);
+        guiData.pickedBox = snapshot.current.pickedBox;
+        if (snapshot.current.closeRequested)
+            glfwSetWindowShouldClose(window, true);
+        replay.update(camera);
 
         // 绑定着色器
         shaderProgram.use();
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
         if(width == 0 || height == 0){
             width = 1;
             height = 1;
         }
-        glm::mat4 projection = glm::perspective(glm::radians(camera.getZoom()), (float)width / (float)height, 0.1f, 100.0f);
+        glm::mat4 projection = camera.getProjectionMatrix((float)width / (float)height, 0.1f, 100.0f);
         glm::mat4 view = camera.getViewMatrix();
-        glm::mat4 model = glm::mat4(1.0f);
 
-        shaderProgram.setUniform("model", model);
         shaderProgram.setUniform("view", view);
         shaderProgram.setUniform("projection", projection);
 
-        box.draw();
+        glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), boxAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+        for (size_t i = 0; i < boxPositions.size(); i++) {
+            bool picked = static_cast<int>(i) == guiData.pickedBox;
+            shaderProgram.setUniform("model", glm::translate(rotation, boxPositions[i]));
+            shaderProgram.setUniform("tint", picked ? glm::vec3(1.0f, 0.5f, 0.5f) : glm::vec3(1.0f));
+            box.draw();
+        }
        //TODO =======================================origanize DrawCALL -- end=========================================*/
 
        /* -------------------------------------------RENDER IMGUI---------------------------------------*/
@@ -168,8 +282,13 @@ int main(int, char**)
             glfwMakeContextCurrent(backup_current_context);
         }
         /* -------------------------------------------RENDER IMGUI---------------------------------------*/
+        replay.endFrame();
+        if (replay.finished())
+            glfwSetWindowShouldClose(window, true);
         glfwSwapBuffers(window);
     }
+    simulation.stop();
+    replay.finish(argc, argv);
 
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
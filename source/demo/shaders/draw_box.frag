@@ -3,10 +3,11 @@
 in vec2 TexCoord;
 
 uniform sampler2D ourTexture;
+uniform vec3 tint;
 
 out vec4 FragColor;
 
 void main()
 {
-    FragColor = texture(ourTexture, TexCoord);
+    FragColor = texture(ourTexture, TexCoord) * vec4(tint, 1.0);
 }
\ No newline at end of file
@@ -1,8 +1,17 @@
+// 轨迹球相机：绕观察点旋转（Arcball）或者在屏幕平面内平移（Planar）
+//  -- 状态为观察点、到观察点的距离和朝向四元数（相机空间到世界空间的旋转，相机看向 -Z），
+//     视图矩阵直接由四元数得到，不需要保存和旋转相机的位置、右方向点和上方向点
+//  -- 每次旋转后重新归一化四元数，长时间拖动也不会累积缩放和不正交的误差
+
 #ifndef ARCBALL_CAMERA_H
 #define ARCBALL_CAMERA_H
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "camera_path.h"
+#include "frustum.h"
 
 #define ENABLE_ARCBALL_CAMERA
 
@@ -16,14 +25,14 @@ public:
 
     ArcballCamera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 10.0f),
                   glm::vec3 lookat = glm::vec3(0.0f, 0.0f, 0.0f),
-                  glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f)) : m_worldUp(worldUp), m_position(position), m_frontPoint(lookat){
+                  glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f)) : m_pivot(lookat), m_worldUp(worldUp){
         m_backup = Backup(position, lookat, worldUp);
 
-        glm::vec3 frontDir = getFrontDir();
+        glm::vec3 frontDir = glm::normalize(lookat - position);
         glm::vec3 rightDir = glm::normalize(glm::cross(frontDir, worldUp));
         glm::vec3 upDir = glm::normalize(glm::cross(rightDir, frontDir));
-        m_rightPoint = m_position + rightDir;
-        m_upPoint = m_position + upDir;
+        m_distance = glm::length(lookat - position);
+        m_orientation = glm::normalize(glm::quat_cast(glm::mat3(rightDir, upDir, -frontDir)));
     }
 
     ArcballCamera(float posX, float posY, float posZ,
@@ -33,46 +42,72 @@ public:
 
     ~ArcballCamera(){}
 
+    // 旋转矩阵的三列为相机的右、上、后方向，视图矩阵为它的转置和平移
     glm::mat4 getViewMatrix() const {
-        glm::vec3 front = getFrontDir();
-        glm::vec3 right = getRightDir();
-        glm::vec3 up = getUpDir();
+        glm::mat3 rotation = glm::mat3_cast(m_orientation);
+        glm::vec3 position = m_pivot + m_distance * rotation[2];
 
         glm::mat4 result = glm::mat4(1.0f);
-        result[0][0] = right.x;
-        result[1][0] = right.y;
-        result[2][0] = right.z;
-        result[0][1] = up.x;
-        result[1][1] = up.y;
-        result[2][1] = up.z;
-        result[0][2] = -front.x;
-        result[1][2] = -front.y;
-        result[2][2] = -front.z;
-        result[3][0] = -glm::dot(right, m_position);
-        result[3][1] = -glm::dot(up, m_position);
-        result[3][2] = glm::dot(front, m_position);
+        for (int i = 0; i < 3; i++) {
+            result[0][i] = rotation[i].x;
+            result[1][i] = rotation[i].y;
+            result[2][i] = rotation[i].z;
+            result[3][i] = -glm::dot(rotation[i], position);
+        }
         return result;
     }
 
     glm::vec3 getPosition() const {
-        return m_position;
+        return m_pivot + m_distance * (m_orientation * glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+
+    glm::vec3 getPivot() const {
+        return m_pivot;
+    }
+
+    float getDistance() const {
+        return m_distance;
+    }
+
+    glm::quat getOrientation() const {
+        return m_orientation;
     }
 
     float getZoom() const {
         return m_zoom;
     }
 
+    CameraPose getPose() const {
+        CameraPose pose;
+        pose.position = getPosition();
+        pose.orientation = m_orientation;
+        pose.zoom = m_zoom;
+        return pose;
+    }
+
+    // 保持到观察点的距离不变，观察点随相机移动
+    void setPose(const CameraPose& pose) {
+        m_orientation = glm::normalize(pose.orientation);
+        m_pivot = pose.position - m_distance * (m_orientation * glm::vec3(0.0f, 0.0f, 1.0f));
+        m_zoom = pose.zoom;
+    }
+
+    // zoom 为透视投影的 fovy（角度）
+    glm::mat4 getProjectionMatrix(float aspect, float zNear = 0.1f, float zFar = 100.0f) const {
+        return glm::perspective(glm::radians(m_zoom), aspect, zNear, zFar);
+    }
+
+    // 世界空间中的视锥体，参数与 getProjectionMatrix() 相同
+    Frustum getFrustum(float aspect, float zNear = 0.1f, float zFar = 100.0f) const {
+        return Frustum::fromMatrix(getProjectionMatrix(aspect, zNear, zFar) * getViewMatrix());
+    }
+
     void reset(){
         *this = ArcballCamera(m_backup.position, m_backup.lookat, m_backup.worldUp);
     }
 
     void setDistance(float distance){
-        glm::vec3 front = getFrontDir();
-        glm::vec3 right = getRightDir();
-        glm::vec3 up = getUpDir();
-        m_position = m_frontPoint - distance * front;
-        m_rightPoint = m_position + right;
-        m_upPoint = m_position + up;
+        m_distance = distance;
     }
 
     void setSensitive(float sensitive){
@@ -85,29 +120,19 @@ public:
     }
 
     void processMouseMovement(int viewWidth, int viewHeight, float xoffset, float yoffset, MoveStyle moveStyle = MoveStyle::Arcball) {
-        auto pos = m_position;
-        auto pivot = m_frontPoint;
-        glm::vec3 front = getFrontDir();
-        glm::vec3 right = getRightDir();
-        glm::vec3 up = getUpDir();
-
         if (moveStyle == MoveStyle::Planar) {
-            glm::vec3 offset = m_sensitive * glm::vec3(xoffset * right - yoffset * up);
-            m_position = pos + offset;
-            m_frontPoint = pivot + offset;
-            m_rightPoint = m_position + right;
-            m_upPoint = m_position + up;
+            glm::vec3 right = m_orientation * glm::vec3(1.0f, 0.0f, 0.0f);
+            glm::vec3 up = m_orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+            m_pivot += m_sensitive * glm::vec3(xoffset * right - yoffset * up);
         } else if (moveStyle == MoveStyle::Arcball) {
             float deltaAngleX = (2.0f * PI / viewWidth) * xoffset;
             float deltaAngleY = (PI / viewHeight) * yoffset;
 
-            glm::vec3 newPosition = rotatePoint(pos, deltaAngleX, deltaAngleY); 
-            glm::vec3 newRightPoint = rotatePoint(m_rightPoint, deltaAngleX, deltaAngleY);
-            glm::vec3 newUpPoint = rotatePoint(m_upPoint, deltaAngleX, deltaAngleY);
-
-            m_position = newPosition;
-            m_rightPoint = newRightPoint;
-            m_upPoint = newUpPoint;
+            // 先绕相机的上方向旋转 deltaAngleX，再绕（旋转前的）右方向旋转 deltaAngleY，
+            // 两个轴都是相机空间的坐标轴，所以在右侧相乘
+            glm::quat rotationX = glm::angleAxis(deltaAngleX, glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::quat rotationY = glm::angleAxis(deltaAngleY, glm::vec3(1.0f, 0.0f, 0.0f));
+            m_orientation = glm::normalize(m_orientation * rotationY * rotationX);
         }
     }
 
@@ -115,10 +140,9 @@ private:
 
     static constexpr float PI = 3.14159265359f;
 
-    glm::vec3 m_position;
-    glm::vec3 m_frontPoint;
-    glm::vec3 m_rightPoint;
-    glm::vec3 m_upPoint;
+    glm::vec3 m_pivot;
+    float m_distance;
+    glm::quat m_orientation;
 
     glm::vec3 m_worldUp;
 
@@ -139,27 +163,6 @@ private:
         if (value > max) return max;
         return value;
     }
-
-    glm::vec3 getFrontDir() const {
-        return glm::normalize(m_frontPoint - m_position);
-    }
-
-    glm::vec3 getRightDir() const {
-        return glm::normalize(m_rightPoint - m_position);
-    }
-
-    glm::vec3 getUpDir() const {
-        return glm::normalize(m_upPoint - m_position);
-    }
-
-    glm::vec3 rotatePoint(glm::vec3 point, float angleX, float angleY) const {
-        glm::mat4 rotationX = glm::rotate(glm::mat4(1.0f), angleX, getUpDir());
-        glm::vec3 result = glm::vec3(rotationX * glm::vec4(point - m_frontPoint, 1.0f)) + m_frontPoint;
-
-        glm::mat4 rotationY = glm::rotate(glm::mat4(1.0f), angleY, getRightDir());
-        result = glm::vec3(rotationY * glm::vec4(result - m_frontPoint, 1.0f)) + m_frontPoint;
-        return result;
-    }
 };
 
 #endif // ARCBALL_CAMERA_H
@@ -0,0 +1,312 @@
+// 该文件中包含了基准测试程序共用的工具：
+//  -- createHeadlessContext : 创建不可见窗口的OpenGL上下文，用于无界面运行
+//  -- Timer                 : 基于steady_clock的CPU计时器
+//  -- GpuTimer              : 基于GL_TIME_ELAPSED查询的GPU计时器
+//  -- median                : 多次采样取中位数
+//  -- getPeakRSS            : 查询进程的峰值常驻内存
+//  -- getCurrentRSS         : 查询进程当前的常驻内存，前后两次的差用于统计单个测试的内存增长
+//  -- BenchmarkReport       : 收集测试结果并以JSON格式输出，便于在不同提交之间对比
+//  -- getIntArgument        : 读取形如 --name <value> 的整数命令行参数
+//  -- getStringArgument     : 读取形如 --name <value> 的字符串命令行参数
+// 所有的基准测试程序都支持参数 --out <file>，不指定时输出到标准输出
+
+#ifndef BENCHMARK_UTILS_H
+#define BENCHMARK_UTILS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// 创建一个不可见窗口并初始化glad，失败时返回nullptr
+// 如果当前环境没有显示设备（例如CI），且GLFW支持Null平台，则退回到OSMesa软件上下文
+GLFWwindow* createHeadlessContext(int width = 64, int height = 64, int major = 4, int minor = 5) {
+    auto tryCreate = [&]() -> GLFWwindow* {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        return glfwCreateWindow(width, height, "benchmark", nullptr, nullptr);
+    };
+
+    GLFWwindow* window = nullptr;
+    if (glfwInit()) {
+        window = tryCreate();
+    }
+#ifdef GLFW_PLATFORM_NULL
+    if (window == nullptr) {
+        glfwTerminate();
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        if (glfwInit()) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            window = tryCreate();
+        }
+    }
+#endif
+    if (window == nullptr) {
+        std::cerr << "Failed to create headless OpenGL context" << std::endl;
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    return window;
+}
+
+class Timer {
+public:
+    Timer() { reset(); }
+
+    void reset() {
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// 测量begin()和end()之间提交的GL命令在GPU上的执行时间
+// resultMs() 会阻塞直到查询结果可用，只适合在基准测试中使用
+class GpuTimer {
+public:
+    GpuTimer() {
+        glGenQueries(1, &m_query);
+    }
+
+    ~GpuTimer() {
+        glDeleteQueries(1, &m_query);
+    }
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin() {
+        glBeginQuery(GL_TIME_ELAPSED, m_query);
+    }
+
+    void end() {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    double resultMs() const {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m_query, GL_QUERY_RESULT, &elapsed);
+        return static_cast<double>(elapsed) / 1.0e6;
+    }
+
+private:
+    GLuint m_query;
+};
+
+double median(std::vector<double> samples) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// 返回进程的峰值常驻内存，单位为字节
+size_t getPeakRSS() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<size_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// 返回进程当前的常驻内存，单位为字节，不支持的平台返回0
+size_t getCurrentRSS() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<size_t>(counters.WorkingSetSize);
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return static_cast<size_t>(info.resident_size);
+#else
+    // /proc/self/statm 的第二项为常驻的页数
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, residentPages = 0;
+    if (!(statm >> pages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// 读取形如 --name <value> 的整数参数，不存在时返回默认值
+int getIntArgument(int argc, char** argv, const char* name, int defaultValue) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return std::atoi(argv[i + 1]);
+        }
+    }
+    return defaultValue;
+}
+
+std::string getStringArgument(int argc, char** argv, const char* name, const std::string& defaultValue = "") {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return defaultValue;
+}
+
+bool hasArgument(int argc, char** argv, const char* name) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+class BenchmarkReport {
+public:
+    // 一条测试结果，字段按添加顺序输出
+    class Record {
+    public:
+        Record& set(const std::string& key, const std::string& value) {
+            m_fields.emplace_back(key, quote(value));
+            return *this;
+        }
+
+        Record& set(const std::string& key, const char* value) {
+            return set(key, std::string(value));
+        }
+
+        Record& set(const std::string& key, double value) {
+            std::ostringstream stream;
+            stream.precision(6);
+            stream << std::fixed << value;
+            m_fields.emplace_back(key, stream.str());
+            return *this;
+        }
+
+        Record& set(const std::string& key, int value) {
+            m_fields.emplace_back(key, std::to_string(value));
+            return *this;
+        }
+
+        Record& set(const std::string& key, size_t value) {
+            m_fields.emplace_back(key, std::to_string(value));
+            return *this;
+        }
+
+    private:
+        friend class BenchmarkReport;
+        std::vector<std::pair<std::string, std::string>> m_fields;
+    };
+
+    explicit BenchmarkReport(std::string name) : m_name(std::move(name)) {}
+
+    Record& addRecord() {
+        m_records.emplace_back();
+        return m_records.back();
+    }
+
+    // 附加在报告顶层的信息，比如OpenGL的渲染器名称
+    Record& info() {
+        return m_info;
+    }
+
+    void write(std::ostream& out) const {
+        out << "{\n  \"benchmark\": " << quote(m_name) << ",\n";
+        for (const auto& field : m_info.m_fields) {
+            out << "  " << quote(field.first) << ": " << field.second << ",\n";
+        }
+        out << "  \"peak_rss_bytes\": " << getPeakRSS() << ",\n";
+        out << "  \"results\": [";
+        for (size_t i = 0; i < m_records.size(); i++) {
+            out << (i == 0 ? "\n    {" : ",\n    {");
+            const auto& fields = m_records[i].m_fields;
+            for (size_t j = 0; j < fields.size(); j++) {
+                out << (j == 0 ? "" : ", ") << quote(fields[j].first) << ": " << fields[j].second;
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    // 根据命令行参数 --out <file> 决定输出位置
+    bool write(int argc, char** argv) const {
+        for (int i = 1; i + 1 < argc; i++) {
+            if (std::strcmp(argv[i], "--out") == 0) {
+                std::ofstream file(argv[i + 1]);
+                if (!file) {
+                    std::cerr << "BenchmarkReport: Failed to open file: " << argv[i + 1] << std::endl;
+                    return false;
+                }
+                write(file);
+                return true;
+            }
+        }
+        write(std::cout);
+        return true;
+    }
+
+private:
+    std::string m_name;
+    Record m_info;
+    std::vector<Record> m_records;
+
+    static std::string quote(const std::string& value) {
+        std::string result = "\"";
+        for (char c : value) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result + "\"";
+    }
+};
+
+#endif // BENCHMARK_UTILS_H
@@ -4,7 +4,10 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include <vector>
+#include <array>
+
+#include "geometry_pool.h"
+#include "procedural_mesh.h"
 
 class Box {
 public:
@@ -18,14 +21,38 @@ public:
     ~Box() {
         glDeleteVertexArrays(1, &m_vao);
         glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ebo);
     }
 
     void draw() {
         glBindVertexArray(m_vao);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        glDrawElements(GL_TRIANGLES, INDEX_COUNT, GL_UNSIGNED_SHORT, nullptr);
         glBindVertexArray(0);
     }
 
+    // 每个面4个顶点，共24个不重复的顶点；每个面2个三角形，共36个索引
+    static constexpr int VERTEX_COUNT = procedural_mesh::BOX_SIZE.vertexCount;
+    static constexpr int INDEX_COUNT = procedural_mesh::BOX_SIZE.indexCount;
+    static constexpr int FLOATS_PER_VERTEX = procedural_mesh::FLOATS_PER_VERTEX;
+
+    // 以原点为中心，半长为extension的盒子的顶点数据，每个顶点的布局为：位置(3) 法线(3) 纹理坐标(2)
+    // 角点、法线、纹理坐标都来自 procedural_mesh 中的编译期常量表，不需要分配内存
+    static std::array<float, VERTEX_COUNT * FLOATS_PER_VERTEX> generateVertexData(const glm::vec3& extension) {
+        std::array<float, VERTEX_COUNT * FLOATS_PER_VERTEX> vertices;
+        procedural_mesh::generateBoxVertices(extension, vertices.data());
+        return vertices;
+    }
+
+    static const std::array<unsigned short, INDEX_COUNT>& generateIndices() {
+        return procedural_mesh::BOX_INDICES<unsigned short>;
+    }
+
+    // 把盒子网格放入几何池中，池的顶点格式需要是 VertexFormat::positionNormalUV()
+    static PoolMesh addToPool(GeometryPool& pool, const glm::vec3& extension = glm::vec3(1.0f)) {
+        std::array<float, VERTEX_COUNT * FLOATS_PER_VERTEX> vertices = generateVertexData(extension);
+        return pool.allocate(vertices.data(), VERTEX_COUNT, procedural_mesh::BOX_INDICES<uint32_t>.data(), INDEX_COUNT);
+    }
+
 private:
     glm::vec3 m_center;
     glm::vec3 m_extension;
@@ -34,127 +61,35 @@ private:
     GLuint m_vbo;
     GLuint m_ebo;
 
-    // Box 局部坐标系说明：
-    /*
-           Z
-           |
-           |
-           |
-           @-----------Y
-          /
-         /
-        /
-       X
-    */
-    std::vector<glm::vec3> getCornerPoints() {
-        float halfLength = m_extension.x;
-        float halfWidth = m_extension.y;
-        float halfHeight = m_extension.z;
-        // 生成顶点
-        return {
-            // 上部四个顶点, 从第一卦限，逆时针
-            { halfLength,  halfWidth, halfHeight},
-            {-halfLength,  halfWidth, halfHeight},
-            {-halfLength, -halfWidth, halfHeight},
-            { halfLength, -halfWidth, halfHeight},
-            // 下部四个顶点， 从第五卦限，逆时针
-            { halfLength,  halfWidth, -halfHeight},
-            {-halfLength,  halfWidth, -halfHeight},
-            {-halfLength, -halfWidth, -halfHeight},
-            { halfLength, -halfWidth, -halfHeight},
-        };
-    }
-
-    // 正对每个面时的索引顺序为 a b c a c d
-    /*
-       b----------a
-       |         /|
-       |       /  |
-       |     /    |
-       |   /      |
-       | /        |
-       c----------d
-    */
-    std::vector<unsigned int> getIndices() {
-        return {
-            // 前面 px
-            0, 3, 7, 0, 7, 4,
-            // 右侧面 py
-            1, 0, 4, 1, 4, 5,
-            // 后面 nx
-            2, 1, 5, 2, 5, 6,
-            // 左侧面 ny
-            3, 2, 6, 3, 6, 7,
-            // 顶面 pz
-            1, 2, 3, 1, 3, 0,
-            // 底面 nz
-            4, 7, 6, 4, 6, 5,
-        };
-    }
-
-    // 正对每个面时的纹理坐标顺序
-    /*
-       (0,1)-----------(1,1)
-       |                   |
-       |                   |
-       |                   |
-       |                   |
-       |                   |
-       (0,0)-----------(1,0)
-    */
-    std::vector<glm::vec2> getTextureCoord() {
-        return {
-            {1.0, 1.0}, {0.0, 1.0}, {0.0, 0.0},
-            {1.0, 1.0}, {0.0, 0.0}, {1.0, 0.0}
-        };
-    }
-
-    std::vector<glm::vec3> getNormal() {
-        return {
-            { 1, 0, 0}, { 0, 1, 0}, {-1, 0, 0},
-            { 0,-1, 0}, { 0, 0, 1}, { 0, 0,-1},
-        };
-    }
-    
+    // Box 局部坐标系和每个面的角点顺序见 procedural_mesh.h
     void generate() {
-        std::vector<float> vertices = generateVertexData();
+        std::array<float, VERTEX_COUNT * FLOATS_PER_VERTEX> vertices = generateVertexData(m_extension);
+        const std::array<unsigned short, INDEX_COUNT>& indices = generateIndices();
         glGenVertexArrays(1, &m_vao);
         glGenBuffers(1, &m_vbo);
+        glGenBuffers(1, &m_ebo);
 
         glBindVertexArray(m_vao);
         glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        // EBO的绑定记录在VAO中，解绑VAO之前不能解绑EBO
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.data(), GL_STATIC_DRAW);
 
         // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
-        // texture coord attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
         // normal attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        // texture coord attribute
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
 
         // 解绑 VAO
         glBindVertexArray(0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
-
-    std::vector<float> generateVertexData() {
-        std::vector<float> vertices;
-        auto&& indices = getIndices();
-        auto&& cornerPoints = getCornerPoints();
-        auto&& textureCoord = getTextureCoord();
-        auto&& normal = getNormal();
-
-        int count = 0;
-        for (const auto& point : indices) {
-            vertices.insert(vertices.end(), {cornerPoints[point].x, cornerPoints[point].y, cornerPoints[point].z});
-            vertices.insert(vertices.end(), {normal[count / 6].x, normal[count / 6].y, normal[count / 6].z});
-            vertices.insert(vertices.end(), {textureCoord[count % 6].x, textureCoord[count % 6].y});
-            count++;
-        }
-        return vertices;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 };
 
@@ -0,0 +1,175 @@
+#ifndef BOX_INSTANCER_H
+#define BOX_INSTANCER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "box.h"
+
+// 使用实例化渲染绘制大量的盒子：
+//  -- 所有实例共享一个单位盒子网格（半长为1）
+//  -- 每个实例的中心、半长和颜色存放在实例缓冲中，只有被修改过的区间会重新上传
+//  -- draw() 只需要一次 glDrawElementsInstanced
+// 顶点着色器中的属性位置：
+//  -- 0 位置  1 法线  2 纹理坐标      （与 Box 一致）
+//  -- 3 中心  4 半长  5 颜色          （每个实例一份）
+class BoxInstancer {
+public:
+    struct Instance {
+        glm::vec3 center;
+        glm::vec3 extension;
+        glm::vec4 color;
+    };
+
+    explicit BoxInstancer(size_t capacity = 1024) : m_capacity(std::max<size_t>(capacity, 1)) {
+        generate();
+    }
+
+    ~BoxInstancer() {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ebo);
+        glDeleteBuffers(1, &m_instanceVbo);
+    }
+
+    BoxInstancer(const BoxInstancer&) = delete;
+    BoxInstancer& operator=(const BoxInstancer&) = delete;
+
+    // 添加一个实例，返回实例的索引
+    size_t add(glm::vec3 center, glm::vec3 extension = glm::vec3(1.0f), glm::vec4 color = glm::vec4(1.0f)) {
+        m_instances.push_back({center, extension, color});
+        markDirty(m_instances.size() - 1);
+        return m_instances.size() - 1;
+    }
+
+    void set(size_t index, const Instance& instance) {
+        m_instances[index] = instance;
+        markDirty(index);
+    }
+
+    void setCenter(size_t index, glm::vec3 center) {
+        m_instances[index].center = center;
+        markDirty(index);
+    }
+
+    void setColor(size_t index, glm::vec4 color) {
+        m_instances[index].color = color;
+        markDirty(index);
+    }
+
+    const Instance& get(size_t index) const {
+        return m_instances[index];
+    }
+
+    size_t size() const {
+        return m_instances.size();
+    }
+
+    void clear() {
+        m_instances.clear();
+        m_dirtyBegin = m_dirtyEnd = 0;
+    }
+
+    // 把修改过的实例上传到GPU，draw() 会自动调用
+    void flush() {
+        if (m_instances.size() > m_capacity) {
+            while (m_capacity < m_instances.size()) {
+                m_capacity *= 2;
+            }
+            // 容量不够时重新分配缓冲，并上传全部数据
+            glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+            glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+            m_dirtyBegin = 0;
+            m_dirtyEnd = m_instances.size();
+        }
+        if (m_dirtyBegin < m_dirtyEnd) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+            glBufferSubData(GL_ARRAY_BUFFER, m_dirtyBegin * sizeof(Instance), (m_dirtyEnd - m_dirtyBegin) * sizeof(Instance),
+                            m_instances.data() + m_dirtyBegin);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        m_dirtyBegin = m_dirtyEnd = 0;
+    }
+
+    void draw() {
+        flush();
+        if (m_instances.empty()) {
+            return;
+        }
+        glBindVertexArray(m_vao);
+        glDrawElementsInstanced(GL_TRIANGLES, Box::INDEX_COUNT, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(m_instances.size()));
+        glBindVertexArray(0);
+    }
+
+private:
+    GLuint m_vao;
+    GLuint m_vbo;
+    GLuint m_ebo;
+    GLuint m_instanceVbo;
+
+    std::vector<Instance> m_instances;
+    size_t m_capacity;
+    // 需要上传的实例区间 [m_dirtyBegin, m_dirtyEnd)
+    size_t m_dirtyBegin = 0;
+    size_t m_dirtyEnd = 0;
+
+    void markDirty(size_t index) {
+        if (m_dirtyBegin == m_dirtyEnd) {
+            m_dirtyBegin = index;
+            m_dirtyEnd = index + 1;
+        } else {
+            m_dirtyBegin = std::min(m_dirtyBegin, index);
+            m_dirtyEnd = std::max(m_dirtyEnd, index + 1);
+        }
+    }
+
+    void generate() {
+        const auto& vertices = procedural_mesh::BOX_VERTICES;
+        const auto& indices = Box::generateIndices();
+        glGenVertexArrays(1, &m_vao);
+        glGenBuffers(1, &m_vbo);
+        glGenBuffers(1, &m_ebo);
+        glGenBuffers(1, &m_instanceVbo);
+
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.data(), GL_STATIC_DRAW);
+
+        const GLsizei stride = Box::FLOATS_PER_VERTEX * sizeof(float);
+        // position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glEnableVertexAttribArray(0);
+        // normal attribute
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        // texture coord attribute
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        // 实例属性，每个实例前进一次
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, center));
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, extension));
+        glEnableVertexAttribArray(4);
+        glVertexAttribDivisor(4, 1);
+        glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, color));
+        glEnableVertexAttribArray(5);
+        glVertexAttribDivisor(5, 1);
+
+        // 解绑 VAO
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+};
+
+#endif // BOX_INSTANCER_H
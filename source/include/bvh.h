@@ -0,0 +1,374 @@
+// 包围盒层次结构（BVH），用于拾取和射线查询
+//  -- 构建：按表面积启发式（SAH）分桶（BIN_COUNT个桶）选择划分位置，图元数不超过 maxLeafSize 时作为叶子
+//  -- 节点保存在一个连续的数组中，每个节点32字节，两个子节点总是相邻（right = left + 1），
+//     子节点的下标总是大于父节点，因此从后往前遍历数组就可以自底向上更新包围盒（refit）
+//  -- 图元可以是场景中的物体（每个物体一个AABB），也可以是网格的三角形（见 triangleBounds / intersectTriangle）
+//  -- 射线查询时先访问较近的子节点，图元的精确测试由调用者提供
+// 物体移动后调用 refit() 只更新包围盒，不改变树的结构；移动很大时树的质量会下降，需要重新 build()
+
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+struct Aabb {
+    glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+    glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+
+    void grow(const glm::vec3& point) {
+        boundsMin = glm::min(boundsMin, point);
+        boundsMax = glm::max(boundsMax, point);
+    }
+
+    void grow(const Aabb& other) {
+        boundsMin = glm::min(boundsMin, other.boundsMin);
+        boundsMax = glm::max(boundsMax, other.boundsMax);
+    }
+
+    glm::vec3 center() const {
+        return (boundsMin + boundsMax) * 0.5f;
+    }
+
+    float surfaceArea() const {
+        glm::vec3 size = boundsMax - boundsMin;
+        if (size.x < 0.0f) {
+            return 0.0f;
+        }
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+};
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;        // 不要求归一化，相交的参数t以 direction 的长度为单位
+
+    // 屏幕坐标（像素，原点在左上角，与GLFW的鼠标坐标一致）对应的世界空间射线，从近平面指向远平面
+    static Ray fromScreen(float x, float y, float width, float height, const glm::mat4& view, const glm::mat4& projection) {
+        glm::mat4 inverse = glm::inverse(projection * view);
+        float ndcX = 2.0f * x / width - 1.0f;
+        float ndcY = 1.0f - 2.0f * y / height;
+        glm::vec4 nearPoint = inverse * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+        glm::vec4 farPoint = inverse * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+        glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+        return {origin, glm::normalize(glm::vec3(farPoint) / farPoint.w - origin)};
+    }
+};
+
+// 射线与AABB的slab测试，返回进入点的t，不相交或者比 tMax 远时返回 FLT_MAX
+inline float intersectAabb(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& boundsMin, const glm::vec3& boundsMax, float tMax) {
+    glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+    glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return entry <= exit ? entry : FLT_MAX;
+}
+
+// Möller–Trumbore，返回t，不相交时返回 FLT_MAX（不区分正反面）
+inline float intersectTriangle(const Ray& ray, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    glm::vec3 edge1 = b - a;
+    glm::vec3 edge2 = c - a;
+    glm::vec3 p = glm::cross(ray.direction, edge2);
+    float determinant = glm::dot(edge1, p);
+    if (std::abs(determinant) < 1e-12f) {
+        return FLT_MAX;
+    }
+    float inverseDeterminant = 1.0f / determinant;
+    glm::vec3 s = ray.origin - a;
+    float u = glm::dot(s, p) * inverseDeterminant;
+    if (u < 0.0f || u > 1.0f) {
+        return FLT_MAX;
+    }
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = glm::dot(ray.direction, q) * inverseDeterminant;
+    if (v < 0.0f || u + v > 1.0f) {
+        return FLT_MAX;
+    }
+    float t = glm::dot(edge2, q) * inverseDeterminant;
+    return t >= 0.0f ? t : FLT_MAX;
+}
+
+// 网格中每个三角形的包围盒，vertices 的前三个float为位置
+inline std::vector<Aabb> triangleBounds(const float* vertices, size_t strideBytes, const uint32_t* indices, size_t indexCount) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertices);
+    std::vector<Aabb> bounds(indexCount / 3);
+    for (size_t t = 0; t < bounds.size(); t++) {
+        for (int k = 0; k < 3; k++) {
+            const float* p = reinterpret_cast<const float*>(bytes + indices[t * 3 + k] * strideBytes);
+            bounds[t].grow(glm::vec3(p[0], p[1], p[2]));
+        }
+    }
+    return bounds;
+}
+
+struct RayHit {
+    static constexpr uint32_t NONE = ~0u;
+
+    uint32_t primitive = NONE;
+    float t = FLT_MAX;
+
+    bool valid() const {
+        return primitive != NONE;
+    }
+};
+
+class Bvh {
+public:
+    static constexpr int BIN_COUNT = 16;
+    static constexpr uint32_t MAX_DEPTH = 64;      // 超过这个深度的节点不再划分
+    static constexpr float TRAVERSAL_COST = 1.0f;  // 访问一个内部节点的代价，以测试一个图元的代价为单位
+
+    // count == 0 为内部节点，leftOrFirst 为左子节点的下标；否则为叶子，图元为 primitives[leftOrFirst, leftOrFirst + count)
+    struct Node {
+        glm::vec3 boundsMin;
+        uint32_t leftOrFirst;
+        glm::vec3 boundsMax;
+        uint32_t count;
+
+        bool isLeaf() const {
+            return count > 0;
+        }
+    };
+
+    // bounds[i] 为第i个图元的包围盒
+    void build(const Aabb* bounds, size_t count, uint32_t maxLeafSize = 4) {
+        m_nodes.clear();
+        m_primitives.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            m_primitives[i] = static_cast<uint32_t>(i);
+        }
+        if (count == 0) {
+            return;
+        }
+        m_nodes.reserve(2 * count);
+        m_centers.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            m_centers[i] = bounds[i].center();
+        }
+
+        m_nodes.push_back({glm::vec3(0.0f), 0, glm::vec3(0.0f), static_cast<uint32_t>(count)});
+        std::vector<std::pair<uint32_t, uint32_t>> stack = {{0u, 1u}};     // (节点, 深度)
+        while (!stack.empty()) {
+            auto [nodeIndex, depth] = stack.back();
+            stack.pop_back();
+            updateNodeBounds(nodeIndex, bounds);
+            Split split = findSplit(m_nodes[nodeIndex], bounds);
+            Node& node = m_nodes[nodeIndex];
+            // 划分的代价不低于不划分时停止（图元数超过 maxLeafSize 时仍然强制划分）
+            // 代价都乘了节点的表面积：叶子为 N * A，划分为 TRAVERSAL_COST * A + Nl * Al + Nr * Ar
+            float area = surfaceArea(node);
+            float leafCost = static_cast<float>(node.count) * area;
+            float splitCost = TRAVERSAL_COST * area + split.cost;
+            if (split.axis < 0 || depth >= MAX_DEPTH || (node.count <= maxLeafSize && splitCost >= leafCost)) {
+                continue;
+            }
+
+            // 按划分位置原地分开图元
+            uint32_t first = node.leftOrFirst;
+            uint32_t last = first + node.count;
+            uint32_t middle = first;
+            for (uint32_t i = first; i < last; i++) {
+                if (m_centers[m_primitives[i]][split.axis] < split.position) {
+                    std::swap(m_primitives[i], m_primitives[middle++]);
+                }
+            }
+            if (middle == first || middle == last) {
+                continue;
+            }
+
+            uint32_t left = static_cast<uint32_t>(m_nodes.size());
+            node.leftOrFirst = left;
+            node.count = 0;
+            m_nodes.push_back({glm::vec3(0.0f), first, glm::vec3(0.0f), middle - first});
+            m_nodes.push_back({glm::vec3(0.0f), middle, glm::vec3(0.0f), last - middle});
+            stack.push_back({left + 1, depth + 1});
+            stack.push_back({left, depth + 1});
+        }
+        m_centers.clear();
+        m_centers.shrink_to_fit();
+    }
+
+    // 图元移动后更新所有节点的包围盒，bounds 的顺序与 build() 时相同
+    void refit(const Aabb* bounds) {
+        for (size_t i = m_nodes.size(); i-- > 0;) {
+            Node& node = m_nodes[i];
+            if (node.isLeaf()) {
+                updateNodeBounds(static_cast<uint32_t>(i), bounds);
+            } else {
+                const Node& left = m_nodes[node.leftOrFirst];
+                const Node& right = m_nodes[node.leftOrFirst + 1];
+                node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+                node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+            }
+        }
+    }
+
+    // intersectPrimitive(primitive, ray, tMax) 返回图元的相交参数t，不相交时返回 FLT_MAX
+    // 返回最近的相交图元
+    template <typename IntersectPrimitive>
+    RayHit intersect(const Ray& ray, IntersectPrimitive&& intersectPrimitive, float tMax = FLT_MAX) const {
+        RayHit hit;
+        hit.t = tMax;
+        if (m_nodes.empty()) {
+            return hit;
+        }
+        // 方向分量为0时得到无穷大，slab测试仍然正确
+        const glm::vec3 inverseDirection = 1.0f / ray.direction;
+        uint32_t stack[MAX_DEPTH + 1];
+        int stackSize = 0;
+        if (intersectAabb(ray.origin, inverseDirection, m_nodes[0].boundsMin, m_nodes[0].boundsMax, hit.t) == FLT_MAX) {
+            return hit;
+        }
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const Node& node = m_nodes[stack[--stackSize]];
+            if (node.isLeaf()) {
+                for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+                    float t = intersectPrimitive(m_primitives[i], ray, hit.t);
+                    if (t < hit.t) {
+                        hit.t = t;
+                        hit.primitive = m_primitives[i];
+                    }
+                }
+                continue;
+            }
+            // 变量名不用 near/far，它们在 windows.h 中是宏
+            uint32_t nearChild = node.leftOrFirst;
+            uint32_t farChild = node.leftOrFirst + 1;
+            float tNear = intersectAabb(ray.origin, inverseDirection, m_nodes[nearChild].boundsMin, m_nodes[nearChild].boundsMax, hit.t);
+            float tFar = intersectAabb(ray.origin, inverseDirection, m_nodes[farChild].boundsMin, m_nodes[farChild].boundsMax, hit.t);
+            if (tFar < tNear) {
+                std::swap(nearChild, farChild);
+                std::swap(tNear, tFar);
+            }
+            // 先压入较远的子节点，较近的子节点先出栈；树的深度不超过 MAX_DEPTH，栈不会溢出
+            if (tFar != FLT_MAX) {
+                stack[stackSize++] = farChild;
+            }
+            if (tNear != FLT_MAX) {
+                stack[stackSize++] = nearChild;
+            }
+        }
+        if (!hit.valid()) {
+            hit.t = FLT_MAX;
+        }
+        return hit;
+    }
+
+    // 图元就是 bounds 中的AABB时的射线查询，例如拾取场景中的物体
+    RayHit intersectBoxes(const Ray& ray, const Aabb* bounds, float tMax = FLT_MAX) const {
+        const glm::vec3 inverseDirection = 1.0f / ray.direction;
+        return intersect(ray, [&](uint32_t primitive, const Ray& r, float t) {
+            return intersectAabb(r.origin, inverseDirection, bounds[primitive].boundsMin, bounds[primitive].boundsMax, t);
+        }, tMax);
+    }
+
+    const std::vector<Node>& nodes() const {
+        return m_nodes;
+    }
+
+    const std::vector<uint32_t>& primitives() const {
+        return m_primitives;
+    }
+
+    size_t depth() const {
+        if (m_nodes.empty()) {
+            return 0;
+        }
+        size_t maxDepth = 0;
+        std::vector<std::pair<uint32_t, size_t>> stack = {{0u, 1}};
+        while (!stack.empty()) {
+            auto [index, depth] = stack.back();
+            stack.pop_back();
+            maxDepth = std::max(maxDepth, depth);
+            if (!m_nodes[index].isLeaf()) {
+                stack.push_back({m_nodes[index].leftOrFirst, depth + 1});
+                stack.push_back({m_nodes[index].leftOrFirst + 1, depth + 1});
+            }
+        }
+        return maxDepth;
+    }
+
+private:
+    struct Split {
+        int axis = -1;
+        float position = 0.0f;
+        float cost = FLT_MAX;
+    };
+
+    static float surfaceArea(const Node& node) {
+        Aabb box{node.boundsMin, node.boundsMax};
+        return box.surfaceArea();
+    }
+
+    void updateNodeBounds(uint32_t nodeIndex, const Aabb* bounds) {
+        Node& node = m_nodes[nodeIndex];
+        Aabb box;
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+            box.grow(bounds[m_primitives[i]]);
+        }
+        node.boundsMin = box.boundsMin;
+        node.boundsMax = box.boundsMax;
+    }
+
+    // 在图元中心的包围盒内，每个轴均匀分成 BIN_COUNT 个桶，在桶的边界上计算SAH代价
+    Split findSplit(const Node& node, const Aabb* bounds) const {
+        Split best;
+        Aabb centerBounds;
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+            centerBounds.grow(m_centers[m_primitives[i]]);
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            float lower = centerBounds.boundsMin[axis];
+            float upper = centerBounds.boundsMax[axis];
+            if (upper <= lower) {
+                continue;
+            }
+            Aabb binBounds[BIN_COUNT];
+            uint32_t binCounts[BIN_COUNT] = {};
+            float scale = BIN_COUNT / (upper - lower);
+            for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+                uint32_t primitive = m_primitives[i];
+                int bin = std::min(BIN_COUNT - 1, static_cast<int>((m_centers[primitive][axis] - lower) * scale));
+                binCounts[bin]++;
+                binBounds[bin].grow(bounds[primitive]);
+            }
+            // 从两端累加，得到每个划分位置左右两边的面积和图元数
+            float leftArea[BIN_COUNT - 1], rightArea[BIN_COUNT - 1];
+            uint32_t leftCount[BIN_COUNT - 1], rightCount[BIN_COUNT - 1];
+            Aabb leftBox, rightBox;
+            uint32_t leftSum = 0, rightSum = 0;
+            for (int i = 0; i < BIN_COUNT - 1; i++) {
+                leftSum += binCounts[i];
+                leftCount[i] = leftSum;
+                leftBox.grow(binBounds[i]);
+                leftArea[i] = leftBox.surfaceArea();
+                rightSum += binCounts[BIN_COUNT - 1 - i];
+                rightCount[BIN_COUNT - 2 - i] = rightSum;
+                rightBox.grow(binBounds[BIN_COUNT - 1 - i]);
+                rightArea[BIN_COUNT - 2 - i] = rightBox.surfaceArea();
+            }
+            for (int i = 0; i < BIN_COUNT - 1; i++) {
+                float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+                if (leftCount[i] > 0 && rightCount[i] > 0 && cost < best.cost) {
+                    best.axis = axis;
+                    best.position = lower + (i + 1) / scale;
+                    best.cost = cost;
+                }
+            }
+        }
+        return best;
+    }
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_primitives;     // 叶子中的图元编号，按叶子的顺序排列
+    std::vector<glm::vec3> m_centers;       // 只在构建时使用
+};
+
+#endif // BVH_H
@@ -4,6 +4,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "camera_path.h"
+#include "frustum.h"
+
 #define ENABLE_FPS_CAMERA
 
 class Camera{
@@ -52,6 +55,35 @@ public:
         return zoom;
     }
 
+    CameraPose getPose() const {
+        CameraPose pose;
+        pose.position = position;
+        pose.orientation = CameraPose::orientationFromAxes(right, up, front);
+        pose.zoom = zoom;
+        return pose;
+    }
+
+    // yaw 和 pitch 由朝向的前方向得到，之后的鼠标移动从这个朝向继续
+    void setPose(const CameraPose& pose) {
+        position = pose.position;
+        front = pose.orientation * glm::vec3(0.0f, 0.0f, -1.0f);
+        right = pose.orientation * glm::vec3(1.0f, 0.0f, 0.0f);
+        up = pose.orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+        yaw = glm::degrees(std::atan2(front.z, front.x));
+        pitch = glm::degrees(std::asin(glm::clamp(front.y, -1.0f, 1.0f)));
+        zoom = pose.zoom;
+    }
+
+    // zoom 为透视投影的 fovy（角度）
+    glm::mat4 getProjectionMatrix(float aspect, float zNear = 0.1f, float zFar = 100.0f) const {
+        return glm::perspective(glm::radians(zoom), aspect, zNear, zFar);
+    }
+
+    // 世界空间中的视锥体，参数与 getProjectionMatrix() 相同
+    Frustum getFrustum(float aspect, float zNear = 0.1f, float zFar = 100.0f) const {
+        return Frustum::fromMatrix(getProjectionMatrix(aspect, zNear, zFar) * getViewMatrix());
+    }
+
     void reset() {
         *this = Camera(m_backup.position, m_backup.up, m_backup.yaw, m_backup.pitch);
     }
@@ -0,0 +1,195 @@
+// 相机路径的录制和回放，使演示程序可以在固定的相机运动下重复运行并对比帧时间
+//  -- CameraPose : 相机的位置、朝向（相机空间到世界空间的旋转，相机看向 -Z）和 zoom（fovy，角度）
+//                  Camera 和 ArcballCamera 都可以通过 getPose()/setPose() 读取和设置
+//  -- CameraPath : 按时间排列的 CameraPose，回放时按任意时间插值（位置和zoom线性插值，朝向球面插值），
+//                  可以保存为紧凑的二进制文件
+// 文件布局（小端）：Header | Key[keyCount]，每个 Key 40字节；格式变化时需要增加 VERSION
+
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct CameraPose {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    float zoom = 45.0f;
+
+    glm::mat4 getViewMatrix() const {
+        glm::mat3 rotation = glm::mat3_cast(orientation);
+        glm::mat4 result = glm::mat4(1.0f);
+        for (int i = 0; i < 3; i++) {
+            result[0][i] = rotation[i].x;
+            result[1][i] = rotation[i].y;
+            result[2][i] = rotation[i].z;
+            result[3][i] = -glm::dot(rotation[i], position);
+        }
+        return result;
+    }
+
+    // 位置和zoom线性插值，朝向球面插值
+    static CameraPose interpolate(const CameraPose& a, const CameraPose& b, float t) {
+        CameraPose result;
+        result.position = glm::mix(a.position, b.position, t);
+        result.orientation = glm::normalize(glm::slerp(a.orientation, b.orientation, t));
+        result.zoom = glm::mix(a.zoom, b.zoom, t);
+        return result;
+    }
+
+    // 由相机的右、上、前方向构造朝向，三个方向需要正交且已归一化
+    static glm::quat orientationFromAxes(const glm::vec3& right, const glm::vec3& up, const glm::vec3& front) {
+        return glm::normalize(glm::quat_cast(glm::mat3(right, up, -front)));
+    }
+};
+
+class CameraPath {
+public:
+    static constexpr char MAGIC[8] = {'L', 'O', 'G', 'L', 'C', 'P', 'T', 'H'};
+    static constexpr uint32_t VERSION = 1;
+
+    struct Key {
+        float time;
+        glm::vec3 position;
+        float orientation[4];   // w, x, y, z
+        float zoom;
+        float padding[1];
+    };
+
+    // 时间需要单调不减，时间与最后一个关键帧相同时替换它；
+    // 比最后一个关键帧早的时间（以及NaN、无穷大）会破坏 sample() 依赖的顺序，不添加并返回false
+    bool add(float time, const CameraPose& pose) {
+        if (!std::isfinite(time) || (!m_keys.empty() && time < m_keys.back().time)) {
+            return false;
+        }
+        Key key = {};
+        key.time = time;
+        key.position = pose.position;
+        key.orientation[0] = pose.orientation.w;
+        key.orientation[1] = pose.orientation.x;
+        key.orientation[2] = pose.orientation.y;
+        key.orientation[3] = pose.orientation.z;
+        key.zoom = pose.zoom;
+        if (!m_keys.empty() && time == m_keys.back().time) {
+            m_keys.back() = key;
+            return true;
+        }
+        m_keys.push_back(key);
+        return true;
+    }
+
+    // 超出录制范围的时间取第一个或最后一个关键帧
+    CameraPose sample(float time) const {
+        if (m_keys.empty()) {
+            return {};
+        }
+        auto next = std::upper_bound(m_keys.begin(), m_keys.end(), time, [](float t, const Key& key) { return t < key.time; });
+        if (next == m_keys.begin()) {
+            return poseOf(m_keys.front());
+        }
+        if (next == m_keys.end()) {
+            return poseOf(m_keys.back());
+        }
+        const Key& previous = *(next - 1);
+        const float t = (time - previous.time) / (next->time - previous.time);
+        return CameraPose::interpolate(poseOf(previous), poseOf(*next), t);
+    }
+
+    float duration() const {
+        return m_keys.empty() ? 0.0f : m_keys.back().time - m_keys.front().time;
+    }
+
+    float startTime() const {
+        return m_keys.empty() ? 0.0f : m_keys.front().time;
+    }
+
+    size_t size() const {
+        return m_keys.size();
+    }
+
+    bool empty() const {
+        return m_keys.empty();
+    }
+
+    void clear() {
+        m_keys.clear();
+    }
+
+    const std::vector<Key>& keys() const {
+        return m_keys;
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.keyCount = static_cast<uint32_t>(m_keys.size());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(m_keys.data()), static_cast<std::streamsize>(sizeof(Key) * m_keys.size()));
+        return static_cast<bool>(file);
+    }
+
+    // 文件不存在、版本不一致、被截断或者关键帧的时间不是递增时返回false，路径保持不变
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return false;
+        }
+        const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        file.seekg(0);
+        Header header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+            return false;
+        }
+        // 先用文件大小检查 keyCount，损坏的文件不会导致分配过多的内存
+        if (static_cast<uint64_t>(header.keyCount) * sizeof(Key) > fileSize - sizeof(Header)) {
+            return false;
+        }
+        std::vector<Key> keys(header.keyCount);
+        if (!file.read(reinterpret_cast<char*>(keys.data()), static_cast<std::streamsize>(sizeof(Key) * keys.size()))) {
+            return false;
+        }
+        for (size_t i = 1; i < keys.size(); i++) {
+            if (!(keys[i - 1].time < keys[i].time)) {
+                return false;
+            }
+        }
+        m_keys = std::move(keys);
+        return true;
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t keyCount;
+    };
+
+    static_assert(sizeof(Header) == 16, "camera path header must not change silently");
+    static_assert(sizeof(Key) == 40, "camera path key must not change silently");
+
+    std::vector<Key> m_keys;
+
+    static CameraPose poseOf(const Key& key) {
+        CameraPose pose;
+        pose.position = key.position;
+        pose.orientation = glm::quat(key.orientation[0], key.orientation[1], key.orientation[2], key.orientation[3]);
+        pose.zoom = key.zoom;
+        return pose;
+    }
+};
+
+#endif // CAMERA_PATH_H
@@ -0,0 +1,182 @@
+// 演示程序的相机录制和回放（见 camera_path.h），回放时以固定的时间步长运行并输出每帧的CPU/GPU时间
+//  -- --record <file> : 正常交互运行，每帧记录相机的状态，退出时保存
+//  -- --replay <file> : 每帧按固定步长推进时间并设置相机，路径结束时退出，以 BenchmarkReport 的格式输出每帧的时间
+//                       回放不需要鼠标输入，应使用 createHeadlessContext() 创建不可见的上下文
+//  -- --fps N         : 回放的步长为 1/N 秒，默认60
+//  -- --out <file>    : 报告的输出位置，不指定时输出到标准输出
+// 构造时不需要OpenGL上下文，可以先根据 replaying() 决定如何创建窗口。用法：
+//     CameraReplay replay(argc, argv, "demo_name");
+//     while (...) {
+//         deltaTime = replay.beginFrame(static_cast<float>(glfwGetTime()));
+//         ... 处理输入
+//         replay.update(camera);
+//         ... 绘制
+//         replay.endFrame();
+//         if (replay.finished()) break;
+//     }
+//     replay.finish(argc, argv);
+
+#ifndef CAMERA_REPLAY_H
+#define CAMERA_REPLAY_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "camera_path.h"
+
+class CameraReplay {
+public:
+    enum class Mode { NONE, RECORD, REPLAY };
+
+    CameraReplay(int argc, char** argv, const std::string& name) : m_name(name) {
+        m_path = getStringArgument(argc, argv, "--replay");
+        if (!m_path.empty()) {
+            if (m_cameraPath.load(m_path) && !m_cameraPath.empty()) {
+                m_mode = Mode::REPLAY;
+                m_timestep = 1.0f / static_cast<float>(std::max(1, getIntArgument(argc, argv, "--fps", 60)));
+            } else {
+                std::cerr << "CameraReplay: Failed to load camera path: " << m_path << std::endl;
+                m_failed = true;
+            }
+            return;
+        }
+        m_path = getStringArgument(argc, argv, "--record");
+        if (!m_path.empty()) {
+            m_mode = Mode::RECORD;
+        }
+    }
+
+    CameraReplay(const CameraReplay&) = delete;
+    CameraReplay& operator=(const CameraReplay&) = delete;
+
+    Mode mode() const {
+        return m_mode;
+    }
+
+    bool replaying() const {
+        return m_mode == Mode::REPLAY;
+    }
+
+    // 指定了 --replay 但路径无法读取
+    bool failed() const {
+        return m_failed;
+    }
+
+    // 返回这一帧使用的 deltaTime：回放时为固定步长，否则为与上一帧真实时间的差
+    float beginFrame(float currentTime) {
+        float deltaTime;
+        if (m_mode == Mode::REPLAY) {
+            deltaTime = m_frame == 0 ? 0.0f : m_timestep;
+            m_time = m_cameraPath.startTime() + m_frame * m_timestep;
+            // GpuTimer 需要OpenGL上下文，第一帧时才创建
+            if (!m_gpuTimer) {
+                m_gpuTimer = std::make_unique<GpuTimer>();
+            }
+            m_cpuTimer.reset();
+            m_gpuTimer->begin();
+        } else {
+            if (m_frame == 0) {
+                m_startTime = currentTime;
+            }
+            deltaTime = m_frame == 0 ? 0.0f : currentTime - m_lastTime;
+            m_lastTime = currentTime;
+            m_time = currentTime - m_startTime;
+        }
+        return deltaTime;
+    }
+
+    // 录制时记录相机的状态，回放时设置相机的状态；CameraType 为 Camera 或者 ArcballCamera
+    template <typename CameraType>
+    void update(CameraType& camera) {
+        if (m_mode == Mode::RECORD) {
+            m_cameraPath.add(m_time, camera.getPose());
+        } else if (m_mode == Mode::REPLAY) {
+            camera.setPose(m_cameraPath.sample(m_time));
+        }
+    }
+
+    // 回放时等待GPU完成这一帧，记录提交和完成的时间
+    void endFrame() {
+        if (m_mode == Mode::REPLAY) {
+            m_gpuTimer->end();
+            double submitMs = m_cpuTimer.elapsedMs();
+            glFinish();
+            m_frames.push_back({m_time, submitMs, m_cpuTimer.elapsedMs(), m_gpuTimer->resultMs()});
+        }
+        m_frame++;
+    }
+
+    bool finished() const {
+        return m_mode == Mode::REPLAY && m_time >= m_cameraPath.startTime() + m_cameraPath.duration();
+    }
+
+    // 录制时保存路径，回放时输出报告
+    bool finish(int argc, char** argv) const {
+        if (m_mode == Mode::RECORD) {
+            if (!m_cameraPath.save(m_path)) {
+                std::cerr << "CameraReplay: Failed to save camera path: " << m_path << std::endl;
+                return false;
+            }
+            return true;
+        }
+        if (m_mode != Mode::REPLAY) {
+            return true;
+        }
+        std::vector<double> submitMs, frameMs, gpuMs;
+        for (const FrameTime& frame : m_frames) {
+            submitMs.push_back(frame.submitMs);
+            frameMs.push_back(frame.frameMs);
+            gpuMs.push_back(frame.gpuMs);
+        }
+        BenchmarkReport report(m_name + "_replay");
+        report.info()
+            .set("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)))
+            .set("camera_path", m_path)
+            .set("frames", m_frames.size())
+            .set("timestep_ms", m_timestep * 1000.0)
+            .set("median_submit_ms", median(submitMs))
+            .set("median_frame_ms", median(frameMs))
+            .set("median_gpu_ms", median(gpuMs));
+        for (size_t i = 0; i < m_frames.size(); i++) {
+            report.addRecord()
+                .set("frame", i)
+                .set("time", static_cast<double>(m_frames[i].time))
+                .set("submit_ms", m_frames[i].submitMs)
+                .set("frame_ms", m_frames[i].frameMs)
+                .set("gpu_ms", m_frames[i].gpuMs);
+        }
+        return report.write(argc, argv);
+    }
+
+private:
+    struct FrameTime {
+        float time;
+        double submitMs;    // 提交这一帧的CPU时间
+        double frameMs;     // 包括等待GPU完成
+        double gpuMs;
+    };
+
+    std::string m_name;
+    std::string m_path;
+    Mode m_mode = Mode::NONE;
+    bool m_failed = false;
+    CameraPath m_cameraPath;
+
+    int m_frame = 0;
+    float m_time = 0.0f;
+    float m_startTime = 0.0f;
+    float m_lastTime = 0.0f;
+    float m_timestep = 1.0f / 60.0f;
+
+    Timer m_cpuTimer;
+    std::unique_ptr<GpuTimer> m_gpuTimer;
+    std::vector<FrameTime> m_frames;
+};
+
+#endif // CAMERA_REPLAY_H
@@ -0,0 +1,551 @@
+// 多线程录制、单线程回放的渲染命令
+//  -- GL调用只能在上下文所在的线程执行；场景遍历（剔除、计算矩阵、选择状态）可以放在工作线程中，
+//     结果录制为紧凑的POD命令（绑定程序、按 location 设置uniform、绑定VAO/纹理、绘制），由GL线程排序并回放
+//  -- CommandBuffer 是一个线程独占的线性缓冲，只追加写入；reset() 保留容量，稳定之后录制不再分配内存
+//  -- 命令按包组织：beginPacket(key) 之后的命令属于同一个包，包是排序的单位（例如一个物体的一次绘制）
+//  -- CommandQueue 为 JobSystem 的每个线程准备一个 CommandBuffer，recorder(jobs) 按当前线程的编号选择；
+//     sort() 收集所有线程的包，按 key 做LSD基数排序（每次8位，所有key在这8位上都相同时跳过这一趟），
+//     execute() 在GL线程中依次回放，跳过与当前状态相同的程序/VAO/纹理/渲染状态
+//  -- uniform 的 location 属于回放时当前的程序，录制者需要使用同一个包中绑定的程序的 location
+//  -- draw_key 按 (pass, 半透明, 程序, 材质, 深度) 生成 key，使状态切换最少，
+//     不透明物体从前到后（利用early-Z），半透明物体从后到前
+// key 相同的包按收集的顺序（线程编号，录制顺序），需要确定的顺序时把物体编号放在 key 的低位
+
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "geometry_pool.h"
+#include "job_system.h"
+
+enum class CommandType : uint16_t {
+    BIND_PROGRAM,
+    BIND_VERTEX_ARRAY,
+    BIND_TEXTURE,
+    UNIFORM_INT,
+    UNIFORM_VEC4,
+    UNIFORM_MAT4,
+    DRAW_ELEMENTS,
+    SET_RENDER_STATE,
+};
+
+// 每个命令之前的头，size 为命令本身的字节数
+struct CommandHeader {
+    CommandType type;
+    uint16_t size;
+};
+
+namespace render_command {
+
+struct BindProgram {
+    static constexpr CommandType TYPE = CommandType::BIND_PROGRAM;
+    GLuint program;
+};
+
+struct BindVertexArray {
+    static constexpr CommandType TYPE = CommandType::BIND_VERTEX_ARRAY;
+    GLuint vertexArray;
+};
+
+// glBindTextureUnit，unit 小于 MAX_TRACKED_TEXTURE_UNITS 时跳过重复的绑定
+struct BindTexture {
+    static constexpr CommandType TYPE = CommandType::BIND_TEXTURE;
+    GLuint unit;
+    GLuint texture;
+};
+
+struct UniformInt {
+    static constexpr CommandType TYPE = CommandType::UNIFORM_INT;
+    GLint location;
+    GLint value;
+};
+
+struct UniformVec4 {
+    static constexpr CommandType TYPE = CommandType::UNIFORM_VEC4;
+    GLint location;
+    glm::vec4 value;
+};
+
+struct UniformMat4 {
+    static constexpr CommandType TYPE = CommandType::UNIFORM_MAT4;
+    GLint location;
+    glm::mat4 value;
+};
+
+// instanceCount 为1时使用 glDrawElementsBaseVertex
+struct DrawElements {
+    static constexpr CommandType TYPE = CommandType::DRAW_ELEMENTS;
+    GLenum mode;
+    GLsizei count;
+    GLenum indexType;
+    uint32_t indexOffset;       // 字节
+    GLint baseVertex;
+    GLsizei instanceCount;
+};
+
+// 默认状态为 DEPTH_WRITE（不混合，写深度），半透明物体通常是 BLEND（不写深度）
+struct SetRenderState {
+    static constexpr CommandType TYPE = CommandType::SET_RENDER_STATE;
+    static constexpr uint32_t BLEND = 1;            // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+    static constexpr uint32_t DEPTH_WRITE = 2;
+    static constexpr uint32_t DEFAULT = DEPTH_WRITE;
+    uint32_t flags;
+};
+
+} // namespace render_command
+
+// 64位的排序key，从高位到低位：
+//     不透明：pass(4) | 0 | 程序(10) | 材质(14) | 深度(16) | 序号(19)
+//     半透明：pass(4) | 1 | 反转的深度(16) | 程序(10) | 材质(14) | 序号(19)
+// 同一个pass中不透明的包在半透明之前；半透明需要从后到前混合，深度在状态之前
+// 材质由调用者编号（例如纹理和VAO的组合），超出位数的值被截断（只影响排序效果，不影响正确性）
+namespace draw_key {
+
+constexpr uint32_t PASS_BITS = 4;
+constexpr uint32_t PROGRAM_BITS = 10;
+constexpr uint32_t MATERIAL_BITS = 14;
+constexpr uint32_t DEPTH_BITS = 16;
+constexpr uint32_t SEQUENCE_BITS = 19;
+static_assert(PASS_BITS + 1 + PROGRAM_BITS + MATERIAL_BITS + DEPTH_BITS + SEQUENCE_BITS == 64, "draw key must use 64 bits");
+
+constexpr uint32_t SEQUENCE_SHIFT = 0;
+constexpr uint32_t TRANSLUCENT_SHIFT = 64 - PASS_BITS - 1;
+constexpr uint32_t PASS_SHIFT = 64 - PASS_BITS;
+
+inline uint64_t field(uint32_t value, uint32_t bits, uint32_t shift) {
+    return (static_cast<uint64_t>(value) & ((uint64_t(1) << bits) - 1)) << shift;
+}
+
+// 相机空间的深度（沿视线方向的距离）按对数分布量化到 DEPTH_BITS 位，近处精度高
+inline uint32_t depthBucket(float viewDepth, float zNear, float zFar) {
+    float t = std::log(std::max(viewDepth, zNear) / zNear) / std::log(zFar / zNear);
+    t = std::min(std::max(t, 0.0f), 1.0f);
+    return static_cast<uint32_t>(t * static_cast<float>((1u << DEPTH_BITS) - 1) + 0.5f);
+}
+
+inline uint64_t opaque(uint32_t pass, uint32_t program, uint32_t material, uint32_t depth, uint32_t sequence = 0) {
+    return field(pass, PASS_BITS, PASS_SHIFT) |
+           field(program, PROGRAM_BITS, SEQUENCE_BITS + DEPTH_BITS + MATERIAL_BITS) |
+           field(material, MATERIAL_BITS, SEQUENCE_BITS + DEPTH_BITS) |
+           field(depth, DEPTH_BITS, SEQUENCE_BITS) |
+           field(sequence, SEQUENCE_BITS, SEQUENCE_SHIFT);
+}
+
+inline uint64_t translucent(uint32_t pass, uint32_t program, uint32_t material, uint32_t depth, uint32_t sequence = 0) {
+    const uint32_t depthMask = (1u << DEPTH_BITS) - 1;
+    return field(pass, PASS_BITS, PASS_SHIFT) |
+           (uint64_t(1) << TRANSLUCENT_SHIFT) |
+           field(depthMask - (depth & depthMask), DEPTH_BITS, SEQUENCE_BITS + MATERIAL_BITS + PROGRAM_BITS) |
+           field(program, PROGRAM_BITS, SEQUENCE_BITS + MATERIAL_BITS) |
+           field(material, MATERIAL_BITS, SEQUENCE_BITS) |
+           field(sequence, SEQUENCE_BITS, SEQUENCE_SHIFT);
+}
+
+inline uint32_t pass(uint64_t key) {
+    return static_cast<uint32_t>(key >> PASS_SHIFT);
+}
+
+inline bool isTranslucent(uint64_t key) {
+    return ((key >> TRANSLUCENT_SHIFT) & 1) != 0;
+}
+
+} // namespace draw_key
+
+class alignas(64) CommandBuffer {
+public:
+    // [begin, end) 为包中的命令在缓冲中的字节范围
+    struct Packet {
+        uint64_t key;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    void reset() {
+        m_size = 0;
+        m_packets.clear();
+    }
+
+    void beginPacket(uint64_t key) {
+        const uint32_t offset = static_cast<uint32_t>(m_size);
+        m_packets.push_back({key, offset, offset});
+    }
+
+    void bindProgram(GLuint program) {
+        write(render_command::BindProgram{program});
+    }
+
+    void bindVertexArray(GLuint vertexArray) {
+        write(render_command::BindVertexArray{vertexArray});
+    }
+
+    void bindTexture(GLuint unit, GLuint texture) {
+        write(render_command::BindTexture{unit, texture});
+    }
+
+    void setRenderState(uint32_t flags) {
+        write(render_command::SetRenderState{flags});
+    }
+
+    void setUniform(GLint location, int value) {
+        write(render_command::UniformInt{location, value});
+    }
+
+    void setUniform(GLint location, const glm::vec4& value) {
+        write(render_command::UniformVec4{location, value});
+    }
+
+    void setUniform(GLint location, const glm::mat4& value) {
+        write(render_command::UniformMat4{location, value});
+    }
+
+    void drawElements(GLenum mode, GLsizei count, GLenum indexType, uint32_t indexOffset, GLint baseVertex = 0,
+                      GLsizei instanceCount = 1) {
+        write(render_command::DrawElements{mode, count, indexType, indexOffset, baseVertex, instanceCount});
+    }
+
+    // 几何池中的网格，需要先绑定 pool.vertexArray()
+    void drawMesh(const PoolMesh& mesh, GLenum mode = GL_TRIANGLES, GLsizei instanceCount = 1) {
+        drawElements(mode, static_cast<GLsizei>(mesh.indexCount), GL_UNSIGNED_INT,
+                     mesh.firstIndex * static_cast<uint32_t>(sizeof(uint32_t)), mesh.baseVertex, instanceCount);
+    }
+
+    // 命令必须写在某个包中
+    template <typename Command>
+    void write(const Command& command) {
+        static_assert(std::is_trivially_copyable<Command>::value, "render commands must be POD");
+        assert(!m_packets.empty() && "beginPacket() must be called before writing commands");
+        const CommandHeader header{Command::TYPE, static_cast<uint16_t>(sizeof(Command))};
+        const size_t size = sizeof(CommandHeader) + sizeof(Command);
+        if (m_size + size > m_data.size()) {
+            m_data.resize(std::max(m_data.size() * 2, m_size + size));
+        }
+        std::memcpy(m_data.data() + m_size, &header, sizeof(CommandHeader));
+        std::memcpy(m_data.data() + m_size + sizeof(CommandHeader), &command, sizeof(Command));
+        m_size += size;
+        m_packets.back().end = static_cast<uint32_t>(m_size);
+    }
+
+    const std::vector<Packet>& packets() const {
+        return m_packets;
+    }
+
+    const unsigned char* data() const {
+        return m_data.data();
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    std::vector<unsigned char> m_data;
+    size_t m_size = 0;
+    std::vector<Packet> m_packets;
+};
+
+class CommandQueue {
+public:
+    static constexpr GLuint MAX_TRACKED_TEXTURE_UNITS = 16;
+
+    explicit CommandQueue(unsigned int bufferCount = 1) : m_buffers(std::max(1u, bufferCount)) {}
+
+    explicit CommandQueue(const JobSystem& jobs) : CommandQueue(jobs.threadCount()) {}
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    CommandBuffer& buffer(size_t index) {
+        return m_buffers[index];
+    }
+
+    // 当前线程的缓冲，只能在 jobs 的线程中调用（其他线程的 threadIndex() 为 -1），缓冲数不能少于 jobs 的线程数
+    CommandBuffer& recorder(const JobSystem& jobs) {
+        const int index = jobs.threadIndex();
+        assert(index >= 0 && static_cast<size_t>(index) < m_buffers.size() && "recorder() called outside the job system's threads");
+        return m_buffers[static_cast<size_t>(index)];
+    }
+
+    size_t bufferCount() const {
+        return m_buffers.size();
+    }
+
+    // 每帧录制之前调用
+    void reset() {
+        for (CommandBuffer& buffer : m_buffers) {
+            buffer.reset();
+        }
+        m_order.clear();
+    }
+
+    // 录制结束后在GL线程调用，key 相同的包保持收集的顺序
+    void sort() {
+        m_order.clear();
+        for (uint32_t b = 0; b < m_buffers.size(); b++) {
+            const auto& packets = m_buffers[b].packets();
+            for (uint32_t p = 0; p < packets.size(); p++) {
+                m_order.push_back({packets[p].key, b, p});
+            }
+        }
+        radixSort();
+    }
+
+    // 按 sort() 的顺序回放，开始时渲染状态需要是默认状态（不混合，写深度）
+    // 结束时程序、VAO和纹理保持最后一次绑定的状态，渲染状态恢复为默认
+    void execute() {
+        m_stats = {};
+        GLuint program = INVALID;
+        GLuint vertexArray = INVALID;
+        uint32_t renderState = render_command::SetRenderState::DEFAULT;
+        GLuint textures[MAX_TRACKED_TEXTURE_UNITS];
+        std::fill(std::begin(textures), std::end(textures), INVALID);
+
+        for (const PacketRef& ref : m_order) {
+            const CommandBuffer& buffer = m_buffers[ref.buffer];
+            const CommandBuffer::Packet& packet = buffer.packets()[ref.packet];
+            const unsigned char* cursor = buffer.data() + packet.begin;
+            const unsigned char* end = buffer.data() + packet.end;
+            while (cursor < end) {
+                CommandHeader header;
+                std::memcpy(&header, cursor, sizeof(CommandHeader));
+                const unsigned char* payload = cursor + sizeof(CommandHeader);
+                cursor = payload + header.size;
+                m_stats.commands++;
+                switch (header.type) {
+                case CommandType::BIND_PROGRAM: {
+                    auto command = read<render_command::BindProgram>(payload);
+                    if (command.program == program) {
+                        m_stats.skippedBinds++;
+                        break;
+                    }
+                    program = command.program;
+                    glUseProgram(program);
+                    m_stats.programBinds++;
+                    break;
+                }
+                case CommandType::BIND_VERTEX_ARRAY: {
+                    auto command = read<render_command::BindVertexArray>(payload);
+                    if (command.vertexArray == vertexArray) {
+                        m_stats.skippedBinds++;
+                        break;
+                    }
+                    vertexArray = command.vertexArray;
+                    glBindVertexArray(vertexArray);
+                    m_stats.vertexArrayBinds++;
+                    break;
+                }
+                case CommandType::BIND_TEXTURE: {
+                    auto command = read<render_command::BindTexture>(payload);
+                    if (command.unit < MAX_TRACKED_TEXTURE_UNITS) {
+                        if (textures[command.unit] == command.texture) {
+                            m_stats.skippedBinds++;
+                            break;
+                        }
+                        textures[command.unit] = command.texture;
+                    }
+                    glBindTextureUnit(command.unit, command.texture);
+                    m_stats.textureBinds++;
+                    break;
+                }
+                case CommandType::UNIFORM_INT: {
+                    auto command = read<render_command::UniformInt>(payload);
+                    glUniform1i(command.location, command.value);
+                    break;
+                }
+                case CommandType::UNIFORM_VEC4: {
+                    auto command = read<render_command::UniformVec4>(payload);
+                    glUniform4fv(command.location, 1, &command.value[0]);
+                    break;
+                }
+                case CommandType::UNIFORM_MAT4: {
+                    auto command = read<render_command::UniformMat4>(payload);
+                    glUniformMatrix4fv(command.location, 1, GL_FALSE, &command.value[0][0]);
+                    break;
+                }
+                case CommandType::DRAW_ELEMENTS: {
+                    auto command = read<render_command::DrawElements>(payload);
+                    const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(command.indexOffset));
+                    if (command.instanceCount == 1) {
+                        glDrawElementsBaseVertex(command.mode, command.count, command.indexType, offset, command.baseVertex);
+                    } else {
+                        glDrawElementsInstancedBaseVertex(command.mode, command.count, command.indexType, offset,
+                                                          command.instanceCount, command.baseVertex);
+                    }
+                    m_stats.draws++;
+                    break;
+                }
+                case CommandType::SET_RENDER_STATE: {
+                    auto command = read<render_command::SetRenderState>(payload);
+                    if (command.flags == renderState) {
+                        m_stats.skippedBinds++;
+                        break;
+                    }
+                    applyRenderState(renderState, command.flags);
+                    renderState = command.flags;
+                    m_stats.renderStateChanges++;
+                    break;
+                }
+                }
+            }
+        }
+        applyRenderState(renderState, render_command::SetRenderState::DEFAULT);
+    }
+
+    // 以下统计对应上一次 sort()/execute()
+    size_t packetCount() const {
+        return m_order.size();
+    }
+
+    // 排序后第 index 个包的 key
+    uint64_t packetKey(size_t index) const {
+        return m_order[index].key;
+    }
+
+    size_t recordedBytes() const {
+        size_t bytes = 0;
+        for (const CommandBuffer& buffer : m_buffers) {
+            bytes += buffer.size();
+        }
+        return bytes;
+    }
+
+    size_t commandCount() const {
+        return m_stats.commands;
+    }
+
+    size_t drawCount() const {
+        return m_stats.draws;
+    }
+
+    // 实际执行的状态切换次数：程序、VAO、纹理绑定和渲染状态
+    size_t stateChangeCount() const {
+        return m_stats.programBinds + m_stats.vertexArrayBinds + m_stats.textureBinds + m_stats.renderStateChanges;
+    }
+
+    size_t programBindCount() const {
+        return m_stats.programBinds;
+    }
+
+    size_t vertexArrayBindCount() const {
+        return m_stats.vertexArrayBinds;
+    }
+
+    size_t textureBindCount() const {
+        return m_stats.textureBinds;
+    }
+
+    size_t renderStateChangeCount() const {
+        return m_stats.renderStateChanges;
+    }
+
+    // 上一次 sort() 实际执行的基数排序趟数（0到8）
+    size_t radixPassCount() const {
+        return m_radixPasses;
+    }
+
+    // 与当前状态相同而跳过的绑定
+    size_t skippedBindCount() const {
+        return m_stats.skippedBinds;
+    }
+
+private:
+    static constexpr GLuint INVALID = 0xFFFFFFFFu;
+
+    struct PacketRef {
+        uint64_t key;
+        uint32_t buffer;
+        uint32_t packet;
+    };
+
+    struct Stats {
+        size_t commands = 0;
+        size_t draws = 0;
+        size_t programBinds = 0;
+        size_t vertexArrayBinds = 0;
+        size_t textureBinds = 0;
+        size_t renderStateChanges = 0;
+        size_t skippedBinds = 0;
+    };
+
+    std::vector<CommandBuffer> m_buffers;
+    std::vector<PacketRef> m_order;
+    std::vector<PacketRef> m_scratch;
+    size_t m_radixPasses = 0;
+    Stats m_stats;
+
+    // LSD基数排序，稳定；一次遍历统计所有8个字节的直方图，某个字节上所有key都相同时跳过这一趟
+    void radixSort() {
+        constexpr int DIGITS = 8;
+        constexpr int RADIX = 256;
+        m_radixPasses = 0;
+        const size_t count = m_order.size();
+        if (count < 2) {
+            return;
+        }
+        std::vector<uint32_t> histograms(DIGITS * RADIX, 0);
+        for (const PacketRef& ref : m_order) {
+            for (int d = 0; d < DIGITS; d++) {
+                histograms[d * RADIX + ((ref.key >> (d * 8)) & 0xFF)]++;
+            }
+        }
+        m_scratch.resize(count);
+        PacketRef* source = m_order.data();
+        PacketRef* target = m_scratch.data();
+        for (int d = 0; d < DIGITS; d++) {
+            uint32_t* histogram = histograms.data() + d * RADIX;
+            const uint32_t shift = static_cast<uint32_t>(d * 8);
+            if (histogram[(source[0].key >> shift) & 0xFF] == count) {
+                continue;
+            }
+            uint32_t offset = 0;
+            for (int digit = 0; digit < RADIX; digit++) {
+                const uint32_t digitCount = histogram[digit];
+                histogram[digit] = offset;
+                offset += digitCount;
+            }
+            for (size_t i = 0; i < count; i++) {
+                target[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+            }
+            std::swap(source, target);
+            m_radixPasses++;
+        }
+        if (source != m_order.data()) {
+            m_order.swap(m_scratch);
+        }
+    }
+
+    static void applyRenderState(uint32_t current, uint32_t flags) {
+        using render_command::SetRenderState;
+        const uint32_t changed = current ^ flags;
+        if (changed & SetRenderState::BLEND) {
+            if (flags & SetRenderState::BLEND) {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            } else {
+                glDisable(GL_BLEND);
+            }
+        }
+        if (changed & SetRenderState::DEPTH_WRITE) {
+            glDepthMask((flags & SetRenderState::DEPTH_WRITE) ? GL_TRUE : GL_FALSE);
+        }
+    }
+
+    template <typename Command>
+    static Command read(const unsigned char* payload) {
+        Command command;
+        std::memcpy(&command, payload, sizeof(Command));
+        return command;
+    }
+};
+
+#endif // COMMAND_BUFFER_H
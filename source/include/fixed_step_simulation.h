@@ -0,0 +1,171 @@
+// 固定步长的模拟：模拟（相机、物体的变换等）以固定的频率运行，渲染线程对最近两步的状态插值
+//  -- 第 tick 步（从0开始）把状态从时间 time 推进到 time + step，时间从 start() 开始计算，
+//     没有跳过的步时 time 为 tick * step，跳过之后 time 包括跳过的时间，与真实时间保持对齐
+//     StepFunction 只接收 (state, tick, time, step)，结果与渲染的帧率和线程的调度无关；
+//     输入按步取得，例如 InputQueue::poll(time + step) 只取出这一步结束之前的事件（见 input_queue.h），
+//     跳过的时间中的输入在跳过之后的第一步中一起取出
+//  -- 每步之后发布快照 (previous, current, tick)，渲染线程 acquire() 取得最新的快照，
+//     用 alpha(snapshot, time) 在 previous 和 current 之间插值（画面比模拟晚一步）
+//  -- 快照在三个缓冲区之间轮换（模拟写一个、渲染读一个、一个等待交换），交换只是一次原子操作，
+//     渲染不会等待模拟，模拟也不会等待渲染或者垂直同步
+//  -- start() 在单独的线程中按真实时间运行；落后时（例如调试断点）一次最多补 MAX_CATCH_UP 步，之后跳过剩余的时间
+//  -- 不调用 start() 时由调用者用 advanceTo(time) 在当前线程推进，用于回放等需要按给定时间运行的情况
+// State 需要可以复制，acquire() 返回的快照在下一次 acquire() 之前有效
+
+#ifndef FIXED_STEP_SIMULATION_H
+#define FIXED_STEP_SIMULATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+template <typename State>
+class FixedStepSimulation {
+public:
+    static constexpr int MAX_CATCH_UP = 8;
+
+    // time 为这一步开始的时间（秒）
+    using StepFunction = std::function<void(State& state, uint64_t tick, double time, double step)>;
+
+    struct Snapshot {
+        State previous;
+        State current;
+        uint64_t tick = 0;      // 已经完成的步数
+        double time = 0.0;      // current 对应的时间，没有跳过的步时为 tick * step
+    };
+
+    FixedStepSimulation(double step, const State& initial, StepFunction stepFunction)
+        : m_step(step), m_stepFunction(std::move(stepFunction)), m_state(initial) {
+        for (Snapshot& snapshot : m_snapshots) {
+            snapshot.previous = initial;
+            snapshot.current = initial;
+        }
+    }
+
+    ~FixedStepSimulation() {
+        stop();
+    }
+
+    FixedStepSimulation(const FixedStepSimulation&) = delete;
+    FixedStepSimulation& operator=(const FixedStepSimulation&) = delete;
+
+    void start() {
+        if (m_running) {
+            return;
+        }
+        m_startTime = Clock::now();
+        m_running = true;
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    void stop() {
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+        m_thread.join();
+    }
+
+    bool running() const {
+        return m_running;
+    }
+
+    double step() const {
+        return m_step;
+    }
+
+    // 从 start() 开始的秒数
+    double time() const {
+        return std::chrono::duration<double>(Clock::now() - m_startTime).count();
+    }
+
+    // 在当前线程中推进到 time（秒），不能与 start() 同时使用
+    void advanceTo(double time) {
+        while (static_cast<double>(m_tick + 1) * m_step <= time) {
+            stepOnce();
+        }
+    }
+
+    // 渲染线程调用，取得最新发布的快照
+    const Snapshot& acquire() {
+        if (m_middle.load(std::memory_order_relaxed) & FRESH) {
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return m_snapshots[m_front];
+    }
+
+    // 时间 time 对应的插值系数：time 从 snapshot.time 到 snapshot.time + step 时从0增加到1
+    float alpha(const Snapshot& snapshot, double time) const {
+        double t = (time - snapshot.time) / m_step;
+        return static_cast<float>(std::min(std::max(t, 0.0), 1.0));
+    }
+
+    // 以下统计只由模拟线程写入
+    uint64_t tickCount() const {
+        return m_tickCount.load(std::memory_order_relaxed);
+    }
+
+    // 落后超过 MAX_CATCH_UP 步时跳过的步数
+    uint64_t skippedTicks() const {
+        return m_skippedTicks.load(std::memory_order_relaxed);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint32_t FRESH = 4;
+    static constexpr uint32_t INDEX_MASK = 3;
+
+    double m_step;
+    StepFunction m_stepFunction;
+    State m_state;
+    uint64_t m_tick = 0;
+    uint64_t m_skipped = 0;                     // 只由模拟线程使用，与 m_skippedTicks 相同
+
+    Snapshot m_snapshots[3];
+    uint32_t m_back = 0;                        // 模拟线程写入
+    std::atomic<uint32_t> m_middle{1};          // 等待交换，FRESH 表示有新的快照
+    uint32_t m_front = 2;                       // 渲染线程读取
+
+    Clock::time_point m_startTime = Clock::now();
+    std::atomic<bool> m_running{false};
+    std::atomic<uint64_t> m_tickCount{0};
+    std::atomic<uint64_t> m_skippedTicks{0};
+    std::thread m_thread;
+
+    void stepOnce() {
+        Snapshot& snapshot = m_snapshots[m_back];
+        snapshot.previous = m_state;
+        m_stepFunction(m_state, m_tick, static_cast<double>(m_tick + m_skipped) * m_step, m_step);
+        m_tick++;
+        snapshot.current = m_state;
+        snapshot.tick = m_tick;
+        snapshot.time = static_cast<double>(m_tick + m_skipped) * m_step;
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+        m_tickCount.store(m_tick, std::memory_order_relaxed);
+    }
+
+    void run() {
+        while (m_running) {
+            // 向上取整，醒来时 time() 一定已经到达这一步的结束时间
+            double stepEnd = static_cast<double>(m_tick + m_skipped + 1) * m_step;
+            std::this_thread::sleep_until(m_startTime + std::chrono::ceil<Clock::duration>(std::chrono::duration<double>(stepEnd)));
+            // 到现在为止应该完成的步数（不包括跳过的）
+            uint64_t due = static_cast<uint64_t>(time() / m_step) - m_skipped;
+            if (due > m_tick + MAX_CATCH_UP) {
+                // 跳过的时间不再模拟，之后的步仍然对齐到 start() 的时间
+                uint64_t skipped = due - m_tick - MAX_CATCH_UP;
+                m_skipped += skipped;
+                m_skippedTicks.store(m_skipped, std::memory_order_relaxed);
+                due -= skipped;
+            }
+            while (m_tick < due && m_running) {
+                stepOnce();
+            }
+        }
+    }
+};
+
+#endif // FIXED_STEP_SIMULATION_H
@@ -0,0 +1,75 @@
+// 视锥体：从 投影 * 视图（* 模型）矩阵中提取6个平面（Gribb & Hartmann 的方法）
+// 平面的法线朝向视锥体内部并且已经归一化，点 p 在平面内侧时 dot(normal, p) + d >= 0
+// 传入的矩阵包含模型矩阵时，得到的是对象空间中的平面
+// 批量剔除大量物体见 frustum_culling.h
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+struct Frustum {
+    // 不使用 NEAR/FAR 作为名字，它们在 windows.h 中是宏
+    enum Plane { PLANE_LEFT = 0, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, PLANE_COUNT };
+    // classifyBox 的结果，用于层次结构的剔除：完全在内侧的节点不需要再测试其中的物体
+    enum Containment { CONTAINMENT_OUTSIDE = 0, CONTAINMENT_INTERSECTING, CONTAINMENT_INSIDE };
+
+    glm::vec4 planes[PLANE_COUNT];     // (normal, d)
+
+    static Frustum fromMatrix(const glm::mat4& matrix) {
+        // glm 的矩阵按列保存，matrix[c][r] 为第r行第c列
+        auto row = [&matrix](int r) { return glm::vec4(matrix[0][r], matrix[1][r], matrix[2][r], matrix[3][r]); };
+        Frustum frustum;
+        frustum.planes[PLANE_LEFT] = row(3) + row(0);
+        frustum.planes[PLANE_RIGHT] = row(3) - row(0);
+        frustum.planes[PLANE_BOTTOM] = row(3) + row(1);
+        frustum.planes[PLANE_TOP] = row(3) - row(1);
+        frustum.planes[PLANE_NEAR] = row(3) + row(2);
+        frustum.planes[PLANE_FAR] = row(3) - row(2);
+        for (auto& plane : frustum.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    // 球体完全在某个平面外侧时返回false（保守测试，视锥体角落附近的球可能误判为可见）
+    bool intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // AABB用中心和半边长表示，投影到平面法线上的半径为 |n| · extent
+    bool intersectsBox(const glm::vec3& center, const glm::vec3& extent) const {
+        for (const auto& plane : planes) {
+            float radius = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 与 intersectsBox 相同的测试，另外区分AABB是否完全在所有平面的内侧
+    Containment classifyBox(const glm::vec3& center, const glm::vec3& extent) const {
+        Containment result = CONTAINMENT_INSIDE;
+        for (const auto& plane : planes) {
+            float radius = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+            float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            if (distance < -radius) {
+                return CONTAINMENT_OUTSIDE;
+            }
+            if (distance < radius) {
+                result = CONTAINMENT_INTERSECTING;
+            }
+        }
+        return result;
+    }
+};
+
+#endif // FRUSTUM_H
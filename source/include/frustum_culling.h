@@ -0,0 +1,393 @@
+// 批量视锥剔除：大量物体的包围球或AABB以SoA方式保存，一次测试多个物体，输出紧凑的可见物体编号列表
+//  -- AVX2：每次8个物体，用查表 + _mm256_permutevar8x32_epi32 直接写出可见编号
+//  -- SSE2：每次4个物体，逐位写出可见编号
+//  -- 没有SIMD时使用标量实现（Frustum::intersectsSphere / intersectsBox），各实现的结果完全相同
+// SIMD实现按与标量实现相同的顺序计算，没有使用FMA，因此边界上的物体也会得到相同的结果
+// （ENABLE_AVX2 同时关闭了编译器的FMA合并(-ffp-contract=off)，否则标量实现中的乘加可能被合并而产生不同的舍入）
+// 多线程版本把数组分成连续的几段，每个线程把结果写在输出数组中自己那一段的开头，最后按顺序合并，
+// 结果与单线程相同；传入 JobSystem 的版本每段固定 JOB_BATCHES 批，由 parallelFor 分配给各个线程
+// 输出数组 visible 至少需要 paddedSize() 个元素（SIMD实现会整批写入）
+
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "frustum.h"
+#include "job_system.h"
+#include "simd.h"
+
+namespace frustum_culling {
+
+// SoA数组的长度补齐到 BATCH 的倍数，补齐的元素半径为 PADDING_RADIUS，总是被剔除
+constexpr size_t BATCH = 8;
+constexpr size_t JOB_BATCHES = 256;
+constexpr float PADDING_RADIUS = -1e30f;
+
+inline size_t paddedCount(size_t count) {
+    return (count + BATCH - 1) / BATCH * BATCH;
+}
+
+struct SphereArrays {
+    std::vector<float> centerX, centerY, centerZ, radius;
+    size_t count = 0;
+
+    void resize(size_t newCount) {
+        size_t padded = paddedCount(newCount);
+        for (auto* array : {&centerX, &centerY, &centerZ, &radius}) {
+            array->resize(padded, 0.0f);
+        }
+        std::fill(radius.begin() + newCount, radius.end(), PADDING_RADIUS);
+        count = newCount;
+    }
+
+    void set(size_t i, const glm::vec3& center, float sphereRadius) {
+        centerX[i] = center.x;
+        centerY[i] = center.y;
+        centerZ[i] = center.z;
+        radius[i] = sphereRadius;
+    }
+
+    size_t paddedSize() const {
+        return radius.size();
+    }
+};
+
+// AABB以中心和半边长保存
+struct BoxArrays {
+    std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ;
+    size_t count = 0;
+
+    void resize(size_t newCount) {
+        size_t padded = paddedCount(newCount);
+        for (auto* array : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ}) {
+            array->resize(padded, 0.0f);
+        }
+        for (auto* array : {&extentX, &extentY, &extentZ}) {
+            std::fill(array->begin() + newCount, array->end(), PADDING_RADIUS);
+        }
+        count = newCount;
+    }
+
+    void set(size_t i, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+        centerX[i] = center.x;
+        centerY[i] = center.y;
+        centerZ[i] = center.z;
+        extentX[i] = extent.x;
+        extentY[i] = extent.y;
+        extentZ[i] = extent.z;
+    }
+
+    size_t paddedSize() const {
+        return centerX.size();
+    }
+};
+
+namespace detail {
+
+// [begin, end) 中 begin 是 BATCH 的倍数，end 是 BATCH 的倍数或者等于 count
+inline size_t cullRangeScalar(const Frustum& frustum, const SphereArrays& spheres, size_t begin, size_t end, uint32_t* visible) {
+    size_t visibleCount = 0;
+    end = std::min(end, spheres.count);
+    for (size_t i = begin; i < end; i++) {
+        if (frustum.intersectsSphere(glm::vec3(spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]), spheres.radius[i])) {
+            visible[visibleCount++] = static_cast<uint32_t>(i);
+        }
+    }
+    return visibleCount;
+}
+
+inline size_t cullRangeScalar(const Frustum& frustum, const BoxArrays& boxes, size_t begin, size_t end, uint32_t* visible) {
+    size_t visibleCount = 0;
+    end = std::min(end, boxes.count);
+    for (size_t i = begin; i < end; i++) {
+        if (frustum.intersectsBox(glm::vec3(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]),
+                                  glm::vec3(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]))) {
+            visible[visibleCount++] = static_cast<uint32_t>(i);
+        }
+    }
+    return visibleCount;
+}
+
+#if defined(SIMD_AVX2)
+
+// 8位掩码 -> 为1的位的下标，用于把可见的编号移到寄存器的前面
+struct CompactionTable {
+    uint32_t lanes[256][8] = {};
+
+    constexpr CompactionTable() {
+        for (int mask = 0; mask < 256; mask++) {
+            int count = 0;
+            for (int lane = 0; lane < 8; lane++) {
+                if (mask & (1 << lane)) {
+                    lanes[mask][count++] = static_cast<uint32_t>(lane);
+                }
+            }
+        }
+    }
+};
+
+inline constexpr CompactionTable COMPACTION_TABLE{};
+
+struct SimdPlanes {
+    __m256 x[Frustum::PLANE_COUNT], y[Frustum::PLANE_COUNT], z[Frustum::PLANE_COUNT], w[Frustum::PLANE_COUNT];
+    __m256 absX[Frustum::PLANE_COUNT], absY[Frustum::PLANE_COUNT], absZ[Frustum::PLANE_COUNT];
+
+    explicit SimdPlanes(const Frustum& frustum) {
+        for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            x[p] = _mm256_set1_ps(plane.x);
+            y[p] = _mm256_set1_ps(plane.y);
+            z[p] = _mm256_set1_ps(plane.z);
+            w[p] = _mm256_set1_ps(plane.w);
+            absX[p] = _mm256_set1_ps(std::abs(plane.x));
+            absY[p] = _mm256_set1_ps(std::abs(plane.y));
+            absZ[p] = _mm256_set1_ps(std::abs(plane.z));
+        }
+    }
+
+    // ((nx * x + ny * y) + nz * z) + w，与 glm::dot(normal, center) + w 的顺序相同
+    __m256 distance(int p, __m256 cx, __m256 cy, __m256 cz) const {
+        __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x[p], cx), _mm256_mul_ps(y[p], cy)), _mm256_mul_ps(z[p], cz));
+        return _mm256_add_ps(dot, w[p]);
+    }
+};
+
+inline size_t writeVisible(int mask, size_t base, uint32_t* visible) {
+    __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(COMPACTION_TABLE.lanes[mask]));
+    __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(base)), lanes);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(visible), indices);
+    return static_cast<size_t>(popCount(static_cast<uint32_t>(mask)));
+}
+
+inline size_t cullRange(const Frustum& frustum, const SphereArrays& spheres, size_t begin, size_t end, uint32_t* visible) {
+    const SimdPlanes planes(frustum);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    end = std::min(paddedCount(end), spheres.paddedSize());
+    size_t visibleCount = 0;
+    for (size_t i = begin; i < end; i += 8) {
+        __m256 x = _mm256_loadu_ps(&spheres.centerX[i]);
+        __m256 y = _mm256_loadu_ps(&spheres.centerY[i]);
+        __m256 z = _mm256_loadu_ps(&spheres.centerZ[i]);
+        __m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(&spheres.radius[i]), signMask);
+        __m256 inside = _mm256_cmp_ps(planes.distance(0, x, y, z), negativeRadius, _CMP_GE_OQ);
+        for (int p = 1; p < Frustum::PLANE_COUNT; p++) {
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(planes.distance(p, x, y, z), negativeRadius, _CMP_GE_OQ));
+        }
+        visibleCount += writeVisible(_mm256_movemask_ps(inside), i, visible + visibleCount);
+    }
+    return visibleCount;
+}
+
+inline size_t cullRange(const Frustum& frustum, const BoxArrays& boxes, size_t begin, size_t end, uint32_t* visible) {
+    const SimdPlanes planes(frustum);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    end = std::min(paddedCount(end), boxes.paddedSize());
+    size_t visibleCount = 0;
+    for (size_t i = begin; i < end; i += 8) {
+        __m256 x = _mm256_loadu_ps(&boxes.centerX[i]);
+        __m256 y = _mm256_loadu_ps(&boxes.centerY[i]);
+        __m256 z = _mm256_loadu_ps(&boxes.centerZ[i]);
+        __m256 ex = _mm256_loadu_ps(&boxes.extentX[i]);
+        __m256 ey = _mm256_loadu_ps(&boxes.extentY[i]);
+        __m256 ez = _mm256_loadu_ps(&boxes.extentZ[i]);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planes.absX[p], ex), _mm256_mul_ps(planes.absY[p], ey)),
+                                          _mm256_mul_ps(planes.absZ[p], ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(planes.distance(p, x, y, z), _mm256_xor_ps(radius, signMask), _CMP_GE_OQ));
+        }
+        visibleCount += writeVisible(_mm256_movemask_ps(inside), i, visible + visibleCount);
+    }
+    return visibleCount;
+}
+
+#elif defined(SIMD_SSE2)
+
+struct SimdPlanes {
+    __m128 x[Frustum::PLANE_COUNT], y[Frustum::PLANE_COUNT], z[Frustum::PLANE_COUNT], w[Frustum::PLANE_COUNT];
+    __m128 absX[Frustum::PLANE_COUNT], absY[Frustum::PLANE_COUNT], absZ[Frustum::PLANE_COUNT];
+
+    explicit SimdPlanes(const Frustum& frustum) {
+        for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            x[p] = _mm_set1_ps(plane.x);
+            y[p] = _mm_set1_ps(plane.y);
+            z[p] = _mm_set1_ps(plane.z);
+            w[p] = _mm_set1_ps(plane.w);
+            absX[p] = _mm_set1_ps(std::abs(plane.x));
+            absY[p] = _mm_set1_ps(std::abs(plane.y));
+            absZ[p] = _mm_set1_ps(std::abs(plane.z));
+        }
+    }
+
+    __m128 distance(int p, __m128 cx, __m128 cy, __m128 cz) const {
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x[p], cx), _mm_mul_ps(y[p], cy)), _mm_mul_ps(z[p], cz));
+        return _mm_add_ps(dot, w[p]);
+    }
+};
+
+inline size_t writeVisible(int mask, size_t base, uint32_t* visible) {
+    size_t count = 0;
+    while (mask != 0) {
+        visible[count++] = static_cast<uint32_t>(base + countTrailingZeros(static_cast<uint32_t>(mask)));
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+inline size_t cullRange(const Frustum& frustum, const SphereArrays& spheres, size_t begin, size_t end, uint32_t* visible) {
+    const SimdPlanes planes(frustum);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    end = std::min(paddedCount(end), spheres.paddedSize());
+    size_t visibleCount = 0;
+    for (size_t i = begin; i < end; i += 4) {
+        __m128 x = _mm_loadu_ps(&spheres.centerX[i]);
+        __m128 y = _mm_loadu_ps(&spheres.centerY[i]);
+        __m128 z = _mm_loadu_ps(&spheres.centerZ[i]);
+        __m128 negativeRadius = _mm_xor_ps(_mm_loadu_ps(&spheres.radius[i]), signMask);
+        __m128 inside = _mm_cmpge_ps(planes.distance(0, x, y, z), negativeRadius);
+        for (int p = 1; p < Frustum::PLANE_COUNT; p++) {
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(planes.distance(p, x, y, z), negativeRadius));
+        }
+        visibleCount += writeVisible(_mm_movemask_ps(inside), i, visible + visibleCount);
+    }
+    return visibleCount;
+}
+
+inline size_t cullRange(const Frustum& frustum, const BoxArrays& boxes, size_t begin, size_t end, uint32_t* visible) {
+    const SimdPlanes planes(frustum);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    end = std::min(paddedCount(end), boxes.paddedSize());
+    size_t visibleCount = 0;
+    for (size_t i = begin; i < end; i += 4) {
+        __m128 x = _mm_loadu_ps(&boxes.centerX[i]);
+        __m128 y = _mm_loadu_ps(&boxes.centerY[i]);
+        __m128 z = _mm_loadu_ps(&boxes.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.absX[p], ex), _mm_mul_ps(planes.absY[p], ey)),
+                                       _mm_mul_ps(planes.absZ[p], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(planes.distance(p, x, y, z), _mm_xor_ps(radius, signMask)));
+        }
+        visibleCount += writeVisible(_mm_movemask_ps(inside), i, visible + visibleCount);
+    }
+    return visibleCount;
+}
+
+#else
+
+template <typename Arrays>
+size_t cullRange(const Frustum& frustum, const Arrays& arrays, size_t begin, size_t end, uint32_t* visible) {
+    return cullRangeScalar(frustum, arrays, begin, end, visible);
+}
+
+#endif
+
+template <typename Arrays>
+size_t cullParallel(const Frustum& frustum, const Arrays& arrays, uint32_t* visible, unsigned int threadCount) {
+    const size_t batches = paddedCount(arrays.count) / BATCH;
+    threadCount = std::max(1u, std::min<unsigned int>(threadCount, static_cast<unsigned int>(batches)));
+    if (threadCount <= 1) {
+        return cullRange(frustum, arrays, 0, arrays.count, visible);
+    }
+    std::vector<size_t> begins(threadCount + 1);
+    for (unsigned int t = 0; t <= threadCount; t++) {
+        begins[t] = std::min(arrays.count, batches * t / threadCount * BATCH);
+    }
+    std::vector<size_t> counts(threadCount);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threadCount; t++) {
+        threads.emplace_back([&, t]() {
+            counts[t] = cullRange(frustum, arrays, begins[t], begins[t + 1], visible + begins[t]);
+        });
+    }
+    counts[0] = cullRange(frustum, arrays, begins[0], begins[1], visible);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // 把每一段的结果依次移到前面，目标位置总是不超过源位置；前面的段都没有剔除时位置相同，不需要移动
+    size_t visibleCount = counts[0];
+    for (unsigned int t = 1; t < threadCount; t++) {
+        if (visibleCount != begins[t]) {
+            std::copy(visible + begins[t], visible + begins[t] + counts[t], visible + visibleCount);
+        }
+        visibleCount += counts[t];
+    }
+    return visibleCount;
+}
+
+template <typename Arrays>
+size_t cullJobs(JobSystem& jobs, const Frustum& frustum, const Arrays& arrays, uint32_t* visible) {
+    const size_t segment = JOB_BATCHES * BATCH;
+    const size_t segmentCount = (arrays.count + segment - 1) / segment;
+    if (segmentCount <= 1) {
+        return cullRange(frustum, arrays, 0, arrays.count, visible);
+    }
+    std::vector<size_t> counts(segmentCount);
+    jobs.parallelFor(0, segmentCount, 1, [&](size_t first, size_t last) {
+        for (size_t s = first; s < last; s++) {
+            const size_t begin = s * segment;
+            counts[s] = cullRange(frustum, arrays, begin, std::min(arrays.count, begin + segment), visible + begin);
+        }
+    });
+    size_t visibleCount = counts[0];
+    for (size_t s = 1; s < segmentCount; s++) {
+        if (visibleCount != s * segment) {
+            std::copy(visible + s * segment, visible + s * segment + counts[s], visible + visibleCount);
+        }
+        visibleCount += counts[s];
+    }
+    return visibleCount;
+}
+
+} // namespace detail
+
+// 以下函数都返回可见物体的个数，编号按从小到大的顺序写入 visible
+inline size_t cullSpheresScalar(const Frustum& frustum, const SphereArrays& spheres, uint32_t* visible) {
+    return detail::cullRangeScalar(frustum, spheres, 0, spheres.count, visible);
+}
+
+inline size_t cullSpheres(const Frustum& frustum, const SphereArrays& spheres, uint32_t* visible) {
+    return detail::cullRange(frustum, spheres, 0, spheres.count, visible);
+}
+
+inline size_t cullSpheresParallel(const Frustum& frustum, const SphereArrays& spheres, uint32_t* visible,
+                                  unsigned int threadCount = std::thread::hardware_concurrency()) {
+    return detail::cullParallel(frustum, spheres, visible, threadCount);
+}
+
+inline size_t cullSpheresParallel(JobSystem& jobs, const Frustum& frustum, const SphereArrays& spheres, uint32_t* visible) {
+    return detail::cullJobs(jobs, frustum, spheres, visible);
+}
+
+inline size_t cullBoxesScalar(const Frustum& frustum, const BoxArrays& boxes, uint32_t* visible) {
+    return detail::cullRangeScalar(frustum, boxes, 0, boxes.count, visible);
+}
+
+inline size_t cullBoxes(const Frustum& frustum, const BoxArrays& boxes, uint32_t* visible) {
+    return detail::cullRange(frustum, boxes, 0, boxes.count, visible);
+}
+
+inline size_t cullBoxesParallel(const Frustum& frustum, const BoxArrays& boxes, uint32_t* visible,
+                                unsigned int threadCount = std::thread::hardware_concurrency()) {
+    return detail::cullParallel(frustum, boxes, visible, threadCount);
+}
+
+inline size_t cullBoxesParallel(JobSystem& jobs, const Frustum& frustum, const BoxArrays& boxes, uint32_t* visible) {
+    return detail::cullJobs(jobs, frustum, boxes, visible);
+}
+
+} // namespace frustum_culling
+
+#endif // FRUSTUM_CULLING_H
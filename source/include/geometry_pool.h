@@ -0,0 +1,280 @@
+#ifndef GEOMETRY_POOL_H
+#define GEOMETRY_POOL_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "vertex_format.h"
+
+// 区间分配器，在 [0, capacity) 上分配连续的区间，单位由使用者决定（顶点个数或索引个数）
+// 空闲区间按起始位置保存在有序表中：分配时首次适配，释放时与相邻的空闲区间合并
+class RangeAllocator {
+public:
+    static constexpr uint32_t INVALID_OFFSET = 0xFFFFFFFFu;
+
+    explicit RangeAllocator(uint32_t capacity = 0) : m_capacity(capacity) {
+        if (capacity > 0) {
+            m_freeBlocks[0] = capacity;
+        }
+    }
+
+    // 分配失败返回 INVALID_OFFSET
+    uint32_t allocate(uint32_t size) {
+        if (size == 0) {
+            return INVALID_OFFSET;
+        }
+        for (auto it = m_freeBlocks.begin(); it != m_freeBlocks.end(); ++it) {
+            if (it->second < size) {
+                continue;
+            }
+            uint32_t offset = it->first;
+            uint32_t remaining = it->second - size;
+            m_freeBlocks.erase(it);
+            if (remaining > 0) {
+                m_freeBlocks[offset + size] = remaining;
+            }
+            m_usedSize += size;
+            return offset;
+        }
+        return INVALID_OFFSET;
+    }
+
+    void free(uint32_t offset, uint32_t size) {
+        if (size == 0 || offset == INVALID_OFFSET) {
+            return;
+        }
+        m_usedSize -= size;
+        auto next = m_freeBlocks.lower_bound(offset);
+        // 与后一个空闲区间合并
+        if (next != m_freeBlocks.end() && offset + size == next->first) {
+            size += next->second;
+            next = m_freeBlocks.erase(next);
+        }
+        // 与前一个空闲区间合并
+        if (next != m_freeBlocks.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                prev->second += size;
+                return;
+            }
+        }
+        m_freeBlocks[offset] = size;
+    }
+
+    // 扩大容量，新增部分作为空闲区间加入
+    void grow(uint32_t newCapacity) {
+        if (newCapacity <= m_capacity) {
+            return;
+        }
+        uint32_t oldCapacity = m_capacity;
+        m_capacity = newCapacity;
+        m_usedSize += newCapacity - oldCapacity;
+        free(oldCapacity, newCapacity - oldCapacity);
+    }
+
+    uint32_t capacity() const {
+        return m_capacity;
+    }
+
+    uint32_t usedSize() const {
+        return m_usedSize;
+    }
+
+    size_t freeBlockCount() const {
+        return m_freeBlocks.size();
+    }
+
+private:
+    uint32_t m_capacity;
+    uint32_t m_usedSize = 0;
+    std::map<uint32_t, uint32_t> m_freeBlocks;
+};
+
+// 一个网格在几何池中的位置，绘制时配合 baseVertex/firstIndex 使用
+struct PoolMesh {
+    int32_t baseVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+
+    bool valid() const {
+        return indexCount > 0;
+    }
+};
+
+// 几何池：同一种顶点格式的所有网格共享一个大的VBO和IBO，以及一个VAO
+//  -- 顶点和索引区间分别由 RangeAllocator 管理，容量不足时缓冲会翻倍扩容
+//  -- 索引统一为32位，保存的是网格内部的顶点编号，绘制时通过 baseVertex 偏移
+//  -- 切换网格不需要切换VAO，bind() 一次之后可以连续调用 draw()
+class GeometryPool {
+public:
+    GeometryPool(const VertexFormat& format, uint32_t vertexCapacity = 65536, uint32_t indexCapacity = 3 * 65536)
+        : m_format(format), m_vertexAllocator(vertexCapacity), m_indexAllocator(indexCapacity) {
+        glGenVertexArrays(1, &m_vao);
+        m_vbo = createBuffer(static_cast<size_t>(vertexCapacity) * m_format.stride);
+        m_ebo = createBuffer(static_cast<size_t>(indexCapacity) * sizeof(uint32_t));
+
+        // 属性格式需要绑定VAO来设置，之后恢复调用者绑定的VAO
+        GLint previousVertexArray = 0;
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+        glBindVertexArray(m_vao);
+        m_format.apply(0);
+        glBindVertexArray(static_cast<GLuint>(previousVertexArray));
+        attachBuffers();
+    }
+
+    ~GeometryPool() {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ebo);
+    }
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    // vertices 按照池的顶点格式排列，indices 是网格内部的顶点编号
+    PoolMesh allocate(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount) {
+        PoolMesh mesh;
+        uint32_t vertexOffset = allocateRange(m_vertexAllocator, vertexCount, m_vbo, m_format.stride);
+        uint32_t indexOffset = allocateRange(m_indexAllocator, indexCount, m_ebo, sizeof(uint32_t));
+        if (vertexOffset == RangeAllocator::INVALID_OFFSET || indexOffset == RangeAllocator::INVALID_OFFSET) {
+            m_vertexAllocator.free(vertexOffset, vertexCount);
+            m_indexAllocator.free(indexOffset, indexCount);
+            return mesh;
+        }
+
+        mesh.baseVertex = static_cast<int32_t>(vertexOffset);
+        mesh.vertexCount = vertexCount;
+        mesh.firstIndex = indexOffset;
+        mesh.indexCount = indexCount;
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(vertexOffset) * m_format.stride,
+                        static_cast<GLsizeiptr>(vertexCount) * m_format.stride, vertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(indexOffset) * sizeof(uint32_t),
+                        static_cast<GLsizeiptr>(indexCount) * sizeof(uint32_t), indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return mesh;
+    }
+
+    // 只分配索引，与 vertexSource 共享顶点，用于同一组顶点的多个索引列表（例如 LOD）
+    // 返回的网格 vertexCount 为0，free() 时只释放索引区间
+    PoolMesh allocateIndices(const PoolMesh& vertexSource, const uint32_t* indices, uint32_t indexCount) {
+        PoolMesh mesh;
+        uint32_t indexOffset = allocateRange(m_indexAllocator, indexCount, m_ebo, sizeof(uint32_t));
+        if (indexOffset == RangeAllocator::INVALID_OFFSET) {
+            return mesh;
+        }
+        mesh.baseVertex = vertexSource.baseVertex;
+        mesh.firstIndex = indexOffset;
+        mesh.indexCount = indexCount;
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(indexOffset) * sizeof(uint32_t),
+                        static_cast<GLsizeiptr>(indexCount) * sizeof(uint32_t), indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return mesh;
+    }
+
+    void free(PoolMesh& mesh) {
+        if (!mesh.valid()) {
+            return;
+        }
+        m_vertexAllocator.free(static_cast<uint32_t>(mesh.baseVertex), mesh.vertexCount);
+        m_indexAllocator.free(mesh.firstIndex, mesh.indexCount);
+        mesh = PoolMesh();
+    }
+
+    void bind() const {
+        glBindVertexArray(m_vao);
+    }
+
+    // 需要先调用 bind()
+    void draw(const PoolMesh& mesh, GLenum mode = GL_TRIANGLES) const {
+        glDrawElementsBaseVertex(mode, static_cast<GLsizei>(mesh.indexCount), GL_UNSIGNED_INT,
+                                 (void*)(static_cast<uintptr_t>(mesh.firstIndex) * sizeof(uint32_t)), mesh.baseVertex);
+    }
+
+    const VertexFormat& format() const {
+        return m_format;
+    }
+
+    GLuint vertexArray() const {
+        return m_vao;
+    }
+
+    GLuint vertexBuffer() const {
+        return m_vbo;
+    }
+
+    GLuint indexBuffer() const {
+        return m_ebo;
+    }
+
+    const RangeAllocator& vertexAllocator() const {
+        return m_vertexAllocator;
+    }
+
+    const RangeAllocator& indexAllocator() const {
+        return m_indexAllocator;
+    }
+
+private:
+    VertexFormat m_format;
+    RangeAllocator m_vertexAllocator;
+    RangeAllocator m_indexAllocator;
+
+    GLuint m_vao;
+    GLuint m_vbo;
+    GLuint m_ebo;
+
+    // 通过 GL_COPY_WRITE_BUFFER 创建，不影响当前VAO的 GL_ELEMENT_ARRAY_BUFFER
+    static GLuint createBuffer(size_t size) {
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+
+    // 直接设置 m_vao 的顶点缓冲和索引缓冲（DSA），不改变当前绑定的VAO
+    void attachBuffers() const {
+        glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, m_format.stride);
+        glVertexArrayElementBuffer(m_vao, m_ebo);
+    }
+
+    // 分配失败时把缓冲扩容到能容纳本次分配，然后再分配一次
+    uint32_t allocateRange(RangeAllocator& allocator, uint32_t count, GLuint& buffer, size_t elementSize) {
+        uint32_t offset = allocator.allocate(count);
+        if (offset != RangeAllocator::INVALID_OFFSET || count == 0) {
+            return offset;
+        }
+        uint32_t oldCapacity = allocator.capacity();
+        uint32_t newCapacity = oldCapacity > 0 ? oldCapacity : count;
+        while (newCapacity < oldCapacity + count) {
+            newCapacity *= 2;
+        }
+
+        GLuint newBuffer = createBuffer(static_cast<size_t>(newCapacity) * elementSize);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldCapacity) * elementSize);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = newBuffer;
+
+        attachBuffers();
+
+        allocator.grow(newCapacity);
+        return allocator.allocate(count);
+    }
+};
+
+#endif // GEOMETRY_POOL_H
@@ -1,27 +1,15 @@
-// 该文件中包含了glfw需要的回调函数，以及camera相关的交互函数 ：
+// 该文件中包含了glfw需要的回调函数，以及把一帧的输入应用到相机的函数 ：
 //  -- glfw_error_callback
 //  -- framebuffer_size_callback
-//  -- mouse_callback
-//  -- scroll_callback
-//  -- processInput
-// 你需要提前定义SCREEN_WIDTH 和 SCREEN_HEIGHT
-// 你需要提前包含camera.h 或者 arcball_camera.h中的一种，且只能包含一种
-// 你需要提前定义名为camera的相机类
+//  -- applyCameraInput : 输入来自 InputQueue::poll()（见 input_queue.h），鼠标、滚轮和按键的回调由 InputQueue 设置
+// 你需要提前包含camera.h 或者 arcball_camera.h（可以都包含），只会定义已包含的相机类型对应的函数
 
 #ifndef GLFW_CALLBACK_H
 #define GLFW_CALLBACK_H
 
-// comon for both camera types
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
+#include <cstdio>
 
-float lastX = SCREEN_WIDTH / 2.0f;
-float lastY = SCREEN_HEIGHT / 2.0f;
-bool firstMouse = true;
-
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
-    camera.processMouseScroll(static_cast<float>(yoffset));
-}
+#include "input_queue.h"
 
 void glfw_error_callback(int error, const char* description)
 {
@@ -35,47 +23,27 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 /* ------------------------------------------ FPS camera specific --------------------------------------*/
 #ifdef ENABLE_FPS_CAMERA
 
-void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
-    float xpos = static_cast<float>(xposIn);
-    float ypos = static_cast<float>(yposIn);
-
-    if (firstMouse) {
-        lastX = xpos;
-        lastY = ypos;
-        firstMouse = false;
-    }
-
-    float xoffset = xpos - lastX;
-    float yoffset = lastY - ypos;
-
-    lastX = xpos;
-    lastY = ypos;
-
-    camera.processMouseMovement(xoffset, yoffset);
-}
-
-void processInput(GLFWwindow* window) {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-
-    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS){
+// F 切换冻结状态，WASD移动（按住 Shift 加速），鼠标移动改变视线方向
+void applyCameraInput(const InputFrame& input, Camera& camera, float deltaTime) {
+    if (input.keyPressed(GLFW_KEY_F)) {
         camera.changeFreezedState();
     }
-
-    float factor = 1.0f;
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
-        factor = 2.0f;
+    for (const MouseMotion& motion : input.motions) {
+        camera.processMouseMovement(motion.delta.x, -motion.delta.y);
     }
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS){
+    camera.processMouseScroll(input.scroll.y);
+
+    float factor = input.keyDown(GLFW_KEY_LEFT_SHIFT) ? 2.0f : 1.0f;
+    if (input.keyDown(GLFW_KEY_W)) {
         camera.processKeyboard(Camera::MOVEDIRECTION::FORWARD, deltaTime, factor);
     }
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS){
+    if (input.keyDown(GLFW_KEY_S)) {
         camera.processKeyboard(Camera::MOVEDIRECTION::BACKWARD, deltaTime, factor);
     }
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS){
+    if (input.keyDown(GLFW_KEY_A)) {
         camera.processKeyboard(Camera::MOVEDIRECTION::LEFT, deltaTime, factor);
     }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS){
+    if (input.keyDown(GLFW_KEY_D)) {
         camera.processKeyboard(Camera::MOVEDIRECTION::RIGHT, deltaTime, factor);
     }
 }
@@ -86,61 +54,24 @@ void processInput(GLFWwindow* window) {
 
 #ifdef ENABLE_ARCBALL_CAMERA
 
-bool isPlanning = false;
-bool isRotating = false;
-bool isGuiFocused = false;
-
-void mouse_callback(GLFWwindow* window, double xposIn, double yposIn){
-    if(isGuiFocused){
+// 按住左键拖动时绕观察点旋转，按住中键拖动时平移（两个键都按下时旋转），滚轮缩放
+// width/height 为帧缓冲的大小
+void applyCameraInput(const InputFrame& input, ArcballCamera& camera, int width, int height) {
+    camera.processMouseScroll(input.scroll.y);
+    if (width == 0 || height == 0) {
         return;
     }
-
-    float xpos = static_cast<float>(xposIn);
-    float ypos = static_cast<float>(yposIn);
-
-    if (firstMouse) {
-        lastX = xpos;
-        lastY = ypos;
-        firstMouse = false;
-    }
-
-    float xoffset = lastX - xpos;
-    float yoffset = lastY - ypos;
-
-    lastX = xpos;
-    lastY = ypos;
-
-    ArcballCamera::MoveStyle moveStyle = ArcballCamera::MoveStyle::None;
-
-    if (isPlanning) {
-        moveStyle = ArcballCamera::MoveStyle::Planar;
-    }
-    
-    if (isRotating) {
-        moveStyle = ArcballCamera::MoveStyle::Arcball;
-    }
-    int width, height;
-    glfwGetFramebufferSize(window, &width, &height);
-    if(width == 0 || height == 0) {
-        return;
-    }
-    camera.processMouseMovement(width, height, xoffset, yoffset, moveStyle);
-}
-
-void processInput(GLFWwindow* window) {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS) {
-        isPlanning = true;
-    }
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_RELEASE) {
-        isPlanning = false;
-    }
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
-        isRotating = true;
-    }
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_RELEASE) {
-        isRotating = false;
+    for (const MouseMotion& motion : input.motions) {
+        ArcballCamera::MoveStyle moveStyle = ArcballCamera::MoveStyle::None;
+        if (motion.buttons & (1u << GLFW_MOUSE_BUTTON_MIDDLE)) {
+            moveStyle = ArcballCamera::MoveStyle::Planar;
+        }
+        if (motion.buttons & (1u << GLFW_MOUSE_BUTTON_LEFT)) {
+            moveStyle = ArcballCamera::MoveStyle::Arcball;
+        }
+        if (moveStyle != ArcballCamera::MoveStyle::None) {
+            camera.processMouseMovement(width, height, -motion.delta.x, -motion.delta.y, moveStyle);
+        }
     }
 }
 
@@ -0,0 +1,241 @@
+// GPU驱动的视锥剔除：适用于静态场景，物体的数据只在 upload() 时上传一次
+//  -- 每个物体的包围球和网格(PoolMesh)保存在SSBO中，计算着色器(shaders/gpu_cull.comp)每个线程测试一个物体
+//  -- 可见的物体用 atomicAdd 在计数缓冲中取得位置，写出紧凑的间接命令，计数作为
+//     glMultiDrawElementsIndirectCount 的绘制个数，CPU不需要逐个物体处理，也不需要读回结果
+//  -- 命令的 baseInstance 等于物体的编号，DrawData 与 IndirectRenderer 的布局相同（binding = DRAW_DATA_BINDING），
+//     因此可以直接使用 indirect_draw.vert
+//  -- 不支持 GL 4.6 / GL_ARB_indirect_parameters 时读回计数，再调用 glMultiDrawElementsIndirect
+//  -- 传入 HiZBuffer 时，通过视锥测试的物体再用上一帧的深度做遮挡测试（见 hi_z.h），被遮挡的个数见 readOccludedCount()
+// 可见命令的顺序取决于线程执行的顺序，每帧可能不同；readVisible() 读回排序后的可见编号，用于和CPU剔除的结果对比
+// 所有物体的网格必须在同一个 GeometryPool 中
+
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frustum.h"
+#include "geometry_pool.h"
+#include "hi_z.h"
+#include "indirect_renderer.h"
+#include "shader_program.h"
+
+class GpuCuller {
+public:
+    // 与 gpu_cull.comp 中的 binding 和 local_size_x 一致
+    static constexpr GLuint DRAW_DATA_BINDING = IndirectRenderer::DRAW_DATA_BINDING;
+    static constexpr GLuint OBJECT_BINDING = 1;
+    static constexpr GLuint COMMAND_BINDING = 2;
+    static constexpr GLuint COUNT_BINDING = 3;
+    static constexpr GLuint WORKGROUP_SIZE = 64;
+    static constexpr GLuint HI_Z_TEXTURE_UNIT = 0;
+
+    // std430 布局，与着色器中的 CullObject 一致
+    struct CullObject {
+        glm::vec4 sphere;       // 世界空间中的包围球 (center, radius)
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t padding;
+    };
+
+    explicit GpuCuller(const std::string& shaderPath = "shaders/gpu_cull.comp")
+        : m_program({{ShaderProgram::ShaderType::COMPUTE, shaderPath}}) {
+        glGenBuffers(1, &m_objectBuffer);
+        glGenBuffers(1, &m_drawDataBuffer);
+        glGenBuffers(1, &m_commandBuffer);
+        glGenBuffers(1, &m_countBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Counters), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ~GpuCuller() {
+        glDeleteBuffers(1, &m_objectBuffer);
+        glDeleteBuffers(1, &m_drawDataBuffer);
+        glDeleteBuffers(1, &m_commandBuffer);
+        glDeleteBuffers(1, &m_countBuffer);
+    }
+
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    void clear() {
+        m_objects.clear();
+        m_drawData.clear();
+    }
+
+    // 返回物体的编号（等于间接命令的 baseInstance）
+    uint32_t add(const PoolMesh& mesh, const IndirectRenderer::DrawData& data, const glm::vec3& center, float radius) {
+        m_objects.push_back({glm::vec4(center, radius), mesh.indexCount, mesh.firstIndex, mesh.baseVertex, 0});
+        m_drawData.push_back(data);
+        return static_cast<uint32_t>(m_objects.size() - 1);
+    }
+
+    // 把物体上传到GPU，添加或修改物体后调用一次
+    void upload() {
+        upload(m_objectBuffer, m_objects);
+        upload(m_drawDataBuffer, m_drawData);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(m_objects.size(), 1) * sizeof(DrawElementsIndirectCommand),
+                     nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        m_uploadedCount = m_objects.size();
+    }
+
+    // 计数清零后分派计算着色器，结果留在GPU上，由 draw() 或 readVisible() 使用
+    void cull(const Frustum& frustum) {
+        if (begin(frustum)) {
+            m_program.setUniform("occlusionEnabled", false);
+            dispatch();
+        }
+    }
+
+    // 视锥剔除后再做遮挡测试，hiZ 为上一帧的深度，previousViewProjection 为上一帧的 投影 * 视图 矩阵
+    // hiZ 还没有 build() 过时只做视锥剔除
+    // 只临时使用 HI_Z_TEXTURE_UNIT，之后恢复当前的纹理单元和这个单元上原来绑定的纹理
+    void cull(const Frustum& frustum, const HiZBuffer& hiZ, const glm::mat4& previousViewProjection) {
+        if (!begin(frustum)) {
+            return;
+        }
+        m_program.setUniform("occlusionEnabled", hiZ.valid());
+        if (!hiZ.valid()) {
+            dispatch();
+            return;
+        }
+        m_program.setUniform("previousViewProjection", previousViewProjection);
+        m_program.setUniform("hiZ", static_cast<int>(HI_Z_TEXTURE_UNIT));
+        GLint previousActiveTexture = 0;
+        GLint previousTexture = 0;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
+        glActiveTexture(GL_TEXTURE0 + HI_Z_TEXTURE_UNIT);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+        glBindTexture(GL_TEXTURE_2D, hiZ.texture());
+        dispatch();
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture));
+        glActiveTexture(static_cast<GLenum>(previousActiveTexture));
+    }
+    // 绘制 cull() 的结果，调用前需要设置好着色器
+    void draw(const GeometryPool& pool) {
+        if (m_uploadedCount == 0) {
+            return;
+        }
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, m_drawDataBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+        pool.bind();
+        if (supportsIndirectCount()) {
+            glBindBuffer(GL_PARAMETER_BUFFER, m_countBuffer);
+            if (GLAD_GL_VERSION_4_6) {
+                glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0,
+                                                 static_cast<GLsizei>(m_uploadedCount), 0);
+            } else {
+                glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0,
+                                                    static_cast<GLsizei>(m_uploadedCount), 0);
+            }
+            glBindBuffer(GL_PARAMETER_BUFFER, 0);
+        } else {
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(readDrawCount()), 0);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // 以下读回函数会等待GPU完成剔除，只用于统计和验证
+    uint32_t readDrawCount() const {
+        return readCounters().drawCount;
+    }
+
+    // 通过视锥测试但被遮挡的物体个数，没有做遮挡测试时为0
+    uint32_t readOccludedCount() const {
+        return readCounters().occludedCount;
+    }
+
+    // 可见物体的编号，按从小到大排序（与 frustum_culling 的输出顺序相同）
+    void readVisible(std::vector<uint32_t>& visible) const {
+        std::vector<DrawElementsIndirectCommand> commands(readDrawCount());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        visible.resize(commands.size());
+        for (size_t i = 0; i < commands.size(); i++) {
+            visible[i] = commands[i].baseInstance;
+        }
+        std::sort(visible.begin(), visible.end());
+    }
+
+    static bool supportsIndirectCount() {
+        return GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_indirect_parameters;
+    }
+
+    size_t objectCount() const {
+        return m_uploadedCount;
+    }
+
+private:
+    // 与着色器中的 CountBuffer 一致，drawCount 同时作为 GL_PARAMETER_BUFFER 的绘制个数
+    struct Counters {
+        uint32_t drawCount;
+        uint32_t occludedCount;
+    };
+
+    ShaderProgram m_program;
+    GLuint m_objectBuffer;
+    GLuint m_drawDataBuffer;
+    GLuint m_commandBuffer;
+    GLuint m_countBuffer;
+    size_t m_uploadedCount = 0;
+
+    std::vector<CullObject> m_objects;
+    std::vector<IndirectRenderer::DrawData> m_drawData;
+
+    // 计数清零并设置视锥平面，没有物体时返回false
+    bool begin(const Frustum& frustum) {
+        const GLuint zero = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        if (m_uploadedCount == 0) {
+            return false;
+        }
+
+        m_program.use();
+        for (int i = 0; i < Frustum::PLANE_COUNT; i++) {
+            m_program.setUniform("planes[" + std::to_string(i) + "]", frustum.planes[i]);
+        }
+        m_program.setUniform("objectCount", static_cast<int>(m_uploadedCount));
+        return true;
+    }
+
+    void dispatch() {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, m_objectBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, m_commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNT_BINDING, m_countBuffer);
+        glDispatchCompute(static_cast<GLuint>((m_uploadedCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+        // 间接命令和计数在之后作为绘制参数读取
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    }
+
+    Counters readCounters() const {
+        Counters counters{0, 0};
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(Counters), &counters);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        return counters;
+    }
+
+    template <typename T>
+    static void upload(GLuint buffer, const std::vector<T>& data) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(data.size(), 1) * sizeof(T), data.empty() ? nullptr : data.data(),
+                     GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+};
+
+#endif // GPU_CULLING_H
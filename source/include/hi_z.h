@@ -0,0 +1,123 @@
+// 层次深度缓冲(Hi-Z)：深度纹理的mip链，每一级的纹素保存上一级对应2x2区域（奇数尺寸时包括多出的一行/列）中最远的深度
+//  -- build() 由计算着色器(shaders/hi_z_build.comp)生成：第0级从深度纹理复制，之后每级一次分派
+//  -- 遮挡测试见 shaders/gpu_cull.comp：包围体投影到屏幕上的矩形选择覆盖不超过2x2个纹素的级别，
+//     包围体最近的深度比这些纹素最远的深度还要远时，物体被遮挡
+// 通常使用上一帧的深度，测试时用上一帧的 投影 * 视图 矩阵投影包围体（GpuCuller::cull 的 previousViewProjection）
+// 深度为窗口坐标 [0, 1]，深度测试为 GL_LESS（越大越远）
+
+#ifndef HI_Z_H
+#define HI_Z_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <string>
+
+#include "shader_program.h"
+
+class HiZBuffer {
+public:
+    // 与 hi_z_build.comp 中的 local_size 一致
+    static constexpr GLuint WORKGROUP_SIZE = 8;
+
+    HiZBuffer(int width, int height, const std::string& shaderPath = "shaders/hi_z_build.comp")
+        : m_program({{ShaderProgram::ShaderType::COMPUTE, shaderPath}}) {
+        resize(width, height);
+    }
+
+    ~HiZBuffer() {
+        glDeleteTextures(1, &m_texture);
+    }
+
+    HiZBuffer(const HiZBuffer&) = delete;
+    HiZBuffer& operator=(const HiZBuffer&) = delete;
+
+    // 尺寸应与深度纹理相同，重新分配后需要再次 build()
+    void resize(int width, int height) {
+        if (m_texture != 0) {
+            glDeleteTextures(1, &m_texture);
+        }
+        m_width = std::max(1, width);
+        m_height = std::max(1, height);
+        m_levels = 1;
+        while ((std::max(m_width, m_height) >> m_levels) > 0) {
+            m_levels++;
+        }
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexStorage2D(GL_TEXTURE_2D, m_levels, GL_R32F, m_width, m_height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_valid = false;
+    }
+
+    // depthTexture 为深度纹理（比较模式为 GL_NONE），尺寸与 Hi-Z 的第0级相同
+    void build(GLuint depthTexture) {
+        m_program.use();
+        m_program.setUniform("source", 0);
+        glActiveTexture(GL_TEXTURE0);
+        for (int level = 0; level < m_levels; level++) {
+            const int width = levelWidth(level);
+            const int height = levelHeight(level);
+            if (level == 0) {
+                glBindTexture(GL_TEXTURE_2D, depthTexture);
+                m_program.setUniform("sourceLevel", 0);
+                m_program.setUniform("downsample", false);
+            } else {
+                // 读取上一级、写入当前级，两者是同一个纹理的不同级别
+                glBindTexture(GL_TEXTURE_2D, m_texture);
+                m_program.setUniform("sourceLevel", level - 1);
+                m_program.setUniform("downsample", true);
+                glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+            }
+            glBindImageTexture(0, m_texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            glDispatchCompute((width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, (height + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1);
+        }
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_valid = true;
+    }
+
+    GLuint texture() const {
+        return m_texture;
+    }
+
+    // 至少 build() 过一次
+    bool valid() const {
+        return m_valid;
+    }
+
+    int width() const {
+        return m_width;
+    }
+
+    int height() const {
+        return m_height;
+    }
+
+    int levels() const {
+        return m_levels;
+    }
+
+    int levelWidth(int level) const {
+        return std::max(1, m_width >> level);
+    }
+
+    int levelHeight(int level) const {
+        return std::max(1, m_height >> level);
+    }
+
+private:
+    ShaderProgram m_program;
+    GLuint m_texture = 0;
+    int m_width = 0;
+    int m_height = 0;
+    int m_levels = 0;
+    bool m_valid = false;
+};
+
+#endif // HI_Z_H
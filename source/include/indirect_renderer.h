@@ -0,0 +1,154 @@
+#ifndef INDIRECT_RENDERER_H
+#define INDIRECT_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "geometry_pool.h"
+
+// glMultiDrawElementsIndirect 使用的命令结构，布局由OpenGL规定
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// 多重间接绘制：
+//  -- 每帧通过 add() 记录绘制，submit() 时按 (bucket, 几何池) 排序
+//  -- 每个桶写入连续的间接命令，然后只调用一次 glMultiDrawElementsIndirect
+//  -- 每个绘制的数据(DrawData)按排序后的顺序写入SSBO(binding = DRAW_DATA_BINDING)
+//     命令的 baseInstance 等于绘制在SSBO中的下标，着色器中用 gl_BaseInstanceARB 读取
+//     （gl_DrawIDARB 在每次 glMultiDrawElementsIndirect 调用时都会从0开始，跨桶时不能直接使用）
+// 着色器需要 #extension GL_ARB_shader_draw_parameters : require
+class IndirectRenderer {
+public:
+    static constexpr GLuint DRAW_DATA_BINDING = 0;
+
+    // std430 布局，与着色器中的 DrawData 一致
+    struct DrawData {
+        glm::mat4 model;
+        glm::vec4 color;
+    };
+
+    IndirectRenderer() {
+        glGenBuffers(1, &m_commandBuffer);
+        glGenBuffers(1, &m_drawDataBuffer);
+    }
+
+    ~IndirectRenderer() {
+        glDeleteBuffers(1, &m_commandBuffer);
+        glDeleteBuffers(1, &m_drawDataBuffer);
+    }
+
+    IndirectRenderer(const IndirectRenderer&) = delete;
+    IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+
+    void begin() {
+        m_draws.clear();
+    }
+
+    // bucket 表示一组相同的渲染状态（着色器、纹理等），由 submit() 的回调负责设置
+    void add(const GeometryPool& pool, const PoolMesh& mesh, const DrawData& data, uint32_t bucket = 0) {
+        m_draws.push_back({bucket, &pool, mesh, data});
+    }
+
+    // 提交本帧的所有绘制，bindState 在每个桶开始绘制前调用
+    void submit(const std::function<void(uint32_t bucket)>& bindState = nullptr) {
+        m_multiDrawCount = 0;
+        if (m_draws.empty()) {
+            return;
+        }
+
+        // 排序只交换下标，保证相同的 (bucket, pool) 相邻且保持记录顺序
+        m_order.resize(m_draws.size());
+        std::iota(m_order.begin(), m_order.end(), 0u);
+        std::stable_sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) {
+            if (m_draws[a].bucket != m_draws[b].bucket) {
+                return m_draws[a].bucket < m_draws[b].bucket;
+            }
+            return std::less<const GeometryPool*>()(m_draws[a].pool, m_draws[b].pool);
+        });
+
+        m_commands.resize(m_draws.size());
+        m_drawData.resize(m_draws.size());
+        for (uint32_t i = 0; i < m_order.size(); i++) {
+            const Draw& draw = m_draws[m_order[i]];
+            m_commands[i] = {draw.mesh.indexCount, 1, draw.mesh.firstIndex, draw.mesh.baseVertex, i};
+            m_drawData[i] = draw.data;
+        }
+
+        upload(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer, m_commands, m_commandCapacity);
+        upload(GL_SHADER_STORAGE_BUFFER, m_drawDataBuffer, m_drawData, m_drawDataCapacity);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, m_drawDataBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+
+        size_t begin = 0;
+        while (begin < m_order.size()) {
+            const Draw& first = m_draws[m_order[begin]];
+            size_t end = begin + 1;
+            while (end < m_order.size() && m_draws[m_order[end]].bucket == first.bucket &&
+                   m_draws[m_order[end]].pool == first.pool) {
+                end++;
+            }
+            if (bindState && (begin == 0 || m_draws[m_order[begin - 1]].bucket != first.bucket)) {
+                bindState(first.bucket);
+            }
+            first.pool->bind();
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                        (void*)(begin * sizeof(DrawElementsIndirectCommand)),
+                                        static_cast<GLsizei>(end - begin), 0);
+            m_multiDrawCount++;
+            begin = end;
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    size_t drawCount() const {
+        return m_draws.size();
+    }
+
+    // 上一次 submit() 中 glMultiDrawElementsIndirect 的调用次数
+    size_t multiDrawCount() const {
+        return m_multiDrawCount;
+    }
+
+private:
+    struct Draw {
+        uint32_t bucket;
+        const GeometryPool* pool;
+        PoolMesh mesh;
+        DrawData data;
+    };
+
+    GLuint m_commandBuffer;
+    GLuint m_drawDataBuffer;
+    size_t m_commandCapacity = 0;
+    size_t m_drawDataCapacity = 0;
+    size_t m_multiDrawCount = 0;
+
+    std::vector<Draw> m_draws;
+    std::vector<uint32_t> m_order;
+    std::vector<DrawElementsIndirectCommand> m_commands;
+    std::vector<DrawData> m_drawData;
+
+    // 每帧重新分配存储(orphan)，避免等待上一帧仍在使用的缓冲
+    template <typename T>
+    static void upload(GLenum target, GLuint buffer, const std::vector<T>& data, size_t& capacity) {
+        glBindBuffer(target, buffer);
+        capacity = std::max(capacity, data.size());
+        glBufferData(target, capacity * sizeof(T), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(target, 0, data.size() * sizeof(T), data.data());
+        glBindBuffer(target, 0);
+    }
+};
+
+#endif // INDIRECT_RENDERER_H
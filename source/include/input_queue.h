@@ -0,0 +1,214 @@
+// 输入事件队列：GLFW回调只把带时间戳的事件放入无锁队列（见 spsc_queue.h），不修改任何程序状态
+//  -- InputQueue::attach() 设置窗口的光标、鼠标按键、滚轮和键盘回调（使用窗口的 user pointer），
+//     需要在 ImGui_ImplGlfw_InitForOpenGL 之前调用，ImGui会把事件继续传给这些回调
+//  -- InputQueue::poll() 由模拟/渲染在确定的时间点调用，取出所有事件并合并为一个 InputFrame：
+//     鼠标移动按按键状态合并为几段位移（通常每帧一段），滚轮累加，记录按键和鼠标按键的按下事件和当前状态
+//  -- 事件的时间戳为 glfwGetTime()，InputFrame 中记录最早和最晚的事件时间，用于统计输入到显示的延迟
+// 在绘制之前再调用一次 glfwPollEvents() 和 poll()，可以让这一帧使用尽可能新的输入
+// 模拟在单独的线程中按固定步长运行时，由模拟线程调用 poll(stepEndTime)，每步只使用这一步结束之前的事件
+
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "spsc_queue.h"
+
+struct InputEvent {
+    enum Type : uint32_t { CURSOR_MOVE, MOUSE_BUTTON, SCROLL, KEY };
+
+    Type type;
+    int code;           // MOUSE_BUTTON：GLFW_MOUSE_BUTTON_*，KEY：GLFW_KEY_*
+    int action;         // GLFW_PRESS/GLFW_RELEASE/GLFW_REPEAT
+    float x;            // CURSOR_MOVE：光标位置，SCROLL：滚轮偏移
+    float y;
+    double time;        // glfwGetTime()
+};
+
+// 按键状态相同的一段连续的鼠标移动
+struct MouseMotion {
+    glm::vec2 delta;        // 光标位置的变化（窗口坐标，向右、向下为正）
+    uint32_t buttons;       // 移动时按下的鼠标按键，第 i 位为 GLFW_MOUSE_BUTTON_1 + i
+};
+
+// 一次 poll() 得到的输入
+struct InputFrame {
+    std::vector<MouseMotion> motions;
+    std::vector<InputEvent> presses;        // 按键和鼠标按键的按下事件（不包括 GLFW_REPEAT），x/y 为当时的光标位置
+    glm::vec2 cursor = glm::vec2(0.0f);     // 当前光标位置
+    glm::vec2 scroll = glm::vec2(0.0f);
+    uint32_t buttons = 0;                   // 当前按下的鼠标按键
+    std::bitset<GLFW_KEY_LAST + 1> keys;    // 当前按下的按键
+    size_t eventCount = 0;
+    double oldestTime = 0.0;
+    double newestTime = 0.0;
+
+    bool keyDown(int key) const {
+        return key >= 0 && key <= GLFW_KEY_LAST && keys.test(static_cast<size_t>(key));
+    }
+
+    bool buttonDown(int button) const {
+        return (buttons >> button) & 1u;
+    }
+
+    // 这一帧内是否按下过，返回按下时的事件
+    const InputEvent* findPress(InputEvent::Type type, int code) const {
+        for (const InputEvent& event : presses) {
+            if (event.type == type && event.code == code) {
+                return &event;
+            }
+        }
+        return nullptr;
+    }
+
+    bool keyPressed(int key) const {
+        return findPress(InputEvent::KEY, key) != nullptr;
+    }
+
+    bool buttonPressed(int button) const {
+        return findPress(InputEvent::MOUSE_BUTTON, button) != nullptr;
+    }
+};
+
+class InputQueue {
+public:
+    explicit InputQueue(size_t capacity = 1024) : m_events(capacity) {}
+
+    InputQueue(const InputQueue&) = delete;
+    InputQueue& operator=(const InputQueue&) = delete;
+
+    void attach(GLFWwindow* window) {
+        glfwSetWindowUserPointer(window, this);
+        glfwSetCursorPosCallback(window, [](GLFWwindow* window, double x, double y) {
+            fromWindow(window)->push({InputEvent::CURSOR_MOVE, 0, 0, static_cast<float>(x), static_cast<float>(y), glfwGetTime()});
+        });
+        glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int) {
+            fromWindow(window)->push({InputEvent::MOUSE_BUTTON, button, action, 0.0f, 0.0f, glfwGetTime()});
+        });
+        glfwSetScrollCallback(window, [](GLFWwindow* window, double xoffset, double yoffset) {
+            fromWindow(window)->push({InputEvent::SCROLL, 0, 0, static_cast<float>(xoffset), static_cast<float>(yoffset), glfwGetTime()});
+        });
+        glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int, int action, int) {
+            fromWindow(window)->push({InputEvent::KEY, key, action, 0.0f, 0.0f, glfwGetTime()});
+        });
+    }
+
+    // 生产者（GLFW回调或者其他输入线程）调用，队列满时丢弃事件
+    bool push(const InputEvent& event) {
+        if (!m_events.push(event)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // 消费者调用，取出所有事件
+    InputFrame poll() {
+        return poll(std::numeric_limits<double>::infinity());
+    }
+
+    // 只取出时间戳早于 untilTime 的事件，之后的事件留到下一次，用于按固定步长取输入（见 fixed_step_simulation.h）
+    InputFrame poll(double untilTime) {
+        InputFrame frame;
+        InputEvent event;
+        while (nextEvent(event)) {
+            if (event.time >= untilTime) {
+                m_pending = event;
+                m_hasPending = true;
+                break;
+            }
+            if (frame.eventCount == 0) {
+                frame.oldestTime = event.time;
+            }
+            frame.newestTime = event.time;
+            frame.eventCount++;
+            apply(event, frame);
+        }
+        frame.cursor = m_cursor;
+        frame.buttons = m_buttons;
+        frame.keys = m_keys;
+        return frame;
+    }
+
+    size_t droppedCount() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    SpscQueue<InputEvent> m_events;
+    std::atomic<size_t> m_dropped{0};
+
+    // 以下只由消费者修改
+    InputEvent m_pending = {};      // poll(untilTime) 取出但还没有使用的事件
+    bool m_hasPending = false;
+    glm::vec2 m_cursor = glm::vec2(0.0f);
+    bool m_hasCursor = false;       // 第一个光标事件只记录位置，不产生位移
+    uint32_t m_buttons = 0;
+    std::bitset<GLFW_KEY_LAST + 1> m_keys;
+
+    static InputQueue* fromWindow(GLFWwindow* window) {
+        return static_cast<InputQueue*>(glfwGetWindowUserPointer(window));
+    }
+
+    bool nextEvent(InputEvent& event) {
+        if (m_hasPending) {
+            event = m_pending;
+            m_hasPending = false;
+            return true;
+        }
+        return m_events.pop(event);
+    }
+
+    void apply(const InputEvent& event, InputFrame& frame) {
+        switch (event.type) {
+        case InputEvent::CURSOR_MOVE: {
+            glm::vec2 position(event.x, event.y);
+            if (m_hasCursor) {
+                // 按键状态不变时合并到上一段
+                if (!frame.motions.empty() && frame.motions.back().buttons == m_buttons) {
+                    frame.motions.back().delta += position - m_cursor;
+                } else {
+                    frame.motions.push_back({position - m_cursor, m_buttons});
+                }
+            }
+            m_cursor = position;
+            m_hasCursor = true;
+            break;
+        }
+        case InputEvent::MOUSE_BUTTON:
+            if (event.code < 0 || event.code >= 32) {
+                break;
+            }
+            if (event.action == GLFW_PRESS) {
+                m_buttons |= 1u << event.code;
+                frame.presses.push_back({event.type, event.code, event.action, m_cursor.x, m_cursor.y, event.time});
+            } else if (event.action == GLFW_RELEASE) {
+                m_buttons &= ~(1u << event.code);
+            }
+            break;
+        case InputEvent::SCROLL:
+            frame.scroll += glm::vec2(event.x, event.y);
+            break;
+        case InputEvent::KEY:
+            if (event.code < 0 || event.code > GLFW_KEY_LAST) {
+                break;
+            }
+            if (event.action == GLFW_PRESS) {
+                m_keys.set(static_cast<size_t>(event.code));
+                frame.presses.push_back({event.type, event.code, event.action, m_cursor.x, m_cursor.y, event.time});
+            } else if (event.action == GLFW_RELEASE) {
+                m_keys.reset(static_cast<size_t>(event.code));
+            }
+            break;
+        }
+    }
+};
+
+#endif // INPUT_QUEUE_H
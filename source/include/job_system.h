@@ -0,0 +1,406 @@
+// 工作窃取的任务调度器
+//  -- JobSystem(threadCount) 包括创建它的线程共 threadCount 个线程，创建者是 0 号线程，
+//     只在 wait() 中执行任务；其余线程是后台工作线程
+//  -- 每个线程有一个 Chase-Lev 双端队列：自己从底部 push/pop（后进先出，缓存友好），
+//     其他线程从顶部窃取（先进先出，窃取到的通常是较大的任务）
+//  -- 依赖用计数器表示：spawn(counter, function) 使计数器加一，任务完成时减一；
+//     wait(counter) 在计数器归零之前执行其他任务而不是阻塞，所以任务中也可以 spawn 并 wait（不需要纤程）
+//  -- parallelFor(begin, end, grain, function) 把区间递归地二分，每次把右半部分作为任务，
+//     直到长度不超过 grain，function(rangeBegin, rangeEnd) 在各个线程上执行
+//  -- 任务保存在每个线程自己的环形任务池中，spawn 不分配内存；闭包最多 JOB_STORAGE 字节，
+//     队列或任务池满时直接在当前线程执行
+//  -- 空闲的工作线程先让出时间片，一段时间之后在条件变量上睡眠，spawn 只在有线程睡眠时通知
+// 不属于这个 JobSystem 的线程也可以 spawn 和 wait，任务经过加锁的共享队列（较慢）
+// 析构之前所有任务都需要已经完成（等待过所有计数器）
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Chase-Lev 双端队列（Lê et al. 2013 的 C11 内存序版本），容量固定
+// push/pop 只能由所有者线程调用，steal 可以由任意线程调用；满时 push 返回false，空时返回 nullptr
+template <typename T>
+class WorkStealingDeque {
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    explicit WorkStealingDeque(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_slots.reset(new std::atomic<T*>[size]);
+        m_mask = static_cast<int64_t>(size) - 1;
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    bool push(T* item) {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top > m_mask) {
+            return false;
+        }
+        m_slots[bottom & m_mask].store(item, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    T* pop() {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = m_slots[bottom & m_mask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // 最后一个元素，与窃取者竞争
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    T* steal() {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        T* item = m_slots[top & m_mask].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // 其他线程同时修改时只是一个近似值
+    bool empty() const {
+        return m_bottom.load(std::memory_order_seq_cst) <= m_top.load(std::memory_order_seq_cst);
+    }
+
+private:
+    std::unique_ptr<std::atomic<T*>[]> m_slots;
+    int64_t m_mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_top{0};       // 窃取者写
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_bottom{0};    // 所有者写
+};
+
+// 未完成的任务数，归零表示所有任务都已完成
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool done() const {
+        return m_pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_pending{0};
+};
+
+class JobSystem {
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr size_t JOB_STORAGE = 48;
+    static constexpr uint32_t JOB_POOL_SIZE = 4096;     // 每个线程，2的幂
+    static constexpr int SPIN_COUNT = 64;               // 空闲时睡眠之前让出时间片的次数
+
+    explicit JobSystem(unsigned int threadCount = std::thread::hardware_concurrency()) {
+        threadCount = std::max(1u, threadCount);
+        for (unsigned int i = 0; i < threadCount; i++) {
+            m_workers.emplace_back(new Worker(i));
+        }
+        threadContext() = {this, 0};
+        for (unsigned int i = 1; i < threadCount; i++) {
+            m_threads.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_running.store(false, std::memory_order_relaxed);
+        }
+        m_sleepCondition.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+        if (threadContext().system == this) {
+            threadContext() = {};
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned int threadCount() const {
+        return static_cast<unsigned int>(m_workers.size());
+    }
+
+    // 当前线程在这个 JobSystem 中的编号 [0, threadCount)，不属于这个 JobSystem 时为 -1
+    // 可以用来索引每个线程各自的临时数据
+    int threadIndex() const {
+        const ThreadContext& context = threadContext();
+        return context.system == this ? static_cast<int>(context.index) : -1;
+    }
+
+    // function 不带参数，完成后 counter 减一；counter 需要在 wait 返回之前保持有效
+    template <typename Function>
+    void spawn(JobCounter& counter, Function&& function) {
+        using Closure = std::decay_t<Function>;
+        static_assert(sizeof(Closure) <= JOB_STORAGE, "job closure too large, capture by reference or pointer");
+        static_assert(alignof(Closure) <= alignof(std::max_align_t), "job closure over-aligned");
+
+        const int index = threadIndex();
+        if (index < 0) {
+            inject(counter, std::function<void()>(std::forward<Function>(function)));
+            return;
+        }
+        Worker& worker = *m_workers[index];
+        Job& job = worker.jobs[worker.nextJob & (JOB_POOL_SIZE - 1)];
+        if (job.invoke.load(std::memory_order_acquire) != nullptr) {
+            // 任务池中的这个位置还没有执行完（被其他线程窃取后仍在执行），不等待
+            function();
+            return;
+        }
+        new (job.storage) Closure(std::forward<Function>(function));
+        job.counter = &counter;
+        job.invoke.store(&invokeClosure<Closure>, std::memory_order_relaxed);
+        counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+        if (!worker.deque.push(&job)) {
+            execute(&job);
+            return;
+        }
+        worker.nextJob++;
+        wakeOne();
+    }
+
+    // 计数器归零之前执行其他任务（包括与这个计数器无关的任务）
+    void wait(const JobCounter& counter) {
+        const int index = threadIndex();
+        while (!counter.done()) {
+            if (!runOne(index)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // function(rangeBegin, rangeEnd) 处理 [rangeBegin, rangeEnd)，每段的长度不超过 grain
+    // grain 为0时按线程数自动选择（每个线程大约8段）
+    template <typename Function>
+    void parallelFor(size_t begin, size_t end, size_t grain, const Function& function) {
+        if (begin >= end) {
+            return;
+        }
+        if (grain == 0) {
+            grain = std::max<size_t>(1, (end - begin) / (threadCount() * 8));
+        }
+        JobCounter counter;
+        RangeTask<Function> task{this, &function, grain, &counter};
+        task.run(begin, end);
+        wait(counter);
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Job {
+        std::atomic<void (*)(void*)> invoke{nullptr};   // nullptr 表示这个位置空闲
+        JobCounter* counter = nullptr;
+        alignas(std::max_align_t) unsigned char storage[JOB_STORAGE];
+    };
+
+    struct Worker {
+        WorkStealingDeque<Job> deque{JOB_POOL_SIZE};
+        std::unique_ptr<Job[]> jobs{new Job[JOB_POOL_SIZE]};
+        uint32_t nextJob = 0;
+        uint32_t random;
+
+        explicit Worker(unsigned int index) : random(index * 2654435761u + 1u) {}
+    };
+
+    struct ThreadContext {
+        const JobSystem* system = nullptr;
+        unsigned int index = 0;
+    };
+
+    template <typename Function>
+    struct RangeTask {
+        JobSystem* system;
+        const Function* function;
+        size_t grain;
+        JobCounter* counter;
+
+        // RangeTask 在 parallelFor 的栈上，wait 返回之前一直有效
+        void run(size_t begin, size_t end) const {
+            while (end - begin > grain) {
+                const size_t middle = begin + (end - begin) / 2;
+                const RangeTask* self = this;
+                system->spawn(*counter, [self, middle, end]() { self->run(middle, end); });
+                end = middle;
+            }
+            (*function)(begin, end);
+        }
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_running{true};
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    std::atomic<uint32_t> m_sleeping{0};
+
+    // 不属于这个 JobSystem 的线程提交的任务
+    std::mutex m_injectedMutex;
+    std::deque<std::pair<std::function<void()>, JobCounter*>> m_injected;
+    std::atomic<size_t> m_injectedCount{0};
+
+    static ThreadContext& threadContext() {
+        static thread_local ThreadContext context;
+        return context;
+    }
+
+    template <typename Closure>
+    static void invokeClosure(void* storage) {
+        Closure& closure = *static_cast<Closure*>(storage);
+        closure();
+        closure.~Closure();
+    }
+
+    void execute(Job* job) {
+        JobCounter* counter = job->counter;
+        job->invoke.load(std::memory_order_relaxed)(job->storage);
+        job->invoke.store(nullptr, std::memory_order_release);
+        counter->m_pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    void inject(JobCounter& counter, std::function<void()> function) {
+        counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(m_injectedMutex);
+            m_injected.emplace_back(std::move(function), &counter);
+            m_injectedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        wakeOne();
+    }
+
+    // 执行一个任务：先取自己的队列，然后是共享队列，最后从随机的线程开始窃取；没有任务时返回false
+    bool runOne(int index) {
+        if (index >= 0) {
+            if (Job* job = m_workers[index]->deque.pop()) {
+                execute(job);
+                return true;
+            }
+        }
+        if (m_injectedCount.load(std::memory_order_relaxed) > 0) {
+            std::pair<std::function<void()>, JobCounter*> injected;
+            {
+                std::lock_guard<std::mutex> lock(m_injectedMutex);
+                if (!m_injected.empty()) {
+                    injected = std::move(m_injected.front());
+                    m_injected.pop_front();
+                    m_injectedCount.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+            if (injected.second) {
+                injected.first();
+                injected.second->m_pending.fetch_sub(1, std::memory_order_release);
+                return true;
+            }
+        }
+        const size_t count = m_workers.size();
+        uint32_t start;
+        if (index >= 0) {
+            uint32_t& random = m_workers[index]->random;
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            start = random;
+        } else {
+            start = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        }
+        for (size_t i = 0; i < count; i++) {
+            const size_t victim = (start + i) % count;
+            if (static_cast<int>(victim) == index) {
+                continue;
+            }
+            if (Job* job = m_workers[victim]->deque.steal()) {
+                execute(job);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool hasWork() const {
+        if (m_injectedCount.load(std::memory_order_seq_cst) > 0) {
+            return true;
+        }
+        for (const auto& worker : m_workers) {
+            if (!worker->deque.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 与 workerLoop 中 m_sleeping 加一后的 hasWork() 对应：要么睡眠的线程看到新任务，要么这里看到睡眠的线程
+    void wakeOne() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+            }
+            m_sleepCondition.notify_one();
+        }
+    }
+
+    void workerLoop(unsigned int index) {
+        threadContext() = {this, index};
+        int idle = 0;
+        while (m_running.load(std::memory_order_relaxed)) {
+            if (runOne(static_cast<int>(index))) {
+                idle = 0;
+                continue;
+            }
+            if (++idle < SPIN_COUNT) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            if (!hasWork() && m_running.load(std::memory_order_relaxed)) {
+                m_sleepCondition.wait(lock);
+            }
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+            idle = 0;
+        }
+    }
+};
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,139 @@
+// 细节层次（LOD）
+//  -- LodMesh：同一个网格的多级索引列表，所有级别共享一份顶点数据（GeometryPool::allocateIndices）
+//  -- LodSelector：按投影到屏幕上的误差（像素）选择级别，选择满足阈值的最粗糙的一级
+// 屏幕空间误差 = 对象空间误差 * 缩放 / 距离 * projectionScale
+// 其中 projectionScale = 视口高度 / (2 * tan(fovy / 2))，即距离为1处一个单位长度对应的像素数
+
+#ifndef LOD_H
+#define LOD_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "arcball_camera.h"
+#include "geometry_pool.h"
+#include "mesh_simplifier.h"
+
+struct LodMesh {
+    std::vector<PoolMesh> levels;       // levels[0] 为原始网格
+    std::vector<float> errors;          // 每一级相对于原始网格的误差，对象空间单位
+    glm::vec3 center = glm::vec3(0.0f); // 包围球
+    float radius = 0.0f;
+
+    size_t levelCount() const {
+        return levels.size();
+    }
+
+    uint32_t triangleCount(size_t level) const {
+        return levels[level].indexCount / 3;
+    }
+};
+
+// vertices 按照池的顶点格式排列，前三个float为位置
+// 生成LOD链并上传：第0级用 allocate()，其余级别只分配索引
+inline LodMesh createLodMesh(GeometryPool& pool, const float* vertices, uint32_t vertexCount, size_t strideBytes,
+                             const uint32_t* indices, uint32_t indexCount, size_t maxLevels = 5) {
+    LodMesh mesh;
+    std::vector<mesh_simplifier::LodLevel> chain =
+        mesh_simplifier::generateLodChain(vertices, vertexCount, strideBytes, indices, indexCount, maxLevels);
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertices);
+    glm::vec3 boundsMin(INFINITY), boundsMax(-INFINITY);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        const float* p = reinterpret_cast<const float*>(bytes + v * strideBytes);
+        boundsMin = glm::min(boundsMin, glm::vec3(p[0], p[1], p[2]));
+        boundsMax = glm::max(boundsMax, glm::vec3(p[0], p[1], p[2]));
+    }
+    mesh.center = (boundsMin + boundsMax) * 0.5f;
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        const float* p = reinterpret_cast<const float*>(bytes + v * strideBytes);
+        mesh.radius = std::max(mesh.radius, glm::length(glm::vec3(p[0], p[1], p[2]) - mesh.center));
+    }
+
+    PoolMesh base = pool.allocate(vertices, vertexCount, chain[0].indices.data(), static_cast<uint32_t>(chain[0].indices.size()));
+    if (!base.valid()) {
+        return mesh;
+    }
+    mesh.levels.push_back(base);
+    mesh.errors.push_back(0.0f);
+    for (size_t level = 1; level < chain.size(); level++) {
+        PoolMesh indicesOnly = pool.allocateIndices(base, chain[level].indices.data(), static_cast<uint32_t>(chain[level].indices.size()));
+        if (!indicesOnly.valid()) {
+            break;
+        }
+        mesh.levels.push_back(indicesOnly);
+        mesh.errors.push_back(chain[level].error);
+    }
+    return mesh;
+}
+
+inline void freeLodMesh(GeometryPool& pool, LodMesh& mesh) {
+    // 先释放只有索引的级别，最后释放带顶点的第0级
+    for (size_t level = mesh.levels.size(); level-- > 0;) {
+        pool.free(mesh.levels[level]);
+    }
+    mesh.levels.clear();
+    mesh.errors.clear();
+}
+
+class LodSelector {
+public:
+    // fovy 为弧度，pixelThreshold 为允许的屏幕空间误差（像素）
+    LodSelector(float fovy, float viewportHeight, float pixelThreshold = 1.0f)
+        : m_projectionScale(viewportHeight / (2.0f * std::tan(fovy * 0.5f))), m_pixelThreshold(pixelThreshold) {}
+
+    // ArcballCamera 的 zoom 就是透视投影的 fovy（角度）
+    static LodSelector fromCamera(const ArcballCamera& camera, float viewportHeight, float pixelThreshold = 1.0f) {
+        LodSelector selector(glm::radians(camera.getZoom()), viewportHeight, pixelThreshold);
+        selector.setViewPosition(camera.getPosition());
+        return selector;
+    }
+
+    void setViewPosition(const glm::vec3& position) {
+        m_viewPosition = position;
+    }
+
+    void setPixelThreshold(float pixelThreshold) {
+        m_pixelThreshold = pixelThreshold;
+    }
+
+    float getPixelThreshold() const {
+        return m_pixelThreshold;
+    }
+
+    // 对象空间误差 error 在距离 distance 处投影到屏幕上的像素数
+    float screenError(float error, float distance) const {
+        return error / std::max(distance, 1e-4f) * m_projectionScale;
+    }
+
+    // model 为物体的模型矩阵（可以带均匀缩放），距离取到包围球表面的距离
+    // 相机在包围球内部时总是返回第0级
+    size_t select(const LodMesh& mesh, const glm::mat4& model) const {
+        glm::vec3 center = glm::vec3(model * glm::vec4(mesh.center, 1.0f));
+        float scale = std::sqrt(std::max({glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+                                          glm::dot(glm::vec3(model[1]), glm::vec3(model[1])),
+                                          glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))}));
+        float distance = glm::length(center - m_viewPosition) - mesh.radius * scale;
+        if (distance <= 0.0f) {
+            return 0;
+        }
+        // errors 单调递增，从最粗糙的一级往回找
+        for (size_t level = mesh.errors.size(); level-- > 1;) {
+            if (screenError(mesh.errors[level] * scale, distance) <= m_pixelThreshold) {
+                return level;
+            }
+        }
+        return 0;
+    }
+
+private:
+    float m_projectionScale;
+    float m_pixelThreshold;
+    glm::vec3 m_viewPosition = glm::vec3(0.0f);
+};
+
+#endif // LOD_H
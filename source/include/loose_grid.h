@@ -0,0 +1,382 @@
+// 松散均匀网格：动态物体（AABB）的空间索引，用于视锥剔除、范围查询和拾取
+//  -- 物体按包围盒中心放入一个格子，格子的“松散”范围是格子向外扩展半个格子，
+//     半边长不超过半个格子的物体一定在所在格子的松散范围内，插入、移动、删除都是O(1)（摊还）
+//  -- 更大的物体或者中心在网格范围外的物体放入单独的列表，每次查询都逐个测试
+//  -- 每个格子的物体连续保存（包围盒和句柄，32字节），删除时与最后一个交换；物体在同一个格子内移动时只更新包围盒
+//  -- 格子按 BLOCK_SIZE^3 分块，视锥查询先测试块再测试格子，完全在视锥内的块/格子中的物体不再逐个测试
+//  -- 射线查询用3D-DDA按顺序遍历射线经过的格子以及它们周围一圈的格子（物体最多伸出半个格子），
+//     下一个格子的进入距离超过当前最近的交点时结束
+// 查询都是const的，可以在多个线程中同时进行；修改需要与查询互斥
+
+#ifndef LOOSE_GRID_H
+#define LOOSE_GRID_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "bvh.h"
+#include "frustum.h"
+
+class LooseGrid {
+public:
+    static constexpr uint32_t INVALID = ~0u;
+    static constexpr int BLOCK_SIZE = 4;
+
+    // 格子中的一个物体
+    struct Entry {
+        glm::vec3 boundsMin;
+        uint32_t handle;
+        glm::vec3 boundsMax;
+        uint32_t padding;
+    };
+
+    // worldBounds 之外的物体仍然可以插入，只是会放入单独的列表
+    LooseGrid(const Aabb& worldBounds, float cellSize)
+        : m_origin(worldBounds.boundsMin), m_cellSize(cellSize), m_inverseCellSize(1.0f / cellSize), m_looseness(cellSize * 0.5f) {
+        glm::vec3 size = worldBounds.boundsMax - worldBounds.boundsMin;
+        for (int axis = 0; axis < 3; axis++) {
+            m_dims[axis] = std::max(1, static_cast<int>(std::ceil(size[axis] * m_inverseCellSize)));
+            m_blockDims[axis] = (m_dims[axis] + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        }
+        const size_t cellCount = static_cast<size_t>(m_dims.x) * m_dims.y * m_dims.z;
+        m_oversized = static_cast<uint32_t>(cellCount);
+        m_cells.resize(cellCount + 1);
+        m_blockCounts.assign(static_cast<size_t>(m_blockDims.x) * m_blockDims.y * m_blockDims.z, 0);
+    }
+
+    // 返回物体的句柄，删除后句柄会被重复使用
+    uint32_t insert(const Aabb& bounds) {
+        uint32_t handle;
+        if (m_freeHandles.empty()) {
+            handle = static_cast<uint32_t>(m_locations.size());
+            m_locations.push_back({INVALID, INVALID});
+        } else {
+            handle = m_freeHandles.back();
+            m_freeHandles.pop_back();
+        }
+        place(handle, bounds, cellOf(bounds));
+        m_count++;
+        return handle;
+    }
+
+    // 返回物体是否换到了另一个格子
+    bool move(uint32_t handle, const Aabb& bounds) {
+        const uint32_t cell = cellOf(bounds);
+        const Location& location = m_locations[handle];
+        if (cell == location.cell) {
+            Entry& entry = m_cells[cell][location.slot];
+            entry.boundsMin = bounds.boundsMin;
+            entry.boundsMax = bounds.boundsMax;
+            return false;
+        }
+        unplace(handle);
+        place(handle, bounds, cell);
+        return true;
+    }
+
+    void remove(uint32_t handle) {
+        unplace(handle);
+        m_locations[handle] = {INVALID, INVALID};
+        m_freeHandles.push_back(handle);
+        m_count--;
+    }
+
+    void clear() {
+        for (auto& entries : m_cells) {
+            entries.clear();
+        }
+        std::fill(m_blockCounts.begin(), m_blockCounts.end(), 0u);
+        m_locations.clear();
+        m_freeHandles.clear();
+        m_count = 0;
+    }
+
+    Aabb bounds(uint32_t handle) const {
+        const Location& location = m_locations[handle];
+        const Entry& entry = m_cells[location.cell][location.slot];
+        return {entry.boundsMin, entry.boundsMax};
+    }
+
+    size_t size() const {
+        return m_count;
+    }
+
+    size_t cellCount() const {
+        return m_oversized;
+    }
+
+    size_t oversizedCount() const {
+        return m_cells[m_oversized].size();
+    }
+
+    // 以下查询对每个可能相交的物体调用 callback(handle)，顺序不固定
+
+    // 与 Frustum::intersectsBox 的结果相同
+    template <typename Callback>
+    void queryFrustum(const Frustum& frustum, Callback&& callback) const {
+        const int blockCells = BLOCK_SIZE;
+        for (int bz = 0; bz < m_blockDims.z; bz++) {
+            for (int by = 0; by < m_blockDims.y; by++) {
+                for (int bx = 0; bx < m_blockDims.x; bx++) {
+                    if (m_blockCounts[(static_cast<size_t>(bz) * m_blockDims.y + by) * m_blockDims.x + bx] == 0) {
+                        continue;
+                    }
+                    const glm::ivec3 first(bx * blockCells, by * blockCells, bz * blockCells);
+                    const glm::ivec3 last = glm::min(first + glm::ivec3(blockCells - 1), m_dims - 1);
+                    const Frustum::Containment block = classifyCells(frustum, first, last);
+                    if (block == Frustum::CONTAINMENT_OUTSIDE) {
+                        continue;
+                    }
+                    for (int z = first.z; z <= last.z; z++) {
+                        for (int y = first.y; y <= last.y; y++) {
+                            for (int x = first.x; x <= last.x; x++) {
+                                const std::vector<Entry>& entries = m_cells[cellIndex(x, y, z)];
+                                if (entries.empty()) {
+                                    continue;
+                                }
+                                const glm::ivec3 cell(x, y, z);
+                                const Frustum::Containment containment =
+                                    block == Frustum::CONTAINMENT_INSIDE ? block : classifyCells(frustum, cell, cell);
+                                if (containment == Frustum::CONTAINMENT_INSIDE) {
+                                    for (const Entry& entry : entries) {
+                                        callback(entry.handle);
+                                    }
+                                } else if (containment == Frustum::CONTAINMENT_INTERSECTING) {
+                                    queryEntries(entries, frustum, callback);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        queryEntries(m_cells[m_oversized], frustum, callback);
+    }
+
+    // 包围盒与球相交的物体
+    template <typename Callback>
+    void querySphere(const glm::vec3& center, float radius, Callback&& callback) const {
+        auto overlaps = [&center, radius](const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+            glm::vec3 offset = glm::clamp(center, boundsMin, boundsMax) - center;
+            return glm::dot(offset, offset) <= radius * radius;
+        };
+        queryRange(center - radius, center + radius, overlaps, callback);
+    }
+
+    // 包围盒与AABB相交的物体
+    template <typename Callback>
+    void queryBox(const Aabb& box, Callback&& callback) const {
+        auto overlaps = [&box](const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+            return glm::all(glm::lessThanEqual(boundsMin, box.boundsMax)) && glm::all(glm::lessThanEqual(box.boundsMin, boundsMax));
+        };
+        queryRange(box.boundsMin, box.boundsMax, overlaps, callback);
+    }
+
+    // 与 Bvh::intersect 相同：intersect(handle, ray, tMax) 返回物体的相交参数t，不相交时返回 FLT_MAX，返回最近的物体
+    template <typename IntersectObject>
+    RayHit raycast(const Ray& ray, IntersectObject&& intersect, float tMax = FLT_MAX) const {
+        RayHit hit;
+        hit.t = tMax;
+        const glm::vec3 inverseDirection = 1.0f / ray.direction;
+        auto testEntries = [&](const std::vector<Entry>& entries) {
+            for (const Entry& entry : entries) {
+                if (intersectAabb(ray.origin, inverseDirection, entry.boundsMin, entry.boundsMax, hit.t) == FLT_MAX) {
+                    continue;
+                }
+                float t = intersect(entry.handle, ray, hit.t);
+                if (t < hit.t) {
+                    hit.t = t;
+                    hit.primitive = entry.handle;
+                }
+            }
+        };
+        testEntries(m_cells[m_oversized]);
+        traverseRay(ray, inverseDirection, hit, testEntries);
+        if (!hit.valid()) {
+            hit.t = FLT_MAX;
+        }
+        return hit;
+    }
+
+    // 以包围盒本身作为物体
+    RayHit raycast(const Ray& ray, float tMax = FLT_MAX) const {
+        const glm::vec3 inverseDirection = 1.0f / ray.direction;
+        return raycast(ray, [&](uint32_t handle, const Ray&, float maxT) {
+            Aabb box = bounds(handle);
+            return intersectAabb(ray.origin, inverseDirection, box.boundsMin, box.boundsMax, maxT);
+        }, tMax);
+    }
+
+private:
+    struct Location {
+        uint32_t cell;
+        uint32_t slot;
+    };
+
+    glm::vec3 m_origin;
+    float m_cellSize;
+    float m_inverseCellSize;
+    float m_looseness;
+    glm::ivec3 m_dims;
+    glm::ivec3 m_blockDims;
+    uint32_t m_oversized;       // 单独列表在 m_cells 中的下标（最后一个）
+    size_t m_count = 0;
+
+    std::vector<std::vector<Entry>> m_cells;
+    std::vector<uint32_t> m_blockCounts;    // 每个块中的物体个数，跳过空的块
+    std::vector<Location> m_locations;      // 句柄 -> (格子, 格子中的位置)
+    std::vector<uint32_t> m_freeHandles;
+
+    size_t cellIndex(int x, int y, int z) const {
+        return (static_cast<size_t>(z) * m_dims.y + y) * m_dims.x + x;
+    }
+
+    size_t blockOf(uint32_t cell) const {
+        const int x = static_cast<int>(cell % m_dims.x);
+        const int y = static_cast<int>(cell / m_dims.x % m_dims.y);
+        const int z = static_cast<int>(cell / m_dims.x / m_dims.y);
+        return (static_cast<size_t>(z / BLOCK_SIZE) * m_blockDims.y + y / BLOCK_SIZE) * m_blockDims.x + x / BLOCK_SIZE;
+    }
+
+    uint32_t cellOf(const Aabb& bounds) const {
+        const glm::vec3 extent = (bounds.boundsMax - bounds.boundsMin) * 0.5f;
+        if (extent.x > m_looseness || extent.y > m_looseness || extent.z > m_looseness) {
+            return m_oversized;
+        }
+        const glm::vec3 cell = glm::floor((bounds.center() - m_origin) * m_inverseCellSize);
+        if (cell.x < 0.0f || cell.y < 0.0f || cell.z < 0.0f || cell.x >= m_dims.x || cell.y >= m_dims.y || cell.z >= m_dims.z) {
+            return m_oversized;
+        }
+        return static_cast<uint32_t>(cellIndex(static_cast<int>(cell.x), static_cast<int>(cell.y), static_cast<int>(cell.z)));
+    }
+
+    void place(uint32_t handle, const Aabb& bounds, uint32_t cell) {
+        std::vector<Entry>& entries = m_cells[cell];
+        m_locations[handle] = {cell, static_cast<uint32_t>(entries.size())};
+        entries.push_back({bounds.boundsMin, handle, bounds.boundsMax, 0});
+        if (cell != m_oversized) {
+            m_blockCounts[blockOf(cell)]++;
+        }
+    }
+
+    // 与最后一个物体交换后删除
+    void unplace(uint32_t handle) {
+        const Location location = m_locations[handle];
+        std::vector<Entry>& entries = m_cells[location.cell];
+        entries[location.slot] = entries.back();
+        m_locations[entries[location.slot].handle].slot = location.slot;
+        entries.pop_back();
+        if (location.cell != m_oversized) {
+            m_blockCounts[blockOf(location.cell)]--;
+        }
+    }
+
+    // 格子 [first, last]（包括两端）的松散范围与视锥的关系
+    Frustum::Containment classifyCells(const Frustum& frustum, const glm::ivec3& first, const glm::ivec3& last) const {
+        const glm::vec3 boundsMin = m_origin + glm::vec3(first) * m_cellSize - m_looseness;
+        const glm::vec3 boundsMax = m_origin + glm::vec3(last + 1) * m_cellSize + m_looseness;
+        return frustum.classifyBox((boundsMin + boundsMax) * 0.5f, (boundsMax - boundsMin) * 0.5f);
+    }
+
+    template <typename Callback>
+    static void queryEntries(const std::vector<Entry>& entries, const Frustum& frustum, Callback& callback) {
+        for (const Entry& entry : entries) {
+            if (frustum.intersectsBox((entry.boundsMin + entry.boundsMax) * 0.5f, (entry.boundsMax - entry.boundsMin) * 0.5f)) {
+                callback(entry.handle);
+            }
+        }
+    }
+
+    // 与 [queryMin, queryMax] 相交的松散范围所在的格子，再用 overlaps 逐个测试
+    template <typename Overlaps, typename Callback>
+    void queryRange(const glm::vec3& queryMin, const glm::vec3& queryMax, Overlaps& overlaps, Callback& callback) const {
+        // 先在浮点数中限制范围，避免很大的坐标转换为整数时溢出
+        const glm::vec3 cellMax(m_dims - 1);
+        const glm::ivec3 first(glm::clamp(glm::floor((queryMin - m_looseness - m_origin) * m_inverseCellSize), glm::vec3(0.0f), cellMax + 1.0f));
+        const glm::ivec3 last(glm::clamp(glm::floor((queryMax + m_looseness - m_origin) * m_inverseCellSize), glm::vec3(-1.0f), cellMax));
+        auto testEntries = [&](const std::vector<Entry>& entries) {
+            for (const Entry& entry : entries) {
+                if (overlaps(entry.boundsMin, entry.boundsMax)) {
+                    callback(entry.handle);
+                }
+            }
+        };
+        for (int z = first.z; z <= last.z; z++) {
+            for (int y = first.y; y <= last.y; y++) {
+                for (int x = first.x; x <= last.x; x++) {
+                    testEntries(m_cells[cellIndex(x, y, z)]);
+                }
+            }
+        }
+        testEntries(m_cells[m_oversized]);
+    }
+
+    // 3D-DDA，范围是网格向外扩展一圈的格子（物体可能伸出网格半个格子）
+    // 第一个格子访问周围3x3x3个格子，之后每走一步只访问前进方向上新出现的3x3个格子，每个格子只访问一次
+    template <typename TestEntries>
+    void traverseRay(const Ray& ray, const glm::vec3& inverseDirection, const RayHit& hit, TestEntries& testEntries) const {
+        const glm::vec3 gridMin = m_origin - m_cellSize;
+        const glm::vec3 gridMax = m_origin + glm::vec3(m_dims + 1) * m_cellSize;
+        float t = intersectAabb(ray.origin, inverseDirection, gridMin, gridMax, hit.t);
+        if (t == FLT_MAX) {
+            return;
+        }
+        const glm::ivec3 low(-1);
+        const glm::ivec3 high = m_dims;
+        glm::ivec3 cell(glm::clamp(glm::floor((ray.origin + ray.direction * t - m_origin) * m_inverseCellSize), glm::vec3(low), glm::vec3(high)));
+        glm::ivec3 step;
+        glm::vec3 tNext;
+        glm::vec3 tDelta;
+        for (int axis = 0; axis < 3; axis++) {
+            if (ray.direction[axis] > 0.0f) {
+                step[axis] = 1;
+                tNext[axis] = (m_origin[axis] + (cell[axis] + 1) * m_cellSize - ray.origin[axis]) * inverseDirection[axis];
+                tDelta[axis] = m_cellSize * inverseDirection[axis];
+            } else if (ray.direction[axis] < 0.0f) {
+                step[axis] = -1;
+                tNext[axis] = (m_origin[axis] + cell[axis] * m_cellSize - ray.origin[axis]) * inverseDirection[axis];
+                tDelta[axis] = -m_cellSize * inverseDirection[axis];
+            } else {
+                step[axis] = 0;
+                tNext[axis] = FLT_MAX;
+                tDelta[axis] = FLT_MAX;
+            }
+        }
+
+        auto visit = [&](const glm::ivec3& from, const glm::ivec3& to) {
+            const glm::ivec3 first = glm::max(from, glm::ivec3(0));
+            const glm::ivec3 last = glm::min(to, m_dims - 1);
+            for (int z = first.z; z <= last.z; z++) {
+                for (int y = first.y; y <= last.y; y++) {
+                    for (int x = first.x; x <= last.x; x++) {
+                        testEntries(m_cells[cellIndex(x, y, z)]);
+                    }
+                }
+            }
+        };
+        visit(cell - 1, cell + 1);
+        while (true) {
+            int axis = tNext.x < tNext.y ? (tNext.x < tNext.z ? 0 : 2) : (tNext.y < tNext.z ? 1 : 2);
+            // 下一个格子比当前最近的交点还远时，之后的物体都不会更近
+            if (tNext[axis] > hit.t) {
+                break;
+            }
+            cell[axis] += step[axis];
+            if (cell[axis] < low[axis] || cell[axis] > high[axis]) {
+                break;
+            }
+            tNext[axis] += tDelta[axis];
+            glm::ivec3 from = cell - 1;
+            glm::ivec3 to = cell + 1;
+            from[axis] = to[axis] = cell[axis] + step[axis];
+            visit(from, to);
+        }
+    }
+};
+
+#endif // LOOSE_GRID_H
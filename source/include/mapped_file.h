@@ -0,0 +1,145 @@
+// 只读的内存映射文件，打开后可以直接通过 data() 访问文件内容，不需要先读入内存
+// Windows 使用 CreateFileMapping/MapViewOfFile，其他平台使用 mmap
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path) {
+        open(path);
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+#if defined(_WIN32)
+            std::swap(m_file, other.m_file);
+            std::swap(m_mapping, other.m_mapping);
+#endif
+        }
+        return *this;
+    }
+
+    // 映射整个文件，失败或文件为空时返回false
+    bool open(const std::string& path) {
+        close();
+#if defined(_WIN32)
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping == nullptr) {
+            close();
+            return false;
+        }
+        m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        m_size = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat status;
+        if (fstat(fd, &status) != 0 || status.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // 映射建立后文件描述符就可以关闭了
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        m_data = static_cast<const unsigned char*>(data);
+        m_size = static_cast<size_t>(status.st_size);
+#endif
+        if (m_data == nullptr) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (m_data != nullptr) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_file);
+        }
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data != nullptr) {
+            munmap(const_cast<unsigned char*>(m_data), m_size);
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    bool isOpen() const {
+        return m_data != nullptr;
+    }
+
+    const unsigned char* data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,432 @@
+// CPU上的遮挡剔除（Masked Occlusion Culling的做法）：把遮挡物的三角形光栅化到低分辨率的分层深度缓冲中，
+// 再用物体的AABB测试是否被完全挡住，不需要GPU，也不需要读回
+//  -- 屏幕分成 32x8 像素的tile，每个tile只保存两个深度和一个256位的覆盖掩码（每行一个32位整数）：
+//     z0 为参考层，整个tile中遮挡物最远的深度；z1 为工作层，掩码中的像素遮挡物最远的深度
+//     工作层覆盖满整个tile时合并到参考层；新的三角形离参考层比离工作层更近时丢弃工作层（只会变得更保守）
+//  -- 深度使用 1/w，越大越近，0表示无穷远（清空后的状态）
+//  -- 三角形的覆盖掩码按行计算：每条边在每一行上的交点决定一段连续的像素，移位得到这一行的掩码
+//     AVX2 一次计算一个tile的8行（_mm256_sllv_epi32 / _mm256_srlv_epi32），没有AVX2时使用标量实现，
+//     两者结果相同（前提是编译器不把标量实现中的 slope * y + intercept 合并为FMA，ENABLE_AVX2 会加上 -ffp-contract=off）
+//  -- 三角形在tile中最远的深度由深度平面在tile四个角上的最小值得到（并且不小于三个顶点的最小值），是保守的
+//  -- 只光栅化正面（逆时针）的三角形，有顶点在相机平面附近或后面的三角形直接跳过（少画遮挡物总是安全的）
+// 被遮挡的判断是保守的：isVisible() 返回false时物体一定被挡住（像素中心的精度内）
+// 多线程版本把tile按行分成几段，每个线程处理所有三角形在自己那一段的部分，结果与单线程相同
+
+#ifndef MASKED_OCCLUSION_H
+#define MASKED_OCCLUSION_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "simd.h"
+
+namespace masked_occlusion {
+
+constexpr int TILE_WIDTH = 32;
+constexpr int TILE_HEIGHT = 8;
+// w 小于这个值的顶点认为在相机平面附近或后面
+constexpr float MIN_W = 1e-4f;
+
+struct Tile {
+    uint32_t mask[TILE_HEIGHT];     // 工作层覆盖的像素，第 r 行第 i 位为tile中第 r 行第 i 列的像素
+    float z0;
+    float z1;
+};
+
+// 一个遮挡物网格：positions 的每个顶点以3个float的位置开头，相邻顶点间隔 strideBytes 字节，
+// indices 每3个为一个逆时针的三角形，modelViewProjection 把顶点变换到裁剪空间
+struct Occluder {
+    glm::mat4 modelViewProjection;
+    const float* positions;
+    size_t strideBytes;
+    size_t vertexCount;
+    const uint32_t* indices;
+    size_t indexCount;
+};
+
+// 光栅化的统计
+struct RasterStats {
+    size_t triangles = 0;       // 输入的三角形个数
+    size_t rasterized = 0;      // 实际光栅化的三角形（去掉背面、退化、屏幕外和跨过相机平面的三角形）
+};
+
+namespace detail {
+
+// 三角形的一条边，A * x + B * y + C >= 0 为内侧
+//  -- A > 0 (LEFT) : 第 y 行中 x >= slope * y + intercept 的像素在内侧
+//  -- A < 0 (RIGHT): 第 y 行中 x <= slope * y + intercept 的像素在内侧
+//  -- A = 0 (HORIZONTAL): 整行都在内侧或者都在外侧，由 B * y + C >= 0 决定
+struct Edge {
+    enum Type { LEFT, RIGHT, HORIZONTAL };
+    Type type;
+    float slope;
+    float intercept;
+    float b;
+    float c;
+};
+
+struct Triangle {
+    Edge edges[3];
+    float zA, zB, zC;           // 深度平面 z = zA * x + zB * y + zC
+    float zMin;                 // 三个顶点中最远的深度
+    int tileX0, tileX1, tileY0, tileY1;     // 包围盒覆盖的tile范围（包括两端）
+};
+
+// 每个tile中第 r 行像素中心的y坐标偏移
+constexpr float ROW_CENTERS[TILE_HEIGHT] = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f};
+
+// 裁剪空间的三个顶点 -> 屏幕空间的三角形，不需要光栅化时返回false
+inline bool setupTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2, int width, int height,
+                          int tilesX, int tilesY, Triangle& triangle) {
+    if (c0.w < MIN_W || c1.w < MIN_W || c2.w < MIN_W) {
+        return false;
+    }
+    const glm::vec4 clip[3] = {c0, c1, c2};
+    glm::vec2 p[3];
+    float z[3];
+    for (int i = 0; i < 3; i++) {
+        float inverseW = 1.0f / clip[i].w;
+        p[i] = glm::vec2((clip[i].x * inverseW * 0.5f + 0.5f) * width, (clip[i].y * inverseW * 0.5f + 0.5f) * height);
+        z[i] = inverseW;
+    }
+    const float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+    if (!(area > 0.0f)) {
+        return false;
+    }
+
+    glm::vec2 boundsMin = glm::min(glm::min(p[0], p[1]), p[2]);
+    glm::vec2 boundsMax = glm::max(glm::max(p[0], p[1]), p[2]);
+    if (boundsMax.x < 0.0f || boundsMax.y < 0.0f || boundsMin.x >= width || boundsMin.y >= height) {
+        return false;
+    }
+    // 先在浮点数中裁剪到屏幕，避免靠近相机平面的顶点转换为整数时溢出
+    boundsMin = glm::max(boundsMin, glm::vec2(0.0f));
+    boundsMax = glm::min(boundsMax, glm::vec2(static_cast<float>(width - 1), static_cast<float>(height - 1)));
+    triangle.tileX0 = static_cast<int>(boundsMin.x) / TILE_WIDTH;
+    triangle.tileY0 = static_cast<int>(boundsMin.y) / TILE_HEIGHT;
+    triangle.tileX1 = std::min(tilesX - 1, static_cast<int>(boundsMax.x) / TILE_WIDTH);
+    triangle.tileY1 = std::min(tilesY - 1, static_cast<int>(boundsMax.y) / TILE_HEIGHT);
+
+    for (int i = 0; i < 3; i++) {
+        const glm::vec2& a = p[i];
+        const glm::vec2& b = p[(i + 1) % 3];
+        Edge& edge = triangle.edges[i];
+        const float edgeA = -(b.y - a.y);
+        const float edgeB = b.x - a.x;
+        edge.b = edgeB;
+        edge.c = -edgeA * a.x - edgeB * a.y;
+        if (edgeA == 0.0f) {
+            edge.type = Edge::HORIZONTAL;
+            edge.slope = 0.0f;
+            edge.intercept = 0.0f;
+        } else {
+            edge.type = edgeA > 0.0f ? Edge::LEFT : Edge::RIGHT;
+            edge.slope = -edgeB / edgeA;
+            edge.intercept = -edge.c / edgeA;
+        }
+    }
+
+    // 解深度平面：z = z0 + zA * (x - x0) + zB * (y - y0)
+    const glm::vec2 d1 = p[1] - p[0];
+    const glm::vec2 d2 = p[2] - p[0];
+    const float dz1 = z[1] - z[0];
+    const float dz2 = z[2] - z[0];
+    triangle.zA = (dz1 * d2.y - dz2 * d1.y) / area;
+    triangle.zB = (dz2 * d1.x - dz1 * d2.x) / area;
+    triangle.zC = z[0] - triangle.zA * p[0].x - triangle.zB * p[0].y;
+    triangle.zMin = std::min(std::min(z[0], z[1]), z[2]);
+    return true;
+}
+
+// 三角形在 [x0, x0 + TILE_WIDTH] x [y0, y0 + TILE_HEIGHT] 中最远的深度
+inline float tileDepth(const Triangle& triangle, float x0, float y0) {
+    float x = std::min(triangle.zA * x0, triangle.zA * (x0 + TILE_WIDTH));
+    float y = std::min(triangle.zB * y0, triangle.zB * (y0 + TILE_HEIGHT));
+    return std::max(triangle.zMin, triangle.zC + x + y);
+}
+
+inline uint32_t rowMaskScalar(const Edge& edge, float y, float x0) {
+    if (edge.type == Edge::HORIZONTAL) {
+        return edge.b * y + edge.c >= 0.0f ? ~0u : 0u;
+    }
+    const float x = edge.slope * y + edge.intercept - x0 - 0.5f;
+    if (edge.type == Edge::LEFT) {
+        // 第一个在内侧的列
+        int first = static_cast<int>(std::min(std::max(std::ceil(x), 0.0f), 32.0f));
+        return first >= 32 ? 0u : ~0u << first;
+    }
+    // 最后一个在内侧的列为 floor(x)，右移去掉它右边的列
+    int shift = static_cast<int>(std::min(std::max(31.0f - std::floor(x), 0.0f), 32.0f));
+    return shift >= 32 ? 0u : ~0u >> shift;
+}
+
+inline void tileMaskScalar(const Triangle& triangle, float x0, float y0, uint32_t* mask) {
+    for (int r = 0; r < TILE_HEIGHT; r++) {
+        const float y = y0 + ROW_CENTERS[r];
+        mask[r] = rowMaskScalar(triangle.edges[0], y, x0) & rowMaskScalar(triangle.edges[1], y, x0) &
+                  rowMaskScalar(triangle.edges[2], y, x0);
+    }
+}
+
+#ifdef SIMD_AVX2
+
+// 与 tileMaskScalar 相同的计算顺序，一次计算8行；乘和加分开计算，与关闭FMA合并的标量实现逐位相同
+inline void tileMask(const Triangle& triangle, float x0, float y0, uint32_t* mask) {
+    const __m256 y = _mm256_add_ps(_mm256_set1_ps(y0), _mm256_loadu_ps(ROW_CENTERS));
+    const __m256i ones = _mm256_set1_epi32(-1);
+    __m256i result = ones;
+    for (const Edge& edge : triangle.edges) {
+        if (edge.type == Edge::HORIZONTAL) {
+            __m256 value = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edge.b), y), _mm256_set1_ps(edge.c));
+            result = _mm256_and_si256(result, _mm256_castps_si256(_mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_GE_OQ)));
+            continue;
+        }
+        __m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edge.slope), y), _mm256_set1_ps(edge.intercept));
+        x = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_set1_ps(x0)), _mm256_set1_ps(0.5f));
+        if (edge.type == Edge::LEFT) {
+            __m256 first = _mm256_min_ps(_mm256_max_ps(_mm256_ceil_ps(x), _mm256_setzero_ps()), _mm256_set1_ps(32.0f));
+            result = _mm256_and_si256(result, _mm256_sllv_epi32(ones, _mm256_cvttps_epi32(first)));
+        } else {
+            __m256 shift = _mm256_sub_ps(_mm256_set1_ps(31.0f), _mm256_floor_ps(x));
+            shift = _mm256_min_ps(_mm256_max_ps(shift, _mm256_setzero_ps()), _mm256_set1_ps(32.0f));
+            result = _mm256_and_si256(result, _mm256_srlv_epi32(ones, _mm256_cvttps_epi32(shift)));
+        }
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(mask), result);
+}
+
+#else
+
+inline void tileMask(const Triangle& triangle, float x0, float y0, uint32_t* mask) {
+    tileMaskScalar(triangle, x0, y0, mask);
+}
+
+#endif
+
+// 把三角形在一个tile中的覆盖合并到tile中，z 为三角形在tile中最远的深度
+inline void updateTile(Tile& tile, const uint32_t* mask, float z) {
+    uint32_t covered = 0;
+    uint32_t working = 0;
+    for (int r = 0; r < TILE_HEIGHT; r++) {
+        covered |= mask[r];
+        working |= tile.mask[r];
+    }
+    // 三角形比参考层还远时不会带来新的信息
+    if (covered == 0 || z <= tile.z0) {
+        return;
+    }
+    if (working == 0) {
+        tile.z1 = z;
+    } else if (z < tile.z1 && tile.z1 - z > z - tile.z0) {
+        // 新三角形离参考层更近，丢弃工作层，只保留新三角形
+        std::fill(tile.mask, tile.mask + TILE_HEIGHT, 0u);
+        tile.z1 = z;
+    } else {
+        tile.z1 = std::min(tile.z1, z);
+    }
+    uint32_t full = ~0u;
+    for (int r = 0; r < TILE_HEIGHT; r++) {
+        tile.mask[r] |= mask[r];
+        full &= tile.mask[r];
+    }
+    // 工作层覆盖满整个tile，工作层中所有深度都比参考层近，合并为新的参考层
+    if (full == ~0u) {
+        tile.z0 = tile.z1;
+        tile.z1 = 0.0f;
+        std::fill(tile.mask, tile.mask + TILE_HEIGHT, 0u);
+    }
+}
+
+} // namespace detail
+
+class OcclusionBuffer {
+public:
+    // 宽和高向上取整到tile的倍数，投影时使用取整后的尺寸
+    OcclusionBuffer(int width, int height)
+        : m_tilesX(std::max(1, (width + TILE_WIDTH - 1) / TILE_WIDTH)),
+          m_tilesY(std::max(1, (height + TILE_HEIGHT - 1) / TILE_HEIGHT)),
+          m_width(m_tilesX * TILE_WIDTH),
+          m_height(m_tilesY * TILE_HEIGHT),
+          m_tiles(static_cast<size_t>(m_tilesX) * m_tilesY) {
+        clear();
+    }
+
+    void clear() {
+        std::fill(m_tiles.begin(), m_tiles.end(), Tile{{0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u}, 0.0f, 0.0f});
+    }
+
+    // 单个网格，参数的含义见 Occluder
+    RasterStats renderTriangles(const glm::mat4& modelViewProjection, const float* positions, size_t strideBytes, size_t vertexCount,
+                                const uint32_t* indices, size_t indexCount) {
+        const Occluder occluder{modelViewProjection, positions, strideBytes, vertexCount, indices, indexCount};
+        return rasterize<true>(&occluder, 1, 0, m_tilesY, m_clip);
+    }
+
+    RasterStats renderTrianglesScalar(const glm::mat4& modelViewProjection, const float* positions, size_t strideBytes, size_t vertexCount,
+                                      const uint32_t* indices, size_t indexCount) {
+        const Occluder occluder{modelViewProjection, positions, strideBytes, vertexCount, indices, indexCount};
+        return rasterize<false>(&occluder, 1, 0, m_tilesY, m_clip);
+    }
+
+    // 一批遮挡物，按顺序光栅化
+    RasterStats renderOccluders(const Occluder* occluders, size_t count) {
+        return rasterize<true>(occluders, count, 0, m_tilesY, m_clip);
+    }
+
+    RasterStats renderOccludersScalar(const Occluder* occluders, size_t count) {
+        return rasterize<false>(occluders, count, 0, m_tilesY, m_clip);
+    }
+
+    // 每个线程负责一段连续的tile行，各自变换所有遮挡物的顶点
+    RasterStats renderOccludersParallel(const Occluder* occluders, size_t count,
+                                        unsigned int threadCount = std::thread::hardware_concurrency()) {
+        threadCount = std::max(1u, std::min<unsigned int>(threadCount, static_cast<unsigned int>(m_tilesY)));
+        if (threadCount <= 1) {
+            return renderOccluders(occluders, count);
+        }
+        auto rowBegin = [this, threadCount](unsigned int t) {
+            return m_tilesY * static_cast<int>(t) / static_cast<int>(threadCount);
+        };
+        std::vector<std::thread> threads;
+        for (unsigned int t = 1; t < threadCount; t++) {
+            threads.emplace_back([&, t]() {
+                std::vector<glm::vec4> clip;
+                rasterize<true>(occluders, count, rowBegin(t), rowBegin(t + 1), clip);
+            });
+        }
+        RasterStats stats = rasterize<true>(occluders, count, rowBegin(0), rowBegin(1), m_clip);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return stats;
+    }
+
+    // AABB投影到屏幕上的矩形中有任何像素可能看到物体时返回true
+    // 包围盒跨过相机平面时无法测试，总是返回true；完全在屏幕外时返回false
+    bool isVisible(const glm::mat4& viewProjection, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+        glm::vec2 screenMin(FLT_MAX);
+        glm::vec2 screenMax(-FLT_MAX);
+        float nearest = 0.0f;
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y, (i & 4) ? boundsMax.z : boundsMin.z);
+            glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            if (clip.w < MIN_W) {
+                return true;
+            }
+            float inverseW = 1.0f / clip.w;
+            glm::vec2 screen((clip.x * inverseW * 0.5f + 0.5f) * m_width, (clip.y * inverseW * 0.5f + 0.5f) * m_height);
+            screenMin = glm::min(screenMin, screen);
+            screenMax = glm::max(screenMax, screen);
+            nearest = std::max(nearest, inverseW);
+        }
+        if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= m_width || screenMin.y >= m_height) {
+            return false;
+        }
+        screenMin = glm::max(screenMin, glm::vec2(0.0f));
+        screenMax = glm::min(screenMax, glm::vec2(static_cast<float>(m_width - 1), static_cast<float>(m_height - 1)));
+        const int x0 = static_cast<int>(screenMin.x);
+        const int y0 = static_cast<int>(screenMin.y);
+        const int x1 = static_cast<int>(screenMax.x);
+        const int y1 = static_cast<int>(screenMax.y);
+        for (int ty = y0 / TILE_HEIGHT; ty <= y1 / TILE_HEIGHT; ty++) {
+            const int rowBegin = std::max(y0 - ty * TILE_HEIGHT, 0);
+            const int rowEnd = std::min(y1 - ty * TILE_HEIGHT, TILE_HEIGHT - 1);
+            for (int tx = x0 / TILE_WIDTH; tx <= x1 / TILE_WIDTH; tx++) {
+                const Tile& tile = m_tiles[static_cast<size_t>(ty) * m_tilesX + tx];
+                // 矩形在这个tile中覆盖的列
+                const int first = std::max(x0 - tx * TILE_WIDTH, 0);
+                const int last = std::min(x1 - tx * TILE_WIDTH, TILE_WIDTH - 1);
+                const uint32_t columns = (~0u << first) & (~0u >> (TILE_WIDTH - 1 - last));
+                const bool nearerThanReference = nearest >= tile.z0;
+                const bool nearerThanWorking = nearest >= std::max(tile.z0, tile.z1);
+                for (int r = rowBegin; r <= rowEnd; r++) {
+                    if ((nearerThanReference && (columns & ~tile.mask[r]) != 0) ||
+                        (nearerThanWorking && (columns & tile.mask[r]) != 0)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    int width() const {
+        return m_width;
+    }
+
+    int height() const {
+        return m_height;
+    }
+
+    int tilesX() const {
+        return m_tilesX;
+    }
+
+    int tilesY() const {
+        return m_tilesY;
+    }
+
+    const std::vector<Tile>& tiles() const {
+        return m_tiles;
+    }
+
+private:
+    int m_tilesX;
+    int m_tilesY;
+    int m_width;
+    int m_height;
+    std::vector<Tile> m_tiles;
+    std::vector<glm::vec4> m_clip;      // 变换到裁剪空间的顶点
+
+    // 只更新 [tileRowBegin, tileRowEnd) 行的tile，clip 为顶点变换用的临时数组
+    template <bool Simd>
+    RasterStats rasterize(const Occluder* occluders, size_t count, int tileRowBegin, int tileRowEnd, std::vector<glm::vec4>& clip) {
+        RasterStats stats;
+        uint32_t mask[TILE_HEIGHT];
+        detail::Triangle triangle;
+        for (size_t o = 0; o < count; o++) {
+            const Occluder& occluder = occluders[o];
+            clip.resize(occluder.vertexCount);
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(occluder.positions);
+            for (size_t i = 0; i < occluder.vertexCount; i++) {
+                const float* p = reinterpret_cast<const float*>(bytes + i * occluder.strideBytes);
+                clip[i] = occluder.modelViewProjection * glm::vec4(p[0], p[1], p[2], 1.0f);
+            }
+
+            const uint32_t* indices = occluder.indices;
+            stats.triangles += occluder.indexCount / 3;
+            for (size_t i = 0; i + 2 < occluder.indexCount; i += 3) {
+                if (!detail::setupTriangle(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]],
+                                           m_width, m_height, m_tilesX, m_tilesY, triangle)) {
+                    continue;
+                }
+                stats.rasterized++;
+                const int ty0 = std::max(triangle.tileY0, tileRowBegin);
+                const int ty1 = std::min(triangle.tileY1, tileRowEnd - 1);
+                for (int ty = ty0; ty <= ty1; ty++) {
+                    const float y0 = static_cast<float>(ty * TILE_HEIGHT);
+                    for (int tx = triangle.tileX0; tx <= triangle.tileX1; tx++) {
+                        const float x0 = static_cast<float>(tx * TILE_WIDTH);
+                        if (Simd) {
+                            detail::tileMask(triangle, x0, y0, mask);
+                        } else {
+                            detail::tileMaskScalar(triangle, x0, y0, mask);
+                        }
+                        detail::updateTile(m_tiles[static_cast<size_t>(ty) * m_tilesX + tx], mask, detail::tileDepth(triangle, x0, y0));
+                    }
+                }
+            }
+        }
+        return stats;
+    }
+};
+
+} // namespace masked_occlusion
+
+#endif // MASKED_OCCLUSION_H
@@ -0,0 +1,419 @@
+// 网格优化，在加载模型或离线处理时对三角形和顶点重新排序：
+//  -- optimizeVertexCache : Forsyth 线性时间的顶点缓存优化，按顶点分数贪心地选择下一个三角形
+//  -- optimizeOverdraw    : 在顶点缓存优化的基础上，把三角形分成若干簇，朝外的簇先画，减少重复着色
+//                           （Sander 等人 "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"）
+//  -- optimizeVertexFetch : 按照索引中第一次出现的顺序重排顶点，使顶点读取尽量连续
+//  -- analyzeVertexCache  : 用FIFO缓存模拟计算 ACMR（每个三角形的平均缓存缺失数）和 ATVR（缺失数/顶点数）
+// 所有函数都是确定性的，相同的输入总是得到相同的输出，与 optimizeMeshes 使用的线程数无关
+
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "job_system.h"
+
+namespace mesh_optimizer {
+
+struct VertexCacheStats {
+    float acmr = 0.0f;      // 理想值0.5，最差为3
+    float atvr = 0.0f;      // 理想值1
+    uint32_t misses = 0;
+};
+
+// cacheSize 为FIFO缓存的大小，默认值接近桌面GPU的后变换缓存
+inline VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16) {
+    VertexCacheStats stats;
+    if (indexCount < 3 || vertexCount == 0) {
+        return stats;
+    }
+    // timestamps[v] 为顶点v进入缓存时的计数，计数差大于缓存大小说明已经被挤出
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    for (size_t i = 0; i < indexCount; i++) {
+        uint32_t vertex = indices[i];
+        if (time - timestamps[vertex] > cacheSize) {
+            timestamps[vertex] = time++;
+            stats.misses++;
+        }
+    }
+    stats.acmr = static_cast<float>(stats.misses) / static_cast<float>(indexCount / 3);
+    stats.atvr = static_cast<float>(stats.misses) / static_cast<float>(vertexCount);
+    return stats;
+}
+
+/* ------------------------------------------ 顶点缓存优化 ------------------------------------------*/
+namespace detail {
+
+constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+constexpr uint32_t FORSYTH_MAX_VALENCE = 32;
+
+struct ForsythTables {
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[FORSYTH_MAX_VALENCE + 1];
+
+    ForsythTables() {
+        // 最近使用的3个顶点属于刚画完的三角形，给一个固定的分数，避免总是选择相邻的同一个三角形带
+        for (uint32_t i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+            cache[i] = i < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(i - 3) / (FORSYTH_CACHE_SIZE - 3), 1.5f);
+        }
+        // 剩余三角形越少的顶点分数越高，尽快把它用完
+        valence[0] = 0.0f;
+        for (uint32_t i = 1; i <= FORSYTH_MAX_VALENCE; i++) {
+            valence[i] = 2.0f / std::sqrt(static_cast<float>(i));
+        }
+    }
+};
+
+inline float forsythScore(const ForsythTables& tables, int cachePosition, uint32_t remaining) {
+    if (remaining == 0) {
+        return -1.0f;
+    }
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    return score + tables.valence[std::min(remaining, FORSYTH_MAX_VALENCE)];
+}
+
+} // namespace detail
+
+// destination 与 indices 不能是同一块内存
+inline void optimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount) {
+    using namespace detail;
+    static const ForsythTables tables;
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // 每个顶点相邻的三角形列表（CSR格式），remaining 为还没有输出的相邻三角形数
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        remaining[indices[i]]++;
+    }
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (size_t k = 0; k < 3; k++) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScores[v] = forsythScore(tables, -1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    uint32_t bestTriangle = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+        if (triangleScores[t] > triangleScores[bestTriangle]) {
+            bestTriangle = static_cast<uint32_t>(t);
+        }
+    }
+
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t cacheCount = 0;
+    size_t inputCursor = 0;
+    const uint32_t INVALID = ~0u;
+
+    for (size_t output = 0; output < triangleCount; output++) {
+        // 缓存中的顶点都没有剩余三角形时，按输入顺序取下一个没有输出的三角形
+        if (bestTriangle == INVALID) {
+            while (emitted[inputCursor]) {
+                inputCursor++;
+            }
+            bestTriangle = static_cast<uint32_t>(inputCursor);
+        }
+
+        const uint32_t* triangle = &indices[bestTriangle * 3];
+        std::memcpy(destination + output * 3, triangle, 3 * sizeof(uint32_t));
+        emitted[bestTriangle] = 1;
+
+        // 从三个顶点的邻接列表中删除这个三角形
+        for (int k = 0; k < 3; k++) {
+            uint32_t vertex = triangle[k];
+            uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+            uint32_t* end = begin + remaining[vertex];
+            uint32_t* found = std::find(begin, end, bestTriangle);
+            if (found != end) {
+                *found = *(end - 1);
+                remaining[vertex]--;
+            }
+        }
+
+        // 新三角形的顶点放到缓存最前面，其余顶点依次后移
+        uint32_t newCount = 0;
+        for (int k = 0; k < 3; k++) {
+            newCache[newCount++] = triangle[k];
+        }
+        for (uint32_t i = 0; i < cacheCount; i++) {
+            uint32_t vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                newCache[newCount++] = vertex;
+            }
+        }
+        for (uint32_t i = FORSYTH_CACHE_SIZE; i < newCount; i++) {
+            cachePositions[newCache[i]] = -1;
+            vertexScores[newCache[i]] = forsythScore(tables, -1, remaining[newCache[i]]);
+        }
+        cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+        std::memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+        // 只有缓存中顶点的分数会变化，只需要更新它们相邻的三角形
+        for (uint32_t i = 0; i < cacheCount; i++) {
+            cachePositions[cache[i]] = static_cast<int>(i);
+            vertexScores[cache[i]] = forsythScore(tables, static_cast<int>(i), remaining[cache[i]]);
+        }
+        bestTriangle = INVALID;
+        float bestScore = -1.0f;
+        for (uint32_t i = 0; i < cacheCount; i++) {
+            uint32_t vertex = cache[i];
+            for (uint32_t a = 0; a < remaining[vertex]; a++) {
+                uint32_t t = adjacency[adjacencyOffsets[vertex] + a];
+                const uint32_t* other = &indices[t * 3];
+                float score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+                triangleScores[t] = score;
+                // 分数相同时选择编号小的三角形，保证结果与遍历顺序无关
+                if (score > bestScore || (score == bestScore && t < bestTriangle)) {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+    }
+}
+
+/* ------------------------------------------ 过度绘制优化 ------------------------------------------*/
+// indices 应该已经做过顶点缓存优化；threshold 为允许的 ACMR 增加比例，越大簇越小、过度绘制越少
+// positions 指向第一个顶点的位置，strideBytes 为顶点的步长
+inline void optimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+                             const float* positions, size_t vertexCount, size_t strideBytes, float threshold = 1.05f) {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+    const uint32_t cacheSize = 16;
+    auto position = [positions, strideBytes](uint32_t vertex) {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + vertex * strideBytes);
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    // 硬边界：三个顶点都不在缓存中的三角形，在这里切开不会增加缓存缺失
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    auto simulate = [&](size_t triangle) {
+        uint32_t misses = 0;
+        for (size_t k = 0; k < 3; k++) {
+            uint32_t vertex = indices[triangle * 3 + k];
+            if (time - timestamps[vertex] > cacheSize) {
+                timestamps[vertex] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    };
+    auto resetCache = [&]() {
+        time += cacheSize + 1;
+    };
+    // 第一个三角形总是硬边界（即使它有重复的顶点），保证每个三角形都属于某个簇
+    std::vector<uint32_t> hardBoundaries;
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (simulate(t) == 3 || t == 0) {
+            hardBoundaries.push_back(static_cast<uint32_t>(t));
+        }
+    }
+    hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+
+    // 软边界：在硬边界之间，簇内累计的 ACMR 不超过 整个硬簇的ACMR * threshold 时就可以切开
+    std::vector<uint32_t> clusters;
+    for (size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+        uint32_t begin = hardBoundaries[h];
+        uint32_t end = hardBoundaries[h + 1];
+        resetCache();
+        uint32_t clusterMisses = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            clusterMisses += simulate(t);
+        }
+        float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        clusters.push_back(begin);
+        resetCache();
+        uint32_t start = begin;
+        uint32_t misses = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            misses += simulate(t);
+            if (t + 1 < end && static_cast<float>(misses) / static_cast<float>(t + 1 - start) <= clusterThreshold) {
+                clusters.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                resetCache();
+            }
+        }
+    }
+    const size_t clusterCount = clusters.size();
+    clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+    // 每个簇的面积加权中心和法线，按照中心相对于网格中心在法线方向上的距离从大到小排序
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+    for (size_t c = 0; c < clusterCount; c++) {
+        float clusterArea = 0.0f;
+        for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            glm::vec3 a = position(indices[t * 3]);
+            glm::vec3 b = position(indices[t * 3 + 1]);
+            glm::vec3 d = position(indices[t * 3 + 2]);
+            glm::vec3 normal = glm::cross(b - a, d - a);
+            float area = glm::length(normal);
+            glm::vec3 center = (a + b + d) / 3.0f;
+            clusterCenters[c] += center * area;
+            clusterNormals[c] += normal;
+            clusterArea += area;
+        }
+        meshCenter += clusterCenters[c];
+        meshArea += clusterArea;
+        clusterCenters[c] = clusterArea > 0.0f ? clusterCenters[c] / clusterArea : position(indices[clusters[c] * 3]);
+    }
+    meshCenter = meshArea > 0.0f ? meshCenter / meshArea : glm::vec3(0.0f);
+
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        float length = glm::length(clusterNormals[c]);
+        sortKeys[c] = length > 0.0f ? glm::dot(clusterCenters[c] - meshCenter, clusterNormals[c] / length) : 0.0f;
+    }
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        order[c] = static_cast<uint32_t>(c);
+    }
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    uint32_t* output = destination;
+    for (uint32_t c : order) {
+        size_t count = (clusters[c + 1] - clusters[c]) * 3;
+        std::memcpy(output, indices + clusters[c] * 3, count * sizeof(uint32_t));
+        output += count;
+    }
+    // 不足一个三角形的剩余索引保持在最后
+    std::memcpy(output, indices + triangleCount * 3, (indexCount - triangleCount * 3) * sizeof(uint32_t));
+    output += indexCount - triangleCount * 3;
+    assert(static_cast<size_t>(output - destination) == indexCount);
+}
+
+/* ------------------------------------------ 顶点读取优化 ------------------------------------------*/
+// 原地重排 vertices 并改写 indices，返回被索引引用的顶点数；没有被引用的顶点按原顺序放在最后
+inline size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t strideBytes, uint32_t* indices, size_t indexCount) {
+    const uint32_t UNUSED = ~0u;
+    std::vector<uint32_t> remap(vertexCount, UNUSED);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        uint32_t& target = remap[indices[i]];
+        if (target == UNUSED) {
+            target = next++;
+        }
+        indices[i] = target;
+    }
+    const size_t usedCount = next;
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (remap[v] == UNUSED) {
+            remap[v] = next++;
+        }
+    }
+
+    std::vector<unsigned char> source(static_cast<const unsigned char*>(vertices),
+                                      static_cast<const unsigned char*>(vertices) + vertexCount * strideBytes);
+    unsigned char* target = static_cast<unsigned char*>(vertices);
+    for (size_t v = 0; v < vertexCount; v++) {
+        std::memcpy(target + remap[v] * strideBytes, source.data() + v * strideBytes, strideBytes);
+    }
+    return usedCount;
+}
+
+/* ------------------------------------------ 完整的优化流程 ------------------------------------------*/
+struct MeshOptimizationReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// 一个网格的顶点和索引，位置在每个顶点的最前面，索引是网格内部的顶点编号
+struct MeshView {
+    void* vertices;
+    size_t vertexCount;
+    size_t strideBytes;
+    uint32_t* indices;
+    size_t indexCount;
+};
+
+// 依次做顶点缓存优化、过度绘制优化、顶点读取优化，overdrawThreshold 小于等于0时跳过过度绘制优化
+inline MeshOptimizationReport optimizeMesh(const MeshView& mesh, float overdrawThreshold = 1.05f) {
+    MeshOptimizationReport report;
+    report.before = analyzeVertexCache(mesh.indices, mesh.indexCount, mesh.vertexCount);
+
+    std::vector<uint32_t> temporary(mesh.indexCount);
+    optimizeVertexCache(temporary.data(), mesh.indices, mesh.indexCount, mesh.vertexCount);
+    if (overdrawThreshold > 0.0f) {
+        optimizeOverdraw(mesh.indices, temporary.data(), mesh.indexCount, static_cast<const float*>(mesh.vertices),
+                         mesh.vertexCount, mesh.strideBytes, overdrawThreshold);
+    } else {
+        std::copy(temporary.begin(), temporary.end(), mesh.indices);
+    }
+    optimizeVertexFetch(mesh.vertices, mesh.vertexCount, mesh.strideBytes, mesh.indices, mesh.indexCount);
+
+    report.after = analyzeVertexCache(mesh.indices, mesh.indexCount, mesh.vertexCount);
+    return report;
+}
+
+// 把多个网格分配到 threadCount 个线程上优化，每个网格互相独立，结果与线程数无关
+inline std::vector<MeshOptimizationReport> optimizeMeshes(const std::vector<MeshView>& meshes, float overdrawThreshold = 1.05f,
+                                                          unsigned int threadCount = std::thread::hardware_concurrency()) {
+    std::vector<MeshOptimizationReport> reports(meshes.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < meshes.size(); i = next++) {
+            reports[i] = optimizeMesh(meshes[i], overdrawThreshold);
+        }
+    };
+    threadCount = std::max(1u, std::min<unsigned int>(threadCount, static_cast<unsigned int>(meshes.size())));
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return reports;
+}
+
+// 同上，每个网格是 jobs 中的一个任务
+inline std::vector<MeshOptimizationReport> optimizeMeshes(JobSystem& jobs, const std::vector<MeshView>& meshes,
+                                                          float overdrawThreshold = 1.05f) {
+    std::vector<MeshOptimizationReport> reports(meshes.size());
+    jobs.parallelFor(0, meshes.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            reports[i] = optimizeMesh(meshes[i], overdrawThreshold);
+        }
+    });
+    return reports;
+}
+
+} // namespace mesh_optimizer
+
+#endif // MESH_OPTIMIZER_H
@@ -0,0 +1,350 @@
+// 网格简化，基于二次误差度量（Garland & Heckbert, "Surface Simplification Using Quadric Error Metrics"）的边折叠
+//  -- 只做半边折叠：把顶点v合并到相邻顶点w上，不产生新的顶点，简化结果只是一个新的索引列表，
+//     因此同一个网格的所有LOD可以共享一份顶点数据（见 GeometryPool::allocateIndices）
+//  -- 属性完全相同的顶点先合并；位置相同但属性不同的顶点（纹理接缝）和边界上的顶点不会被移除
+//  -- 每一轮按折叠代价从小到大选取互不相邻的边折叠，直到达到目标索引数或者误差上限
+// 返回的误差是对象空间中的距离，运行时用它计算屏幕空间误差来选择LOD（见 lod.h）
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "mesh_optimizer.h"
+
+namespace mesh_simplifier {
+
+// 对称的4x4矩阵，只保存上三角的10个元素；weight 为累加的三角形面积
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+    double weight = 0;
+
+    // 平面 ax + by + cz + d = 0，(a, b, c) 为单位法线
+    static Quadric fromPlane(double a, double b, double c, double d, double weight) {
+        Quadric q;
+        q.a2 = a * a * weight; q.ab = a * b * weight; q.ac = a * c * weight; q.ad = a * d * weight;
+        q.b2 = b * b * weight; q.bc = b * c * weight; q.bd = b * d * weight;
+        q.c2 = c * c * weight; q.cd = c * d * weight;
+        q.d2 = d * d * weight;
+        q.weight = weight;
+        return q;
+    }
+
+    void add(const Quadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        weight += q.weight;
+    }
+
+    // 点到所有平面距离平方的加权和
+    double evaluate(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+               b2 * y * y + 2 * bc * y * z + 2 * bd * y +
+               c2 * z * z + 2 * cd * z + d2;
+    }
+};
+
+struct SimplifyResult {
+    std::vector<uint32_t> indices;
+    float error = 0.0f;         // 折叠过程中最大的平均距离，对象空间单位
+};
+
+namespace detail {
+
+constexpr uint32_t NONE = ~0u;
+
+// 按字节比较顶点，用于合并属性完全相同的顶点
+struct VertexBytes {
+    const unsigned char* data;
+    size_t stride;
+    size_t size;     // 参与比较的字节数
+
+    size_t hash(uint32_t vertex) const {
+        const unsigned char* p = data + vertex * stride;
+        size_t h = 2166136261u;
+        for (size_t i = 0; i < size; i++) {
+            h = (h ^ p[i]) * 16777619u;
+        }
+        return h;
+    }
+
+    bool equal(uint32_t a, uint32_t b) const {
+        return std::memcmp(data + a * stride, data + b * stride, size) == 0;
+    }
+};
+
+// 返回每个顶点对应的第一个相同顶点的编号
+inline std::vector<uint32_t> weldVertices(const VertexBytes& bytes, size_t vertexCount) {
+    auto hash = [&bytes](uint32_t v) { return bytes.hash(v); };
+    auto equal = [&bytes](uint32_t a, uint32_t b) { return bytes.equal(a, b); };
+    std::unordered_map<uint32_t, uint32_t, decltype(hash), decltype(equal)> table(vertexCount, hash, equal);
+    std::vector<uint32_t> canonical(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        canonical[v] = table.emplace(v, v).first->second;
+    }
+    return canonical;
+}
+
+struct Collapse {
+    uint32_t from;          // 被移除的位置顶点
+    uint32_t to;            // 保留的位置顶点
+    uint32_t toWedge;       // 折叠后使用的 to 的顶点（与 from 在同一侧的纹理接缝）
+    float cost;
+};
+
+} // namespace detail
+
+// targetIndexCount 为目标索引数，targetError 为允许的最大误差（对象空间距离）
+inline SimplifyResult simplify(const float* vertices, size_t vertexCount, size_t strideBytes, const uint32_t* indices, size_t indexCount,
+                               size_t targetIndexCount, float targetError = FLT_MAX) {
+    using namespace detail;
+    SimplifyResult result;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertices);
+    auto position = [bytes, strideBytes](uint32_t vertex) {
+        const float* p = reinterpret_cast<const float*>(bytes + vertex * strideBytes);
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    // wedge: 属性完全相同的顶点合并后的编号；positionId: 位置相同的顶点合并后的编号
+    std::vector<uint32_t> wedge = weldVertices({bytes, strideBytes, strideBytes}, vertexCount);
+    std::vector<uint32_t> positionId = weldVertices({bytes, strideBytes, 3 * sizeof(float)}, vertexCount);
+
+    // 一个位置上有多个不同的顶点就是纹理接缝
+    std::vector<uint32_t> wedgeOfPosition(vertexCount, NONE);
+    std::vector<char> locked(vertexCount, 0);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        uint32_t p = positionId[v];
+        if (wedgeOfPosition[p] == NONE) {
+            wedgeOfPosition[p] = wedge[v];
+        } else if (wedgeOfPosition[p] != wedge[v]) {
+            locked[p] = 1;
+        }
+    }
+
+    // 三角形保存wedge编号，去掉退化的三角形
+    std::vector<uint32_t> triangles;
+    triangles.reserve(indexCount);
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        uint32_t a = wedge[indices[i]], b = wedge[indices[i + 1]], c = wedge[indices[i + 2]];
+        if (positionId[a] != positionId[b] && positionId[b] != positionId[c] && positionId[a] != positionId[c]) {
+            triangles.insert(triangles.end(), {a, b, c});
+        }
+    }
+
+    // 只被一个三角形使用的边是边界，被两个以上三角形使用的边是非流形边，它们的顶点都不能移除
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeCounts;
+        edgeCounts.reserve(triangles.size());
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = positionId[triangles[i + k]];
+                uint32_t b = positionId[triangles[i + (k + 1) % 3]];
+                edgeCounts[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)]++;
+            }
+        }
+        for (const auto& [edge, count] : edgeCounts) {
+            if (count != 2) {
+                locked[static_cast<uint32_t>(edge >> 32)] = 1;
+                locked[static_cast<uint32_t>(edge & 0xffffffffu)] = 1;
+            }
+        }
+    }
+
+    // 每个位置顶点的二次误差为相邻三角形平面的面积加权和
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < triangles.size(); i += 3) {
+        glm::vec3 a = position(triangles[i]), b = position(triangles[i + 1]), c = position(triangles[i + 2]);
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float area = glm::length(normal);
+        if (area <= 0.0f) {
+            continue;
+        }
+        normal /= area;
+        Quadric q = Quadric::fromPlane(normal.x, normal.y, normal.z, -glm::dot(normal, a), area * 0.5);
+        for (int k = 0; k < 3; k++) {
+            quadrics[positionId[triangles[i + k]]].add(q);
+        }
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> candidates;
+    std::vector<char> touched(vertexCount);
+    std::vector<uint32_t> collapseTo(vertexCount, NONE);
+    std::vector<uint32_t> wedgeRemap(vertexCount, NONE);
+    const size_t targetTriangles = targetIndexCount / 3;
+    const double maxCost = static_cast<double>(targetError) * targetError;
+    double resultCost = 0.0;
+
+    while (triangles.size() / 3 > targetTriangles) {
+        const size_t triangleCount = triangles.size() / 3;
+
+        // 位置顶点 -> 三角形 的邻接表
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t corner : triangles) {
+            adjacencyOffsets[positionId[corner] + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        adjacency.resize(triangles.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < triangles.size(); i++) {
+                adjacency[fill[positionId[triangles[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // 所有可以移除起点的有向边及其代价
+        candidates.clear();
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t fromWedge = triangles[i + k];
+                uint32_t toWedge = triangles[i + (k + 1) % 3];
+                for (int direction = 0; direction < 2; direction++) {
+                    uint32_t from = positionId[fromWedge];
+                    uint32_t to = positionId[toWedge];
+                    if (!locked[from]) {
+                        Quadric q = quadrics[from];
+                        q.add(quadrics[to]);
+                        double cost = q.weight > 0.0 ? std::max(0.0, q.evaluate(position(to))) / q.weight : 0.0;
+                        candidates.push_back({from, to, toWedge, static_cast<float>(cost)});
+                    }
+                    std::swap(fromWedge, toWedge);
+                }
+            }
+        }
+        // 代价相同时按编号排序，保证结果是确定的
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) {
+            if (a.cost != b.cost) {
+                return a.cost < b.cost;
+            }
+            return a.from != b.from ? a.from < b.from : a.to < b.to;
+        });
+
+        // 每一轮最多折叠剩余三角形数的一半（每次折叠大约减少两个三角形）
+        const size_t collapseLimit = std::max<size_t>(1, (triangleCount - targetTriangles) / 2);
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t collapses = 0;
+        for (const Collapse& collapse : candidates) {
+            if (collapses >= collapseLimit || collapse.cost > maxCost) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+            // 折叠后不能有三角形翻转
+            bool flipped = false;
+            glm::vec3 target = position(collapse.to);
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && !flipped; a++) {
+                const uint32_t* triangle = &triangles[adjacency[a] * 3];
+                glm::vec3 p[3];
+                glm::vec3 q[3];
+                bool containsTarget = false;
+                for (int k = 0; k < 3; k++) {
+                    uint32_t id = positionId[triangle[k]];
+                    containsTarget = containsTarget || id == collapse.to;
+                    p[k] = position(triangle[k]);
+                    q[k] = id == collapse.from ? target : p[k];
+                }
+                if (containsTarget) {
+                    continue;
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                flipped = glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after);
+            }
+            if (flipped) {
+                continue;
+            }
+
+            collapseTo[collapse.from] = collapse.to;
+            wedgeRemap[wedgeOfPosition[collapse.from]] = collapse.toWedge;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            resultCost = std::max(resultCost, static_cast<double>(collapse.cost));
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++) {
+                for (int k = 0; k < 3; k++) {
+                    touched[positionId[triangles[adjacency[a] * 3 + k]]] = 1;
+                }
+            }
+            collapses++;
+        }
+        if (collapses == 0) {
+            break;
+        }
+
+        // 应用这一轮的折叠，去掉退化的三角形
+        size_t write = 0;
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            uint32_t corners[3];
+            for (int k = 0; k < 3; k++) {
+                uint32_t corner = triangles[i + k];
+                corners[k] = collapseTo[positionId[corner]] != NONE ? wedgeRemap[corner] : corner;
+            }
+            if (positionId[corners[0]] != positionId[corners[1]] && positionId[corners[1]] != positionId[corners[2]] &&
+                positionId[corners[0]] != positionId[corners[2]]) {
+                std::copy(corners, corners + 3, triangles.begin() + write);
+                write += 3;
+            }
+        }
+        triangles.resize(write);
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            if (collapseTo[v] != NONE) {
+                locked[v] = 1;          // 已经移除的顶点不会再出现
+                collapseTo[v] = NONE;
+            }
+        }
+    }
+
+    result.indices = std::move(triangles);
+    result.error = static_cast<float>(std::sqrt(resultCost));
+    return result;
+}
+
+/* ------------------------------------------ LOD链 ------------------------------------------*/
+struct LodLevel {
+    std::vector<uint32_t> indices;
+    float error = 0.0f;         // 相对于原始网格的误差，逐级单调递增
+};
+
+// 第0级是原始网格，之后每一级的目标三角形数为上一级的 reduction 倍
+// 简化不动时（例如只剩边界和接缝）提前结束；每一级都做一次顶点缓存优化
+inline std::vector<LodLevel> generateLodChain(const float* vertices, size_t vertexCount, size_t strideBytes,
+                                              const uint32_t* indices, size_t indexCount,
+                                              size_t maxLevels = 5, float reduction = 0.5f, float maxError = FLT_MAX) {
+    std::vector<LodLevel> levels;
+    levels.push_back({std::vector<uint32_t>(indices, indices + indexCount), 0.0f});
+    while (levels.size() < maxLevels) {
+        const LodLevel& previous = levels.back();
+        size_t target = static_cast<size_t>(previous.indices.size() / 3 * reduction) * 3;
+        SimplifyResult simplified = simplify(vertices, vertexCount, strideBytes, previous.indices.data(), previous.indices.size(), target, maxError);
+        if (simplified.indices.empty() || simplified.indices.size() > previous.indices.size() * 0.9) {
+            break;
+        }
+        LodLevel level;
+        level.indices.resize(simplified.indices.size());
+        mesh_optimizer::optimizeVertexCache(level.indices.data(), simplified.indices.data(), simplified.indices.size(), vertexCount);
+        // 每一级都是从上一级简化得到的，误差累加作为相对于原始网格的保守估计
+        level.error = previous.error + simplified.error;
+        levels.push_back(std::move(level));
+    }
+    return levels;
+}
+
+} // namespace mesh_simplifier
+
+#endif // MESH_SIMPLIFIER_H
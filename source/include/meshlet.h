@@ -0,0 +1,392 @@
+// 网格簇（meshlet）：把大网格切分成最多 MAX_VERTICES 个顶点、MAX_TRIANGLES 个三角形的小簇
+//  -- 构建（离线或加载时）：贪心地从一个三角形开始，每次加入新增顶点最少、离簇中心最近、法线最接近的相邻三角形
+//     簇的三角形在索引列表中连续存放，因此每个簇就是原网格中的一段索引区间，可以直接作为间接绘制命令
+//  -- 每个簇计算包围球和法线锥，运行时按簇剔除：包围球在视锥体外，或者法线锥表明所有三角形都背对相机
+//  -- 剔除在对象空间中进行，每次处理4个簇（SSE2），没有SSE2时使用标量实现，两者结果相同
+// 背面剔除的判定与 meshoptimizer 的 meshopt_computeMeshletBounds 相同：
+//   dot(center - camera, coneAxis) >= coneCutoff * length(center - camera) + radius
+
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "frustum.h"
+#include "geometry_pool.h"
+#include "simd.h"
+
+namespace meshlet {
+
+// 与 mesh shader 常用的限制相同（NVIDIA推荐 64 个顶点 / 124 个三角形）
+constexpr size_t MAX_VERTICES = 64;
+constexpr size_t MAX_TRIANGLES = 124;
+
+struct Meshlet {
+    uint32_t firstIndex;        // 在 MeshletMesh::indices 中的位置
+    uint32_t indexCount;
+    uint32_t vertexCount;       // 簇中不同顶点的个数
+};
+
+struct MeshletBounds {
+    glm::vec3 center;
+    float radius;
+    glm::vec3 coneAxis;
+    float coneCutoff;           // 法线锥半角的正弦，等于1时表示不能做背面剔除
+};
+
+struct MeshletMesh {
+    std::vector<uint32_t> indices;      // 按簇重新排列后的三角形，顶点编号不变
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshletBounds> bounds;
+};
+
+namespace detail {
+
+constexpr uint32_t NONE = ~0u;
+
+inline glm::vec3 readPosition(const unsigned char* vertices, size_t strideBytes, uint32_t vertex) {
+    const float* p = reinterpret_cast<const float*>(vertices + vertex * strideBytes);
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+inline MeshletBounds computeBounds(const unsigned char* vertices, size_t strideBytes, const uint32_t* indices, size_t indexCount) {
+    MeshletBounds bounds;
+    glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+    for (size_t i = 0; i < indexCount; i++) {
+        glm::vec3 p = readPosition(vertices, strideBytes, indices[i]);
+        boundsMin = glm::min(boundsMin, p);
+        boundsMax = glm::max(boundsMax, p);
+    }
+    bounds.center = (boundsMin + boundsMax) * 0.5f;
+    bounds.radius = 0.0f;
+    for (size_t i = 0; i < indexCount; i++) {
+        bounds.radius = std::max(bounds.radius, glm::length(readPosition(vertices, strideBytes, indices[i]) - bounds.center));
+    }
+
+    // 法线锥：轴为三角形法线的平均方向，半角由偏离轴最远的法线决定
+    std::vector<glm::vec3> normals;
+    normals.reserve(indexCount / 3);
+    glm::vec3 axis(0.0f);
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        glm::vec3 a = readPosition(vertices, strideBytes, indices[i]);
+        glm::vec3 b = readPosition(vertices, strideBytes, indices[i + 1]);
+        glm::vec3 c = readPosition(vertices, strideBytes, indices[i + 2]);
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        if (length > 0.0f) {
+            normals.push_back(normal / length);
+            axis += normals.back();
+        }
+    }
+    float axisLength = glm::length(axis);
+    bounds.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+    float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+    for (const auto& normal : normals) {
+        minDot = std::min(minDot, glm::dot(normal, bounds.coneAxis));
+    }
+    // 锥的半角接近90度时几乎不可能被剔除，直接禁用
+    bounds.coneCutoff = minDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+    return bounds;
+}
+
+} // namespace detail
+
+// vertices 的前三个float为位置；coneWeight 越大，簇内法线越一致（背面剔除率更高），但簇的形状越不紧凑
+inline MeshletMesh buildMeshlets(const float* vertices, size_t vertexCount, size_t strideBytes, const uint32_t* indices, size_t indexCount,
+                                 size_t maxVertices = MAX_VERTICES, size_t maxTriangles = MAX_TRIANGLES, float coneWeight = 0.5f) {
+    using namespace detail;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertices);
+    const size_t triangleCount = indexCount / 3;
+    MeshletMesh result;
+    result.indices.reserve(triangleCount * 3);
+
+    // 顶点 -> 三角形 的邻接表
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        offsets[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    std::vector<glm::vec3> normals(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        glm::vec3 a = readPosition(bytes, strideBytes, indices[t * 3]);
+        glm::vec3 b = readPosition(bytes, strideBytes, indices[t * 3 + 1]);
+        glm::vec3 c = readPosition(bytes, strideBytes, indices[t * 3 + 2]);
+        centroids[t] = (a + b + c) / 3.0f;
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        normals[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+    }
+
+    // 每个顶点还没有加入簇的三角形个数，优先选择会变成孤立三角形的候选，避免最后留下很多零散的小簇
+    std::vector<uint32_t> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        live[v] = offsets[v + 1] - offsets[v];
+    }
+    auto minLive = [&](uint32_t triangle) {
+        return std::min({live[indices[triangle * 3]], live[indices[triangle * 3 + 1]], live[indices[triangle * 3 + 2]]});
+    };
+
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<uint32_t> vertexMeshlet(vertexCount, NONE);      // 顶点当前属于哪个簇
+    std::vector<uint32_t> candidates;
+    size_t nextSeed = 0;
+
+    auto newVertices = [&](uint32_t triangle, uint32_t meshletIndex) {
+        uint32_t count = 0;
+        for (int k = 0; k < 3; k++) {
+            count += vertexMeshlet[indices[triangle * 3 + k]] != meshletIndex;
+        }
+        return count;
+    };
+
+    glm::vec3 previousCenter(0.0f);
+    while (true) {
+        // 新的簇从上一个簇边缘上离它最近的三角形开始，这样簇会连片地推进，不会留下零散的小块
+        uint32_t triangle = NONE;
+        uint32_t seedLive = ~0u;
+        float seedDistance = FLT_MAX;
+        for (uint32_t candidate : candidates) {
+            if (emitted[candidate]) {
+                continue;
+            }
+            uint32_t candidateLive = minLive(candidate);
+            float distance = glm::length(centroids[candidate] - previousCenter);
+            if (candidateLive < seedLive || (candidateLive == seedLive && (distance < seedDistance || (distance == seedDistance && candidate < triangle)))) {
+                seedLive = candidateLive;
+                seedDistance = distance;
+                triangle = candidate;
+            }
+        }
+        if (triangle == NONE) {
+            while (nextSeed < triangleCount && emitted[nextSeed]) {
+                nextSeed++;
+            }
+            if (nextSeed == triangleCount) {
+                break;
+            }
+            triangle = static_cast<uint32_t>(nextSeed);
+        }
+
+        const uint32_t meshletIndex = static_cast<uint32_t>(result.meshlets.size());
+        Meshlet current{static_cast<uint32_t>(result.indices.size()), 0, 0};
+        glm::vec3 centroidSum(0.0f);
+        glm::vec3 normalSum(0.0f);
+        candidates.clear();
+
+        while (triangle != NONE) {
+            // 加入三角形，并把它的顶点相邻的三角形加入候选
+            emitted[triangle] = 1;
+            for (int k = 0; k < 3; k++) {
+                uint32_t vertex = indices[triangle * 3 + k];
+                result.indices.push_back(vertex);
+                live[vertex]--;
+                if (vertexMeshlet[vertex] != meshletIndex) {
+                    vertexMeshlet[vertex] = meshletIndex;
+                    current.vertexCount++;
+                    for (uint32_t a = offsets[vertex]; a < offsets[vertex + 1]; a++) {
+                        if (!emitted[adjacency[a]]) {
+                            candidates.push_back(adjacency[a]);
+                        }
+                    }
+                }
+            }
+            current.indexCount += 3;
+            centroidSum += centroids[triangle];
+            normalSum += normals[triangle];
+            if (current.indexCount / 3 >= maxTriangles) {
+                break;
+            }
+
+            // 选择下一个三角形：新增顶点数优先，其次是到簇中心的距离和法线差异
+            // 这里的新增顶点数只用于比较优先级，是否超过顶点数限制按实际的个数判断
+            glm::vec3 center = centroidSum / static_cast<float>(current.indexCount / 3);
+            float normalLength = glm::length(normalSum);
+            glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+            triangle = NONE;
+            uint32_t bestNew = 4;
+            float bestScore = FLT_MAX;
+            size_t write = 0;
+            for (size_t c = 0; c < candidates.size(); c++) {
+                uint32_t candidate = candidates[c];
+                if (emitted[candidate]) {
+                    continue;
+                }
+                candidates[write++] = candidate;
+                uint32_t added = newVertices(candidate, meshletIndex);
+                if (current.vertexCount + added > maxVertices) {
+                    continue;
+                }
+                float score = glm::length(centroids[candidate] - center) * (1.0f + coneWeight * (1.0f - glm::dot(normals[candidate], axis)));
+                // 某个顶点只剩这一个三角形时提高它的优先级，否则它以后很可能只能单独成簇
+                if (minLive(candidate) == 1) {
+                    added = added > 0 ? added - 1 : 0;
+                }
+                if (added < bestNew || (added == bestNew && (score < bestScore || (score == bestScore && candidate < triangle)))) {
+                    bestNew = added;
+                    bestScore = score;
+                    triangle = candidate;
+                }
+            }
+            candidates.resize(write);
+        }
+
+        previousCenter = centroidSum / static_cast<float>(current.indexCount / 3);
+        result.bounds.push_back(computeBounds(bytes, strideBytes, &result.indices[current.firstIndex], current.indexCount));
+        result.meshlets.push_back(current);
+    }
+    return result;
+}
+
+// 网格整体上传到几何池后，一个簇对应的绘制区间
+inline PoolMesh clusterMesh(const PoolMesh& mesh, const Meshlet& meshlet) {
+    PoolMesh cluster;
+    cluster.baseVertex = mesh.baseVertex;
+    cluster.firstIndex = mesh.firstIndex + meshlet.firstIndex;
+    cluster.indexCount = meshlet.indexCount;
+    return cluster;
+}
+
+/* ------------------------------------------ 剔除 ------------------------------------------*/
+
+// SoA布局的簇包围数据，长度补齐到4的倍数，补齐的簇半径为负（总是被视锥剔除）
+struct ClusterBounds {
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> axisX, axisY, axisZ, cutoff;
+    size_t count = 0;
+
+    explicit ClusterBounds(const std::vector<MeshletBounds>& bounds) : count(bounds.size()) {
+        size_t padded = (count + 3) & ~size_t(3);
+        for (auto* array : {&centerX, &centerY, &centerZ, &axisX, &axisY, &axisZ}) {
+            array->assign(padded, 0.0f);
+        }
+        radius.assign(padded, -FLT_MAX);
+        cutoff.assign(padded, 1.0f);
+        for (size_t i = 0; i < count; i++) {
+            centerX[i] = bounds[i].center.x;
+            centerY[i] = bounds[i].center.y;
+            centerZ[i] = bounds[i].center.z;
+            radius[i] = bounds[i].radius;
+            axisX[i] = bounds[i].coneAxis.x;
+            axisY[i] = bounds[i].coneAxis.y;
+            axisZ[i] = bounds[i].coneAxis.z;
+            cutoff[i] = bounds[i].coneCutoff;
+        }
+    }
+};
+
+// 每帧累加的统计
+struct ClusterCullStats {
+    size_t tested = 0;
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;
+    size_t visible = 0;
+
+    void reset() {
+        *this = ClusterCullStats();
+    }
+};
+
+// frustum 和 cameraPosition 都在网格的对象空间中（见 Frustum::fromMatrix(projection * view * model)）
+// 对象空间中的平面已经归一化，因此模型矩阵可以带均匀缩放
+// 可见簇的编号写入 visible（至少 bounds.count 个元素），返回可见簇的个数
+inline size_t cullClustersScalar(const ClusterBounds& bounds, const Frustum& frustum, const glm::vec3& cameraPosition,
+                                 uint32_t* visible, ClusterCullStats& stats) {
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < bounds.count; i++) {
+        glm::vec3 center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+        if (!frustum.intersectsSphere(center, bounds.radius[i])) {
+            stats.frustumCulled++;
+            continue;
+        }
+        glm::vec3 offset = center - cameraPosition;
+        glm::vec3 axis(bounds.axisX[i], bounds.axisY[i], bounds.axisZ[i]);
+        if (glm::dot(offset, axis) >= bounds.cutoff[i] * glm::length(offset) + bounds.radius[i]) {
+            stats.backfaceCulled++;
+            continue;
+        }
+        visible[visibleCount++] = static_cast<uint32_t>(i);
+    }
+    stats.tested += bounds.count;
+    stats.visible += visibleCount;
+    return visibleCount;
+}
+
+inline size_t cullClusters(const ClusterBounds& bounds, const Frustum& frustum, const glm::vec3& cameraPosition,
+                           uint32_t* visible, ClusterCullStats& stats) {
+#ifdef SIMD_SSE2
+    __m128 planeX[Frustum::PLANE_COUNT], planeY[Frustum::PLANE_COUNT], planeZ[Frustum::PLANE_COUNT], planeW[Frustum::PLANE_COUNT];
+    for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    const __m128 cameraX = _mm_set1_ps(cameraPosition.x);
+    const __m128 cameraY = _mm_set1_ps(cameraPosition.y);
+    const __m128 cameraZ = _mm_set1_ps(cameraPosition.z);
+    const __m128 zero = _mm_setzero_ps();
+    const size_t padded = bounds.centerX.size();
+    size_t visibleCount = 0;
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;
+    for (size_t i = 0; i < padded; i += 4) {
+        __m128 x = _mm_loadu_ps(&bounds.centerX[i]);
+        __m128 y = _mm_loadu_ps(&bounds.centerY[i]);
+        __m128 z = _mm_loadu_ps(&bounds.centerZ[i]);
+        __m128 r = _mm_loadu_ps(&bounds.radius[i]);
+        // dot(normal, center) + d + radius >= 0 对所有平面成立
+        __m128 inside = _mm_cmpge_ps(r, zero);
+        for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+                                         _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, r), zero));
+        }
+        __m128 dx = _mm_sub_ps(x, cameraX);
+        __m128 dy = _mm_sub_ps(y, cameraY);
+        __m128 dz = _mm_sub_ps(z, cameraZ);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        __m128 projection = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&bounds.axisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&bounds.axisY[i]))),
+                                       _mm_mul_ps(dz, _mm_loadu_ps(&bounds.axisZ[i])));
+        __m128 backface = _mm_cmpge_ps(projection, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&bounds.cutoff[i]), length), r));
+
+        int insideMask = _mm_movemask_ps(inside);
+        int visibleMask = insideMask & ~_mm_movemask_ps(backface);
+        // 补齐的簇不计入统计
+        int validMask = i + 4 <= bounds.count ? 0xF : (1 << (bounds.count - i)) - 1;
+        frustumCulled += popCount(static_cast<uint32_t>(validMask & ~insideMask));
+        backfaceCulled += popCount(static_cast<uint32_t>(insideMask & ~visibleMask));
+        while (visibleMask != 0) {
+            visible[visibleCount++] = static_cast<uint32_t>(i + countTrailingZeros(static_cast<uint32_t>(visibleMask)));
+            visibleMask &= visibleMask - 1;
+        }
+    }
+    stats.tested += bounds.count;
+    stats.frustumCulled += frustumCulled;
+    stats.backfaceCulled += backfaceCulled;
+    stats.visible += visibleCount;
+    return visibleCount;
+#else
+    return cullClustersScalar(bounds, frustum, cameraPosition, visible, stats);
+#endif
+}
+
+} // namespace meshlet
+
+#endif // MESHLET_H
@@ -0,0 +1,488 @@
+// 模型加载，分为三部分：
+//  -- importModel  : 用assimp导入模型，转换为 StandardVertexLayout 的顶点和32位索引，可选地对每个子网格做
+//                    顶点缓存/过度绘制/顶点读取优化（见 mesh_optimizer.h），优化后的结果也会写入缓存
+//  -- mesh_cache   : 带版本号的二进制网格缓存，加载时直接内存映射，不经过assimp，也不复制数据
+//  -- ModelLoader  : 在工作线程上加载模型（优先读缓存，缓存不存在或过期时导入并写缓存）
+// 上传到GPU时，uploadModel 把每个子网格直接从映射的内存写入 GeometryPool
+// 用法：
+//     ModelLoader loader;
+//     std::future<std::shared_ptr<ModelData>> future = loader.load("models/sponza.obj");
+//     ...
+//     std::shared_ptr<ModelData> model = future.get();
+//     std::vector<PoolMesh> meshes = uploadModel(pool, *model);
+
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "geometry_pool.h"
+#include "mapped_file.h"
+#include "mesh_optimizer.h"
+#include "vertex_format.h"
+
+// 模型中的一个子网格，索引是相对于子网格第一个顶点的编号
+struct ModelMesh {
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t materialIndex;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+// 模型的CPU端数据，顶点布局为 StandardVertexLayout
+// 数据或者保存在自己的vector中（刚导入时），或者直接指向映射的缓存文件（从缓存加载时）
+class ModelData {
+public:
+    static constexpr uint32_t FLOATS_PER_VERTEX = StandardVertexLayout::stride / sizeof(float);
+
+    const float* vertices() const {
+        return m_vertices;
+    }
+
+    const uint32_t* indices() const {
+        return m_indices;
+    }
+
+    uint32_t vertexCount() const {
+        return m_vertexCount;
+    }
+
+    uint32_t indexCount() const {
+        return m_indexCount;
+    }
+
+    const std::vector<ModelMesh>& meshes() const {
+        return m_meshes;
+    }
+
+    const float* meshVertices(const ModelMesh& mesh) const {
+        return m_vertices + static_cast<size_t>(mesh.firstVertex) * FLOATS_PER_VERTEX;
+    }
+
+    const uint32_t* meshIndices(const ModelMesh& mesh) const {
+        return m_indices + mesh.firstIndex;
+    }
+
+    bool fromCache() const {
+        return m_file.isOpen();
+    }
+
+    // 子网格是否经过了 mesh_optimizer 的优化
+    bool optimized() const {
+        return m_optimized;
+    }
+
+    // 只能在刚导入、还没有共享给其他线程时调用，从缓存加载的模型是只读的
+    std::vector<mesh_optimizer::MeshView> meshViews() {
+        std::vector<mesh_optimizer::MeshView> views;
+        if (fromCache()) {
+            return views;
+        }
+        for (const auto& mesh : m_meshes) {
+            views.push_back({&m_vertexStorage[static_cast<size_t>(mesh.firstVertex) * FLOATS_PER_VERTEX], mesh.vertexCount,
+                             StandardVertexLayout::stride, &m_indexStorage[mesh.firstIndex], mesh.indexCount});
+        }
+        return views;
+    }
+
+    void setOptimized(bool optimized) {
+        m_optimized = optimized;
+    }
+
+    // 由 importModel 填充
+    static std::shared_ptr<ModelData> fromVectors(std::vector<float>&& vertices, std::vector<uint32_t>&& indices,
+                                                  std::vector<ModelMesh>&& meshes) {
+        auto model = std::make_shared<ModelData>();
+        model->m_vertexStorage = std::move(vertices);
+        model->m_indexStorage = std::move(indices);
+        model->m_meshes = std::move(meshes);
+        model->m_vertices = model->m_vertexStorage.data();
+        model->m_indices = model->m_indexStorage.data();
+        model->m_vertexCount = static_cast<uint32_t>(model->m_vertexStorage.size() / FLOATS_PER_VERTEX);
+        model->m_indexCount = static_cast<uint32_t>(model->m_indexStorage.size());
+        return model;
+    }
+
+    // 由 mesh_cache::read 填充，vertices 和 indices 指向 file 中的数据
+    static std::shared_ptr<ModelData> fromMappedFile(MappedFile&& file, const float* vertices, uint32_t vertexCount,
+                                                     const uint32_t* indices, uint32_t indexCount, std::vector<ModelMesh>&& meshes) {
+        auto model = std::make_shared<ModelData>();
+        model->m_file = std::move(file);
+        model->m_vertices = vertices;
+        model->m_indices = indices;
+        model->m_vertexCount = vertexCount;
+        model->m_indexCount = indexCount;
+        model->m_meshes = std::move(meshes);
+        return model;
+    }
+
+private:
+    const float* m_vertices = nullptr;
+    const uint32_t* m_indices = nullptr;
+    uint32_t m_vertexCount = 0;
+    uint32_t m_indexCount = 0;
+    std::vector<ModelMesh> m_meshes;
+    bool m_optimized = false;
+
+    std::vector<float> m_vertexStorage;
+    std::vector<uint32_t> m_indexStorage;
+    MappedFile m_file;
+};
+
+/* ------------------------------------------ assimp 导入 ------------------------------------------*/
+// 节点的变换在导入时展开到顶点上(PreTransformVertices)，不是三角形的图元会被丢弃
+// 纹理坐标不翻转，与 loadTexture 的上下翻转相配合
+// optimize 为true时，在多个线程上并行优化各个子网格（结果与线程数无关）
+inline std::shared_ptr<ModelData> importModel(const std::string& path, Assimp::Importer& importer, bool optimize = false) {
+    const unsigned int flags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals |
+                               aiProcess_PreTransformVertices | aiProcess_SortByPType;
+    const aiScene* scene = importer.ReadFile(path, flags);
+    if (scene == nullptr || scene->mRootNode == nullptr || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)) {
+        std::cout << "Model failed to load at path: " << path << "\n" << importer.GetErrorString() << std::endl;
+        return nullptr;
+    }
+
+    // 先统计总数，一次分配好所有的顶点和索引
+    std::vector<ModelMesh> meshes;
+    size_t totalVertices = 0;
+    size_t totalIndices = 0;
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        if (!(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) || mesh->mNumVertices == 0) {
+            continue;
+        }
+        ModelMesh info = {};
+        info.firstVertex = static_cast<uint32_t>(totalVertices);
+        info.vertexCount = mesh->mNumVertices;
+        info.firstIndex = static_cast<uint32_t>(totalIndices);
+        info.indexCount = mesh->mNumFaces * 3;
+        info.materialIndex = mesh->mMaterialIndex;
+        meshes.push_back(info);
+        totalVertices += info.vertexCount;
+        totalIndices += info.indexCount;
+    }
+
+    std::vector<float> vertices(totalVertices * ModelData::FLOATS_PER_VERTEX);
+    std::vector<uint32_t> indices(totalIndices);
+    size_t meshIndex = 0;
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        if (!(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) || mesh->mNumVertices == 0) {
+            continue;
+        }
+        ModelMesh& info = meshes[meshIndex++];
+        float* vertex = &vertices[static_cast<size_t>(info.firstVertex) * ModelData::FLOATS_PER_VERTEX];
+        for (int axis = 0; axis < 3; axis++) {
+            info.boundsMin[axis] = info.boundsMax[axis] = mesh->mVertices[0][axis];
+        }
+        for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+            const aiVector3D& position = mesh->mVertices[v];
+            vertex[0] = position.x;
+            vertex[1] = position.y;
+            vertex[2] = position.z;
+            for (int axis = 0; axis < 3; axis++) {
+                info.boundsMin[axis] = std::min(info.boundsMin[axis], position[axis]);
+                info.boundsMax[axis] = std::max(info.boundsMax[axis], position[axis]);
+            }
+            if (mesh->HasNormals()) {
+                vertex[3] = mesh->mNormals[v].x;
+                vertex[4] = mesh->mNormals[v].y;
+                vertex[5] = mesh->mNormals[v].z;
+            } else {
+                vertex[3] = vertex[4] = vertex[5] = 0.0f;
+            }
+            if (mesh->HasTextureCoords(0)) {
+                vertex[6] = mesh->mTextureCoords[0][v].x;
+                vertex[7] = mesh->mTextureCoords[0][v].y;
+            } else {
+                vertex[6] = vertex[7] = 0.0f;
+            }
+            vertex += ModelData::FLOATS_PER_VERTEX;
+        }
+
+        uint32_t* index = &indices[info.firstIndex];
+        for (unsigned int f = 0; f < mesh->mNumFaces; f++) {
+            const aiFace& face = mesh->mFaces[f];
+            // Triangulate 之后只剩三角形，SortByPType 把点和线分到了其他网格中
+            for (unsigned int k = 0; k < 3; k++) {
+                *index++ = k < face.mNumIndices ? face.mIndices[k] : face.mIndices[0];
+            }
+        }
+    }
+    importer.FreeScene();
+    std::shared_ptr<ModelData> model = ModelData::fromVectors(std::move(vertices), std::move(indices), std::move(meshes));
+    if (optimize) {
+        mesh_optimizer::optimizeMeshes(model->meshViews());
+        model->setOptimized(true);
+    }
+    return model;
+}
+
+/* ------------------------------------------ 二进制网格缓存 ------------------------------------------*/
+// 文件布局（小端）：Header | MeshEntry[meshCount] | 顶点数据 | 索引数据，顶点和索引数据按16字节对齐
+// 源文件的大小和修改时间记录在文件头中，源文件变化后缓存自动失效；格式变化时需要增加 VERSION
+namespace mesh_cache {
+
+constexpr char MAGIC[8] = {'L', 'O', 'G', 'L', 'M', 'E', 'S', 'H'};
+constexpr uint32_t VERSION = 1;
+// Header::flags
+constexpr uint32_t FLAG_OPTIMIZED = 1u << 0;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertexStride;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint32_t meshCount;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t flags;
+    uint64_t vertexDataOffset;
+    uint64_t indexDataOffset;
+};
+
+static_assert(sizeof(Header) == 64, "mesh cache header must not change silently");
+static_assert(sizeof(ModelMesh) == 44, "mesh cache entry must not change silently");
+
+// 用于判断缓存是否过期的源文件信息
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t time = 0;
+
+    static SourceStamp of(const std::string& path) {
+        std::error_code error;
+        SourceStamp stamp;
+        stamp.size = static_cast<uint64_t>(std::filesystem::file_size(path, error));
+        if (error) {
+            return {};
+        }
+        stamp.time = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+        return stamp;
+    }
+};
+
+inline std::string cachePath(const std::string& sourcePath) {
+    return sourcePath + ".meshcache";
+}
+
+inline uint64_t alignOffset(uint64_t offset) {
+    return (offset + 15) & ~uint64_t(15);
+}
+
+// 先写入临时文件再重命名，避免其他进程读到写了一半的缓存
+inline bool write(const std::string& path, const ModelData& model, const SourceStamp& stamp) {
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexStride = StandardVertexLayout::stride;
+    header.sourceSize = stamp.size;
+    header.sourceTime = stamp.time;
+    header.meshCount = static_cast<uint32_t>(model.meshes().size());
+    header.vertexCount = model.vertexCount();
+    header.indexCount = model.indexCount();
+    header.flags = model.optimized() ? FLAG_OPTIMIZED : 0u;
+    header.vertexDataOffset = alignOffset(sizeof(Header) + sizeof(ModelMesh) * model.meshes().size());
+    header.indexDataOffset = alignOffset(header.vertexDataOffset + static_cast<uint64_t>(header.vertexCount) * header.vertexStride);
+
+    // 同一个模型可能在多个线程上同时加载，临时文件名中加上线程编号
+    const std::string temporaryPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        const char padding[16] = {};
+        auto pad = [&file, &padding](uint64_t offset) {
+            uint64_t position = static_cast<uint64_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(offset - position));
+        };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(model.meshes().data()), sizeof(ModelMesh) * model.meshes().size());
+        pad(header.vertexDataOffset);
+        file.write(reinterpret_cast<const char*>(model.vertices()), static_cast<std::streamsize>(header.vertexCount) * header.vertexStride);
+        pad(header.indexDataOffset);
+        file.write(reinterpret_cast<const char*>(model.indices()), static_cast<std::streamsize>(header.indexCount) * sizeof(uint32_t));
+        if (!file) {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+// 映射缓存文件，缓存不存在、版本不一致、源文件已变化或文件被截断时返回nullptr
+// requireOptimized 为true时，没有优化过的缓存也视为过期
+inline std::shared_ptr<ModelData> read(const std::string& path, const SourceStamp& stamp, bool requireOptimized = false) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(Header)) {
+        return nullptr;
+    }
+    Header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.vertexStride != static_cast<uint32_t>(StandardVertexLayout::stride) ||
+        header.sourceSize != stamp.size || header.sourceTime != stamp.time ||
+        (requireOptimized && !(header.flags & FLAG_OPTIMIZED))) {
+        return nullptr;
+    }
+    const uint64_t end = header.indexDataOffset + static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t);
+    if (header.vertexDataOffset < sizeof(Header) + sizeof(ModelMesh) * static_cast<uint64_t>(header.meshCount) ||
+        header.indexDataOffset < header.vertexDataOffset + static_cast<uint64_t>(header.vertexCount) * header.vertexStride ||
+        end > file.size() || header.vertexDataOffset % 16 != 0 || header.indexDataOffset % 16 != 0) {
+        std::cout << "Mesh cache is corrupted: " << path << std::endl;
+        return nullptr;
+    }
+
+    std::vector<ModelMesh> meshes(header.meshCount);
+    std::memcpy(meshes.data(), file.data() + sizeof(Header), sizeof(ModelMesh) * header.meshCount);
+    for (const auto& mesh : meshes) {
+        if (static_cast<uint64_t>(mesh.firstVertex) + mesh.vertexCount > header.vertexCount ||
+            static_cast<uint64_t>(mesh.firstIndex) + mesh.indexCount > header.indexCount) {
+            std::cout << "Mesh cache is corrupted: " << path << std::endl;
+            return nullptr;
+        }
+    }
+    const float* vertices = reinterpret_cast<const float*>(file.data() + header.vertexDataOffset);
+    const uint32_t* indices = reinterpret_cast<const uint32_t*>(file.data() + header.indexDataOffset);
+    std::shared_ptr<ModelData> model = ModelData::fromMappedFile(std::move(file), vertices, header.vertexCount, indices,
+                                                                 header.indexCount, std::move(meshes));
+    model->setOptimized((header.flags & FLAG_OPTIMIZED) != 0);
+    return model;
+}
+
+} // namespace mesh_cache
+
+/* ------------------------------------------ 异步加载 ------------------------------------------*/
+class ModelLoader {
+public:
+    // 每个工作线程有自己的 Assimp::Importer（Importer不能在多个线程之间共享）
+    explicit ModelLoader(unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency() / 2)) {
+        for (unsigned int i = 0; i < std::max(1u, threadCount); i++) {
+            m_workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ModelLoader() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    ModelLoader(const ModelLoader&) = delete;
+    ModelLoader& operator=(const ModelLoader&) = delete;
+
+    // 关闭后总是通过assimp导入，也不写缓存
+    void setCacheEnabled(bool enabled) {
+        m_cacheEnabled = enabled;
+    }
+
+    // 打开后导入时优化子网格，没有优化过的缓存会被重新生成
+    void setOptimizeMeshes(bool enabled) {
+        m_optimizeMeshes = enabled;
+    }
+
+    // 加载失败时future中的结果为nullptr
+    std::future<std::shared_ptr<ModelData>> load(const std::string& path) {
+        auto task = std::make_shared<std::packaged_task<std::shared_ptr<ModelData>(Assimp::Importer&)>>(
+            [path, cacheEnabled = m_cacheEnabled, optimize = m_optimizeMeshes](Assimp::Importer& importer) {
+                return loadModel(path, importer, cacheEnabled, optimize);
+            });
+        std::future<std::shared_ptr<ModelData>> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back([task](Assimp::Importer& importer) { (*task)(importer); });
+        }
+        m_condition.notify_one();
+        return result;
+    }
+
+    // 在当前线程上同步加载
+    static std::shared_ptr<ModelData> loadModel(const std::string& path, Assimp::Importer& importer, bool cacheEnabled = true,
+                                                bool optimize = false) {
+        mesh_cache::SourceStamp stamp = mesh_cache::SourceStamp::of(path);
+        const std::string cachePath = mesh_cache::cachePath(path);
+        if (cacheEnabled) {
+            if (auto cached = mesh_cache::read(cachePath, stamp, optimize)) {
+                return cached;
+            }
+        }
+        std::shared_ptr<ModelData> model = importModel(path, importer, optimize);
+        if (model && cacheEnabled && !mesh_cache::write(cachePath, *model, stamp)) {
+            std::cout << "Failed to write mesh cache: " << cachePath << std::endl;
+        }
+        return model;
+    }
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void(Assimp::Importer&)>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+    bool m_cacheEnabled = true;
+    bool m_optimizeMeshes = false;
+
+    void workerLoop() {
+        Assimp::Importer importer;
+        while (true) {
+            std::function<void(Assimp::Importer&)> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty()) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task(importer);
+        }
+    }
+};
+
+/* ------------------------------------------ 上传 ------------------------------------------*/
+// 把模型的每个子网格放入几何池，池的顶点格式需要是 VertexFormat::positionNormalUV()
+// 从缓存加载的模型直接从映射的内存上传，不经过额外的复制
+inline std::vector<PoolMesh> uploadModel(GeometryPool& pool, const ModelData& model) {
+    std::vector<PoolMesh> result;
+    result.reserve(model.meshes().size());
+    for (const auto& mesh : model.meshes()) {
+        result.push_back(pool.allocate(model.meshVertices(mesh), mesh.vertexCount, model.meshIndices(mesh), mesh.indexCount));
+    }
+    return result;
+}
+
+#endif // MODEL_LOADER_H
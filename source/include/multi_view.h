@@ -0,0 +1,438 @@
+// 多视图渲染：同一帧中用多个相机（主视图、小地图、阴影、立方体贴图的6个面等）绘制同一组物体
+//  -- setViews() 提取每个视图的视锥平面，并合并所有视图中法线逐位相同（或正好相反）的平面：
+//     立方体贴图6个面的36个平面只有9个不同的法线（经过中心的6个对角平面 + 3个坐标轴方向的近/远平面）
+//  -- cull() 只遍历一次物体：每个物体对每个不同的法线只计算一次点积，再与各个视图的平面距离比较，
+//     得到可见视图的掩码（第 v 位表示在视图 v 中可见）
+//  -- submit(Pass::SINGLE) 每个可见物体只有一个间接命令，instanceCount 为可见视图的个数，
+//     顶点着色器（shaders/multi_view.vert）用 gl_BaseInstanceARB + gl_InstanceID 读取 (绘制编号, 视图编号)，
+//     同时写入 gl_Layer 和 gl_ViewportIndex：Target::LAYERS 绑定分层帧缓冲（例如立方体贴图），所有视口相同；
+//     Target::VIEWPORTS 绑定普通的帧缓冲，每个视图使用视口数组中的一个视口，
+//     所有视图只需要一次 glMultiDrawElementsIndirect，需要 GL_ARB_shader_viewport_layer_array
+//  -- submit(Pass::PER_VIEW) 按视图分组的命令，每个视图调用一次 bindView 和 glMultiDrawElementsIndirect，
+//     剔除的结果仍然共享，不支持上面的扩展时使用，bindView 绑定的帧缓冲不能是分层的
+// DrawData 与 IndirectRenderer 的布局相同，所有物体的网格必须在同一个 GeometryPool 中
+
+#ifndef MULTI_VIEW_H
+#define MULTI_VIEW_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "frustum.h"
+#include "frustum_culling.h"
+#include "geometry_pool.h"
+#include "indirect_renderer.h"
+#include "shader_program.h"
+#include "simd.h"
+
+class MultiViewRenderer {
+public:
+    // GL 4.1 之后 GL_MAX_VIEWPORTS 至少为16
+    static constexpr uint32_t MAX_VIEWS = 16;
+    // 与 multi_view.vert 中的 binding 一致，1~3 由 GpuCuller 使用
+    static constexpr GLuint DRAW_DATA_BINDING = IndirectRenderer::DRAW_DATA_BINDING;
+    static constexpr GLuint INSTANCE_BINDING = 4;
+    static constexpr GLuint VIEW_BINDING = 5;
+    // cull() 每次处理的物体个数
+    static constexpr size_t CULL_BLOCK = 64;
+
+    using DrawData = IndirectRenderer::DrawData;
+
+    struct View {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::vec4 viewport;     // (x, y, width, height)
+    };
+
+    enum class Target { VIEWPORTS, LAYERS };
+    enum class Pass { SINGLE, PER_VIEW };
+
+    explicit MultiViewRenderer(const std::string& vertexShaderPath = "shaders/multi_view.vert",
+                               const std::string& fragmentShaderPath = "shaders/box_color.frag")
+        : m_program({{ShaderProgram::ShaderType::VERTEX, vertexShaderPath},
+                     {ShaderProgram::ShaderType::FRAGMENT, fragmentShaderPath}}) {
+        glGenBuffers(1, &m_commandBuffer);
+        glGenBuffers(1, &m_drawDataBuffer);
+        glGenBuffers(1, &m_instanceBuffer);
+        glGenBuffers(1, &m_viewBuffer);
+    }
+
+    ~MultiViewRenderer() {
+        glDeleteBuffers(1, &m_commandBuffer);
+        glDeleteBuffers(1, &m_drawDataBuffer);
+        glDeleteBuffers(1, &m_instanceBuffer);
+        glDeleteBuffers(1, &m_viewBuffer);
+    }
+
+    MultiViewRenderer(const MultiViewRenderer&) = delete;
+    MultiViewRenderer& operator=(const MultiViewRenderer&) = delete;
+
+    static bool supportsSinglePass() {
+        return GLAD_GL_ARB_shader_viewport_layer_array != 0;
+    }
+
+    // 立方体贴图6个面的视图，顺序和朝向与 GL_TEXTURE_CUBE_MAP_POSITIVE_X + i 一致
+    static std::vector<View> cubemapViews(const glm::vec3& center, float zNear, float zFar, int size) {
+        static const glm::vec3 directions[6] = {
+            {1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+            {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}
+        };
+        static const glm::vec3 ups[6] = {
+            {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
+            {0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}
+        };
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, zNear, zFar);
+        std::vector<View> views(6);
+        for (int i = 0; i < 6; i++) {
+            views[i].view = glm::lookAt(center, center + directions[i], ups[i]);
+            views[i].projection = projection;
+            views[i].viewport = glm::vec4(0.0f, 0.0f, static_cast<float>(size), static_cast<float>(size));
+        }
+        return views;
+    }
+
+    // 视图个数不超过 MAX_VIEWS，视图改变时（例如相机移动）每帧调用
+    void setViews(const std::vector<View>& views) {
+        m_views.assign(views.begin(), views.begin() + std::min<size_t>(views.size(), MAX_VIEWS));
+        m_frusta.resize(m_views.size());
+        m_viewPlanes.resize(m_views.size());
+        m_normals.clear();
+        m_viewProjections.resize(m_views.size());
+        for (size_t v = 0; v < m_views.size(); v++) {
+            m_viewProjections[v] = m_views[v].projection * m_views[v].view;
+            m_frusta[v] = Frustum::fromMatrix(m_viewProjections[v]);
+            for (int p = 0; p < Frustum::PLANE_COUNT; p++) {
+                const glm::vec4& plane = m_frusta[v].planes[p];
+                m_viewPlanes[v][p] = sharedPlane(glm::vec3(plane), plane.w);
+            }
+        }
+    }
+
+    void begin() {
+        m_objects.clear();
+        m_spheres.resize(0);
+    }
+
+    void add(const PoolMesh& mesh, const DrawData& data, const glm::vec3& center, float radius) {
+        const size_t index = m_objects.size();
+        m_objects.push_back({mesh, data});
+        m_spheres.resize(index + 1);
+        m_spheres.set(index, center, radius);
+    }
+
+    // 计算每个物体的可见视图掩码，只有至少在一个视图中可见的物体的 DrawData 会上传
+    // SSE2 每次处理 CULL_BLOCK 个物体，结果与标量实现相同
+    void cull() {
+        // 补齐部分的半径为 PADDING_RADIUS，不在任何视图中可见
+        m_viewMasks.resize(m_spheres.paddedSize());
+#if defined(SIMD_SSE2)
+        cullSse2();
+#else
+        cullScalar();
+#endif
+        m_visible.clear();
+        m_pairCount = 0;
+        for (uint32_t i = 0; i < m_objects.size(); i++) {
+            if (m_viewMasks[i] != 0) {
+                m_visible.push_back(i);
+                m_pairCount += popCount(m_viewMasks[i]);
+            }
+        }
+    }
+
+    // 在 cull() 之后调用
+    // Pass::SINGLE 由调用者绑定分层帧缓冲（Target::LAYERS）或者包含所有视口的帧缓冲（Target::VIEWPORTS），不调用 bindView
+    // Pass::PER_VIEW 在每个视图绘制之前调用 bindView（例如绑定立方体贴图的一个面并清屏），然后设置该视图的视口
+    void submit(const GeometryPool& pool, Target target, Pass pass,
+                const std::function<void(uint32_t view)>& bindView = nullptr) {
+        // 不支持扩展时着色器不写入 gl_Layer / gl_ViewportIndex，所有视图都会画到第0层（视口）
+        assert(pass != Pass::SINGLE || supportsSinglePass());
+        m_multiDrawCount = 0;
+        if (m_views.empty()) {
+            return;
+        }
+        m_drawData.resize(m_visible.size());
+        for (size_t i = 0; i < m_visible.size(); i++) {
+            m_drawData[i] = m_objects[m_visible[i]].data;
+        }
+        m_instances.clear();
+        m_commands.clear();
+        m_viewCommandOffsets.assign(m_views.size() + 1, 0);
+        if (pass == Pass::SINGLE) {
+            for (uint32_t i = 0; i < m_visible.size(); i++) {
+                const Object& object = m_objects[m_visible[i]];
+                const uint32_t viewMask = m_viewMasks[m_visible[i]];
+                uint32_t baseInstance = static_cast<uint32_t>(m_instances.size());
+                for (uint32_t mask = viewMask; mask != 0; mask &= mask - 1) {
+                    m_instances.push_back({i, static_cast<uint32_t>(countTrailingZeros(mask))});
+                }
+                m_commands.push_back({object.mesh.indexCount, static_cast<uint32_t>(popCount(viewMask)), object.mesh.firstIndex,
+                                      object.mesh.baseVertex, baseInstance});
+            }
+        } else {
+            for (uint32_t v = 0; v < m_views.size(); v++) {
+                m_viewCommandOffsets[v] = m_commands.size();
+                for (uint32_t i = 0; i < m_visible.size(); i++) {
+                    const Object& object = m_objects[m_visible[i]];
+                    if (m_viewMasks[m_visible[i]] & (1u << v)) {
+                        m_commands.push_back({object.mesh.indexCount, 1, object.mesh.firstIndex,
+                                              object.mesh.baseVertex, static_cast<uint32_t>(m_instances.size())});
+                        m_instances.push_back({i, v});
+                    }
+                }
+            }
+            m_viewCommandOffsets[m_views.size()] = m_commands.size();
+        }
+        if (m_commands.empty()) {
+            return;
+        }
+
+        upload(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer, m_commands, m_commandCapacity);
+        upload(GL_SHADER_STORAGE_BUFFER, m_drawDataBuffer, m_drawData, m_drawDataCapacity);
+        upload(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer, m_instances, m_instanceCapacity);
+        upload(GL_SHADER_STORAGE_BUFFER, m_viewBuffer, m_viewProjections, m_viewCapacity);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, m_drawDataBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, m_instanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VIEW_BINDING, m_viewBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+
+        if (pass == Pass::SINGLE) {
+            m_program.use();
+            if (target == Target::VIEWPORTS) {
+                for (uint32_t v = 0; v < m_views.size(); v++) {
+                    const glm::vec4& viewport = m_views[v].viewport;
+                    glViewportIndexedf(v, viewport.x, viewport.y, viewport.z, viewport.w);
+                }
+            } else {
+                const glm::vec4& viewport = m_views[0].viewport;
+                glViewport(static_cast<GLint>(viewport.x), static_cast<GLint>(viewport.y),
+                           static_cast<GLsizei>(viewport.z), static_cast<GLsizei>(viewport.w));
+            }
+            pool.bind();
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(m_commands.size()), 0);
+            m_multiDrawCount++;
+        } else {
+            for (uint32_t v = 0; v < m_views.size(); v++) {
+                if (bindView) {
+                    bindView(v);
+                }
+                const glm::vec4& viewport = m_views[v].viewport;
+                glViewport(static_cast<GLint>(viewport.x), static_cast<GLint>(viewport.y),
+                           static_cast<GLsizei>(viewport.z), static_cast<GLsizei>(viewport.w));
+                size_t begin = m_viewCommandOffsets[v];
+                size_t end = m_viewCommandOffsets[v + 1];
+                if (begin == end) {
+                    continue;
+                }
+                m_program.use();
+                pool.bind();
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                            (void*)(begin * sizeof(DrawElementsIndirectCommand)),
+                                            static_cast<GLsizei>(end - begin), 0);
+                m_multiDrawCount++;
+            }
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    const ShaderProgram& program() const {
+        return m_program;
+    }
+
+    size_t viewCount() const {
+        return m_views.size();
+    }
+
+    const Frustum& frustum(size_t view) const {
+        return m_frusta[view];
+    }
+
+    // 所有视图中不同的平面法线个数
+    size_t uniquePlaneCount() const {
+        return m_normals.size();
+    }
+
+    size_t objectCount() const {
+        return m_objects.size();
+    }
+
+    // 上一次 cull() 中至少在一个视图中可见的物体数
+    size_t visibleCount() const {
+        return m_visible.size();
+    }
+
+    // 上一次 cull() 中所有视图的可见物体数之和
+    size_t visiblePairCount() const {
+        return m_pairCount;
+    }
+
+    // 物体在视图中可见时第 v 位为1
+    uint32_t viewMask(size_t object) const {
+        return m_viewMasks[object];
+    }
+
+    size_t multiDrawCount() const {
+        return m_multiDrawCount;
+    }
+
+private:
+    struct Object {
+        PoolMesh mesh;
+        DrawData data;
+    };
+
+    // 视图的一个平面：sign * dot(m_normals[normal], p) + d
+    struct ViewPlane {
+        uint32_t normal;
+        float sign;
+        float d;
+    };
+
+    // std430 布局，与 multi_view.vert 中的 Instance 一致
+    struct Instance {
+        uint32_t draw;
+        uint32_t view;
+    };
+
+    ShaderProgram m_program;
+    GLuint m_commandBuffer;
+    GLuint m_drawDataBuffer;
+    GLuint m_instanceBuffer;
+    GLuint m_viewBuffer;
+    size_t m_commandCapacity = 0;
+    size_t m_drawDataCapacity = 0;
+    size_t m_instanceCapacity = 0;
+    size_t m_viewCapacity = 0;
+
+    std::vector<View> m_views;
+    std::vector<Frustum> m_frusta;
+    std::vector<glm::mat4> m_viewProjections;
+    std::vector<glm::vec3> m_normals;
+    std::vector<std::array<ViewPlane, Frustum::PLANE_COUNT>> m_viewPlanes;
+
+    std::vector<Object> m_objects;
+    frustum_culling::SphereArrays m_spheres;
+    std::vector<uint32_t> m_viewMasks;
+    std::vector<float> m_blockDots;     // cullSse2 中一组物体与每个法线的点积
+    std::vector<uint32_t> m_visible;
+    size_t m_pairCount = 0;
+    size_t m_multiDrawCount = 0;
+
+    std::vector<DrawElementsIndirectCommand> m_commands;
+    std::vector<DrawData> m_drawData;
+    std::vector<Instance> m_instances;
+    std::vector<size_t> m_viewCommandOffsets;
+
+    // 查找完全相同或正好相反的法线，找不到时添加
+    // 只合并逐位相同的法线：近似的法线在离原点远的地方距离误差会变大，可能剔除掉可见的物体；
+    // 乘以 ±1 是精确的，因此结果与每个视图分别调用 Frustum::intersectsSphere 相同
+    ViewPlane sharedPlane(const glm::vec3& normal, float d) {
+        for (uint32_t n = 0; n < m_normals.size(); n++) {
+            if (m_normals[n] == normal) {
+                return {n, 1.0f, d};
+            }
+            if (m_normals[n] == -normal) {
+                return {n, -1.0f, d};
+            }
+        }
+        m_normals.push_back(normal);
+        return {static_cast<uint32_t>(m_normals.size() - 1), 1.0f, d};
+    }
+
+    // 先计算每个不同法线的点积，再逐个视图比较6个平面的距离
+    void cullScalar() {
+        std::vector<float> dots(m_normals.size());
+        for (size_t i = 0; i < m_spheres.count; i++) {
+            glm::vec3 center(m_spheres.centerX[i], m_spheres.centerY[i], m_spheres.centerZ[i]);
+            for (size_t n = 0; n < m_normals.size(); n++) {
+                dots[n] = glm::dot(m_normals[n], center);
+            }
+            uint32_t mask = 0;
+            for (uint32_t v = 0; v < m_views.size(); v++) {
+                bool inside = true;
+                for (const ViewPlane& plane : m_viewPlanes[v]) {
+                    inside = inside && plane.sign * dots[plane.normal] + plane.d >= -m_spheres.radius[i];
+                }
+                mask |= static_cast<uint32_t>(inside) << v;
+            }
+            m_viewMasks[i] = mask;
+        }
+    }
+
+#if defined(SIMD_SSE2)
+    // 与 cullScalar 相同的计算顺序，每次处理 CULL_BLOCK 个物体：
+    // 先算出这些物体与每个不同法线的点积，再逐个平面比较，常量只需要加载一次
+    void cullSse2() {
+        constexpr size_t VECTORS = CULL_BLOCK / 4;
+        m_blockDots.resize(m_normals.size() * CULL_BLOCK);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        for (size_t begin = 0; begin < m_spheres.paddedSize(); begin += CULL_BLOCK) {
+            const size_t vectors = std::min(VECTORS, (m_spheres.paddedSize() - begin) / 4);
+            for (size_t n = 0; n < m_normals.size(); n++) {
+                const __m128 normalX = _mm_set1_ps(m_normals[n].x);
+                const __m128 normalY = _mm_set1_ps(m_normals[n].y);
+                const __m128 normalZ = _mm_set1_ps(m_normals[n].z);
+                float* dots = &m_blockDots[n * CULL_BLOCK];
+                for (size_t j = 0; j < vectors; j++) {
+                    const size_t i = begin + j * 4;
+                    __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, _mm_loadu_ps(&m_spheres.centerX[i])),
+                                                       _mm_mul_ps(normalY, _mm_loadu_ps(&m_spheres.centerY[i]))),
+                                            _mm_mul_ps(normalZ, _mm_loadu_ps(&m_spheres.centerZ[i])));
+                    _mm_storeu_ps(dots + j * 4, dot);
+                }
+            }
+            __m128i masks[VECTORS];
+            __m128 negativeRadius[VECTORS];
+            for (size_t j = 0; j < vectors; j++) {
+                masks[j] = _mm_setzero_si128();
+                negativeRadius[j] = _mm_xor_ps(_mm_loadu_ps(&m_spheres.radius[begin + j * 4]), signMask);
+            }
+            for (uint32_t v = 0; v < m_views.size(); v++) {
+                __m128 inside[VECTORS];
+                for (size_t j = 0; j < vectors; j++) {
+                    inside[j] = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                }
+                for (const ViewPlane& plane : m_viewPlanes[v]) {
+                    const __m128 sign = _mm_set1_ps(plane.sign);
+                    const __m128 d = _mm_set1_ps(plane.d);
+                    const float* dots = &m_blockDots[plane.normal * CULL_BLOCK];
+                    for (size_t j = 0; j < vectors; j++) {
+                        __m128 distance = _mm_add_ps(_mm_mul_ps(sign, _mm_loadu_ps(dots + j * 4)), d);
+                        inside[j] = _mm_and_ps(inside[j], _mm_cmpge_ps(distance, negativeRadius[j]));
+                    }
+                }
+                const __m128i bit = _mm_set1_epi32(static_cast<int>(1u << v));
+                for (size_t j = 0; j < vectors; j++) {
+                    masks[j] = _mm_or_si128(masks[j], _mm_and_si128(_mm_castps_si128(inside[j]), bit));
+                }
+            }
+            for (size_t j = 0; j < vectors; j++) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&m_viewMasks[begin + j * 4]), masks[j]);
+            }
+        }
+    }
+#endif
+
+    // 每帧重新分配存储(orphan)，避免等待上一帧仍在使用的缓冲
+    template <typename T>
+    static void upload(GLenum target, GLuint buffer, const std::vector<T>& data, size_t& capacity) {
+        glBindBuffer(target, buffer);
+        capacity = std::max(capacity, data.size());
+        glBufferData(target, capacity * sizeof(T), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(target, 0, data.size() * sizeof(T), data.data());
+        glBindBuffer(target, 0);
+    }
+};
+
+#endif // MULTI_VIEW_H
@@ -0,0 +1,418 @@
+// 程序化网格库，所有网格的顶点布局都是 StandardVertexLayout：位置(3) 法线(3) 纹理坐标(2)
+//  -- 固定拓扑的网格（盒子、二十面体）是编译期生成的 constexpr 表，直接编进可执行文件
+//  -- 带细分参数的网格（平面、UV球、细分二十面体球、圆柱、圆环）先用 xxxSize() 得到顶点数和索引数，
+//     再由 generateXxx() 直接写入调用者提供的缓冲，中间不分配任何内存
+// 除盒子外都以Y轴为上方向，三角形为逆时针（从外侧看）
+// baseVertex 会加到写出的每个索引上，用于把多个网格追加到同一个缓冲中
+// 用法：
+//     MeshSize size = procedural_mesh::uvSphereSize(32, 16);
+//     std::vector<float> vertices(size.vertexCount * procedural_mesh::FLOATS_PER_VERTEX);
+//     std::vector<uint32_t> indices(size.indexCount);
+//     procedural_mesh::generateUVSphere(1.0f, 32, 16, vertices.data(), indices.data());
+
+#ifndef PROCEDURAL_MESH_H
+#define PROCEDURAL_MESH_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace procedural_mesh {
+
+constexpr uint32_t FLOATS_PER_VERTEX = 8;
+constexpr float PI = 3.14159265359f;
+
+struct MeshSize {
+    uint32_t vertexCount;
+    uint32_t indexCount;
+};
+
+namespace detail {
+
+inline void writeVertex(float*& out, const glm::vec3& position, const glm::vec3& normal, float u, float v) {
+    out[0] = position.x;
+    out[1] = position.y;
+    out[2] = position.z;
+    out[3] = normal.x;
+    out[4] = normal.y;
+    out[5] = normal.z;
+    out[6] = u;
+    out[7] = v;
+    out += FLOATS_PER_VERTEX;
+}
+
+// 逆时针的四边形 a b c d 拆成 a b c 和 a c d 两个三角形
+template <typename Index>
+inline void writeQuad(Index*& out, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    out[0] = static_cast<Index>(a);
+    out[1] = static_cast<Index>(b);
+    out[2] = static_cast<Index>(c);
+    out[3] = static_cast<Index>(a);
+    out[4] = static_cast<Index>(c);
+    out[5] = static_cast<Index>(d);
+    out += 6;
+}
+
+template <typename Index>
+inline void writeTriangle(Index*& out, uint32_t a, uint32_t b, uint32_t c) {
+    out[0] = static_cast<Index>(a);
+    out[1] = static_cast<Index>(b);
+    out[2] = static_cast<Index>(c);
+    out += 3;
+}
+
+template <typename Index>
+inline void checkIndexRange(const MeshSize& size, uint32_t baseVertex) {
+    assert(static_cast<uint64_t>(baseVertex) + size.vertexCount <= static_cast<uint64_t>(std::numeric_limits<Index>::max()) + 1);
+    (void)size;
+    (void)baseVertex;
+}
+
+/* ------------------------------------------ 盒子的常量表 ------------------------------------------*/
+// 盒子局部坐标系说明：
+/*
+       Z
+       |
+       |
+       |
+       @-----------Y
+      /
+     /
+    /
+   X
+*/
+// 8个角点相对于半长的符号
+constexpr float BOX_CORNER_SIGNS[8][3] = {
+    // 上部四个顶点, 从第一卦限，逆时针
+    { 1,  1,  1}, {-1,  1,  1}, {-1, -1,  1}, { 1, -1,  1},
+    // 下部四个顶点， 从第五卦限，逆时针
+    { 1,  1, -1}, {-1,  1, -1}, {-1, -1, -1}, { 1, -1, -1},
+};
+
+// 每个面的四个角点，正对每个面时的顺序为 a b c d，三角形为 a b c 和 a c d
+/*
+   b----------a
+   |         /|
+   |       /  |
+   |     /    |
+   |   /      |
+   | /        |
+   c----------d
+*/
+constexpr uint8_t BOX_FACE_CORNERS[24] = {
+    0, 3, 7, 4,     // 前面 px
+    1, 0, 4, 5,     // 右侧面 py
+    2, 1, 5, 6,     // 后面 nx
+    3, 2, 6, 7,     // 左侧面 ny
+    1, 2, 3, 0,     // 顶面 pz
+    4, 7, 6, 5,     // 底面 nz
+};
+
+constexpr float BOX_NORMALS[6][3] = {
+    { 1, 0, 0}, { 0, 1, 0}, {-1, 0, 0},
+    { 0,-1, 0}, { 0, 0, 1}, { 0, 0,-1},
+};
+
+// 正对每个面时的纹理坐标，顺序与角点 a b c d 对应
+/*
+   (0,1)-----------(1,1)
+   |                   |
+   |                   |
+   (0,0)-----------(1,0)
+*/
+constexpr float BOX_TEXTURE_COORDS[4][2] = {
+    {1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 0.0f}
+};
+
+constexpr std::array<float, 24 * FLOATS_PER_VERTEX> makeUnitBoxVertices() {
+    std::array<float, 24 * FLOATS_PER_VERTEX> vertices{};
+    for (size_t i = 0; i < 24; i++) {
+        const float* corner = BOX_CORNER_SIGNS[BOX_FACE_CORNERS[i]];
+        const float* normal = BOX_NORMALS[i / 4];
+        const float* uv = BOX_TEXTURE_COORDS[i % 4];
+        float* vertex = &vertices[i * FLOATS_PER_VERTEX];
+        vertex[0] = corner[0];
+        vertex[1] = corner[1];
+        vertex[2] = corner[2];
+        vertex[3] = normal[0];
+        vertex[4] = normal[1];
+        vertex[5] = normal[2];
+        vertex[6] = uv[0];
+        vertex[7] = uv[1];
+    }
+    return vertices;
+}
+
+template <typename Index>
+constexpr std::array<Index, 36> makeBoxIndices() {
+    std::array<Index, 36> indices{};
+    for (size_t face = 0; face < 6; face++) {
+        Index base = static_cast<Index>(face * 4);
+        indices[face * 6 + 0] = base;
+        indices[face * 6 + 1] = static_cast<Index>(base + 1);
+        indices[face * 6 + 2] = static_cast<Index>(base + 2);
+        indices[face * 6 + 3] = base;
+        indices[face * 6 + 4] = static_cast<Index>(base + 2);
+        indices[face * 6 + 5] = static_cast<Index>(base + 3);
+    }
+    return indices;
+}
+
+} // namespace detail
+
+/* ------------------------------------------ 盒子 ------------------------------------------*/
+constexpr MeshSize BOX_SIZE = {24, 36};
+
+// 半长为1的盒子，每个面4个顶点
+constexpr std::array<float, 24 * FLOATS_PER_VERTEX> BOX_VERTICES = detail::makeUnitBoxVertices();
+template <typename Index>
+constexpr std::array<Index, 36> BOX_INDICES = detail::makeBoxIndices<Index>();
+
+static_assert(BOX_VERTICES[0] == 1.0f && BOX_VERTICES[1] == 1.0f && BOX_VERTICES[3] == 1.0f, "unexpected box vertex table");
+static_assert(BOX_INDICES<uint16_t>[35] == 23, "unexpected box index table");
+
+// 半长为extension的盒子，只需要按extension缩放常量表中的位置
+inline void generateBoxVertices(const glm::vec3& extension, float* vertices) {
+    for (uint32_t i = 0; i < BOX_SIZE.vertexCount; i++) {
+        const float* source = &BOX_VERTICES[i * FLOATS_PER_VERTEX];
+        float* target = vertices + i * FLOATS_PER_VERTEX;
+        target[0] = source[0] * extension.x;
+        target[1] = source[1] * extension.y;
+        target[2] = source[2] * extension.z;
+        for (uint32_t j = 3; j < FLOATS_PER_VERTEX; j++) {
+            target[j] = source[j];
+        }
+    }
+}
+
+template <typename Index>
+inline void generateBox(const glm::vec3& extension, float* vertices, Index* indices, uint32_t baseVertex = 0) {
+    detail::checkIndexRange<Index>(BOX_SIZE, baseVertex);
+    generateBoxVertices(extension, vertices);
+    for (uint32_t i = 0; i < BOX_SIZE.indexCount; i++) {
+        indices[i] = static_cast<Index>(BOX_INDICES<uint32_t>[i] + baseVertex);
+    }
+}
+
+/* ------------------------------------------ 二十面体 ------------------------------------------*/
+constexpr MeshSize ICOSAHEDRON_SIZE = {12, 60};
+
+// 单位球上的12个顶点 (0, ±1, ±φ) 的循环排列，已经归一化
+constexpr float ICOSAHEDRON_A = 0.525731112119133606f;
+constexpr float ICOSAHEDRON_B = 0.850650808352039932f;
+constexpr float ICOSAHEDRON_VERTICES[12][3] = {
+    {-ICOSAHEDRON_A, 0, ICOSAHEDRON_B}, {ICOSAHEDRON_A, 0, ICOSAHEDRON_B},
+    {-ICOSAHEDRON_A, 0, -ICOSAHEDRON_B}, {ICOSAHEDRON_A, 0, -ICOSAHEDRON_B},
+    {0, ICOSAHEDRON_B, ICOSAHEDRON_A}, {0, ICOSAHEDRON_B, -ICOSAHEDRON_A},
+    {0, -ICOSAHEDRON_B, ICOSAHEDRON_A}, {0, -ICOSAHEDRON_B, -ICOSAHEDRON_A},
+    {ICOSAHEDRON_B, ICOSAHEDRON_A, 0}, {-ICOSAHEDRON_B, ICOSAHEDRON_A, 0},
+    {ICOSAHEDRON_B, -ICOSAHEDRON_A, 0}, {-ICOSAHEDRON_B, -ICOSAHEDRON_A, 0},
+};
+constexpr uint8_t ICOSAHEDRON_INDICES[60] = {
+    1, 4, 0,    4, 9, 0,    4, 5, 9,    8, 5, 4,    1, 8, 4,
+    1, 10, 8,   10, 3, 8,   8, 3, 5,    3, 2, 5,    3, 7, 2,
+    3, 10, 7,   10, 6, 7,   6, 11, 7,   6, 0, 11,   6, 1, 0,
+    10, 1, 6,   11, 0, 9,   2, 11, 9,   5, 2, 9,    11, 2, 7,
+};
+
+/* ------------------------------------------ 平面 ------------------------------------------*/
+// XZ平面上以原点为中心，法线为+Y，每个方向分别细分为 segmentsX / segmentsZ 段
+inline MeshSize planeSize(uint32_t segmentsX, uint32_t segmentsZ) {
+    return {(segmentsX + 1) * (segmentsZ + 1), segmentsX * segmentsZ * 6};
+}
+
+template <typename Index>
+inline void generatePlane(float width, float depth, uint32_t segmentsX, uint32_t segmentsZ,
+                          float* vertices, Index* indices, uint32_t baseVertex = 0) {
+    detail::checkIndexRange<Index>(planeSize(segmentsX, segmentsZ), baseVertex);
+    const glm::vec3 normal(0.0f, 1.0f, 0.0f);
+    for (uint32_t i = 0; i <= segmentsX; i++) {
+        float u = static_cast<float>(i) / segmentsX;
+        for (uint32_t j = 0; j <= segmentsZ; j++) {
+            float v = static_cast<float>(j) / segmentsZ;
+            detail::writeVertex(vertices, glm::vec3((u - 0.5f) * width, 0.0f, (v - 0.5f) * depth), normal, u, 1.0f - v);
+        }
+    }
+    const uint32_t row = segmentsZ + 1;
+    for (uint32_t i = 0; i < segmentsX; i++) {
+        for (uint32_t j = 0; j < segmentsZ; j++) {
+            uint32_t a = baseVertex + i * row + j;
+            detail::writeQuad(indices, a, a + 1, a + row + 1, a + row);
+        }
+    }
+}
+
+/* ------------------------------------------ UV球 ------------------------------------------*/
+// 经线方向 segments 段（>=3），纬线方向 rings 段（>=2），经线的接缝和两极的顶点会重复以保证纹理坐标连续
+inline MeshSize uvSphereSize(uint32_t segments, uint32_t rings) {
+    return {(segments + 1) * (rings + 1), segments * (rings - 1) * 6};
+}
+
+template <typename Index>
+inline void generateUVSphere(float radius, uint32_t segments, uint32_t rings,
+                             float* vertices, Index* indices, uint32_t baseVertex = 0) {
+    detail::checkIndexRange<Index>(uvSphereSize(segments, rings), baseVertex);
+    for (uint32_t ring = 0; ring <= rings; ring++) {
+        float v = static_cast<float>(ring) / rings;
+        float phi = v * PI;
+        float sinPhi = std::sin(phi);
+        float cosPhi = std::cos(phi);
+        for (uint32_t segment = 0; segment <= segments; segment++) {
+            float u = static_cast<float>(segment) / segments;
+            float theta = u * 2.0f * PI;
+            glm::vec3 normal(sinPhi * std::sin(theta), cosPhi, sinPhi * std::cos(theta));
+            detail::writeVertex(vertices, normal * radius, normal, u, 1.0f - v);
+        }
+    }
+    // 第一圈和最后一圈各有一个三角形退化到极点，直接跳过
+    const uint32_t row = segments + 1;
+    for (uint32_t ring = 0; ring < rings; ring++) {
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            uint32_t a = baseVertex + ring * row + segment;
+            uint32_t b = a + row;
+            uint32_t c = b + 1;
+            uint32_t d = a + 1;
+            if (ring != rings - 1) {
+                detail::writeTriangle(indices, a, b, c);
+            }
+            if (ring != 0) {
+                detail::writeTriangle(indices, a, c, d);
+            }
+        }
+    }
+}
+
+/* ------------------------------------------ 细分二十面体球 ------------------------------------------*/
+// 二十面体的每个面的每条边都分成 frequency 段（>=1），frequency 为1时就是二十面体本身
+// 每个面单独生成顶点，面与面之间的边上的顶点会重复，但位置和法线完全相同，不会产生裂缝
+// 纹理坐标使用球面映射，经度的接缝处会有一列三角形的纹理坐标不连续
+inline MeshSize icosphereSize(uint32_t frequency) {
+    return {20 * (frequency + 1) * (frequency + 2) / 2, 20 * frequency * frequency * 3};
+}
+
+template <typename Index>
+inline void generateIcosphere(float radius, uint32_t frequency, float* vertices, Index* indices, uint32_t baseVertex = 0) {
+    detail::checkIndexRange<Index>(icosphereSize(frequency), baseVertex);
+    const uint32_t faceVertexCount = (frequency + 1) * (frequency + 2) / 2;
+    // 第i行有 frequency - i + 1 个顶点
+    auto rowStart = [frequency](uint32_t i) { return i * (frequency + 1) - i * (i - 1) / 2; };
+    for (uint32_t face = 0; face < 20; face++) {
+        const float* pa = ICOSAHEDRON_VERTICES[ICOSAHEDRON_INDICES[face * 3 + 0]];
+        const float* pb = ICOSAHEDRON_VERTICES[ICOSAHEDRON_INDICES[face * 3 + 1]];
+        const float* pc = ICOSAHEDRON_VERTICES[ICOSAHEDRON_INDICES[face * 3 + 2]];
+        glm::vec3 a(pa[0], pa[1], pa[2]);
+        glm::vec3 ab = (glm::vec3(pb[0], pb[1], pb[2]) - a) / static_cast<float>(frequency);
+        glm::vec3 ac = (glm::vec3(pc[0], pc[1], pc[2]) - a) / static_cast<float>(frequency);
+        for (uint32_t i = 0; i <= frequency; i++) {
+            for (uint32_t j = 0; j <= frequency - i; j++) {
+                glm::vec3 normal = glm::normalize(a + ab * static_cast<float>(i) + ac * static_cast<float>(j));
+                float u = 0.5f + std::atan2(normal.x, normal.z) / (2.0f * PI);
+                float v = 0.5f + std::asin(glm::clamp(normal.y, -1.0f, 1.0f)) / PI;
+                detail::writeVertex(vertices, normal * radius, normal, u, v);
+            }
+        }
+
+        const uint32_t base = baseVertex + face * faceVertexCount;
+        for (uint32_t i = 0; i < frequency; i++) {
+            for (uint32_t j = 0; j < frequency - i; j++) {
+                uint32_t v00 = base + rowStart(i) + j;
+                uint32_t v10 = base + rowStart(i + 1) + j;
+                detail::writeTriangle(indices, v00, v10, v00 + 1);
+                if (j + 1 < frequency - i) {
+                    detail::writeTriangle(indices, v10, v10 + 1, v00 + 1);
+                }
+            }
+        }
+    }
+}
+
+/* ------------------------------------------ 圆柱 ------------------------------------------*/
+// 以原点为中心、沿Y轴的圆柱，侧面沿圆周 segments 段（>=3）、沿高度 stacks 段（>=1），上下各一个封口
+inline MeshSize cylinderSize(uint32_t segments, uint32_t stacks = 1) {
+    return {(segments + 1) * (stacks + 1) + 2 * (segments + 2), segments * stacks * 6 + 2 * segments * 3};
+}
+
+template <typename Index>
+inline void generateCylinder(float radius, float height, uint32_t segments, uint32_t stacks,
+                             float* vertices, Index* indices, uint32_t baseVertex = 0) {
+    detail::checkIndexRange<Index>(cylinderSize(segments, stacks), baseVertex);
+    const float halfHeight = height * 0.5f;
+    // 侧面
+    for (uint32_t stack = 0; stack <= stacks; stack++) {
+        float v = static_cast<float>(stack) / stacks;
+        for (uint32_t segment = 0; segment <= segments; segment++) {
+            float u = static_cast<float>(segment) / segments;
+            float theta = u * 2.0f * PI;
+            glm::vec3 normal(std::sin(theta), 0.0f, std::cos(theta));
+            detail::writeVertex(vertices, glm::vec3(normal.x * radius, halfHeight - v * height, normal.z * radius), normal, u, 1.0f - v);
+        }
+    }
+    const uint32_t row = segments + 1;
+    for (uint32_t stack = 0; stack < stacks; stack++) {
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            uint32_t a = baseVertex + stack * row + segment;
+            detail::writeQuad(indices, a, a + row, a + row + 1, a + 1);
+        }
+    }
+
+    // 封口：中心点加一圈顶点，纹理坐标为圆盘在单位正方形中的投影
+    uint32_t capBase = baseVertex + row * (stacks + 1);
+    for (int side = 0; side < 2; side++) {
+        float sign = side == 0 ? 1.0f : -1.0f;
+        glm::vec3 normal(0.0f, sign, 0.0f);
+        detail::writeVertex(vertices, glm::vec3(0.0f, sign * halfHeight, 0.0f), normal, 0.5f, 0.5f);
+        for (uint32_t segment = 0; segment <= segments; segment++) {
+            float theta = static_cast<float>(segment) / segments * 2.0f * PI;
+            float s = std::sin(theta);
+            float c = std::cos(theta);
+            detail::writeVertex(vertices, glm::vec3(s * radius, sign * halfHeight, c * radius), normal, 0.5f + 0.5f * s, 0.5f - 0.5f * sign * c);
+        }
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            uint32_t a = capBase + 1 + segment;
+            if (side == 0) {
+                detail::writeTriangle(indices, capBase, a, a + 1);
+            } else {
+                detail::writeTriangle(indices, capBase, a + 1, a);
+            }
+        }
+        capBase += segments + 2;
+    }
+}
+
+/* ------------------------------------------ 圆环 ------------------------------------------*/
+// 位于XZ平面、以原点为中心的圆环，majorRadius为圆环中心线的半径，minorRadius为截面圆的半径
+inline MeshSize torusSize(uint32_t majorSegments, uint32_t minorSegments) {
+    return {(majorSegments + 1) * (minorSegments + 1), majorSegments * minorSegments * 6};
+}
+
+template <typename Index>
+inline void generateTorus(float majorRadius, float minorRadius, uint32_t majorSegments, uint32_t minorSegments,
+                          float* vertices, Index* indices, uint32_t baseVertex = 0) {
+    detail::checkIndexRange<Index>(torusSize(majorSegments, minorSegments), baseVertex);
+    for (uint32_t i = 0; i <= majorSegments; i++) {
+        float u = static_cast<float>(i) / majorSegments;
+        float theta = u * 2.0f * PI;
+        glm::vec3 direction(std::sin(theta), 0.0f, std::cos(theta));
+        for (uint32_t j = 0; j <= minorSegments; j++) {
+            float v = static_cast<float>(j) / minorSegments;
+            float phi = v * 2.0f * PI;
+            glm::vec3 normal = direction * std::cos(phi) + glm::vec3(0.0f, std::sin(phi), 0.0f);
+            detail::writeVertex(vertices, direction * majorRadius + normal * minorRadius, normal, u, v);
+        }
+    }
+    const uint32_t row = minorSegments + 1;
+    for (uint32_t i = 0; i < majorSegments; i++) {
+        for (uint32_t j = 0; j < minorSegments; j++) {
+            uint32_t a = baseVertex + i * row + j;
+            detail::writeQuad(indices, a, a + row, a + row + 1, a + 1);
+        }
+    }
+}
+
+} // namespace procedural_mesh
+
+#endif // PROCEDURAL_MESH_H
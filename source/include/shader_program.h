@@ -9,6 +9,7 @@
 #include <sstream>
 #include <iostream>
 #include <unordered_map>
+#include <vector>
  
 class ShaderProgram{
 public:
@@ -19,6 +20,7 @@ public:
         TESSEVALUATION = GL_TESS_EVALUATION_SHADER,
         GEOMETRY = GL_GEOMETRY_SHADER,
         FRAGMENT = GL_FRAGMENT_SHADER,
+        COMPUTE = GL_COMPUTE_SHADER,
     };
  
     using ShaderSourcePair = std::pair<ShaderType, std::string>;
@@ -100,8 +102,13 @@ public:
         glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
  
-private:
-
+    // ------------------------------------------------------------------------
+    // 程序对象和uniform的location，用于录制渲染命令（见 command_buffer.h）
+    GLuint id() const
+    {
+        return ID;
+    }
+    // ------------------------------------------------------------------------
     GLint getUniformLocation(const std::string& name) const{
         GLint location = glGetUniformLocation(ID, name.c_str());
         if(location == -1){
@@ -110,6 +117,8 @@ private:
         return location;
     }
  
+private:
+
     void compileAndAttachShader(const ShaderSourcePair& shaderSourcePair){
         std::string shaderCode;
         try{
@@ -180,7 +189,8 @@ std::unordered_map<ShaderProgram::ShaderType, const char*> ShaderProgram::shader
     {ShaderProgram::ShaderType::TESSCONTROL, "TESS_CONTROL"},
     {ShaderProgram::ShaderType::TESSEVALUATION, "TESS_EVALUATION"},
     {ShaderProgram::ShaderType::GEOMETRY, "GEOMETRY"},
-    {ShaderProgram::ShaderType::FRAGMENT, "FRAGMENT"}
+    {ShaderProgram::ShaderType::FRAGMENT, "FRAGMENT"},
+    {ShaderProgram::ShaderType::COMPUTE, "COMPUTE"}
 };
  
 #endif
@@ -0,0 +1,50 @@
+// SIMD指令集的检测，其他头文件根据这里的宏选择实现：
+//  -- SIMD_SSE2 : x64平台总是可用
+//  -- SIMD_AVX2 : 需要打开CMake选项 ENABLE_AVX2（MSVC: /arch:AVX2 /fp:precise，GCC/Clang: -mavx2 -mfma -mf16c -ffp-contract=off）
+//  -- SIMD_F16C : 半精度浮点数转换指令，随AVX2一起打开
+// 没有对应指令集时，各个模块都会退回到标量实现
+// 另外提供处理比较掩码的位操作函数
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__F16C__) || defined(__AVX2__)
+#define SIMD_F16C
+#include <immintrin.h>
+#endif
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// SIMD比较结果的掩码处理（C++17没有 <bit>）
+inline int popCount(uint32_t value) {
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    return static_cast<int>((((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+// value 不能为0
+inline int countTrailingZeros(uint32_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+#endif // SIMD_H
@@ -0,0 +1,82 @@
+// 单生产者单消费者的无锁环形队列
+//  -- 容量向上取整为2的幂，满时 push 返回false（不覆盖也不阻塞），空时 pop 返回false
+//  -- 生产者只写 m_tail，消费者只写 m_head，各自缓存对方的下标，只有缓存的下标不够用时才读取对方的原子变量
+//  -- 两组下标放在不同的缓存行中，避免生产者和消费者之间的伪共享
+// 同一时刻只能有一个线程调用 push，一个线程调用 pop，两者可以是同一个线程
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+template <typename T>
+class SpscQueue {
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 生产者调用
+    bool push(const T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask) {
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用
+    bool pop(T& value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false;
+            }
+        }
+        value = m_slots[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 其他线程同时修改时只是一个近似值
+    size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return m_mask + 1;
+    }
+
+private:
+    std::vector<T> m_slots;
+    size_t m_mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{0};    // 消费者写
+    size_t m_cachedTail = 0;                                    // 消费者缓存的 m_tail
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{0};    // 生产者写
+    size_t m_cachedHead = 0;                                    // 生产者缓存的 m_head
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,24 @@
+// 使用 JobSystem 批量读取和解码纹理，上传仍然需要在GL线程中调用 uploadTextureImage
+// 与 textures_loader.h 分开，只加载单个纹理的程序不需要依赖 JobSystem
+
+#ifndef TEXTURE_JOBS_H
+#define TEXTURE_JOBS_H
+
+#include <string>
+#include <vector>
+
+#include "job_system.h"
+#include "textures_loader.h"
+
+// 每个文件的读取和解码是 jobs 中的一个任务，结果与 paths 的顺序相同，失败的图像为空
+std::vector<TextureImage> decodeTextures(JobSystem& jobs, const std::vector<std::string>& paths, bool flipVertically = true) {
+    std::vector<TextureImage> images(paths.size());
+    jobs.parallelFor(0, paths.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            images[i] = decodeTexture(paths[i].c_str(), flipVertically);
+        }
+    });
+    return images;
+}
+
+#endif // TEXTURE_JOBS_H
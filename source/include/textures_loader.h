@@ -5,39 +5,254 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 解码后的图像数据，解码和上传分开进行，解码可以放在工作线程中执行
+// 像素数据由malloc分配（与stb_image一致），所有mip层级连续存放
+struct TextureImage {
+    int width = 0;
+    int height = 0;
+    int nrComponents = 0;
+    GLenum type = GL_UNSIGNED_BYTE;         // GL_UNSIGNED_BYTE 或者 GL_FLOAT(HDR)
+    std::vector<size_t> levelOffsets;       // 每一个mip层级在pixels中的偏移，KTX2文件可能自带mip
+    std::unique_ptr<unsigned char, void(*)(void*)> pixels{nullptr, stbi_image_free};
+
+    explicit operator bool() const {
+        return pixels != nullptr;
+    }
+
+    int levelCount() const {
+        return static_cast<int>(levelOffsets.size());
+    }
+};
+
+/* ------------------------------------------ KTX2 ------------------------------------------*/
+// 只支持未经超压缩(supercompressionScheme == 0)的非压缩格式的2D纹理
+namespace ktx2 {
+
+const unsigned char IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// 文件中使用的VkFormat取值
+enum VkFormat : uint32_t {
+    R8_UNORM = 9,
+    R8G8_UNORM = 16,
+    R8G8B8_UNORM = 23,
+    R8G8B8A8_UNORM = 37,
+    R32G32B32_SFLOAT = 106,
+    R32G32B32A32_SFLOAT = 109,
+};
+
+struct Header {
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+bool isKtx2(const unsigned char* buffer, size_t length) {
+    return length >= sizeof(IDENTIFIER) && std::memcmp(buffer, IDENTIFIER, sizeof(IDENTIFIER)) == 0;
+}
+
+// 根据VkFormat得到通道数和数据类型，不支持的格式返回false
+bool getFormatInfo(uint32_t vkFormat, int& nrComponents, GLenum& type) {
+    switch (vkFormat) {
+        case R8_UNORM:            nrComponents = 1; type = GL_UNSIGNED_BYTE; return true;
+        case R8G8_UNORM:          nrComponents = 2; type = GL_UNSIGNED_BYTE; return true;
+        case R8G8B8_UNORM:        nrComponents = 3; type = GL_UNSIGNED_BYTE; return true;
+        case R8G8B8A8_UNORM:      nrComponents = 4; type = GL_UNSIGNED_BYTE; return true;
+        case R32G32B32_SFLOAT:    nrComponents = 3; type = GL_FLOAT; return true;
+        case R32G32B32A32_SFLOAT: nrComponents = 4; type = GL_FLOAT; return true;
+        default: return false;
+    }
+}
+
+TextureImage decode(const unsigned char* buffer, size_t length, bool flipVertically) {
+    TextureImage image;
+    Header header;
+    size_t headerEnd = sizeof(IDENTIFIER) + sizeof(Header);
+    if (!isKtx2(buffer, length) || length < headerEnd) {
+        return image;
+    }
+    std::memcpy(&header, buffer + sizeof(IDENTIFIER), sizeof(Header));
+    if (header.supercompressionScheme != 0 || header.pixelDepth > 1 || header.faceCount != 1 || header.layerCount > 1) {
+        std::cout << "KTX2: unsupported texture layout" << std::endl;
+        return image;
+    }
+    if (!getFormatInfo(header.vkFormat, image.nrComponents, image.type)) {
+        std::cout << "KTX2: unsupported vkFormat " << header.vkFormat << std::endl;
+        return image;
+    }
+    // 宽高需要能表示为int（glTexImage2D的参数），层级数不会超过32
+    if (header.pixelWidth == 0 || header.pixelHeight == 0 ||
+        header.pixelWidth > static_cast<uint32_t>(INT_MAX) || header.pixelHeight > static_cast<uint32_t>(INT_MAX) ||
+        header.levelCount > 32) {
+        std::cout << "KTX2: invalid texture size" << std::endl;
+        return image;
+    }
+    uint32_t levelCount = header.levelCount == 0 ? 1 : header.levelCount;
+    if (length < headerEnd + levelCount * sizeof(LevelIndex)) {
+        return image;
+    }
+    std::vector<LevelIndex> levels(levelCount);
+    std::memcpy(levels.data(), buffer + headerEnd, levelCount * sizeof(LevelIndex));
+
+    // 每个层级至少要有 uploadTextureImage 上传的字节数，否则 glTexImage2D 会读越界
+    size_t pixelSize = image.nrComponents * (image.type == GL_FLOAT ? sizeof(float) : 1);
+    size_t totalSize = 0;
+    for (uint32_t i = 0; i < levelCount; i++) {
+        const LevelIndex& level = levels[i];
+        uint64_t expectedSize = static_cast<uint64_t>(std::max(1u, header.pixelWidth >> i)) *
+                                std::max(1u, header.pixelHeight >> i) * pixelSize;
+        if (level.byteOffset > length || level.byteLength > length - level.byteOffset) {
+            std::cout << "KTX2: truncated file" << std::endl;
+            return image;
+        }
+        if (level.byteLength < expectedSize) {
+            std::cout << "KTX2: level " << i << " is smaller than expected" << std::endl;
+            return image;
+        }
+        totalSize += static_cast<size_t>(level.byteLength);
+    }
+
+    image.width = static_cast<int>(header.pixelWidth);
+    image.height = static_cast<int>(header.pixelHeight);
+    image.pixels.reset(static_cast<unsigned char*>(std::malloc(totalSize)));
+    if (!image) {
+        return image;
+    }
+    size_t offset = 0;
+    for (uint32_t i = 0; i < levelCount; i++) {
+        image.levelOffsets.push_back(offset);
+        const unsigned char* src = buffer + levels[i].byteOffset;
+        unsigned char* dst = image.pixels.get() + offset;
+        // KTX2默认原点在左上角，与stb_image一致，翻转时逐行倒序拷贝
+        size_t levelHeight = std::max<size_t>(1, header.pixelHeight >> i);
+        size_t rowSize = std::max<size_t>(1, header.pixelWidth >> i) * pixelSize;
+        if (flipVertically && rowSize * levelHeight == levels[i].byteLength) {
+            for (size_t row = 0; row < levelHeight; row++) {
+                std::memcpy(dst + row * rowSize, src + (levelHeight - 1 - row) * rowSize, rowSize);
+            }
+        } else {
+            std::memcpy(dst, src, static_cast<size_t>(levels[i].byteLength));
+        }
+        offset += static_cast<size_t>(levels[i].byteLength);
+    }
+    return image;
+}
+
+} // namespace ktx2
+
+/* ------------------------------------------ decode ------------------------------------------*/
+
+// 从内存中解码图像，支持stb_image支持的格式（包括HDR）以及KTX2
+TextureImage decodeTextureFromMemory(const unsigned char* buffer, size_t length, bool flipVertically = true) {
+    if (ktx2::isKtx2(buffer, length)) {
+        return ktx2::decode(buffer, length, flipVertically);
+    }
+
+    TextureImage image;
+    int size = static_cast<int>(length);
+    // 只设置当前线程的翻转选项，多个线程可以同时解码
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+    if (stbi_is_hdr_from_memory(buffer, size)) {
+        float* data = stbi_loadf_from_memory(buffer, size, &image.width, &image.height, &image.nrComponents, 0);
+        image.pixels.reset(reinterpret_cast<unsigned char*>(data));
+        image.type = GL_FLOAT;
+    } else {
+        unsigned char* data = stbi_load_from_memory(buffer, size, &image.width, &image.height, &image.nrComponents, 0);
+        image.pixels.reset(data);
+        image.type = GL_UNSIGNED_BYTE;
+    }
+    if (image) {
+        image.levelOffsets.push_back(0);
+    }
+    return image;
+}
+
+TextureImage decodeTexture(char const * path, bool flipVertically = true) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return TextureImage();
+    }
+    std::vector<unsigned char> buffer(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    return decodeTextureFromMemory(buffer.data(), buffer.size(), flipVertically);
+}
+
+/* ------------------------------------------ upload ------------------------------------------*/
+
+// 上传到当前绑定的GL_TEXTURE_2D，只有一个层级时不会生成mipmap，由调用者决定是否调用glGenerateMipmap
+void uploadTextureImage(const TextureImage& image) {
+    static const GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    static const GLenum ldrInternalFormats[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    static const GLenum hdrInternalFormats[] = {GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F};
+
+    GLenum format = formats[image.nrComponents - 1];
+    GLenum internalFormat = image.type == GL_FLOAT ? hdrInternalFormats[image.nrComponents - 1]
+                                                   : ldrInternalFormats[image.nrComponents - 1];
+
+    // 每行像素不一定是4字节对齐的（例如宽度为奇数的RGB图像）
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = 0; level < image.levelCount(); level++) {
+        int width = std::max(1, image.width >> level);
+        int height = std::max(1, image.height >> level);
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, format, image.type,
+                     image.pixels.get() + image.levelOffsets[level]);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (image.levelCount() > 1) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levelCount() - 1);
+    }
+}
+
 unsigned int loadTexture(char const * path, bool flipVertically = true)
 {
     unsigned int textureID;
     glGenTextures(1, &textureID);
-    
-    int width, height, nrComponents;
-    stbi_set_flip_vertically_on_load(flipVertically);
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
 
+    TextureImage image = decodeTexture(path, flipVertically);
+    if (image)
+    {
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        uploadTextureImage(image);
+        if (image.levelCount() == 1)
+            glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
     }
     else
     {
         std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
     }
 
     return textureID;
@@ -52,7 +267,7 @@ unsigned int loadCubemap(std::vector<std::string> faces, bool flipVertically = f
     int width, height, nrChannels;
     for (unsigned int i = 0; i < faces.size(); i++)
     {
-        stbi_set_flip_vertically_on_load(flipVertically);
+        stbi_set_flip_vertically_on_load_thread(flipVertically);
         unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
         if (data)
         {
@@ -81,4 +296,4 @@ unsigned int loadCubemap(std::vector<std::string> faces, bool flipVertically = f
     return textureID;
 }
 
-#endif
\ No newline at end of file
+#endif
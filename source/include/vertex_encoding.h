@@ -0,0 +1,280 @@
+#ifndef VERTEX_ENCODING_H
+#define VERTEX_ENCODING_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "simd.h"
+#include "vertex_format.h"
+
+// 顶点属性的压缩编码，与 vertex_format.h 中的紧凑布局配合使用：
+//  -- 位置   : 在网格包围盒内量化为16位无符号归一化整数，着色器中得到 [0, 1]，
+//              反量化矩阵 QuantizationBounds::dequantizeMatrix() 可以直接乘到模型矩阵上
+//  -- 法线   : 10_10_10_2 有符号归一化整数，w 保存切线的副切线方向
+//  -- 纹理坐标: 半精度浮点数
+// 批量编码函数都接受按字节计算的步长，可以直接从交错的顶点数据编码到交错的紧凑顶点中
+// 每种编码都提供标量版本(xxxScalar)和SIMD版本，两者的结果完全一致
+namespace vertex_encoding {
+
+/* ------------------------------------------ 单个值的编码 ------------------------------------------*/
+
+// 就近舍入到偶数，与 _mm_cvtps_ph 和 _mm_cvtps_epi32 的默认舍入方式一致
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t absolute = bits & 0x7FFFFFFFu;
+
+    if (absolute >= 0x7F800000u) {
+        // Inf 和 NaN
+        return static_cast<uint16_t>(sign | (absolute > 0x7F800000u ? 0x7E00u : 0x7C00u));
+    }
+    if (absolute >= 0x477FF000u) {
+        // 超过半精度能表示的最大值，溢出为Inf
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (absolute < 0x38800000u) {
+        // 非规格化数，半精度的最小单位为 2^-24
+        float magnitude;
+        std::memcpy(&magnitude, &absolute, sizeof(magnitude));
+        return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(magnitude * 16777216.0f)));
+    }
+    // 调整指数的偏移(127 -> 15)，并在截断尾数之前就近舍入到偶数
+    absolute += 0xC8000FFFu + ((absolute >> 13) & 1u);
+    return static_cast<uint16_t>(sign | (absolute >> 13));
+}
+
+float halfToFloat(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+    float result;
+    if (exponent == 0) {
+        result = std::ldexp(static_cast<float>(mantissa), -24);
+    } else if (exponent == 31) {
+        result = mantissa == 0 ? INFINITY : NAN;
+    } else {
+        uint32_t bits = ((exponent + 112u) << 23) | (mantissa << 13);
+        std::memcpy(&result, &bits, sizeof(result));
+    }
+    return sign ? -result : result;
+}
+
+uint32_t packSnorm1010102(float x, float y, float z, float w = 0.0f) {
+    auto pack = [](float value, float scale, uint32_t mask) {
+        float clamped = std::min(1.0f, std::max(-1.0f, value));
+        return static_cast<uint32_t>(static_cast<int32_t>(std::nearbyint(clamped * scale))) & mask;
+    };
+    return pack(x, 511.0f, 0x3FFu) | (pack(y, 511.0f, 0x3FFu) << 10) |
+           (pack(z, 511.0f, 0x3FFu) << 20) | (pack(w, 1.0f, 0x3u) << 30);
+}
+
+// 与OpenGL 4.2之后的规则一致：c / (2^(b-1) - 1)，并把最小值钳制到 -1
+glm::vec4 unpackSnorm1010102(uint32_t packed) {
+    auto unpack = [](uint32_t bits, int width) {
+        int32_t value = static_cast<int32_t>(bits << (32 - width)) >> (32 - width);
+        return std::max(-1.0f, static_cast<float>(value) / static_cast<float>((1 << (width - 1)) - 1));
+    };
+    return glm::vec4(unpack(packed & 0x3FFu, 10), unpack((packed >> 10) & 0x3FFu, 10),
+                     unpack((packed >> 20) & 0x3FFu, 10), unpack(packed >> 30, 2));
+}
+
+// 位置量化使用的包围盒
+struct QuantizationBounds {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 extent = glm::vec3(1.0f);
+
+    // positions 中每个位置占3个float，相邻位置相隔 stride 字节
+    static QuantizationBounds compute(const float* positions, size_t count, size_t stride) {
+        QuantizationBounds bounds;
+        if (count == 0) {
+            return bounds;
+        }
+        glm::vec3 lower(INFINITY), upper(-INFINITY);
+        for (size_t i = 0; i < count; i++) {
+            const float* p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + i * stride);
+            lower = glm::min(lower, glm::vec3(p[0], p[1], p[2]));
+            upper = glm::max(upper, glm::vec3(p[0], p[1], p[2]));
+        }
+        bounds.min = lower;
+        bounds.extent = upper - lower;
+        return bounds;
+    }
+
+    // 每个轴的量化系数，包围盒在某个轴上厚度为0时该轴量化为0
+    glm::vec3 scale() const {
+        return glm::vec3(extent.x > 0.0f ? 65535.0f / extent.x : 0.0f,
+                         extent.y > 0.0f ? 65535.0f / extent.y : 0.0f,
+                         extent.z > 0.0f ? 65535.0f / extent.z : 0.0f);
+    }
+
+    // 把 [0, 1] 的归一化位置变换回网格空间
+    glm::mat4 dequantizeMatrix() const {
+        return glm::scale(glm::translate(glm::mat4(1.0f), min), extent);
+    }
+
+    glm::vec3 dequantize(const uint16_t* quantized) const {
+        return min + extent * glm::vec3(quantized[0], quantized[1], quantized[2]) / 65535.0f;
+    }
+};
+
+/* ------------------------------------------ 批量编码 ------------------------------------------*/
+
+template <typename T>
+const T* strided(const void* base, size_t index, size_t stride) {
+    return reinterpret_cast<const T*>(reinterpret_cast<const char*>(base) + index * stride);
+}
+
+template <typename T>
+T* strided(void* base, size_t index, size_t stride) {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(base) + index * stride);
+}
+
+// 每个输出占4个uint16，第4个分量为0
+void encodePositionsScalar(const float* src, size_t srcStride, size_t count, const QuantizationBounds& bounds,
+                           uint16_t* dst, size_t dstStride) {
+    glm::vec3 scale = bounds.scale();
+    for (size_t i = 0; i < count; i++) {
+        const float* p = strided<float>(src, i, srcStride);
+        uint16_t* q = strided<uint16_t>(dst, i, dstStride);
+        for (int axis = 0; axis < 3; axis++) {
+            float value = (p[axis] - bounds.min[axis]) * scale[axis];
+            q[axis] = static_cast<uint16_t>(std::nearbyint(std::min(65535.0f, std::max(0.0f, value))));
+        }
+        q[3] = 0;
+    }
+}
+
+void encodePositions(const float* src, size_t srcStride, size_t count, const QuantizationBounds& bounds,
+                     uint16_t* dst, size_t dstStride) {
+#ifdef SIMD_SSE2
+    glm::vec3 scale = bounds.scale();
+    const __m128 minimum = _mm_set_ps(0.0f, bounds.min.z, bounds.min.y, bounds.min.x);
+    const __m128 factor = _mm_set_ps(0.0f, scale.z, scale.y, scale.x);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 upper = _mm_set1_ps(65535.0f);
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    for (size_t i = 0; i < count; i++) {
+        const float* p = strided<float>(src, i, srcStride);
+        __m128 value = _mm_mul_ps(_mm_sub_ps(_mm_set_ps(0.0f, p[2], p[1], p[0]), minimum), factor);
+        value = _mm_min_ps(_mm_max_ps(value, zero), upper);
+        // SSE2没有无符号饱和打包，先减去32768做有符号打包，再翻转最高位
+        __m128i integer = _mm_sub_epi32(_mm_cvtps_epi32(value), bias32);
+        __m128i packed = _mm_xor_si128(_mm_packs_epi32(integer, integer), bias16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(strided<uint16_t>(dst, i, dstStride)), packed);
+    }
+#else
+    encodePositionsScalar(src, srcStride, count, bounds, dst, dstStride);
+#endif
+}
+
+// hasW 为true时读取第4个分量作为w（切线的副切线方向，取值为±1），否则w为0
+void encodeNormalsScalar(const float* src, size_t srcStride, size_t count, bool hasW, uint32_t* dst, size_t dstStride) {
+    for (size_t i = 0; i < count; i++) {
+        const float* n = strided<float>(src, i, srcStride);
+        *strided<uint32_t>(dst, i, dstStride) = packSnorm1010102(n[0], n[1], n[2], hasW ? n[3] : 0.0f);
+    }
+}
+
+void encodeNormals(const float* src, size_t srcStride, size_t count, bool hasW, uint32_t* dst, size_t dstStride) {
+#ifdef SIMD_SSE2
+    const __m128 lower = _mm_set1_ps(-1.0f);
+    const __m128 upper = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(511.0f);
+    const __m128i mask10 = _mm_set1_epi32(0x3FF);
+    const __m128i mask2 = _mm_set1_epi32(0x3);
+    size_t i = 0;
+    // 每次处理4个顶点，每个寄存器保存4个顶点的同一个分量
+    for (; i + 4 <= count; i += 4) {
+        const float* n0 = strided<float>(src, i + 0, srcStride);
+        const float* n1 = strided<float>(src, i + 1, srcStride);
+        const float* n2 = strided<float>(src, i + 2, srcStride);
+        const float* n3 = strided<float>(src, i + 3, srcStride);
+        __m128 x = _mm_set_ps(n3[0], n2[0], n1[0], n0[0]);
+        __m128 y = _mm_set_ps(n3[1], n2[1], n1[1], n0[1]);
+        __m128 z = _mm_set_ps(n3[2], n2[2], n1[2], n0[2]);
+        __m128 w = hasW ? _mm_set_ps(n3[3], n2[3], n1[3], n0[3]) : _mm_setzero_ps();
+
+        __m128i xi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, lower), upper), scale)), mask10);
+        __m128i yi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, lower), upper), scale)), mask10);
+        __m128i zi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, lower), upper), scale)), mask10);
+        __m128i wi = _mm_and_si128(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(w, lower), upper)), mask2);
+        __m128i packed = _mm_or_si128(_mm_or_si128(xi, _mm_slli_epi32(yi, 10)),
+                                      _mm_or_si128(_mm_slli_epi32(zi, 20), _mm_slli_epi32(wi, 30)));
+
+        *strided<uint32_t>(dst, i + 0, dstStride) = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+        *strided<uint32_t>(dst, i + 1, dstStride) = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi32(packed, 1)));
+        *strided<uint32_t>(dst, i + 2, dstStride) = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi32(packed, 2)));
+        *strided<uint32_t>(dst, i + 3, dstStride) = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi32(packed, 3)));
+    }
+    encodeNormalsScalar(strided<float>(src, i, srcStride), srcStride, count - i, hasW,
+                        strided<uint32_t>(dst, i, dstStride), dstStride);
+#else
+    encodeNormalsScalar(src, srcStride, count, hasW, dst, dstStride);
+#endif
+}
+
+// 每个输入和输出都是2个分量
+void encodeHalf2Scalar(const float* src, size_t srcStride, size_t count, uint16_t* dst, size_t dstStride) {
+    for (size_t i = 0; i < count; i++) {
+        const float* v = strided<float>(src, i, srcStride);
+        uint16_t* h = strided<uint16_t>(dst, i, dstStride);
+        h[0] = floatToHalf(v[0]);
+        h[1] = floatToHalf(v[1]);
+    }
+}
+
+void encodeHalf2(const float* src, size_t srcStride, size_t count, uint16_t* dst, size_t dstStride) {
+#ifdef SIMD_F16C
+    size_t i = 0;
+    // 每次转换2个顶点的4个分量
+    for (; i + 2 <= count; i += 2) {
+        const float* v0 = strided<float>(src, i, srcStride);
+        const float* v1 = strided<float>(src, i + 1, srcStride);
+        __m128i halves = _mm_cvtps_ph(_mm_set_ps(v1[1], v1[0], v0[1], v0[0]), _MM_FROUND_TO_NEAREST_INT);
+        uint32_t first = static_cast<uint32_t>(_mm_cvtsi128_si32(halves));
+        uint32_t second = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(halves, 4)));
+        std::memcpy(strided<uint16_t>(dst, i, dstStride), &first, sizeof(first));
+        std::memcpy(strided<uint16_t>(dst, i + 1, dstStride), &second, sizeof(second));
+    }
+    encodeHalf2Scalar(strided<float>(src, i, srcStride), srcStride, count - i, strided<uint16_t>(dst, i, dstStride), dstStride);
+#else
+    encodeHalf2Scalar(src, srcStride, count, dst, dstStride);
+#endif
+}
+
+/* ------------------------------------------ 紧凑顶点 ------------------------------------------*/
+
+// 与 CompactVertexLayout 对应
+struct CompactVertex {
+    uint16_t position[4];
+    uint32_t normal;
+    uint16_t uv[2];
+};
+
+static_assert(sizeof(CompactVertex) == CompactVertexLayout::stride, "CompactVertex does not match CompactVertexLayout");
+
+// vertices 为 StandardVertexLayout 格式：位置(3) 法线(3) 纹理坐标(2)
+std::vector<CompactVertex> encodeCompactVertices(const float* vertices, size_t count, const QuantizationBounds& bounds) {
+    const size_t srcStride = StandardVertexLayout::stride;
+    std::vector<CompactVertex> result(count);
+    if (count == 0) {
+        return result;
+    }
+    encodePositions(vertices, srcStride, count, bounds, result.data()->position, sizeof(CompactVertex));
+    encodeNormals(vertices + 3, srcStride, count, false, &result.data()->normal, sizeof(CompactVertex));
+    encodeHalf2(vertices + 6, srcStride, count, result.data()->uv, sizeof(CompactVertex));
+    return result;
+}
+
+} // namespace vertex_encoding
+
+#endif // VERTEX_ENCODING_H
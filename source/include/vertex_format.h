@@ -0,0 +1,148 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// 顶点格式描述，所有属性都来自同一个顶点缓冲（binding 0）
+// apply() 使用分离的属性格式(glVertexAttribFormat)，更换顶点缓冲时不需要重新设置属性
+struct VertexAttribute {
+    GLuint location;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLuint offset;
+    bool integer = false;   // 为true时以整数形式传给着色器(ivec/uvec)，否则转换为float
+
+    bool operator==(const VertexAttribute& other) const {
+        return location == other.location && size == other.size && type == other.type &&
+               normalized == other.normalized && offset == other.offset && integer == other.integer;
+    }
+
+    // 设置当前绑定的VAO上这个属性的格式
+    void apply(GLuint bindingIndex) const {
+        if (integer) {
+            glVertexAttribIFormat(location, size, type, offset);
+        } else {
+            glVertexAttribFormat(location, size, type, normalized, offset);
+        }
+        glVertexAttribBinding(location, bindingIndex);
+        glEnableVertexAttribArray(location);
+    }
+};
+
+struct VertexFormat {
+    GLsizei stride = 0;
+    std::vector<VertexAttribute> attributes;
+
+    bool operator==(const VertexFormat& other) const {
+        return stride == other.stride && attributes == other.attributes;
+    }
+
+    bool operator!=(const VertexFormat& other) const {
+        return !(*this == other);
+    }
+
+    // 在当前绑定的VAO上设置属性格式，并把所有属性关联到bindingIndex
+    void apply(GLuint bindingIndex = 0) const {
+        for (const auto& attribute : attributes) {
+            attribute.apply(bindingIndex);
+        }
+    }
+
+    // 位置(3) 法线(3) 纹理坐标(2)，与 Box 的顶点数据一致
+    static VertexFormat positionNormalUV();
+};
+
+/* ------------------------------------------ 编译期顶点布局 ------------------------------------------*/
+// 用模板描述顶点布局，步长和偏移在编译期计算，例如：
+//     using Layout = VertexLayout<Float3Attribute<0>, Float3Attribute<1>, Float2Attribute<2>>;
+//     Layout::stride            -> 32
+//     Layout::offset<2>()       -> 24
+//     Layout::apply()           -> 展开为每个属性的 glVertexAttribFormat 调用
+//     Layout::format()          -> 运行期的 VertexFormat，用于 GeometryPool
+
+template <GLuint Location, GLint Size, GLenum Type, bool Normalized, GLuint Bytes, bool Integer = false>
+struct AttributeDesc {
+    static constexpr GLuint location = Location;
+    static constexpr GLint size = Size;
+    static constexpr GLenum type = Type;
+    static constexpr bool normalized = Normalized;
+    static constexpr GLuint bytes = Bytes;
+    static constexpr bool integer = Integer;
+};
+
+template <GLuint Location> using Float2Attribute = AttributeDesc<Location, 2, GL_FLOAT, false, 8>;
+template <GLuint Location> using Float3Attribute = AttributeDesc<Location, 3, GL_FLOAT, false, 12>;
+template <GLuint Location> using Float4Attribute = AttributeDesc<Location, 4, GL_FLOAT, false, 16>;
+// 两个半精度浮点数，适合纹理坐标
+template <GLuint Location> using Half2Attribute = AttributeDesc<Location, 2, GL_HALF_FLOAT, false, 4>;
+// xyz为10位有符号归一化整数，w为2位，适合法线和切线（w保存副切线的方向）
+template <GLuint Location> using Snorm1010102Attribute = AttributeDesc<Location, 4, GL_INT_2_10_10_10_REV, true, 4>;
+// 4个16位无符号归一化整数，适合在包围盒内量化的位置，第4个分量只用于对齐
+template <GLuint Location> using Unorm16x4Attribute = AttributeDesc<Location, 4, GL_UNSIGNED_SHORT, true, 8>;
+
+template <typename... Attributes>
+struct VertexLayout {
+    static constexpr size_t attributeCount = sizeof...(Attributes);
+    static constexpr GLsizei stride = static_cast<GLsizei>((Attributes::bytes + ... + 0));
+
+    template <size_t Index>
+    static constexpr GLuint offset() {
+        constexpr std::array<GLuint, attributeCount> sizes = {Attributes::bytes...};
+        GLuint result = 0;
+        for (size_t i = 0; i < Index; i++) {
+            result += sizes[i];
+        }
+        return result;
+    }
+
+    static void apply(GLuint bindingIndex = 0) {
+        applyAttributes(bindingIndex, std::index_sequence_for<Attributes...>());
+    }
+
+    static VertexFormat format() {
+        return makeFormat(std::index_sequence_for<Attributes...>());
+    }
+
+private:
+    template <size_t... Indices>
+    static void applyAttributes(GLuint bindingIndex, std::index_sequence<Indices...>) {
+        (makeAttribute<Attributes, offset<Indices>()>().apply(bindingIndex), ...);
+    }
+
+    template <size_t... Indices>
+    static VertexFormat makeFormat(std::index_sequence<Indices...>) {
+        VertexFormat result;
+        result.stride = stride;
+        result.attributes = {makeAttribute<Attributes, offset<Indices>()>()...};
+        return result;
+    }
+
+    template <typename Attribute, GLuint Offset>
+    static VertexAttribute makeAttribute() {
+        return {Attribute::location, Attribute::size, Attribute::type,
+                Attribute::normalized ? GLboolean(GL_TRUE) : GLboolean(GL_FALSE), Offset, Attribute::integer};
+    }
+};
+
+// 位置(3) 法线(3) 纹理坐标(2)，共32字节
+using StandardVertexLayout = VertexLayout<Float3Attribute<0>, Float3Attribute<1>, Float2Attribute<2>>;
+// 量化位置(8) 法线(4) 纹理坐标(4)，共16字节
+using CompactVertexLayout = VertexLayout<Unorm16x4Attribute<0>, Snorm1010102Attribute<1>, Half2Attribute<2>>;
+// 在 CompactVertexLayout 的基础上增加切线(4)，共20字节
+using CompactTangentVertexLayout = VertexLayout<Unorm16x4Attribute<0>, Snorm1010102Attribute<1>, Half2Attribute<2>, Snorm1010102Attribute<3>>;
+
+static_assert(StandardVertexLayout::stride == 32, "unexpected standard vertex size");
+static_assert(CompactVertexLayout::stride == 16, "unexpected compact vertex size");
+static_assert(CompactTangentVertexLayout::stride == 20, "unexpected compact tangent vertex size");
+
+inline VertexFormat VertexFormat::positionNormalUV() {
+    return StandardVertexLayout::format();
+}
+
+#endif // VERTEX_FORMAT_H